@@ -323,39 +323,8 @@ int main() {
                 it->second.setText("// context.cpp\n#include \"fastener/core/context.h\"\n\nnamespace fst {\n    // Implementation here\n}\n");
             }
 
-            it->second.setStyleProvider([](int lineIndex, const std::string& text) {
-                std::vector<TextSegment> segments;
-                static const std::vector<std::string> keywords = {
-                    "int", "void", "float", "bool", "char", "if", "else", "for", "while", "return",
-                    "namespace", "class", "struct", "public", "private", "protected", "static", "const", "using", "include"
-                };
-
-                std::string word;
-                for (int i = 0; i < (int)text.length(); ++i) {
-                    char ch = text[i];
-                    if (isalnum(ch) || ch == '_') {
-                        word += ch;
-                    } else {
-                        if (!word.empty()) {
-                            if (std::find(keywords.begin(), keywords.end(), word) != keywords.end()) {
-                                segments.push_back({i - (int)word.length(), i, Color(86, 156, 214)});
-                            } else if (isdigit(word[0])) {
-                                segments.push_back({i - (int)word.length(), i, Color(181, 206, 168)});
-                            }
-                            word.clear();
-                        }
-                        if (ch == '#' || ch == '<' || ch == '>' || ch == '(' || ch == ')' || ch == '{' || ch == '}' || ch == '[' || ch == ']') {
-                            segments.push_back({i, i + 1, Color(212, 212, 212)});
-                        }
-                    }
-                }
-                if (!word.empty()) {
-                    if (std::find(keywords.begin(), keywords.end(), word) != keywords.end()) {
-                        segments.push_back({(int)text.length() - (int)word.length(), (int)text.length(), Color(86, 156, 214)});
-                    }
-                }
-                return segments;
-            });
+            static const std::shared_ptr<const SyntaxHighlighter> cppHighlighter = SyntaxHighlighter::cpp();
+            it->second.setHighlighter(cppHighlighter);
         }
         return it->second;
     };
@@ -466,6 +435,9 @@ int main() {
         }
     });
     
+    // Poll input as late as the present deadline allows
+    FramePacer pacer(&ctx.profiler());
+    
     auto renderFrame = [&]() {
         ctx.beginFrame(window);
         
@@ -1692,19 +1664,23 @@ int main() {
         RenderToasts(ctx);
         
         ctx.endFrame();
+        pacer.markFrameBuilt();
         window.swapBuffers();
     };
 
     window.setRefreshCallback(renderFrame);
     
     while (window.isOpen()) {
+        pacer.waitForNextFrame();
         window.pollEvents();
+        pacer.markInputSampled();
         if (window.input().isKeyPressed(Key::Escape)) {
             if (menuBar.isOpen()) menuBar.closeAll();
             else if (IsContextMenuOpen(ctx)) CloseContextMenu(ctx);
             else window.close();
         }
         renderFrame();
+        pacer.framePresented();
     }
     
     return 0;
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <algorithm>
 #include <filesystem>
+#include <thread>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -118,8 +119,18 @@ int main() {
     while (mainWindow->isOpen()) {
         wm.pollAllEvents();
         
+        // Zminimalizowane i zasłonięte okna nie są renderowane
+        const auto& visible = wm.windowsNeedingRedraw();
+        auto needsRedraw = [&visible](Window* window) {
+            return std::find(visible.begin(), visible.end(), window) != visible.end();
+        };
+        if (visible.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            continue;
+        }
+        
         // === GŁÓWNE OKNO ===
-        if (!mainWindow->isMinimized()) {
+        if (needsRedraw(mainWindow)) {
             mainWindow->makeContextCurrent();
             ctx.beginFrame(*mainWindow);
             
@@ -198,7 +209,7 @@ int main() {
         }
         
         // === OKNO TOOLS ===
-        if (toolsWindow && toolsWindow->isOpen() && !toolsWindow->isMinimized()) {
+        if (toolsWindow && needsRedraw(toolsWindow)) {
             ctx.beginFrame(*toolsWindow);
             
             DrawList& dl = ctx.drawList();
@@ -5,6 +5,8 @@
  * @brief Library-wide constants to replace magic numbers.
  */
 
+#include <cstddef>
+
 namespace fst {
 namespace constants {
 
@@ -67,6 +69,41 @@ constexpr float DOUBLE_CLICK_TIME = 0.3f;
 /// Invalid time value for click detection initialization
 constexpr float INVALID_CLICK_TIME = -1.0f;
 
+/// Capacity of the pending input event ring buffer
+constexpr int INPUT_EVENT_QUEUE_CAPACITY = 256;
+
+//=============================================================================
+// Frame Pacing
+//=============================================================================
+
+/// Milliseconds kept free before the predicted vblank for scheduling jitter
+constexpr float FRAME_PACER_SAFETY_MARGIN_MS = 2.0f;
+
+/// Number of recent frames whose build time predicts the next one
+constexpr int FRAME_PACER_WORK_HISTORY = 16;
+
+/// Consecutive off-estimate intervals before the refresh estimate is reset
+constexpr int FRAME_PACER_RESYNC_FRAMES = 8;
+
+//=============================================================================
+// Layout
+//=============================================================================
+
+/// Maximum nesting depth of layout containers
+constexpr int MAX_LAYOUT_DEPTH = 64;
+
+/// Alignment of per-container layout state
+constexpr int CACHE_LINE_SIZE = 64;
+
+/// Minimum seconds between size-dependent relayouts during a splitter drag
+constexpr float RESIZE_RELAYOUT_INTERVAL = 1.0f / 15.0f;
+
+/// Seconds without a window size change before a live resize counts as settled
+constexpr float RESIZE_SETTLE_TIME = 0.15f;
+
+/// Blur backdrop textures grow in steps of this many pixels and never shrink
+constexpr int BACKDROP_TEXTURE_GRANULARITY = 128;
+
 //=============================================================================
 // UI Defaults
 //=============================================================================
@@ -80,5 +117,25 @@ constexpr float DEFAULT_SHADOW_BLUR = 8.0f;
 /// Default shadow offset
 constexpr float DEFAULT_SHADOW_OFFSET = 4.0f;
 
+//=============================================================================
+// Text Editing
+//=============================================================================
+
+/// Lines a TextEditor may tokenize for syntax highlighting per frame
+constexpr int TEXT_HIGHLIGHT_LINES_PER_FRAME = 2000;
+
+/// Lines around the view whose highlight segments a TextEditor keeps
+constexpr int TEXT_HIGHLIGHT_CACHED_LINES = 8192;
+
+/// Bytes a background text search scans between publishing matches
+constexpr size_t TEXT_SEARCH_WINDOW_BYTES = 4 * 1024 * 1024;
+
+/// Bytes of one line a regex search scans between cancellation checks; on
+/// longer lines a regex match is limited to this length
+constexpr size_t TEXT_SEARCH_REGEX_CHUNK_BYTES = 64 * 1024;
+
+/// Seconds without an edit before a TextEditor restarts an active search
+constexpr float TEXT_SEARCH_RESTART_DELAY = 0.15f;
+
 } // namespace constants
 } // namespace fst
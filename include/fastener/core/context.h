@@ -3,6 +3,8 @@
 #include "fastener/core/types.h"
 #include "fastener/core/input.h"
 #include "fastener/platform/platform_interface.h"
+#include <any>
+#include <chrono>
 #include <vector>
 #include <deque>
 #include <functional>
@@ -20,12 +22,23 @@ class Font;
 class LayoutContext;
 class DockContext;
 class Profiler;
+class GpuResourceCache;
+
+//=============================================================================
+// ResizeMode - How frames are laid out during a live window resize
+//=============================================================================
+enum class ResizeMode {
+    Relayout,   ///< Lay out at the new window size every frame
+    Stretch     ///< Keep the last settled layout, stretched to the window, until resizing stops
+};
 
 //=============================================================================
 // Context - Main application context
 //=============================================================================
 class Context {
 public:
+    using Clock = std::chrono::steady_clock;
+    
     Context(bool initializeRenderer = true);
     ~Context();
     
@@ -34,9 +47,24 @@ public:
     Context& operator=(const Context&) = delete;
     
     // Frame management
-    void beginFrame(IPlatformWindow& window);
+    void beginFrame(IPlatformWindow& window) { beginFrame(window, Clock::now()); }
+    /** @brief Begin a frame at an explicit time, e.g. to step time in tests. */
+    void beginFrame(IPlatformWindow& window, Clock::time_point now);
     void endFrame();
     
+    // Live window resize
+    void setResizeMode(ResizeMode mode);
+    ResizeMode resizeMode() const;
+    /** @brief Size this frame is laid out at; differs from the window while a resize is stretched. */
+    Vec2 layoutSize() const;
+    /**
+     * @brief True until the window size has been stable for constants::RESIZE_SETTLE_TIME.
+     * 
+     * Event-driven loops should keep redrawing while this is set so the
+     * settled frame gets laid out at the final size.
+     */
+    bool isWindowResizing() const;
+    
     // Profiling
     Profiler& profiler();
 
@@ -45,6 +73,12 @@ public:
     Theme& theme();
     const Theme& theme() const;
     
+    // Style generations - monotonically increasing, bumped only on real changes.
+    // In-place edits through theme() are detected at the next beginFrame.
+    uint64_t themeGeneration() const;
+    uint64_t fontGeneration() const;
+    uint64_t dpiGeneration() const;
+    
     // Font
     bool loadFont(const std::string& path, float size);
     Font* font() const;
@@ -58,6 +92,8 @@ public:
     DrawList& drawList();
     IDrawList* activeDrawList();  ///< Returns test DrawList if set, otherwise normal drawList
     Renderer& renderer();
+    /** @brief Share GL programs and buffers with other contexts, e.g. WindowManager::gpuResources(). Call before the first frame. */
+    void setGpuResourceCache(GpuResourceCache* cache);
     LayoutContext& layout();
     IPlatformWindow& window() const;
     DockContext& docking();
@@ -125,6 +161,41 @@ public:
     // Deferred rendering (for popups/tooltips)
     void deferRender(std::function<void()> cmd);
     
+    /**
+     * @brief Cache a widget's computed measurement across frames.
+     * 
+     * `compute` runs only when `inputsHash` differs from the stored value or
+     * the theme, font or DPI generation changed since it was stored. Entries that are not
+     * requested for a while are evicted.
+     * 
+     * @code
+     *   float w = ctx.measureCache<float>(id, hashString(label), [&] {
+     *       return font->measureText(label).x;
+     *   });
+     * @endcode
+     */
+    template <typename T, typename Fn>
+    const T& measureCache(WidgetId id, uint64_t inputsHash, Fn&& compute);
+    
+    /**
+     * @brief measureCache() for results that depend on the widget's size.
+     * 
+     * A change of `inputsHash` recomputes immediately. A change of only
+     * `sizeHash` during an interactive resize keeps returning the stale
+     * value (callers draw it clipped), recomputing at most every
+     * constants::RESIZE_RELAYOUT_INTERVAL seconds and once the drag ends.
+     */
+    template <typename T, typename Fn>
+    const T& measureCache(WidgetId id, uint64_t inputsHash, uint64_t sizeHash, Fn&& compute);
+    
+    /** @brief Report that a splitter is being dragged this frame. */
+    void beginInteractiveResize();
+    /** @brief True while a splitter was dragged this frame or the previous one. */
+    bool isInteractiveResizing() const;
+    
+    /** @brief Combined theme, font and DPI generation (changes when any does). */
+    uint64_t styleGeneration() const;
+    
     // Menu state management (for internal use)
     struct MenuState {
         Rect contextMenuRect;
@@ -140,10 +211,48 @@ public:
     static IDrawList* testDrawList();
     
 private:
+    struct MeasureCacheEntry {
+        uint64_t inputsHash = 0;
+        uint64_t sizeHash = 0;
+        uint64_t generation = 0;
+        uint64_t lastFrame = 0;
+        float computedAt = 0.0f;
+        std::any value;
+    };
+    
+    MeasureCacheEntry& measureCacheEntry(WidgetId key);
+    bool deferResizeRelayout(const MeasureCacheEntry& entry) const;
+    
+    template <typename T>
+    static WidgetId measureTypeKey() {
+        static const char tag = 0;
+        return static_cast<WidgetId>(reinterpret_cast<uintptr_t>(&tag));
+    }
+    
     struct Impl;
     std::unique_ptr<Impl> m_impl;
     
     // Note: Context stack is now thread-local, managed via pushContext/popContext
 };
 
+template <typename T, typename Fn>
+const T& Context::measureCache(WidgetId id, uint64_t inputsHash, Fn&& compute) {
+    return measureCache<T>(id, inputsHash, 0, std::forward<Fn>(compute));
+}
+
+template <typename T, typename Fn>
+const T& Context::measureCache(WidgetId id, uint64_t inputsHash, uint64_t sizeHash, Fn&& compute) {
+    MeasureCacheEntry& entry = measureCacheEntry(combineIds(id, measureTypeKey<T>()));
+    uint64_t generation = styleGeneration();
+    bool valid = entry.value.has_value() && entry.inputsHash == inputsHash && entry.generation == generation;
+    if (!valid || (entry.sizeHash != sizeHash && !deferResizeRelayout(entry))) {
+        entry.value = T(compute());
+        entry.inputsHash = inputsHash;
+        entry.sizeHash = sizeHash;
+        entry.generation = generation;
+        entry.computedAt = time();
+    }
+    return *std::any_cast<T>(&entry.value);
+}
+
 } // namespace fst
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "fastener/core/constants.h"
+#include <array>
+#include <chrono>
+
+namespace fst {
+
+class Profiler;
+
+//=============================================================================
+// FramePacer - Latency-aware present scheduling
+//=============================================================================
+
+/**
+ * @brief Delays input sampling until just before the next present deadline.
+ *
+ * With vsync the app normally polls input right after the previous swap and
+ * then waits inside the next swap, so input is almost a frame old when it
+ * reaches the screen. The pacer measures the present interval and the time
+ * a frame takes to build, and sleeps until `deadline - work - margin`
+ * before polling.
+ *
+ * @code
+ * FramePacer pacer(&ctx.profiler());
+ * while (window.isOpen()) {
+ *     pacer.waitForNextFrame();
+ *     window.pollEvents();
+ *     pacer.markInputSampled();
+ *     // ... build the frame ...
+ *     pacer.markFrameBuilt();
+ *     window.swapBuffers();
+ *     pacer.framePresented();
+ * }
+ * @endcode
+ *
+ * Without vsync the measured interval equals the build time and the pacer
+ * never sleeps.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(Profiler* profiler = nullptr);
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+    void setSafetyMargin(float ms) { m_safetyMarginMs = ms; }
+
+    /** @brief Sleep until wakeTime(); call before polling events. */
+    void waitForNextFrame();
+
+    /** @brief Call right after polling events. */
+    void markInputSampled() { markInputSampled(Clock::now()); }
+    void markInputSampled(Clock::time_point now);
+
+    /** @brief Call right before swapping buffers; ends the measured work. */
+    void markFrameBuilt() { markFrameBuilt(Clock::now()); }
+    void markFrameBuilt(Clock::time_point now);
+
+    /** @brief Call right after swapping buffers. */
+    void framePresented() { framePresented(Clock::now()); }
+    void framePresented(Clock::time_point now);
+
+    /** @brief When the next frame should start; now if unknown or disabled. */
+    Clock::time_point wakeTime() const;
+
+    float presentInterval() const { return m_intervalMs; }  ///< 0 until measured
+    float predictedWork() const;                            ///< ms
+    float lastLatency() const { return m_lastLatencyMs; }   ///< Input-to-present, ms
+
+private:
+    Profiler* m_profiler = nullptr;
+    bool m_enabled = true;
+    float m_safetyMarginMs = constants::FRAME_PACER_SAFETY_MARGIN_MS;
+
+    Clock::time_point m_lastPresent;
+    Clock::time_point m_inputSampled;
+    bool m_hasPresent = false;
+    bool m_hasInput = false;
+    bool m_hasWork = false;
+
+    float m_intervalMs = 0.0f;
+    int m_offEstimateFrames = 0;
+
+    std::array<float, constants::FRAME_PACER_WORK_HISTORY> m_workMs{};
+    int m_workOffset = 0;
+
+    float m_lastLatencyMs = 0.0f;
+};
+
+} // namespace fst
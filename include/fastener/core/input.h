@@ -1,8 +1,12 @@
 #pragma once
 
 #include "fastener/core/types.h"
+#include "fastener/core/constants.h"
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace fst {
 
@@ -107,6 +111,49 @@ struct Modifiers {
     }
 };
 
+//=============================================================================
+// Input Events
+//=============================================================================
+enum class InputEventType : uint8_t {
+    KeyDown,
+    KeyUp,
+    MouseDown,
+    MouseUp,
+    MouseMove,
+    MouseScroll,
+    Text,
+    TextCommit,  // A whole string at once (IME commit, long key sequences)
+    Preedit,     // IME composition changed; empty text ends it
+    Modifiers    // Modifier keys changed; the new state is in `modifiers`
+};
+
+/**
+ * @brief A single input event in arrival order.
+ *
+ * `time` is in seconds on the platform's event clock (the X server timestamp
+ * on Linux), so only differences between events are meaningful.
+ */
+struct InputEvent {
+    InputEventType type = InputEventType::MouseMove;
+    double time = 0.0;
+    Key key = Key::Unknown;             // KeyDown / KeyUp
+    MouseButton button = MouseButton::Left; // MouseDown / MouseUp
+    Vec2 value;                         // MouseMove position or MouseScroll delta
+    int device = 0;                     // MouseScroll source device, 0 if unknown
+    char32_t codepoint = 0;             // Text
+    std::string text;                   // TextCommit / Preedit, UTF-8
+    int cursorBegin = 0;                // Preedit cursor range, byte offsets
+    int cursorEnd = 0;                  // into text
+    Modifiers modifiers;                // Held when the event happened
+    bool consumed = false;
+};
+
+/** @brief A raw pointer position reported by the platform. */
+struct MouseSample {
+    Vec2 pos;
+    double time = 0.0;
+};
+
 //=============================================================================
 // Input State
 //=============================================================================
@@ -130,17 +177,41 @@ public:
     bool isMouseReleasedRaw(MouseButton button) const;
     bool isMouseDoubleClickedRaw(MouseButton button) const;
     
-    // Mouse position & movement
-    Vec2 mousePos() const { return m_mousePos; }
-    Vec2 mouseDelta() const { return m_mouseDelta; }
-    Vec2 scrollDelta() const { return m_scrollDelta; }
+    // Mouse position & movement, in layout space (see setPointerScale)
+    Vec2 mousePos() const { return m_mousePos * m_pointerScale; }
+    Vec2 mouseDelta() const { return m_mouseDelta * m_pointerScale; }
+    Vec2 scrollDelta() const { return m_scrollDelta; }  // May be fractional
+    Vec2 scrollSteps() const { return m_scrollSteps; }  // Whole wheel detents
     Vec2 windowSize() const { return m_windowSize; }
     
+    // Every pointer position since the last frame, including positions the
+    // platform coalesced away (for drawing apps), in layout space
+    const std::vector<MouseSample>& mouseHistory() const { return m_mouseHistory; }
+    
     // Modifiers
     Modifiers modifiers() const { return m_modifiers; }
     
     // Text input (for this frame)
     const std::string& textInput() const { return m_textInput; }
+    
+    // IME composition shown at the caret until it is committed. The cursor
+    // range is the segment being converted (or an empty range at the caret),
+    // as byte offsets into preeditText().
+    const std::string& preeditText() const { return m_preeditText; }
+    int preeditCursorBegin() const { return m_preeditCursorBegin; }
+    int preeditCursorEnd() const { return m_preeditCursorEnd; }
+    bool hasPreedit() const { return !m_preeditText.empty(); }
+    
+    // Ordered events applied this frame; MouseMove positions are in layout space
+    const std::vector<InputEvent>& events() const { return m_frameEvents; }
+    void consumeEvent(size_t index);
+    size_t pendingEventCount() const { return m_queueCount; }
+    
+    // Input trickling: defer events that would collapse into an already
+    // changed per-frame state (e.g. press + release of one button) to the
+    // following frames instead of merging them.
+    void setInputTrickling(bool enabled) { m_trickle = enabled; }
+    bool inputTrickling() const { return m_trickle; }
 
     // Event consumption (immediate)
     void consumeMouse() { m_mouseConsumed = true; }
@@ -150,19 +221,33 @@ public:
     void beginFrame();
     void endFrame();
     
-    // Event handlers (called by Window)
-    void onKeyDown(Key key);
-    void onKeyUp(Key key);
-    void onMouseDown(MouseButton button);
-    void onMouseUp(MouseButton button);
-    void onMouseMove(float x, float y);
-    void onMouseScroll(float dx, float dy);
-    void onTextInput(char32_t codepoint);
-    void onModifiersChanged(bool shift, bool ctrl, bool alt, bool super);
+    // Event handlers (called by Window). `time` is the event timestamp in
+    // seconds; a negative value stamps the event with the frame time.
+    void onKeyDown(Key key, double time = -1.0);
+    void onKeyUp(Key key, double time = -1.0);
+    void onMouseDown(MouseButton button, double time = -1.0);
+    void onMouseUp(MouseButton button, double time = -1.0);
+    void onMouseMove(float x, float y, double time = -1.0);
+    void recordMouseSample(float x, float y, double time = -1.0);  // History only
+    void onMouseScroll(float dx, float dy, double time = -1.0, int device = 0);
+    void onTextInput(char32_t codepoint, double time = -1.0);
+    void onTextCommit(const std::string& utf8, double time = -1.0);  // One event for the whole string
+    void onPreeditChanged(const std::string& utf8, int cursorBegin, int cursorEnd, double time = -1.0);
+    void onModifiersChanged(bool shift, bool ctrl, bool alt, bool super, double time = -1.0);
     void onResize(float width, float height);
     void setFrameTime(float time);
     
+    // Maps window pixels to layout space; not 1 while a resize is stretched.
+    // This frame's history and events() are rescaled in place on a change.
+    void setPointerScale(Vec2 scale);
+    Vec2 pointerScale() const { return m_pointerScale; }
+    
 private:
+    void enqueue(InputEvent event);
+    void drainQueue();
+    bool wouldCollapse(const InputEvent& event) const;
+    void apply(const InputEvent& event);
+    
     // Keyboard state
     std::array<bool, static_cast<int>(Key::MaxKey)> m_keysDown{};
     std::array<bool, static_cast<int>(Key::MaxKey)> m_keysPressed{};
@@ -173,20 +258,35 @@ private:
     std::array<bool, static_cast<int>(MouseButton::MaxButton)> m_mousePressed{};
     std::array<bool, static_cast<int>(MouseButton::MaxButton)> m_mouseReleased{};
     std::array<bool, static_cast<int>(MouseButton::MaxButton)> m_mouseDoubleClicked{};
-    std::array<float, static_cast<int>(MouseButton::MaxButton)> m_lastClickTime{-1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, -1.0f};
+    std::array<double, static_cast<int>(MouseButton::MaxButton)> m_lastClickTime{-1.0, -1.0, -1.0, -1.0, -1.0, -1.0, -1.0, -1.0};
     
     Vec2 m_mousePos;
     Vec2 m_lastMousePos;
     Vec2 m_mouseDelta;
     Vec2 m_scrollDelta;
+    Vec2 m_scrollSteps;
+    Vec2 m_scrollRemainder;
+    int m_scrollDevice = 0;  // Device the remainder came from
     Vec2 m_windowSize;
+    Vec2 m_pointerScale{1.0f, 1.0f};
     
     Modifiers m_modifiers;
+    Modifiers m_queuedModifiers;  // State after the last queued event
     std::string m_textInput;
+    std::string m_preeditText;
+    int m_preeditCursorBegin = 0;
+    int m_preeditCursorEnd = 0;
     float m_frameTime = 0.0f;
     bool m_mouseConsumed = false;
     
-    static constexpr float DOUBLE_CLICK_TIME = 0.3f;  // seconds
+    // Pending events (ring buffer) and the events applied this frame
+    std::array<InputEvent, constants::INPUT_EVENT_QUEUE_CAPACITY> m_queue{};
+    size_t m_queueHead = 0;
+    size_t m_queueCount = 0;
+    std::vector<InputEvent> m_frameEvents;
+    std::vector<MouseSample> m_mouseHistory;  // Scaled by m_pointerScale
+    bool m_trickle = false;
+    bool m_buttonChangedThisFrame = false;
 };
 
 } // namespace fst
@@ -28,6 +28,11 @@ public:
     const std::vector<ProfileEntry>& getLastFrameEntries() const { return m_lastFrameEntries; }
     void getFrameHistory(float* outHistory, int count) const;
     float getAverageFrameTime() const;
+    
+    // Input-to-present latency (reported by FramePacer)
+    void recordLatency(float ms);
+    void getLatencyHistory(float* outHistory, int count) const;
+    float getAverageLatency() const;
 
 private:
     struct Section {
@@ -43,6 +48,10 @@ private:
     float m_frameHistory[HISTORY_SIZE];
     int m_historyOffset = 0;
     
+    float m_latencyHistory[HISTORY_SIZE];
+    int m_latencyOffset = 0;
+    int m_latencyCount = 0;
+    
     std::chrono::steady_clock::time_point m_frameStartTime;
 };
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <cstring>
 #include <cmath>
 #include <algorithm>
 #include <string>
@@ -319,6 +320,18 @@ constexpr WidgetId combineIds(WidgetId parent, WidgetId child) {
     return parent ^ (child * 1099511628211ULL);
 }
 
+// Mix a value into a hash (for cache keys built from widget inputs)
+constexpr uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+// Hash a float by its bit pattern
+inline uint64_t hashFloat(float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
 //=============================================================================
 // Enums
 //=============================================================================
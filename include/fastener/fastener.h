@@ -9,8 +9,10 @@
 
 #include "fastener/platform/window.h"
 #include "fastener/platform/window_manager.h"
+#include "fastener/platform/headless_window.h"
 
 #include "fastener/graphics/renderer.h"
+#include "fastener/graphics/gpu_resource_cache.h"
 #include "fastener/graphics/draw_list.h"
 #include "fastener/graphics/font.h"
 #include "fastener/graphics/texture.h"
@@ -80,6 +82,7 @@
 
 // Profiling
 #include "fastener/core/profiler.h"
+#include "fastener/core/frame_pacer.h"
 #include "fastener/widgets/profiler_widget.h"
 
 // Localization
@@ -10,6 +10,7 @@
 
 #include "fastener/core/types.h"
 #include <string_view>
+#include <vector>
 
 namespace fst {
 
@@ -27,6 +28,17 @@ enum class DrawLayer {
     Count
 };
 
+//=============================================================================
+// Text Color Runs
+//=============================================================================
+
+/** @brief Color for the text bytes [begin, end) passed to addTextColored(). */
+struct TextColorRun {
+    int begin;
+    int end;
+    Color color;
+};
+
 //=============================================================================
 // IDrawList - Abstract interface for draw operations
 //=============================================================================
@@ -60,6 +72,16 @@ public:
     // Text
     virtual void addText(Font* font, const Vec2& pos, std::string_view text, Color color = Color::none()) = 0;
     
+    /**
+     * @brief Draw text with per-range colors.
+     * 
+     * The default calls addText() once per run and per uncolored gap;
+     * DrawList overrides it to lay out the whole line in one pass.
+     * @param runs Sorted by begin and non-overlapping; bytes outside every run use @p color
+     */
+    virtual void addTextColored(Font* font, const Vec2& pos, std::string_view text,
+                                const std::vector<TextColorRun>& runs, Color color = Color::none());
+    
     // Images
     virtual void addImage(const Texture* texture, const Rect& rect, Color tint = Color::white()) = 0;
     virtual void addImage(const Texture* texture, const Rect& rect, const Vec2& uv0, const Vec2& uv1, 
@@ -78,6 +78,8 @@ public:
     
     // Text
     void addText(Font* font, const Vec2& pos, std::string_view text, Color color = Color::none()) override;
+    void addTextColored(Font* font, const Vec2& pos, std::string_view text,
+                        const std::vector<TextColorRun>& runs, Color color = Color::none()) override;
     
     // Images
     void addImage(const Texture* texture, const Rect& rect, Color tint = Color::white()) override;
@@ -99,6 +101,15 @@ public:
     // Consolidate all layers into the merged buffers
     void mergeLayers();
     
+    /**
+     * @brief Hash of everything drawn beneath a blur command's sample area.
+     * 
+     * Covers every earlier merged command whose clipped bounds overlap the
+     * blurred rect plus its blur radius. Equal values across frames mean the
+     * backdrop is unchanged and a retained blur can be reused.
+     */
+    uint64_t backdropHash(size_t commandIndex) const;
+    
     // Current texture (for batching)
     void setTexture(uint32_t textureId) override;
     
@@ -123,6 +134,11 @@ private:
     std::vector<uint32_t> m_mergedIndices;
     std::vector<DrawCommand> m_mergedCommands;
     
+    // Per merged command: clipped screen bounds, and for blurs the hash of
+    // their own backdrop
+    std::vector<Rect> m_commandBounds;
+    std::vector<uint64_t> m_commandHashes;
+    
     // Helpers (these now work on the current layer)
     void addVertex(const Vec2& pos, const Vec2& uv, Color color);
     void addIndex(uint32_t idx);
@@ -130,10 +146,13 @@ private:
                  const Vec2& uv0, const Vec2& uv1, const Vec2& uv2, const Vec2& uv3,
                  Color color);
     void addQuadFilled(const Rect& rect, Color color);
+    void addTextRuns(Font* font, const Vec2& pos, std::string_view text,
+                     const TextColorRun* runs, size_t runCount, Color color);
     void primRect(const Rect& rect, Color color, float rounding);
     void primRectFilled(const Rect& rect, Color color, float rounding);
     
     void updateCommand();
+    void computeCommandHashes();
     LayerData& currentData() { return m_layers[static_cast<int>(m_currentLayer)]; }
     const LayerData& currentData() const { return m_layers[static_cast<int>(m_currentLayer)]; }
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+
+namespace fst {
+
+//=============================================================================
+// GpuResourceCache - GL objects shared across a context share group
+//=============================================================================
+
+/**
+ * @brief Reference-counted GL objects (programs, buffers, static textures)
+ * shared by every renderer whose context belongs to one share group.
+ *
+ * The first acquire() of a key creates the object; later ones return the
+ * same handle. The object is destroyed when its last reference is released.
+ * Objects that are not shareable between contexts (VAOs, FBOs) must not be
+ * stored here.
+ *
+ * WindowManager owns one for its windows:
+ * @code
+ * WindowManager wm;
+ * Window* main = wm.createWindow(config);
+ * Context ctx;
+ * ctx.setGpuResourceCache(&wm.gpuResources());  // Before the first frame
+ * @endcode
+ */
+class GpuResourceCache {
+public:
+    using Handle = uint32_t;
+    using CreateFn = std::function<Handle()>;
+    using DestroyFn = std::function<void(Handle)>;
+    
+    GpuResourceCache() = default;
+    ~GpuResourceCache();
+    
+    // Non-copyable
+    GpuResourceCache(const GpuResourceCache&) = delete;
+    GpuResourceCache& operator=(const GpuResourceCache&) = delete;
+    
+    /**
+     * @brief Add a reference to the object for @p key, creating it if needed.
+     * @return The shared handle, or 0 if creation failed (nothing is cached)
+     */
+    Handle acquire(const std::string& key, const CreateFn& create, DestroyFn destroy);
+    
+    /** @brief Drop a reference; the last one destroys the object. */
+    void release(const std::string& key);
+    
+    /** @brief Handle for @p key if it exists, 0 otherwise; adds no reference. */
+    Handle find(const std::string& key) const;
+    
+    int refCount(const std::string& key) const;
+    size_t size() const { return m_entries.size(); }
+    
+    /** @brief Destroy every object regardless of references; needs a current context. */
+    void clear();
+
+private:
+    struct Entry {
+        Handle handle = 0;
+        int refs = 0;
+        DestroyFn destroy;
+    };
+    std::unordered_map<std::string, Entry> m_entries;
+};
+
+} // namespace fst
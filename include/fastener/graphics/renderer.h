@@ -8,6 +8,7 @@ namespace fst {
 // Forward declarations
 class DrawList;
 class Texture;
+class GpuResourceCache;
 
 //=============================================================================
 // Renderer - OpenGL rendering backend
@@ -25,8 +26,22 @@ public:
     bool init();
     void shutdown();
     
+    /**
+     * @brief Take programs, buffers and static textures from a cache shared
+     * with other renderers in the same GL share group. Call before init().
+     */
+    void setResourceCache(GpuResourceCache* cache);
+    
     // Frame
     void beginFrame(int width, int height, float dpiScale);
+    
+    /**
+     * @brief Begin a frame whose content was laid out at a different size.
+     * 
+     * Draws content measuring contentWidth x contentHeight stretched over
+     * the width x height framebuffer, e.g. while a live resize settles.
+     */
+    void beginFrame(int width, int height, float dpiScale, int contentWidth, int contentHeight);
     void endFrame();
     
     // Rendering
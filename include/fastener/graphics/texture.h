@@ -29,6 +29,16 @@ public:
     // Update
     void update(int x, int y, int width, int height, const void* data);
     
+    /**
+     * @brief Version of a texture's pixels, bumped on every upload.
+     * 
+     * Values are unique across handles, so a reused GL name never repeats an
+     * old version. Retained blur backdrops fold it in to notice new contents.
+     */
+    static uint64_t contentVersion(uint32_t handle);
+    /** @brief Bump the version after writing to @p handle outside this class. */
+    static void markContentChanged(uint32_t handle);
+    
     // Properties
     int width() const { return m_width; }
     int height() const { return m_height; }
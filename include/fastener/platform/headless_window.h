@@ -0,0 +1,105 @@
+#pragma once
+
+#include "fastener/core/types.h"
+#include "fastener/core/input.h"
+#include "fastener/platform/platform_interface.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fst {
+
+//=============================================================================
+// HeadlessWindow - Offscreen rendering target without a display server
+//=============================================================================
+
+/**
+ * @brief IPlatformWindow backed by an EGL context and a framebuffer object.
+ *
+ * Runs the real Renderer without an X server, e.g. on CI with Mesa llvmpipe
+ * or for server-side thumbnails. Uses EGL_MESA_platform_surfaceless when
+ * available and a pbuffer context otherwise. Input is whatever the caller
+ * feeds into input(); nothing arrives from pollEvents().
+ *
+ * @code
+ * HeadlessWindow window;
+ * if (window.create(640, 480)) {
+ *     Context ctx;
+ *     ctx.beginFrame(window);
+ *     // ... build UI
+ *     ctx.endFrame();
+ *     std::vector<uint8_t> rgba = window.readPixels();
+ * }
+ * @endcode
+ *
+ * Only available on Linux builds with EGL (FST_HAS_EGL); elsewhere
+ * create() fails.
+ */
+class HeadlessWindow : public IPlatformWindow {
+public:
+    HeadlessWindow();
+    ~HeadlessWindow();
+    
+    // Non-copyable
+    HeadlessWindow(const HeadlessWindow&) = delete;
+    HeadlessWindow& operator=(const HeadlessWindow&) = delete;
+    
+    // Lifecycle
+    bool create(int width, int height, float dpiScale = 1.0f);
+    void destroy();
+    bool isOpen() const override;
+    void close() override;
+    
+    /** @brief The rendered frame as RGBA8, top row first; empty if not created. */
+    std::vector<uint8_t> readPixels() const;
+    
+    /** @brief True when rendering without any EGL surface (surfaceless platform). */
+    bool isSurfaceless() const;
+    
+    // Event handling (no event source; input is driven through input())
+    void pollEvents() override;
+    void waitEvents() override;
+    
+    // Rendering
+    void swapBuffers() override;
+    void makeContextCurrent() override;
+    
+    // Properties
+    Vec2 size() const override;
+    Vec2 framebufferSize() const override;
+    float dpiScale() const override;
+    int width() const override;
+    int height() const override;
+    
+    void setTitle(const std::string& title) override;
+    void setSize(int width, int height) override;
+    void setPosition(int x, int y) override;
+    
+    void minimize() override {}
+    void maximize() override {}
+    void restore() override {}
+    void focus() override {}
+    bool isMinimized() const override { return false; }
+    bool isMaximized() const override { return false; }
+    bool isFocused() const override { return true; }
+    
+    void setCursor(Cursor) override {}
+    void hideCursor() override {}
+    void showCursor() override {}
+    
+    // Clipboard is process-local
+    std::string getClipboardText() override;
+    void setClipboardText(const std::string& text) override;
+    
+    InputState& input() override;
+    const InputState& input() const override;
+    
+    void* nativeHandle() const override;  ///< The EGLContext
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace fst
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace fst {
+
+//=============================================================================
+// MappedFile - Read-only memory mapping of a file
+//=============================================================================
+
+/**
+ * @brief Maps a whole file read-only into memory.
+ *
+ * Pages are loaded by the OS on first access, so opening is O(1) in the
+ * file size and untouched parts of the file cost no memory. The mapping is
+ * private: later writes to the file by other processes may or may not be
+ * visible, and truncating the file while it is mapped is undefined.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    // Non-copyable
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const;
+    
+    const char* data() const;
+    size_t size() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace fst
@@ -18,6 +18,8 @@ struct WindowFocusEvent;
  */
 class IPlatformWindow {
 public:
+    using ClipboardCallback = std::function<void(const std::string& text)>;
+    
     virtual ~IPlatformWindow() = default;
 
     virtual bool isOpen() const = 0;
@@ -53,9 +55,25 @@ public:
     virtual void hideCursor() = 0;
     virtual void showCursor() = 0;
     
-    virtual std::string getClipboardText() const = 0;
+    /**
+     * @brief Current clipboard text, without waiting on another client.
+     *
+     * Non-const: platforms that read the clipboard asynchronously return
+     * the last received contents and start a refresh.
+     */
+    virtual std::string getClipboardText() = 0;
     virtual void setClipboardText(const std::string& text) = 0;
     
+    /**
+     * @brief Request the clipboard contents without blocking.
+     *
+     * The callback runs once the text is available, which may be during a
+     * later pollEvents(). The default implementation answers immediately.
+     */
+    virtual void requestClipboardText(ClipboardCallback callback) {
+        callback(getClipboardText());
+    }
+    
     virtual InputState& input() = 0;
     virtual const InputState& input() const = 0;
     
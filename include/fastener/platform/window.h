@@ -26,10 +26,21 @@ struct WindowConfig {
     bool decorated = true;       // Has title bar and borders
     bool maximized = false;
     bool vsync = true;
+    bool adaptiveVsync = false;  // Tear instead of waiting a refresh when a frame is late
     int msaaSamples = 4;         // Anti-aliasing samples (0 to disable)
     bool highDPI = true;         // Enable high-DPI support
 };
 
+//=============================================================================
+// Window Visibility
+//=============================================================================
+enum class WindowVisibility {
+    Visible,
+    Minimized,
+    Obscured,    // Mapped but fully covered by other windows
+    Unmapped     // Hidden, closed or not yet shown
+};
+
 //=============================================================================
 // Window Events
 //=============================================================================
@@ -75,6 +86,17 @@ public:
     void pollEvents() override;
     void waitEvents() override;
     
+    /**
+     * @brief Descriptor that becomes readable when events arrive, or -1.
+     *
+     * The X11 connection socket; windows sharing a context share it. Win32
+     * has no descriptor and returns -1.
+     */
+    int eventFd() const;
+    
+    /** @brief Events already queued client-side, which a descriptor wait would miss. Flushes output. */
+    bool hasPendingEvents() const;
+    
     // Rendering
     void swapBuffers() override;
     void makeContextCurrent() override;
@@ -102,14 +124,18 @@ public:
     bool isMaximized() const override;
     bool isFocused() const override;
     
+    /** @brief Whether anything drawn into the window can currently be seen. */
+    WindowVisibility visibility() const;
+    
     // Cursor
     void setCursor(Cursor cursor) override;
     void hideCursor() override;
     void showCursor() override;
     
     // Clipboard
-    std::string getClipboardText() const override;
+    std::string getClipboardText() override;
     void setClipboardText(const std::string& text) override;
+    void requestClipboardText(ClipboardCallback callback) override;
     
     // Callbacks
     using ResizeCallback = std::function<void(const WindowResizeEvent&)>;
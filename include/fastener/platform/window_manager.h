@@ -1,9 +1,12 @@
 #pragma once
 
 #include "fastener/platform/window.h"
+#include "fastener/graphics/gpu_resource_cache.h"
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <functional>
+#include <cstdint>
 
 namespace fst {
 
@@ -28,8 +31,8 @@ class Context;
  * while (wm.anyWindowOpen()) {
  *     wm.pollAllEvents();
  *     
- *     for (auto* window : wm.windows()) {
- *         if (!window->isOpen()) continue;
+ *     // Minimized, hidden and fully covered windows are skipped
+ *     for (auto* window : wm.windowsNeedingRedraw()) {
  *         window->makeContextCurrent();
  *         ctx.beginFrame(*window);
  *         // ... render UI
@@ -38,6 +41,17 @@ class Context;
  *     }
  * }
  * @endcode
+ * 
+ * Or let the manager own the loop and sleep until something happens:
+ * @code
+ * wm.run([&](Window& window) {
+ *     ctx.beginFrame(window);
+ *     // ... render UI
+ *     ctx.endFrame();
+ *     window.swapBuffers();
+ *     if (getToastCount() > 0) wm.requestRedraw();  // Keep animating
+ * });
+ * @endcode
  */
 class WindowManager {
 public:
@@ -74,6 +88,14 @@ public:
      */
     const std::vector<Window*>& windows() const;
     
+    /**
+     * @brief Open windows whose contents can be seen, as of the last pollAllEvents().
+     * 
+     * Minimized, unmapped and fully obscured windows are left out so the
+     * render loop does not build or swap frames nobody can see.
+     */
+    const std::vector<Window*>& windowsNeedingRedraw() const;
+    
     /**
      * @brief Get the main (first created) window.
      */
@@ -106,6 +128,15 @@ public:
      */
     size_t windowCount() const;
     
+    /**
+     * @brief GL objects shared by every context in the windows' share group.
+     * 
+     * Pass to Context::setGpuResourceCache() so contexts rendering tool
+     * windows reuse the main context's programs and buffers instead of
+     * compiling their own. Contexts using it must be destroyed first.
+     */
+    GpuResourceCache& gpuResources();
+    
     // Cross-window drag & drop support
     
     /**
@@ -128,6 +159,63 @@ public:
      */
     Window* dragSourceWindow() const;
     
+    // Event loop
+    
+    using FrameCallback = std::function<void(Window&)>;
+    using TimerId = uint64_t;
+    using Clock = std::chrono::steady_clock;
+    
+    /**
+     * @brief Run until quit() is called or every window is closed.
+     * 
+     * Waits on all window connections, watched descriptors and the next
+     * timer at once (epoll on Linux, MsgWaitForMultipleObjects on Win32),
+     * then polls events, fires due timers and calls @p frame for each window
+     * in windowsNeedingRedraw(). An idle application does not wake up.
+     */
+    void run(const FrameCallback& frame);
+    
+    /**
+     * @brief Make run() return after the current iteration.
+     */
+    void quit();
+    
+    /**
+     * @brief Render again without waiting, e.g. while an animation runs.
+     */
+    void requestRedraw();
+    
+    /**
+     * @brief Call @p callback from run() after @p seconds, repeatedly if @p repeat.
+     * @return Id for cancelTimer()
+     */
+    TimerId addTimer(double seconds, std::function<void()> callback, bool repeat = false);
+    
+    /**
+     * @brief Cancel a timer; unknown or already fired ids are ignored.
+     */
+    void cancelTimer(TimerId id);
+    
+    /**
+     * @brief Call the callbacks of timers due at @p now; run() does this every iteration.
+     * 
+     * For loops that drive frames themselves. A timer cancelled by an earlier
+     * callback in the same batch does not fire.
+     */
+    void fireDueTimers() { fireDueTimers(Clock::now()); }
+    void fireDueTimers(Clock::time_point now);
+    
+    /**
+     * @brief Call @p onReadable from run() whenever @p fd becomes readable.
+     * @return false where descriptors cannot be waited on (Win32)
+     */
+    bool watchFd(int fd, std::function<void()> onReadable);
+    
+    /**
+     * @brief Stop watching a descriptor; call before closing it.
+     */
+    void unwatchFd(int fd);
+    
 private:
     struct Impl;
     std::unique_ptr<Impl> m_impl;
@@ -83,8 +83,14 @@ public:
     void setWindowTitle(WidgetId windowId, const std::string& title);
     std::string getWindowTitle(WidgetId windowId) const;
     
+    // Floating window rects (persisted with the layout)
+    void setFloatingRect(WidgetId windowId, const Rect& rect);
+    bool getFloatingRect(WidgetId windowId, Rect& outRect) const;
+    
     /**
-     * Refreshes the window-to-node mapping for a subtree.
+     * Invalidates the cached window-to-node mapping of the tree containing
+     * a node (or of all trees). Only needed after editing DockNode fields
+     * directly; DockNode/DockTree operations invalidate it themselves.
      */
     void refreshMappings(DockNode::Id nodeId = DockNode::INVALID_ID);
     
@@ -118,13 +124,22 @@ public:
     // Persistence
     //-------------------------------------------------------------------------
     
+    /** Version written by serializeLayout(); older versions remain readable. */
+    static constexpr uint16_t LAYOUT_FORMAT_VERSION = 1;
+    
     /**
-     * Serializes the current layout to a string.
+     * Serializes all dock spaces (tree shape, split ratios, tab order and
+     * selection) and the floating window rects to a compact, versioned
+     * little-endian binary blob.
      */
     std::string serializeLayout() const;
     
     /**
-     * Deserializes a layout from a string.
+     * Restores a layout written by serializeLayout(), replacing all dock
+     * spaces and floating rects. Nodes are rebuilt in a single pass directly
+     * into the node arrays, without replaying splits.
+     * @return false (leaving the current layout untouched) if the data is
+     *         malformed or from a newer format version
      */
     bool deserializeLayout(const std::string& data);
     
@@ -1,10 +1,10 @@
 #pragma once
 
 #include "fastener/core/types.h"
-#include <memory>
-#include <vector>
+#include <cstdint>
 #include <string>
-#include <functional>
+#include <unordered_map>
+#include <vector>
 
 namespace fst {
 
@@ -42,21 +42,36 @@ struct DockNodeFlags {
     bool passthruCentralNode = false; // For central empty area
 };
 
+class DockTree;
+
 //=============================================================================
 // DockNode - Node in the dock tree hierarchy
 //=============================================================================
+/**
+ * @brief Node in a dock tree.
+ *
+ * Nodes live in the flat node array of their owning DockTree and refer to
+ * their parent and children by index. Splitting may grow that array, so a
+ * split, merge or reset invalidates every DockNode pointer and reference into
+ * the tree, including `this` of the node being split; keep indices or ids
+ * across those calls instead.
+ */
 class DockNode {
 public:
     using Id = uint32_t;
+    using Index = int32_t;
     static constexpr Id INVALID_ID = 0;
+    static constexpr Index NO_INDEX = -1;
     
     Id id = INVALID_ID;
     DockNodeType type = DockNodeType::Unknown;
     DockNodeFlags flags;
     
-    // Tree structure
-    DockNode* parent = nullptr;
-    std::unique_ptr<DockNode> children[2];  // For split nodes
+    // Tree structure (indices into the owning tree's node array)
+    DockTree* tree = nullptr;
+    Index index = NO_INDEX;
+    Index parentIndex = NO_INDEX;
+    Index childIndices[2] = {NO_INDEX, NO_INDEX};  // For split nodes
     
     // For TabContainer/Leaf nodes
     std::vector<WidgetId> dockedWindows;
@@ -64,17 +79,19 @@ public:
     
     // Layout
     Rect bounds;
-    float splitRatio = 0.5f;  // Splitter position (0.0-1.0)
     
     // Constructors
     DockNode() = default;
     explicit DockNode(Id nodeId) : id(nodeId) {}
     
     // Tree queries
-    bool isRootNode() const { return parent == nullptr; }
+    DockNode* parent() const;
+    DockNode* child(int childIndex) const;
+    bool isRootNode() const { return parentIndex == NO_INDEX; }
     bool isLeafNode() const { return type == DockNodeType::Leaf || type == DockNodeType::TabContainer; }
     bool isSplitNode() const { return type == DockNodeType::SplitHorizontal || type == DockNodeType::SplitVertical; }
-    bool isEmpty() const { return dockedWindows.empty() && !children[0] && !children[1]; }
+    bool hasChildren() const { return childIndices[0] != NO_INDEX || childIndices[1] != NO_INDEX; }
+    bool isEmpty() const { return dockedWindows.empty() && !hasChildren(); }
     
     // Window management
     DockNode* findNodeByWindowId(WidgetId windowId);
@@ -87,19 +104,157 @@ public:
     bool hasWindow(WidgetId windowId) const;
     
     // Split operations
-    DockNode* splitNode(DockDirection direction, Id childId0, Id childId1, float ratio = 0.5f);
+    /**
+     * @brief Split this node, moving its contents into one child.
+     * @return Index of the new empty child, or NO_INDEX. Invalidates all node
+     *         pointers, this one included; look nodes up again through tree.
+     */
+    Index splitNode(DockDirection direction, Id childId0, Id childId1, float ratio = 0.5f);
     void mergeNodes();
     
     // Layout calculation
+    /** @brief Splitter position (0.0-1.0) of a split node. */
+    float splitRatio() const { return m_splitRatio; }
+    /**
+     * @brief Set the splitter position, invalidating the cached layout on change.
+     *
+     * The ratio is clamped to [0, 1]; NaN and infinities become 0.5.
+     */
+    bool setSplitRatio(float ratio);
     void updateLayout(const Rect& availableBounds);
     Rect getChildBounds(int childIndex) const;
     
-    // Traversal
-    void forEachNode(const std::function<void(DockNode*)>& callback);
-    void forEachLeaf(const std::function<void(DockNode*)>& callback);
+    // Traversal (callbacks must not split or merge nodes)
+    template<typename Fn> void forEachNode(Fn&& callback);
+    template<typename Fn> void forEachLeaf(Fn&& callback);
     
     // Debug
     std::string debugPrint(int depth = 0) const;
+    
+private:
+    friend class DockTree;
+    
+    float m_splitRatio = 0.5f;
+};
+
+//=============================================================================
+// DockTree - Flat node storage and cached layout for one dock space
+//=============================================================================
+/**
+ * @brief Owns the nodes of one dock space in a flat array.
+ *
+ * Node 0 is the root. Released slots are recycled through a free list. The
+ * split rects, the leaf list and the window-to-node map are cached and only
+ * recomputed after the bounds, a split ratio or the tree structure change.
+ */
+class DockTree {
+public:
+    explicit DockTree(DockNode::Id rootId);
+    
+    DockTree(const DockTree&) = delete;
+    DockTree& operator=(const DockTree&) = delete;
+    
+    DockNode& root() { return m_nodes[0]; }
+    const DockNode& root() const { return m_nodes[0]; }
+    
+    DockNode* node(DockNode::Index index);
+    const DockNode* node(DockNode::Index index) const;
+    DockNode* findNode(DockNode::Id id);
+    const DockNode* findNode(DockNode::Id id) const;
+    DockNode* findWindow(WidgetId windowId);
+    const DockNode* findWindow(WidgetId windowId) const;
+    
+    /** @brief Number of live nodes (excluding recycled slots). */
+    size_t nodeCount() const { return m_nodes.size() - m_freeList.size(); }
+    /** @brief Size of the node array including recycled slots. */
+    size_t capacity() const { return m_nodes.size(); }
+    
+    // Structure
+    /** @brief See DockNode::splitNode(); invalidates all node pointers. */
+    DockNode::Index split(DockNode::Index index, DockDirection direction,
+                          DockNode::Id childId0, DockNode::Id childId1, float ratio);
+    void merge(DockNode::Index index);
+    /** @brief Merge split nodes left with empty children after windows were removed. */
+    void collapseEmptyNodes();
+    /** @brief Create a node in an empty child slot of a split node (used when restoring). */
+    DockNode* attach(DockNode::Index parentIndex, int slot, DockNode::Id id);
+    /** @brief Drop all children and windows of a node, leaving an empty leaf. */
+    void reset(DockNode::Index index = 0);
+    
+    // Layout cache
+    const Rect& bounds() const { return m_bounds; }
+    void setBounds(const Rect& bounds);
+    /** @brief Recompute split rects if anything they depend on changed. */
+    bool updateLayout();
+    void markLayoutDirty() { m_layoutDirty = true; }
+    void markStructureDirty();
+    bool layoutDirty() const { return m_layoutDirty; }
+    uint64_t structureVersion() const { return m_structureVersion; }
+    
+    /** @brief Leaves in depth-first order, cached until the structure changes. */
+    const std::vector<DockNode::Index>& leaves() const;
+    /** @brief Split nodes in depth-first order, cached until the structure changes. */
+    const std::vector<DockNode::Index>& splits() const;
+    
+private:
+    DockNode::Index allocate(DockNode::Id id);
+    void release(DockNode::Index index);
+    void releaseSubtree(DockNode::Index index);
+    void reparentChildren(DockNode::Index index);
+    void rebuildCaches() const;
+    
+    std::vector<DockNode> m_nodes;
+    std::vector<DockNode::Index> m_freeList;
+    std::unordered_map<DockNode::Id, DockNode::Index> m_idToIndex;
+    
+    Rect m_bounds;
+    bool m_layoutDirty = true;
+    bool m_needsCollapse = false;
+    uint64_t m_structureVersion = 1;
+    
+    mutable uint64_t m_cachedVersion = 0;
+    mutable std::vector<DockNode::Index> m_leaves;
+    mutable std::vector<DockNode::Index> m_splits;
+    mutable std::unordered_map<WidgetId, DockNode::Index> m_windowToNode;
+    
+    friend class DockNode;
 };
 
+//=============================================================================
+// Inline implementations
+//=============================================================================
+
+inline DockNode* DockNode::parent() const {
+    return tree ? tree->node(parentIndex) : nullptr;
+}
+
+inline DockNode* DockNode::child(int childIndex) const {
+    if (!tree || childIndex < 0 || childIndex > 1) return nullptr;
+    return tree->node(childIndices[childIndex]);
+}
+
+template<typename Fn>
+void DockNode::forEachNode(Fn&& callback) {
+    callback(this);
+    
+    for (int i = 0; i < 2; ++i) {
+        if (DockNode* c = child(i)) {
+            c->forEachNode(callback);
+        }
+    }
+}
+
+template<typename Fn>
+void DockNode::forEachLeaf(Fn&& callback) {
+    if (isLeafNode() || !hasChildren()) {
+        callback(this);
+    } else {
+        for (int i = 0; i < 2; ++i) {
+            if (DockNode* c = child(i)) {
+                c->forEachLeaf(callback);
+            }
+        }
+    }
+}
+
 } // namespace fst
@@ -35,6 +35,7 @@
  */
 
 #include "fastener/core/types.h"
+#include "fastener/ui/layout.h"
 #include "fastener/ui/style.h"
 #include <string>
 
@@ -46,12 +47,12 @@ class Context;
 // Flex Options - Common options for HStack/VStack containers
 //=============================================================================
 struct FlexOptions {
-    Alignment mainAlign = Alignment::Start;    ///< Main axis alignment (row for HStack, column for VStack)
+    Alignment mainAlign = Alignment::Start;    ///< Main axis alignment (uses last frame's free space)
     Alignment crossAlign = Alignment::Start;   ///< Cross axis alignment
     float gap = 0.0f;                          ///< Gap between children (0 = use theme default)
     Vec4 padding = Vec4(0.0f);                 ///< Inner padding (top, right, bottom, left)
     Style style;                               ///< Container style (size, background, etc.)
-    bool wrap = false;                         ///< Allow wrapping to next line/column (future)
+    bool wrap = false;                         ///< Wrap overflowing children (nested stacks too) to the next line/column
 };
 
 //=============================================================================
@@ -65,6 +66,18 @@ struct GridOptions {
     Style style;                               ///< Container style
 };
 
+//=============================================================================
+// Virtual Grid Options - Options for virtualized grid/flow of uniform cells
+//=============================================================================
+struct VirtualGridOptions {
+    Vec2 cellSize = Vec2(0.0f);                ///< Cell size (y <= 0 = reuse last frame's row height)
+    int columns = 0;                           ///< Number of columns (0 = wrap cells of cellSize.x)
+    float rowGap = 0.0f;                       ///< Gap between rows (0 = use theme default)
+    float columnGap = 0.0f;                    ///< Gap between columns (0 = use theme default)
+    Vec4 padding = Vec4(0.0f);                 ///< Inner padding
+    Style style;                               ///< Container style
+};
+
 //=============================================================================
 // Divider Options - Options for visual separator
 //=============================================================================
@@ -201,6 +214,35 @@ void BeginGrid(Context& ctx, const GridOptions& options = {});
 /// @brief End a grid container
 void EndGrid(Context& ctx);
 
+//=============================================================================
+// Virtual Grid - Grid that only lays out visible items
+//=============================================================================
+
+/**
+ * @brief Begin a virtualized grid of `itemCount` uniform cells.
+ * 
+ * Returns the range of items whose rows intersect the current clip rect.
+ * Submit only those items; each allocation lands in its own cell. The grid
+ * reports the height of all rows, so an enclosing ScrollArea scrolls the
+ * whole set while per-frame cost stays proportional to the visible items.
+ * 
+ * @code
+ *   VirtualGridOptions opts;
+ *   opts.cellSize = Vec2(96, 96);
+ *   ItemRange range = BeginVirtualGrid(ctx, thumbnailCount, opts);
+ *   for (int i = range.first; i < range.last; ++i) {
+ *       ctx.pushId(i);
+ *       Image(ctx, thumbnails[i], imageOpts);
+ *       ctx.popId();
+ *   }
+ *   EndVirtualGrid(ctx);
+ * @endcode
+ */
+ItemRange BeginVirtualGrid(Context& ctx, int itemCount, const VirtualGridOptions& options = {});
+
+/// @brief End a virtualized grid container
+void EndVirtualGrid(Context& ctx);
+
 //=============================================================================
 // Layout Helpers
 //=============================================================================
@@ -211,6 +253,9 @@ void EndGrid(Context& ctx);
  * Similar to SwiftUI's Spacer. In an HStack, pushes items apart horizontally.
  * In a VStack, pushes items apart vertically.
  * 
+ * Free space is taken from the container's previous-frame measurement, so a
+ * newly shown container settles one frame after it first appears.
+ * 
  * @param ctx Context reference
  * @param flex Flex grow factor (default 1.0)
  */
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "fastener/core/types.h"
-#include <vector>
+#include "fastener/core/constants.h"
+#include <array>
 #include <functional>
+#include <unordered_map>
 
 namespace fst {
 
@@ -26,6 +28,18 @@ struct LayoutItem {
     bool visible = true;
 };
 
+//=============================================================================
+// Item Range - Half-open range of item indices [first, last)
+//=============================================================================
+struct ItemRange {
+    int first = 0;
+    int last = 0;
+    
+    constexpr int count() const { return last - first; }
+    constexpr bool empty() const { return last <= first; }
+    constexpr bool contains(int index) const { return index >= first && index < last; }
+};
+
 //=============================================================================
 // Layout Constraints
 //=============================================================================
@@ -58,52 +72,157 @@ public:
     LayoutContext();
     ~LayoutContext();
     
-    // Begin a new layout container
-    void beginContainer(const Rect& bounds, LayoutDirection direction = LayoutDirection::Vertical);
-    void endContainer();
+    // Frame management (advances the measure cache generation)
+    void beginFrame();
+    
+    // Begin a new layout container.
+    // Containers without an explicit id derive one from their parent and
+    // sibling index, which is stable as long as the UI structure is.
+    void beginContainer(const Rect& bounds, LayoutDirection direction = LayoutDirection::Vertical,
+                        WidgetId id = INVALID_WIDGET_ID);
+    
+    /**
+     * @brief End the current container.
+     * @param reportToParent Advance the parent cursor by the used size; pass
+     *        false for containers placed at explicit bounds (e.g. scroll content)
+     * @return Size used by the container's children, including padding
+     */
+    Vec2 endContainer(bool reportToParent = true);
     
     // Allocate space for a widget
     Rect allocate(float width, float height, float flexGrow = 0.0f);
     Rect allocateRemaining();
     
+    /**
+     * @brief Bounds for a nested container filling the rest of the line.
+     *
+     * In a wrapping container a new line is started first if the next child
+     * container, at its size last frame, would overflow this one.
+     */
+    Rect allocateContainer();
+    
     // Container properties
     void setSpacing(float spacing);
     void setPadding(float top, float right, float bottom, float left);
     void setAlignment(Alignment mainAxis, Alignment crossAxis);
     
+    /**
+     * @brief Turn the current container into a fixed-column grid.
+     *
+     * Subsequent allocations are placed cell by cell, wrapping after
+     * `columns` items; rows are as tall as their tallest item.
+     */
+    void setGrid(int columns, float columnGap, float rowGap);
+    
+    /**
+     * @brief Wrap items onto a new line when they overflow the main axis.
+     *
+     * Nested containers placed with allocateContainer() wrap by their size
+     * last frame, so a new child settles one frame late.
+     */
+    void setWrap(bool wrap);
+    
+    /**
+     * @brief Virtualize the current grid over `itemCount` uniform cells.
+     *
+     * Returns the items whose rows intersect `visible` and moves the grid
+     * cursor to the first of them, so only those items need to be allocated.
+     * The container still reports the full extent of all rows to its parent.
+     * A cellHeight <= 0 uses the row height measured last frame (the first
+     * frame yields a single row to measure).
+     */
+    ItemRange virtualizeGrid(int itemCount, float cellHeight, const Rect& visible);
+    
     // Current state
     Rect currentBounds() const;
+    Rect currentContentBounds() const;
     Vec2 currentPosition() const;
     float remainingSpace() const;
     LayoutDirection currentDirection() const;
+    WidgetId currentId() const;
+    
+    /** @brief True if the current container has last frame's measurements. */
+    bool hasMeasure() const;
     
     // Scrolling
     void setScroll(float scrollX, float scrollY);
     Vec2 scroll() const;
     
+    /** @brief Current container nesting depth. */
+    int depth() const { return m_depth; }
+    
 private:
-    struct ContainerState {
+    /**
+     * @brief Children measurements recorded when a container ends.
+     *
+     * Immediate-mode allocation is a single forward pass, so flex growth and
+     * main-axis alignment use the previous frame's totals (one frame latency).
+     */
+    struct ContainerMeasure {
+        float freeSpace = 0.0f;   ///< Main-axis space left after base sizes and gaps
+        float totalFlex = 0.0f;   ///< Sum of flexGrow factors of all children
+        float rowHeight = 0.0f;   ///< Tallest grid row (grid containers only)
+        Vec2 size;                ///< Size reported to the parent, padding included
+        uint64_t lastFrame = 0;   ///< Frame the measure was last written
+    };
+    
+    /**
+     * @brief Per-container state, one cache-line aligned slot per nesting level.
+     *
+     * The content rect (bounds minus padding) is computed once when the
+     * container begins or its padding changes, so allocation only offsets a cursor.
+     */
+    struct alignas(constants::CACHE_LINE_SIZE) ContainerState {
         Rect bounds;
+        Rect content;
         Vec2 cursor;
-        LayoutDirection direction;
-        float spacing = 0.0f;
+        Vec2 scrollOffset;
         Vec4 padding;
+        WidgetId id = INVALID_WIDGET_ID;
+        
+        LayoutDirection direction = LayoutDirection::Vertical;
         Alignment mainAlign = Alignment::Start;
         Alignment crossAlign = Alignment::Start;
-        
-        Vec2 scrollOffset;
+        bool started = false;
+        bool hasMeasure = false;
+        bool wrap = false;
+        float spacing = 0.0f;
+        float lineCross = 0.0f;
         
         // For flex layout and nesting
+        int itemCount = 0;
+        int containerCount = 0;
         float totalFlex = 0.0f;
+        float baseMainSize = 0.0f;
         float remainingSize = 0.0f;
         float maxInnerWidth = 0.0f;
         float maxInnerHeight = 0.0f;
+        
+        // Previous frame measurement (valid if hasMeasure)
+        ContainerMeasure measure;
+        
+        // Grid placement (columns > 0)
+        int columns = 0;
+        int column = 0;
+        float columnWidth = 0.0f;
+        float columnGap = 0.0f;
+        float rowHeight = 0.0f;
+        float maxRowHeight = 0.0f;
     };
     
-    std::vector<ContainerState> m_stack;
+    std::array<ContainerState, constants::MAX_LAYOUT_DEPTH> m_stack;
+    int m_depth = 0;
+    int m_overflow = 0;
+    std::unordered_map<WidgetId, ContainerMeasure> m_measures;
+    uint64_t m_frame = 0;
+    int m_rootCount = 0;
     
-    ContainerState& current();
-    const ContainerState& current() const;
+    ContainerState& current() { return m_stack[m_depth - 1]; }
+    const ContainerState& current() const { return m_stack[m_depth - 1]; }
+    void beginItem(ContainerState& state);
+    void startLine(ContainerState& state);
+    void advance(ContainerState& state, float baseMain, float mainSize, float crossSize);
+    Rect allocateCell(ContainerState& state, float width, float height);
 };
 
 //=============================================================================
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "fastener/core/types.h"
+#include "fastener/ui/layout.h"
 #include "fastener/ui/style.h"
 #include <functional>
 #include <string>
@@ -16,21 +17,64 @@ struct ScrollAreaOptions {
     bool autoHide = true;
     float scrollbarWidth = 10.0f;
     float minThumbSize = 20.0f;
+    bool measureContent = true;     ///< Derive content size from layout allocations made inside, unless set explicitly
+    float smoothScrollSpeed = 18.0f; ///< Approach rate of smooth scrollTo (0 = jump)
 };
 
+/**
+ * @brief Scrollable viewport over content larger than its bounds.
+ * 
+ * contentRenderer runs inside a layout container that starts at the
+ * viewport and is shifted by the scroll offset, so widgets allocated through
+ * the layout scroll automatically. With measureContent the content size is
+ * taken from those allocations (one frame latency) until setContentSize()
+ * is called, after which the explicit size is kept.
+ * 
+ * Long lists only need to submit what is visible:
+ * @code
+ *   area.render(ctx, "list", bounds, [&](const Rect&) {
+ *       ItemRange range = area.visibleRange(rowHeight, rowCount);
+ *       Spacing(ctx, range.first * rowHeight);
+ *       for (int i = range.first; i < range.last; ++i) { ... }
+ *       Spacing(ctx, (rowCount - range.last) * rowHeight);
+ *   });
+ * @endcode
+ */
 class ScrollArea {
 public:
     ScrollArea();
     ~ScrollArea();
 
-    // Set logical size of content inside the scroll area
-    void setContentSize(const Vec2& size) { m_contentSize = size; }
+    // Set logical size of content inside the scroll area; stops measuring it
+    void setContentSize(const Vec2& size) {
+        m_contentSize = size;
+        m_explicitContentSize = true;
+    }
     Vec2 contentSize() const { return m_contentSize; }
 
     // Scroll control
     Vec2 scrollOffset() const { return m_scrollOffset; }
     void setScrollOffset(const Vec2& offset);
-    void scrollTo(const Rect& area);
+    
+    /**
+     * @brief Scroll the minimal amount that makes `area` visible.
+     * @param area Rect in content coordinates (relative to the content origin)
+     * @param smooth Animate towards the target instead of jumping
+     */
+    void scrollTo(const Rect& area, bool smooth = true);
+
+    /** @brief Viewport of the last render (screen coordinates). */
+    Rect viewport() const { return m_viewport; }
+    
+    /**
+     * @brief Indices of fixed-height rows intersecting the viewport.
+     * @param itemHeight Row stride in pixels, including any spacing
+     * @param itemCount Total number of rows (clamps the range)
+     */
+    ItemRange visibleRange(float itemHeight, int itemCount) const;
+    
+    /** @brief True if an allocated (screen space) rect intersects the viewport. */
+    bool isVisible(const Rect& rect) const { return m_viewport.intersects(rect); }
 
     // Main render function
     // contentRenderer is called with the available viewport bounds and current scroll offset
@@ -42,7 +86,13 @@ public:
 
 private:
     Vec2 m_contentSize = {0, 0};
+    bool m_explicitContentSize = false;
     Vec2 m_scrollOffset = {0, 0};
+    Rect m_viewport;
+    
+    // Smooth scrollTo target
+    Vec2 m_scrollTarget = {0, 0};
+    bool m_hasScrollTarget = false;
     
     // Interaction state
     bool m_draggingH = false;
@@ -52,6 +102,7 @@ private:
 
     void handleInteraction(Context& ctx, const std::string& id, const Rect& bounds, const Rect& viewport, const ScrollAreaOptions& options);
     void clampScroll(const Rect& viewport);
+    void updateScrollTarget(float deltaTime, const ScrollAreaOptions& options);
 
 };
 
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "fastener/core/types.h"
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace fst {
+
+class TextBuffer;
+
+struct TextSegment {
+    int startColumn;
+    int endColumn;
+    Color color;
+    Color background = Color::transparent();
+};
+
+/** @brief Token colors used by the built-in highlighters. */
+struct SyntaxColors {
+    Color keyword = Color(86, 156, 214);
+    Color type = Color(78, 201, 176);
+    Color string = Color(206, 145, 120);
+    Color number = Color(181, 206, 168);
+    Color comment = Color(106, 153, 85);
+    Color preprocessor = Color(197, 134, 192);
+    Color punctuation = Color(212, 212, 212);
+};
+
+//=============================================================================
+// SyntaxHighlighter - Line tokenizer with carried state
+//=============================================================================
+
+/**
+ * @brief Tokenizes one line at a time, given the state the previous line
+ * ended in.
+ *
+ * The state is what lets constructs span lines (block comments, raw or
+ * triple-quoted strings); its meaning is private to the highlighter, and 0
+ * is the state at the start of the document. Equal input line and start
+ * state must give equal output, which is what lets the cache stop
+ * re-tokenizing once states converge after an edit.
+ */
+class SyntaxHighlighter {
+public:
+    using State = uint32_t;
+
+    virtual ~SyntaxHighlighter() = default;
+
+    /**
+     * @brief Append the line's segments (byte columns) and return its end state.
+     */
+    virtual State highlightLine(std::string_view line, State state, std::vector<TextSegment>& segments) const = 0;
+
+    // Reference tokenizers
+    static std::unique_ptr<SyntaxHighlighter> cpp(const SyntaxColors& colors = {});
+    static std::unique_ptr<SyntaxHighlighter> json(const SyntaxColors& colors = {});
+    static std::unique_ptr<SyntaxHighlighter> python(const SyntaxColors& colors = {});
+};
+
+//=============================================================================
+// HighlightCache - Segments near the view, states at checkpoints
+//=============================================================================
+
+/**
+ * @brief Caches segments for the lines around the view and start states
+ * every CHECKPOINT_INTERVAL lines.
+ *
+ * Edits invalidate only the changed lines. update() walks forward from the
+ * first line that may be stale: a line is re-tokenized only if its text
+ * changed or it now starts in a different state, so an edit that does not
+ * change the state at its end costs one line. Past the cached window the
+ * walk compares against the checkpoints instead, and stops at the first one
+ * after the edit that still starts in the same state.
+ *
+ * Segments are kept for at most constants::TEXT_HIGHLIGHT_CACHED_LINES
+ * lines, so memory does not grow with the document. A view the walk has not
+ * reached yet is tokenized from the nearest known state and shown
+ * provisionally; constructs opened above it (an unclosed block comment) are
+ * only picked up once the walk gets there.
+ */
+class HighlightCache {
+public:
+    void setHighlighter(std::shared_ptr<const SyntaxHighlighter> highlighter);
+    const SyntaxHighlighter* highlighter() const { return m_highlighter.get(); }
+
+    /** @brief Forget every line (new document). */
+    void reset();
+
+    /** @brief Lines [first, first + oldCount) were replaced by @p newCount lines. */
+    void linesChanged(int first, int oldCount, int newCount);
+
+    /**
+     * @brief Walk lines up to @p lastLine in order, tokenizing at most @p budget lines.
+     * @return Lines tokenized
+     */
+    int update(const TextBuffer& buffer, int lastLine, int budget);
+
+    /**
+     * @brief Give lines [@p firstLine, @p lastLine] segments, tokenizing at most @p budget lines.
+     *
+     * Moves the cached window over the range. Lines too far past validLines()
+     * for the walk start from a guessed state and may change when it arrives.
+     * @return Lines tokenized; lines it did not reach keep segments(line) == nullptr
+     */
+    int update(const TextBuffer& buffer, int firstLine, int lastLine, int budget);
+
+    /** @brief Segments of a tokenized line in the window sorted by column, nullptr otherwise. */
+    const std::vector<TextSegment>* segments(int line) const;
+
+    /** @brief Leading lines known to be up to date. */
+    int validLines() const { return m_validLines; }
+
+private:
+    static constexpr int CHECKPOINT_INTERVAL = 64;
+
+    struct Line {
+        std::vector<TextSegment> segments;
+        SyntaxHighlighter::State startState = 0;
+        SyntaxHighlighter::State endState = 0;
+        bool tokenized = false;
+        bool provisional = false;  // Started from a guessed state
+    };
+
+    struct Checkpoint {
+        int line = 0;
+        SyntaxHighlighter::State state = 0;  // Start state of the line
+    };
+
+    Line* cachedLine(int line);
+    const Line* cachedLine(int line) const;
+    std::vector<Checkpoint>::iterator checkpointAfter(int line);
+    SyntaxHighlighter::State tokenize(const TextBuffer& buffer, int index, SyntaxHighlighter::State start, Line* line);
+    bool viewStartState(const TextBuffer& buffer, int index, int budget, int& used,
+                        SyntaxHighlighter::State& state, bool& provisional);
+    void placeWindow(int firstLine, int lastLine);
+
+    std::shared_ptr<const SyntaxHighlighter> m_highlighter;
+
+    std::vector<Line> m_window;  // Lines [m_windowFirst, m_windowFirst + size)
+    int m_windowFirst = 0;
+    std::vector<TextSegment> m_scratch;  // Segments of lines outside the window
+
+    // Sorted by line. Up to m_validLines they are exact; the ones after it
+    // (up to m_knownLines) were recorded before an edit and still hold if
+    // the walk reaches one at or past m_dirtyEnd in the same state
+    std::vector<Checkpoint> m_checkpoints;
+    int m_validLines = 0;
+    SyntaxHighlighter::State m_validState = 0;  // Start state of line m_validLines
+    int m_knownLines = 0;
+    int m_dirtyEnd = 0;
+};
+
+} // namespace fst
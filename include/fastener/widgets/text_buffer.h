@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fst {
+
+class MappedFile;
+
+struct TextPosition {
+    int line = 0;
+    int column = 0;  // Byte offset within the line
+
+    bool operator==(const TextPosition& other) const {
+        return line == other.line && column == other.column;
+    }
+    bool operator!=(const TextPosition& other) const { return !(*this == other); }
+    bool operator<(const TextPosition& other) const {
+        if (line != other.line) return line < other.line;
+        return column < other.column;
+    }
+};
+
+//=============================================================================
+// TextBuffer - Piece table with a line index
+//=============================================================================
+
+/**
+ * @brief Editable text stored as a piece table.
+ *
+ * The original text and everything inserted since are kept in two
+ * append-only buffers; the document is a sequence of pieces referencing
+ * them. Pieces live in a balanced tree (treap) whose nodes carry subtree
+ * byte and newline counts, so inserts, erases, offset/line conversion and
+ * line lookup are O(log pieces) regardless of document size. Line text is
+ * copied out on demand.
+ *
+ * The original text can also be a read-only file mapping (setMapped()),
+ * which is never copied; edits only ever append to the added buffer.
+ *
+ * Copies are cheap snapshots: they share the original text and copy only
+ * the pieces and the text added by edits, so a copy can be read on another
+ * thread while the source keeps being edited.
+ *
+ * Lines are separated by '\n'; setText() drops the '\r' of CRLF pairs, and
+ * a '\r' left before a '\n' (mapped files) is not part of the line.
+ * Offsets and columns are in bytes.
+ */
+class TextBuffer {
+public:
+    TextBuffer() = default;
+    explicit TextBuffer(const std::string& text) { setText(text); }
+
+    /** @brief Replace the whole document; discards the edit history of the buffers. */
+    void setText(const std::string& text);
+    std::string text() const;
+    
+    /**
+     * @brief Use a mapped file as the original text without copying it.
+     * @param lineBreaks Offsets of every '\n' in the file, from indexLines()
+     */
+    void setMapped(std::shared_ptr<const MappedFile> file, std::vector<size_t> lineBreaks);
+    
+    /** @brief Offsets of every '\n' in @p data; vectorised and split across threads for large inputs. */
+    static std::vector<size_t> indexLines(const char* data, size_t size);
+
+    size_t length() const;
+    int lineCount() const;
+
+    /** @brief Text of a line without its newline; empty for an invalid index. */
+    std::string line(int index) const;
+    int lineLength(int index) const;
+    size_t lineStart(int index) const;
+
+    /** @brief Offset of a position, clamped to the document. */
+    size_t offsetOf(TextPosition pos) const;
+    TextPosition positionOf(size_t offset) const;
+
+    std::string substr(size_t offset, size_t count) const;
+    std::string range(TextPosition start, TextPosition end) const;
+
+    void insert(size_t offset, const std::string& text);
+    void erase(size_t offset, size_t count);
+
+    /** @brief Number of pieces; typing at one spot extends a single piece. */
+    size_t pieceCount() const { return m_nodes.size() - m_free.size(); }
+
+private:
+    struct Node {
+        uint8_t source = 0;     // 0 = original buffer, 1 = added buffer
+        size_t start = 0;       // Range in the source buffer
+        size_t length = 0;
+        size_t newlines = 0;
+        uint32_t priority = 0;
+        int left = -1;
+        int right = -1;
+        size_t subLength = 0;   // Totals over this subtree
+        size_t subNewlines = 0;
+    };
+
+    const char* sourceData(uint8_t source) const;
+    const std::vector<size_t>& sourceBreaks(uint8_t source) const {
+        return source == 0 ? *m_originalBreaks : m_addedBreaks;
+    }
+    size_t countBreaks(uint8_t source, size_t begin, size_t end) const;
+
+    size_t subLength(int node) const { return node < 0 ? 0 : m_nodes[node].subLength; }
+    size_t subNewlines(int node) const { return node < 0 ? 0 : m_nodes[node].subNewlines; }
+
+    int newNode(uint8_t source, size_t start, size_t length);
+    void freeTree(int node);
+    void update(int node);
+    int merge(int a, int b);
+    void split(int node, size_t offset, int& left, int& right);
+    bool extendLast(int node, size_t extra);
+    size_t newlinesBefore(size_t offset) const;
+    char charAt(size_t offset) const;
+    size_t lineEnd(int index) const;
+    void appendRange(int node, size_t begin, size_t end, std::string& out) const;
+
+    // The original text never changes, so copies of the buffer share it
+    std::shared_ptr<const std::string> m_original;  // Unless m_mapping is set
+    std::shared_ptr<const MappedFile> m_mapping;
+    size_t m_originalSize = 0;
+    std::string m_added;
+    std::shared_ptr<const std::vector<size_t>> m_originalBreaks;  // Offsets of '\n' in each buffer
+    std::vector<size_t> m_addedBreaks;
+
+    std::vector<Node> m_nodes;
+    std::vector<int> m_free;
+    int m_root = -1;
+    uint32_t m_seed = 0x9E3779B9u;
+};
+
+} // namespace fst
@@ -2,28 +2,21 @@
 
 #include "fastener/core/types.h"
 #include "fastener/core/input.h"
+#include "fastener/widgets/syntax_highlighter.h"
+#include "fastener/widgets/text_buffer.h"
+#include "fastener/widgets/text_search.h"
 #include <string>
 #include <vector>
+#include <chrono>
 #include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 
 namespace fst {
 class Context;
 
 
-struct TextPosition {
-    int line = 0;
-    int column = 0;
-
-    bool operator==(const TextPosition& other) const {
-        return line == other.line && column == other.column;
-    }
-    bool operator!=(const TextPosition& other) const { return !(*this == other); }
-    bool operator<(const TextPosition& other) const {
-        if (line != other.line) return line < other.line;
-        return column < other.column;
-    }
-};
-
 struct TextSelection {
     TextPosition start;
     TextPosition end;
@@ -35,13 +28,6 @@ struct TextSelection {
     TextPosition max() const { return start < end ? end : start; }
 };
 
-struct TextSegment {
-    int startColumn;
-    int endColumn;
-    Color color;
-    Color background = Color::transparent();
-};
-
 struct TextLineAnnotation {
     int line = 0;
     Color highlightColor = Color(220, 32, 32, 110);
@@ -53,7 +39,14 @@ using StyleProvider = std::function<std::vector<TextSegment>(int lineIndex, cons
 
 enum class EditActionType {
     Insert,
-    Delete
+    Delete,
+    Replace  // Many ranges at once (replace all)
+};
+
+struct TextReplacement {
+    size_t offset = 0;  // In the document before the action
+    std::string removed;
+    std::string inserted;
 };
 
 struct EditAction {
@@ -63,6 +56,8 @@ struct EditAction {
     TextPosition end;
     TextPosition cursorBefore;
     TextPosition cursorAfter;
+    bool typed = false;  // Typed text; consecutive typing within a word is one undo step
+    std::vector<TextReplacement> replacements;  // Replace only; ascending offsets
 };
 
 struct TextEditorOptions {
@@ -72,16 +67,34 @@ struct TextEditorOptions {
     bool suppressNavigationKeys = false;
     bool wordWrap = false;
     float lineHeight = 1.2f;  // Relative to font height
+    bool highlightAhead = true;  // Spend leftover highlight budget on lines below the view
 };
 
 class TextEditor {
 public:
     TextEditor();
     ~TextEditor();
+    TextEditor(TextEditor&&) noexcept;
 
     void setText(const std::string& text);
     std::string getText() const;
     void clear();
+    
+    /**
+     * @brief Show a file through a read-only memory mapping instead of loading it.
+     * 
+     * Only the line index is built (on a background thread); line text is
+     * read from the mapping as it scrolls into view, and edits are kept in
+     * the piece table without touching the file. Until indexing finishes
+     * isLoading() is true and the editor shows a placeholder.
+     * 
+     * @param readOnly Reject edits regardless of TextEditorOptions::readOnly
+     * @return false if the file cannot be opened or mapped
+     */
+    bool openFile(const std::string& path, bool readOnly = true);
+    bool isLoading() const { return m_pendingIndex.valid(); }
+    /** @brief Block until a file opened with openFile() is indexed. */
+    void waitUntilLoaded();
 
     void render(Context& ctx, const Rect& bounds, const TextEditorOptions& options = {});
 
@@ -89,23 +102,91 @@ public:
     // State access
     const TextPosition& cursor() const { return m_cursor; }
     void setCursor(const TextPosition& pos);
-    int lineCount() const { return static_cast<int>(m_lines.size()); }
+    int lineCount() const { return m_buffer.lineCount(); }
     int firstVisibleLine() const;
     int visibleLineCount() const;
     void centerViewOnLine(int line);
     
     void setStyleProvider(StyleProvider provider) { m_styleProvider = std::move(provider); }
+    
+    /**
+     * @brief Highlight with a line-state tokenizer instead of a StyleProvider.
+     * 
+     * Segments are cached per line and only the lines an edit touches (plus
+     * any whose start state it changes) are tokenized again. Each frame
+     * tokenizes at most constants::TEXT_HIGHLIGHT_LINES_PER_FRAME lines, visible ones
+     * first; lines not reached yet are drawn unstyled.
+     * 
+     * Only constants::TEXT_HIGHLIGHT_CACHED_LINES lines around the view keep
+     * their segments. After a jump far into a large file the view is styled
+     * at once from the nearest known state, so a block comment or string
+     * opened above it shows up only when the in-order pass catches up.
+     */
+    void setHighlighter(std::shared_ptr<const SyntaxHighlighter> highlighter) { m_highlights.setHighlighter(std::move(highlighter)); }
     void setLineAnnotations(std::vector<TextLineAnnotation> annotations);
     void clearLineAnnotations();
 
+    // Find / replace
+    
+    /**
+     * @brief Find every match of @p query on a background thread.
+     * 
+     * The worker searches a snapshot of the buffer; matches() fills in as
+     * windows of the document are scanned, and matches in the visible lines
+     * are highlighted. Edits drop the matches, and the search restarts once
+     * typing pauses for constants::TEXT_SEARCH_RESTART_DELAY, or right away
+     * when findNext(), replace() or waitForSearch() need the results.
+     * 
+     * @return false if the regex does not compile
+     */
+    bool find(const SearchQuery& query);
+    void clearFind();
+    bool isSearching() const { return m_searchStale || (m_search && m_search->isRunning()); }
+    /** @brief Block until the whole document has been searched. */
+    void waitForSearch();
+    /** @brief Matches found so far, sorted by offset. */
+    const std::vector<TextMatch>& matches() const { return m_matches; }
+    
+    /** @brief Select the next (previous) match from the cursor, wrapping around. */
+    bool findNext();
+    bool findPrevious();
+    
+    /**
+     * @brief Replace the selected match and select the next one.
+     * @return false if the selection was not a match (the next one is selected instead)
+     */
+    bool replace(const std::string& replacement);
+    
+    /**
+     * @brief Replace every match as a single edit with one undo step.
+     * 
+     * Waits for the search to finish. The replacement is inserted literally,
+     * also for regex queries.
+     * @return Number of matches replaced
+     */
+    size_t replaceAll(const std::string& replacement);
+
     void undo();
     void redo();
     bool canUndo() const { return !m_undoStack.empty(); }
     bool canRedo() const { return !m_redoStack.empty(); }
 
 private:
-    std::vector<std::string> m_lines;
+    TextBuffer m_buffer;
+    bool m_readOnly = false;
+    
+    // File opened with openFile() whose line index is still being built
+    std::shared_ptr<const MappedFile> m_pendingFile;
+    std::future<std::vector<size_t>> m_pendingIndex;
     StyleProvider m_styleProvider;
+    HighlightCache m_highlights;
+    
+    // Find state; the search lives on the heap so the editor stays movable
+    std::unique_ptr<TextSearch> m_search;
+    SearchQuery m_query;
+    std::vector<TextMatch> m_matches;
+    bool m_searchStale = false;  // The buffer changed since the search started
+    std::chrono::steady_clock::time_point m_lastSearchEdit;
     std::vector<TextLineAnnotation> m_lineAnnotations;
     TextPosition m_cursor;
     TextSelection m_selection;
@@ -125,6 +206,10 @@ private:
     std::vector<EditAction> m_redoStack;
     const size_t m_maxHistorySize = 100;
     bool m_isUndoingRedoing = false;
+    bool m_typingGroupOpen = false;  // The next typed insert may merge into the last action
+    
+    // Clipboard text requested by a paste, filled in when the owner answers
+    std::shared_ptr<std::optional<std::string>> m_pendingPaste;
 
     // Internal helpers
     void handleInput(
@@ -134,24 +219,40 @@ private:
         float charWidth,
         float gutterWidth,
         bool focused,
-        bool suppressNavigationKeys);
-    void handleKeyboard(Context& ctx, const Rect& bounds, float rowHeight, float deltaTime, bool suppressNavigationKeys);
+        bool suppressNavigationKeys,
+        bool editable);
+    void handleKeyboard(Context& ctx, const Rect& bounds, float rowHeight, float deltaTime, bool suppressNavigationKeys, bool editable);
     void handleMouse(Context& ctx, const Rect& bounds, float rowHeight, float charWidth, float gutterWidth);
     
-    void insertText(const std::string& text);
+    void finishLoading(bool wait);
+    void resetDocumentState();
+    
+    // Every buffer edit goes through these so the highlight cache follows
+    void bufferInsert(size_t offset, const std::string& text);
+    void bufferErase(size_t offset, size_t count);
+    
+    void applyReplacements(const std::vector<TextReplacement>& replacements, bool undo);
+    
+    void markSearchStale();
+    void pollSearch(bool restartNow);
+    void selectMatch(const TextMatch& match);
+    
+    void insertText(const std::string& text, bool typed = false);
     void deleteSelection();
     void backspace();
     void enter();
     
     void copyToClipboard(Context& ctx);
     void pasteFromClipboard(Context& ctx);
+    void applyPendingPaste();
     void cutToClipboard(Context& ctx);
 
     
     std::string getSelectedText() const;
     std::string getTextRange(TextPosition start, TextPosition end) const;
     
-    void recordAction(EditActionType type, const std::string& text, TextPosition start, TextPosition end, TextPosition cursorBefore);
+    void recordAction(EditActionType type, const std::string& text, TextPosition start, TextPosition end, TextPosition cursorBefore, bool typed = false);
+    void pushAction(EditAction action);
     void applyAction(const EditAction& action, bool undo);
 
     void ensureCursorVisible(const Rect& bounds, float rowHeight);
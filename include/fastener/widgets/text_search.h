@@ -0,0 +1,104 @@
+#pragma once
+
+#include "fastener/widgets/text_buffer.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fst {
+
+struct SearchQuery {
+    std::string pattern;
+    bool caseSensitive = true;  // Literal searches fold ASCII letters only
+    bool regex = false;         // ECMAScript syntax; matches do not span lines
+
+    bool operator==(const SearchQuery& other) const {
+        return pattern == other.pattern && caseSensitive == other.caseSensitive && regex == other.regex;
+    }
+    bool operator!=(const SearchQuery& other) const { return !(*this == other); }
+};
+
+/** @brief A match as a byte range of the document. */
+struct TextMatch {
+    size_t offset = 0;
+    size_t length = 0;
+};
+
+//=============================================================================
+// TextSearch - Background search over a buffer snapshot
+//=============================================================================
+
+/**
+ * @brief Finds every match of a query on a worker thread.
+ *
+ * The worker reads a snapshot of the buffer (TextBuffer copies share the
+ * original text), so the document can keep being edited; matches then refer
+ * to the snapshot and the owner restarts the search. Literal searches scan
+ * fixed-size windows with memchr for the first byte of the pattern; regex
+ * searches go line by line, and through long lines in bounded chunks.
+ * Matches are published after every window and come out sorted and
+ * non-overlapping.
+ *
+ * Cancelling never blocks: the old worker is told to stop and set aside, and
+ * whatever it publishes afterwards goes to its own job state, which nothing
+ * collects from any more. Stopped workers are joined once they have exited,
+ * or at the latest by the destructor.
+ */
+class TextSearch {
+public:
+    TextSearch() = default;
+    ~TextSearch();
+
+    TextSearch(const TextSearch&) = delete;
+    TextSearch& operator=(const TextSearch&) = delete;
+
+    /**
+     * @brief Cancel any running search and search @p snapshot for @p query.
+     * @return false (and nothing is searched) if the regex does not compile
+     */
+    bool start(TextBuffer snapshot, const SearchQuery& query);
+
+    /** @brief Tell the worker to stop and forget its results. */
+    void cancel();
+
+    /** @brief Block until the whole snapshot has been searched. */
+    void wait();
+
+    bool isRunning() const { return m_job && m_job->running.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Append matches found since the last call to @p out.
+     * @return Number of matches appended
+     */
+    size_t collect(std::vector<TextMatch>& out);
+
+private:
+    // State shared with one worker, which may outlive a cancel()
+    struct Job {
+        std::atomic<bool> cancel{false};
+        std::atomic<bool> running{true};
+
+        std::mutex mutex;
+        std::vector<TextMatch> found;  // Published but not yet collected
+
+        void publish(std::vector<TextMatch>& matches);
+    };
+
+    // A cancelled worker that may still be running
+    struct Stopped {
+        std::thread worker;
+        std::shared_ptr<Job> job;
+    };
+
+    void joinStopped(bool all);
+
+    std::thread m_worker;
+    std::shared_ptr<Job> m_job;
+    std::vector<Stopped> m_stopped;
+};
+
+} // namespace fst
@@ -1,4 +1,5 @@
 #include "fastener/core/context.h"
+#include "fastener/core/constants.h"
 #include "fastener/core/log.h"
 #include "fastener/platform/platform_interface.h"
 #include "fastener/platform/window.h"
@@ -12,14 +13,24 @@
 #include "fastener/core/profiler.h"
 #include <vector>
 #include <chrono>
+#include <cmath>
 #include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
 
 namespace fst {
 
+static_assert(std::is_trivially_copyable_v<ThemeColors> && std::is_trivially_copyable_v<ThemeMetrics>,
+              "Theme change detection compares theme bytes");
+
 // Thread-local context stack for multi-window/DI support
 static thread_local std::vector<Context*> s_contextStack;
 static IDrawList* s_testDrawList = nullptr;
 
+// Resize tracking of windows not drawn for this many frames is dropped
+static constexpr uint64_t kWindowResizeMaxAge = 600;
+
 namespace {
 
 class NullWindow final : public IPlatformWindow {
@@ -59,7 +70,7 @@ public:
     void hideCursor() override {}
     void showCursor() override {}
 
-    std::string getClipboardText() const override { return {}; }
+    std::string getClipboardText() override { return {}; }
     void setClipboardText(const std::string&) override {}
 
     InputState& input() override { return m_input; }
@@ -116,6 +127,40 @@ struct Context::Impl {
     // Menu state (moved from global variables in menu.cpp)
     Context::MenuState menuState;
     
+    // Cross-frame measure cache, invalidated by the style generations
+    std::unordered_map<WidgetId, Context::MeasureCacheEntry> measureCache;
+    uint64_t frameIndex = 0;
+    uint64_t resizeFrame = 0;  // frameIndex + 1 of the last splitter drag, 0 if none
+    
+    // Live window resize, tracked per window so a Context shared by several
+    // windows does not see their different sizes as a resize
+    struct WindowResize {
+        Vec2 lastSize;
+        Vec2 layoutSize;        // Last settled size while stretching
+        float resizeTime = -1.0f;
+        uint64_t lastFrame = 0;
+    };
+    ResizeMode resizeMode = ResizeMode::Relayout;
+    std::unordered_map<const IPlatformWindow*, WindowResize> windowResizes;
+    WindowResize* windowResize = nullptr;  // Entry of currentWindow
+    
+    // Style generations and the state they were last bumped for
+    uint64_t themeGeneration = 1;
+    uint64_t fontGeneration = 1;
+    uint64_t dpiGeneration = 1;
+    Theme themeSnapshot = theme;
+    float lastDpiScale = 0.0f;
+    
+    // Bump the theme generation if colors or metrics differ from the snapshot.
+    // Theme is plain colors and floats, so a byte compare is exact.
+    void syncThemeGeneration() {
+        if (std::memcmp(&theme.colors, &themeSnapshot.colors, sizeof(ThemeColors)) != 0 ||
+            std::memcmp(&theme.metrics, &themeSnapshot.metrics, sizeof(ThemeMetrics)) != 0) {
+            themeSnapshot = theme;
+            themeGeneration++;
+        }
+    }
+    
     Impl() {
         startTime = std::chrono::steady_clock::now();
         lastFrameTime = startTime;
@@ -144,16 +189,21 @@ Context::~Context() {
     }
 }
 
-void Context::beginFrame(IPlatformWindow& window) {
+void Context::beginFrame(IPlatformWindow& window, Clock::time_point now) {
     pushContext(this);
     m_impl->frameActive = true;
+    m_impl->frameIndex++;
+    
+    // Detect in-place theme edits and DPI changes before any widget measures
+    m_impl->syncThemeGeneration();
+    if (window.dpiScale() != m_impl->lastDpiScale) {
+        m_impl->lastDpiScale = window.dpiScale();
+        m_impl->dpiGeneration++;
+    }
     m_impl->currentWindow = &window;
     m_impl->inputState = &window.input();
-    m_impl->inputState->onResize(static_cast<float>(window.width()), static_cast<float>(window.height()));
-
     
     // Calculate delta time
-    auto now = std::chrono::steady_clock::now();
     auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_impl->lastFrameTime);
     m_impl->deltaTime = elapsed.count() / 1000000.0f;
     m_impl->lastFrameTime = now;
@@ -161,6 +211,43 @@ void Context::beginFrame(IPlatformWindow& window) {
     auto total = std::chrono::duration_cast<std::chrono::microseconds>(now - m_impl->startTime);
     m_impl->totalTime = total.count() / 1000000.0f;
     
+    // A live window resize is treated like a splitter drag, so size-keyed
+    // measurements are refreshed at a throttled rate
+    // Windows not drawn for a while are gone or hidden; forget them
+    auto& resizes = m_impl->windowResizes;
+    for (auto it = resizes.begin(); it != resizes.end();) {
+        if (it->first != &window && m_impl->frameIndex - it->second.lastFrame > kWindowResizeMaxAge) {
+            it = resizes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    Impl::WindowResize& resize = resizes[&window];
+    resize.lastFrame = m_impl->frameIndex;
+    m_impl->windowResize = &resize;
+    
+    Vec2 windowSize(static_cast<float>(window.width()), static_cast<float>(window.height()));
+    if (windowSize != resize.lastSize) {
+        if (resize.lastSize != Vec2::zero()) {
+            resize.resizeTime = m_impl->totalTime;
+        }
+        resize.lastSize = windowSize;
+    }
+    if (isWindowResizing()) {
+        beginInteractiveResize();
+    }
+    if (m_impl->resizeMode != ResizeMode::Stretch || !isWindowResizing() ||
+        resize.layoutSize == Vec2::zero()) {
+        resize.layoutSize = windowSize;
+    }
+    Vec2 layoutSize = resize.layoutSize;
+    m_impl->inputState->onResize(layoutSize.x, layoutSize.y);
+    
+    // The pointer arrives in window pixels; widgets hit-test in layout space
+    m_impl->inputState->setPointerScale(Vec2(
+        windowSize.x > 0.0f ? layoutSize.x / windowSize.x : 1.0f,
+        windowSize.y > 0.0f ? layoutSize.y / windowSize.y : 1.0f));
+    
     // Profiler
     m_impl->profiler.beginFrame();
     m_impl->profiler.beginSection("Frame");
@@ -182,20 +269,27 @@ void Context::beginFrame(IPlatformWindow& window) {
         }
     }
     if (m_impl->rendererInitialized) {
+        // Content is in framebuffer units at the layout size; while a resize
+        // is stretched the renderer scales it over the whole framebuffer
         Vec2 fbSize = window.framebufferSize();
+        float fbScaleX = windowSize.x > 0.0f ? fbSize.x / windowSize.x : 1.0f;
+        float fbScaleY = windowSize.y > 0.0f ? fbSize.y / windowSize.y : 1.0f;
         m_impl->renderer.beginFrame(
             static_cast<int>(fbSize.x), 
             static_cast<int>(fbSize.y), 
-            window.dpiScale()
+            window.dpiScale(),
+            static_cast<int>(std::lround(layoutSize.x * fbScaleX)),
+            static_cast<int>(std::lround(layoutSize.y * fbScaleY))
         );
     }
     
     // Push fullscreen clip rect
-    m_impl->drawList.pushClipRectFullScreen(window.size());
+    m_impl->drawList.pushClipRectFullScreen(layoutSize);
     
     // Begin root layout container
+    m_impl->layout.beginFrame();
     m_impl->layout.beginContainer(
-        Rect(0.0f, 0.0f, static_cast<float>(window.width()), static_cast<float>(window.height())),
+        Rect(0.0f, 0.0f, layoutSize.x, layoutSize.y),
         LayoutDirection::Vertical
     );
     
@@ -253,6 +347,17 @@ void Context::endFrame() {
     }
     m_impl->postRenderCommands.clear();
 
+    // Evict measurements of widgets that stopped being submitted
+    if ((m_impl->frameIndex & 63) == 0) {
+        for (auto it = m_impl->measureCache.begin(); it != m_impl->measureCache.end();) {
+            if (m_impl->frameIndex - it->second.lastFrame > 120) {
+                it = m_impl->measureCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
     // Cleanup drag and drop state if needed (and render preview)
     EndDragDropFrame(*this);
     
@@ -276,6 +381,7 @@ void Context::endFrame() {
 
 void Context::setTheme(const Theme& theme) {
     m_impl->theme = theme;
+    m_impl->syncThemeGeneration();
 }
 
 Theme& Context::theme() {
@@ -294,6 +400,7 @@ bool Context::loadFont(const std::string& path, float size) {
         return false;
     }
     m_impl->currentFont = m_impl->defaultFont.get();
+    m_impl->fontGeneration++;
     return true;
 }
 
@@ -325,6 +432,10 @@ const InputState& Context::input() const {
     return m_impl->renderer;
 }
 
+void Context::setGpuResourceCache(GpuResourceCache* cache) {
+    m_impl->renderer.setResourceCache(cache);
+}
+
 DrawList& Context::drawList() {
     return m_impl->drawList;
 }
@@ -550,6 +661,61 @@ Context::MenuState& Context::menuState() {
     return m_impl->menuState;
 }
 
+Context::MeasureCacheEntry& Context::measureCacheEntry(WidgetId key) {
+    MeasureCacheEntry& entry = m_impl->measureCache[key];
+    entry.lastFrame = m_impl->frameIndex;
+    return entry;
+}
+
+bool Context::deferResizeRelayout(const MeasureCacheEntry& entry) const {
+    return isInteractiveResizing() && time() - entry.computedAt < constants::RESIZE_RELAYOUT_INTERVAL;
+}
+
+void Context::beginInteractiveResize() {
+    m_impl->resizeFrame = m_impl->frameIndex + 1;
+}
+
+void Context::setResizeMode(ResizeMode mode) {
+    m_impl->resizeMode = mode;
+}
+
+ResizeMode Context::resizeMode() const {
+    return m_impl->resizeMode;
+}
+
+Vec2 Context::layoutSize() const {
+    return m_impl->windowResize ? m_impl->windowResize->layoutSize : Vec2::zero();
+}
+
+bool Context::isWindowResizing() const {
+    const Impl::WindowResize* resize = m_impl->windowResize;
+    return resize && resize->resizeTime >= 0.0f &&
+           m_impl->totalTime - resize->resizeTime < constants::RESIZE_SETTLE_TIME;
+}
+
+bool Context::isInteractiveResizing() const {
+    // Splitters usually draw after the panes they resize, so a drag reported
+    // last frame still counts
+    return m_impl->resizeFrame != 0 && m_impl->frameIndex + 1 - m_impl->resizeFrame <= 1;
+}
+
+uint64_t Context::themeGeneration() const {
+    return m_impl->themeGeneration;
+}
+
+uint64_t Context::fontGeneration() const {
+    return m_impl->fontGeneration;
+}
+
+uint64_t Context::dpiGeneration() const {
+    return m_impl->dpiGeneration;
+}
+
+uint64_t Context::styleGeneration() const {
+    // Each generation only grows, so the sum changes whenever any of them does
+    return m_impl->themeGeneration + m_impl->fontGeneration + m_impl->dpiGeneration;
+}
+
 void Context::setTestDrawList(IDrawList* testDl) {
     s_testDrawList = testDl;
 }
@@ -0,0 +1,87 @@
+#include "fastener/core/frame_pacer.h"
+#include "fastener/core/profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace fst {
+
+static float millisecondsBetween(FramePacer::Clock::time_point from, FramePacer::Clock::time_point to) {
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+FramePacer::FramePacer(Profiler* profiler)
+    : m_profiler(profiler)
+{
+}
+
+void FramePacer::waitForNextFrame() {
+    Clock::time_point wake = wakeTime();
+    if (wake > Clock::now()) {
+        std::this_thread::sleep_until(wake);
+    }
+}
+
+void FramePacer::markInputSampled(Clock::time_point now) {
+    m_inputSampled = now;
+    m_hasInput = true;
+    m_hasWork = false;
+}
+
+void FramePacer::markFrameBuilt(Clock::time_point now) {
+    if (!m_hasInput) return;
+
+    // Build time only; the swap itself may block on vblank
+    m_workMs[m_workOffset] = millisecondsBetween(m_inputSampled, now);
+    m_workOffset = (m_workOffset + 1) % static_cast<int>(m_workMs.size());
+    m_hasWork = true;
+}
+
+void FramePacer::framePresented(Clock::time_point now) {
+    if (m_hasInput && m_hasWork) {
+        m_lastLatencyMs = millisecondsBetween(m_inputSampled, now);
+        if (m_profiler) {
+            m_profiler->recordLatency(m_lastLatencyMs);
+        }
+    }
+    m_hasInput = false;
+    m_hasWork = false;
+
+    if (m_hasPresent) {
+        float interval = millisecondsBetween(m_lastPresent, now);
+        if (m_intervalMs <= 0.0f) {
+            m_intervalMs = interval;
+        } else if (std::fabs(interval - m_intervalMs) < m_intervalMs * 0.5f) {
+            // Smooth the estimate; missed vblanks show up as whole multiples
+            // and are left out
+            m_intervalMs += (interval - m_intervalMs) * 0.1f;
+            m_offEstimateFrames = 0;
+        } else if (++m_offEstimateFrames >= constants::FRAME_PACER_RESYNC_FRAMES) {
+            // The refresh rate really changed (new monitor, vsync toggled)
+            m_intervalMs = interval;
+            m_offEstimateFrames = 0;
+        }
+    }
+    m_lastPresent = now;
+    m_hasPresent = true;
+}
+
+float FramePacer::predictedWork() const {
+    // Worst recent frame: sleeping too long costs a whole refresh
+    return *std::max_element(m_workMs.begin(), m_workMs.end());
+}
+
+FramePacer::Clock::time_point FramePacer::wakeTime() const {
+    if (!m_enabled || !m_hasPresent || m_intervalMs <= 0.0f) {
+        return Clock::now();
+    }
+
+    float delayMs = m_intervalMs - predictedWork() - m_safetyMarginMs;
+    if (delayMs <= 0.0f) {
+        return m_lastPresent;
+    }
+    return m_lastPresent + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float, std::milli>(delayMs));
+}
+
+} // namespace fst
@@ -1,8 +1,30 @@
 #include "fastener/core/input.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <utility>
 
 namespace fst {
 
+static void appendUtf8(std::string& out, char32_t codepoint) {
+    // Convert UTF-32 to UTF-8
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
 bool InputState::isKeyDown(Key key) const {
     int idx = static_cast<int>(key);
     if (idx < 0 || idx >= static_cast<int>(Key::MaxKey)) return false;
@@ -69,6 +91,12 @@ bool InputState::isMouseDoubleClickedRaw(MouseButton button) const {
     return m_mouseDoubleClicked[idx];
 }
 
+void InputState::consumeEvent(size_t index) {
+    if (index < m_frameEvents.size()) {
+        m_frameEvents[index].consumed = true;
+    }
+}
+
 void InputState::beginFrame() {
     // Clear per-frame state
     m_keysPressed.fill(false);
@@ -77,93 +105,301 @@ void InputState::beginFrame() {
     m_mouseReleased.fill(false);
     m_mouseDoubleClicked.fill(false);
     m_scrollDelta = Vec2::zero();
+    m_scrollSteps = Vec2::zero();
     m_textInput.clear();
+    m_frameEvents.clear();
+    m_mouseHistory.clear();
+    m_buttonChangedThisFrame = false;
+    m_mouseConsumed = false;
     
-    // Calculate mouse delta
+    // Events deferred by trickling land in this frame
+    drainQueue();
+    
+    // Calculate mouse delta, including moves that were just drained
     m_mouseDelta = m_mousePos - m_lastMousePos;
     m_lastMousePos = m_mousePos;
-    m_mouseConsumed = false;
 }
 
 void InputState::endFrame() {
     // Nothing to do yet
 }
 
-void InputState::onKeyDown(Key key) {
-    int idx = static_cast<int>(key);
-    if (idx < 0 || idx >= static_cast<int>(Key::MaxKey)) return;
+void InputState::setPointerScale(Vec2 scale) {
+    // A degenerate window size maps nothing; keep positions unscaled
+    if (!(scale.x > 0.0f) || !(scale.y > 0.0f)) scale = Vec2(1.0f, 1.0f);
+    if (scale == m_pointerScale) return;
     
-    if (!m_keysDown[idx]) {
-        m_keysPressed[idx] = true;
+    // Positions recorded so far this frame carry the previous scale
+    Vec2 ratio(scale.x / m_pointerScale.x, scale.y / m_pointerScale.y);
+    for (MouseSample& sample : m_mouseHistory) {
+        sample.pos = sample.pos * ratio;
+    }
+    for (InputEvent& event : m_frameEvents) {
+        if (event.type == InputEventType::MouseMove) event.value = event.value * ratio;
     }
-    m_keysDown[idx] = true;
+    m_pointerScale = scale;
 }
 
-void InputState::onKeyUp(Key key) {
-    int idx = static_cast<int>(key);
-    if (idx < 0 || idx >= static_cast<int>(Key::MaxKey)) return;
+//=============================================================================
+// Event Queue
+//=============================================================================
+
+void InputState::enqueue(InputEvent event) {
+    if (event.time < 0.0) {
+        event.time = m_frameTime;
+    }
+    // Events held back by trickling must keep the modifiers of their own time
+    if (event.type == InputEventType::Modifiers) {
+        m_queuedModifiers = event.modifiers;
+    } else {
+        event.modifiers = m_queuedModifiers;
+    }
+    
+    // A full ring forces the oldest event through rather than dropping input
+    if (m_queueCount == m_queue.size()) {
+        apply(m_queue[m_queueHead]);
+        m_queueHead = (m_queueHead + 1) % m_queue.size();
+        m_queueCount--;
+    }
     
-    m_keysDown[idx] = false;
-    m_keysReleased[idx] = true;
+    m_queue[(m_queueHead + m_queueCount) % m_queue.size()] = std::move(event);
+    m_queueCount++;
+    drainQueue();
 }
 
-void InputState::onMouseDown(MouseButton button) {
-    int idx = static_cast<int>(button);
-    if (idx < 0 || idx >= static_cast<int>(MouseButton::MaxButton)) return;
-    
-    if (!m_mouseDown[idx]) {
-        m_mousePressed[idx] = true;
-        
-        // Check for double click
-        float currentTime = m_frameTime;
-        if (currentTime - m_lastClickTime[idx] < DOUBLE_CLICK_TIME) {
-            m_mouseDoubleClicked[idx] = true;
+void InputState::drainQueue() {
+    while (m_queueCount > 0) {
+        const InputEvent& event = m_queue[m_queueHead];
+        // Stop at the first collapsing event so order is preserved
+        if (m_trickle && wouldCollapse(event)) {
+            break;
         }
-        m_lastClickTime[idx] = currentTime;
+        apply(event);
+        m_queueHead = (m_queueHead + 1) % m_queue.size();
+        m_queueCount--;
     }
-    m_mouseDown[idx] = true;
 }
 
-void InputState::onMouseUp(MouseButton button) {
-    int idx = static_cast<int>(button);
-    if (idx < 0 || idx >= static_cast<int>(MouseButton::MaxButton)) return;
+bool InputState::wouldCollapse(const InputEvent& event) const {
+    switch (event.type) {
+        case InputEventType::KeyDown:
+        case InputEventType::KeyUp: {
+            int idx = static_cast<int>(event.key);
+            if (idx < 0 || idx >= static_cast<int>(Key::MaxKey)) return false;
+            return m_keysPressed[idx] || m_keysReleased[idx];
+        }
+        case InputEventType::MouseDown:
+        case InputEventType::MouseUp: {
+            int idx = static_cast<int>(event.button);
+            if (idx < 0 || idx >= static_cast<int>(MouseButton::MaxButton)) return false;
+            return m_mousePressed[idx] || m_mouseReleased[idx];
+        }
+        case InputEventType::MouseMove:
+            // Keep a click at the position it happened
+            return m_buttonChangedThisFrame;
+        case InputEventType::MouseScroll:
+        case InputEventType::Text:
+        case InputEventType::TextCommit:
+        case InputEventType::Preedit:
+        case InputEventType::Modifiers:
+            return false;
+    }
+    return false;
+}
+
+void InputState::apply(const InputEvent& event) {
+    switch (event.type) {
+        case InputEventType::KeyDown: {
+            int idx = static_cast<int>(event.key);
+            if (idx < 0 || idx >= static_cast<int>(Key::MaxKey)) return;
+            
+            if (!m_keysDown[idx]) {
+                m_keysPressed[idx] = true;
+            }
+            m_keysDown[idx] = true;
+            break;
+        }
+        case InputEventType::KeyUp: {
+            int idx = static_cast<int>(event.key);
+            if (idx < 0 || idx >= static_cast<int>(Key::MaxKey)) return;
+            
+            m_keysDown[idx] = false;
+            m_keysReleased[idx] = true;
+            break;
+        }
+        case InputEventType::MouseDown: {
+            int idx = static_cast<int>(event.button);
+            if (idx < 0 || idx >= static_cast<int>(MouseButton::MaxButton)) return;
+            
+            if (!m_mouseDown[idx]) {
+                m_mousePressed[idx] = true;
+                
+                // Check for double click against the previous press event
+                if (m_lastClickTime[idx] >= 0.0 &&
+                    event.time - m_lastClickTime[idx] < constants::DOUBLE_CLICK_TIME) {
+                    m_mouseDoubleClicked[idx] = true;
+                }
+                m_lastClickTime[idx] = event.time;
+            }
+            m_mouseDown[idx] = true;
+            m_buttonChangedThisFrame = true;
+            break;
+        }
+        case InputEventType::MouseUp: {
+            int idx = static_cast<int>(event.button);
+            if (idx < 0 || idx >= static_cast<int>(MouseButton::MaxButton)) return;
+            
+            m_mouseDown[idx] = false;
+            m_mouseReleased[idx] = true;
+            m_buttonChangedThisFrame = true;
+            break;
+        }
+        case InputEventType::MouseMove:
+            m_mousePos = event.value;
+            break;
+        case InputEventType::MouseScroll: {
+            m_scrollDelta += event.value;
+            
+            // Smooth scrolling reports fractions of a detent; carry them over
+            // so stepping widgets move once per whole detent. A fraction left
+            // by another device or the other direction is a scroll that ended
+            if (event.device != m_scrollDevice) {
+                m_scrollRemainder = Vec2::zero();
+                m_scrollDevice = event.device;
+            }
+            if (event.value.x * m_scrollRemainder.x < 0.0f) m_scrollRemainder.x = 0.0f;
+            if (event.value.y * m_scrollRemainder.y < 0.0f) m_scrollRemainder.y = 0.0f;
+            m_scrollRemainder += event.value;
+            float stepsX = std::trunc(m_scrollRemainder.x);
+            float stepsY = std::trunc(m_scrollRemainder.y);
+            m_scrollSteps += Vec2(stepsX, stepsY);
+            m_scrollRemainder -= Vec2(stepsX, stepsY);
+            break;
+        }
+        case InputEventType::Text:
+            appendUtf8(m_textInput, event.codepoint);
+            break;
+        case InputEventType::TextCommit:
+            m_textInput += event.text;
+            break;
+        case InputEventType::Preedit: {
+            int length = static_cast<int>(event.text.size());
+            m_preeditText = event.text;
+            m_preeditCursorBegin = std::clamp(event.cursorBegin, 0, length);
+            m_preeditCursorEnd = std::clamp(event.cursorEnd, m_preeditCursorBegin, length);
+            break;
+        }
+        case InputEventType::Modifiers:
+            m_modifiers = event.modifiers;
+            break;
+    }
+    m_frameEvents.push_back(event);
+    if (event.type == InputEventType::MouseMove) {
+        m_frameEvents.back().value = event.value * m_pointerScale;
+    }
+}
+
+//=============================================================================
+// Event Handlers
+//=============================================================================
+
+void InputState::onKeyDown(Key key, double time) {
+    InputEvent event;
+    event.type = InputEventType::KeyDown;
+    event.time = time;
+    event.key = key;
+    enqueue(event);
+}
+
+void InputState::onKeyUp(Key key, double time) {
+    InputEvent event;
+    event.type = InputEventType::KeyUp;
+    event.time = time;
+    event.key = key;
+    enqueue(event);
+}
+
+void InputState::onMouseDown(MouseButton button, double time) {
+    InputEvent event;
+    event.type = InputEventType::MouseDown;
+    event.time = time;
+    event.button = button;
+    enqueue(event);
+}
+
+void InputState::onMouseUp(MouseButton button, double time) {
+    InputEvent event;
+    event.type = InputEventType::MouseUp;
+    event.time = time;
+    event.button = button;
+    enqueue(event);
+}
+
+void InputState::recordMouseSample(float x, float y, double time) {
+    m_mouseHistory.push_back({Vec2(x, y) * m_pointerScale, time < 0.0 ? m_frameTime : time});
+}
+
+void InputState::onMouseMove(float x, float y, double time) {
+    recordMouseSample(x, y, time);
     
-    m_mouseDown[idx] = false;
-    m_mouseReleased[idx] = true;
+    InputEvent event;
+    event.type = InputEventType::MouseMove;
+    event.time = time;
+    event.value = {x, y};
+    enqueue(event);
 }
 
-void InputState::onMouseMove(float x, float y) {
-    m_mousePos = {x, y};
+void InputState::onMouseScroll(float dx, float dy, double time, int device) {
+    InputEvent event;
+    event.type = InputEventType::MouseScroll;
+    event.time = time;
+    event.value = {dx, dy};
+    event.device = device;
+    enqueue(event);
 }
 
-void InputState::onMouseScroll(float dx, float dy) {
-    m_scrollDelta = {dx, dy};
+void InputState::onTextInput(char32_t codepoint, double time) {
+    InputEvent event;
+    event.type = InputEventType::Text;
+    event.time = time;
+    event.codepoint = codepoint;
+    enqueue(event);
 }
 
-void InputState::onTextInput(char32_t codepoint) {
-    // Convert UTF-32 to UTF-8
-    if (codepoint < 0x80) {
-        m_textInput += static_cast<char>(codepoint);
-    } else if (codepoint < 0x800) {
-        m_textInput += static_cast<char>(0xC0 | (codepoint >> 6));
-        m_textInput += static_cast<char>(0x80 | (codepoint & 0x3F));
-    } else if (codepoint < 0x10000) {
-        m_textInput += static_cast<char>(0xE0 | (codepoint >> 12));
-        m_textInput += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-        m_textInput += static_cast<char>(0x80 | (codepoint & 0x3F));
-    } else {
-        m_textInput += static_cast<char>(0xF0 | (codepoint >> 18));
-        m_textInput += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
-        m_textInput += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
-        m_textInput += static_cast<char>(0x80 | (codepoint & 0x3F));
+void InputState::onTextCommit(const std::string& utf8, double time) {
+    if (utf8.empty()) return;
+    
+    InputEvent event;
+    event.type = InputEventType::TextCommit;
+    event.time = time;
+    event.text = utf8;
+    enqueue(std::move(event));
+}
+
+void InputState::onPreeditChanged(const std::string& utf8, int cursorBegin, int cursorEnd, double time) {
+    if (utf8 == m_preeditText && cursorBegin == m_preeditCursorBegin && cursorEnd == m_preeditCursorEnd) {
+        return;
     }
+    
+    InputEvent event;
+    event.type = InputEventType::Preedit;
+    event.time = time;
+    event.text = utf8;
+    event.cursorBegin = cursorBegin;
+    event.cursorEnd = cursorEnd;
+    enqueue(std::move(event));
 }
 
-void InputState::onModifiersChanged(bool shift, bool ctrl, bool alt, bool super) {
-    m_modifiers.shift = shift;
-    m_modifiers.ctrl = ctrl;
-    m_modifiers.alt = alt;
-    m_modifiers.super = super;
+void InputState::onModifiersChanged(bool shift, bool ctrl, bool alt, bool super, double time) {
+    InputEvent event;
+    event.type = InputEventType::Modifiers;
+    event.time = time;
+    event.modifiers.shift = shift;
+    event.modifiers.ctrl = ctrl;
+    event.modifiers.alt = alt;
+    event.modifiers.super = super;
+    if (event.modifiers == m_queuedModifiers) return;
+    enqueue(event);
 }
 
 void InputState::onResize(float width, float height) {
@@ -5,6 +5,7 @@ namespace fst {
 
 Profiler::Profiler() {
     for (int i = 0; i < HISTORY_SIZE; ++i) m_frameHistory[i] = 0.0f;
+    for (int i = 0; i < HISTORY_SIZE; ++i) m_latencyHistory[i] = 0.0f;
 }
 
 Profiler::~Profiler() {}
@@ -60,4 +61,23 @@ float Profiler::getAverageFrameTime() const {
     return sum / HISTORY_SIZE;
 }
 
+void Profiler::recordLatency(float ms) {
+    m_latencyHistory[m_latencyOffset] = ms;
+    m_latencyOffset = (m_latencyOffset + 1) % HISTORY_SIZE;
+    if (m_latencyCount < HISTORY_SIZE) m_latencyCount++;
+}
+
+void Profiler::getLatencyHistory(float* outHistory, int count) const {
+    for (int i = 0; i < count; ++i) {
+        int idx = (m_latencyOffset - count + i + HISTORY_SIZE) % HISTORY_SIZE;
+        outHistory[i] = m_latencyHistory[idx];
+    }
+}
+
+float Profiler::getAverageLatency() const {
+    if (m_latencyCount == 0) return 0.0f;
+    float sum = std::accumulate(std::begin(m_latencyHistory), std::end(m_latencyHistory), 0.0f);
+    return sum / m_latencyCount;
+}
+
 } // namespace fst
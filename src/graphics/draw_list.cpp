@@ -2,7 +2,9 @@
 #include "fastener/graphics/texture.h"
 #include "fastener/graphics/font.h"
 #include "fastener/core/constants.h"
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 
 namespace {
@@ -40,6 +42,8 @@ void DrawList::clear() {
     m_mergedVertices.clear();
     m_mergedIndices.clear();
     m_mergedCommands.clear();
+    m_commandBounds.clear();
+    m_commandHashes.clear();
 }
 
 void DrawList::setLayer(DrawLayer layer) {
@@ -79,6 +83,97 @@ void DrawList::mergeLayers() {
         vertexOffset += static_cast<uint32_t>(layer.vertices.size());
         indexOffset += static_cast<uint32_t>(layer.indices.size());
     }
+    
+    computeCommandHashes();
+}
+
+void DrawList::computeCommandHashes() {
+    // Bounds and hashes only serve blur backdrops; skip the walk over every
+    // index when nothing is blurred this frame
+    bool hasBlur = std::any_of(m_mergedCommands.begin(), m_mergedCommands.end(),
+                               [](const DrawCommand& cmd) { return cmd.type == DrawCommandType::Blur; });
+    if (!hasBlur) {
+        m_commandBounds.clear();
+        m_commandHashes.clear();
+        return;
+    }
+    
+    m_commandBounds.assign(m_mergedCommands.size(), Rect());
+    m_commandHashes.assign(m_mergedCommands.size(), 0);
+    
+    for (size_t i = 0; i < m_mergedCommands.size(); ++i) {
+        const DrawCommand& cmd = m_mergedCommands[i];
+        if (cmd.indexCount == 0) continue;
+        
+        Vec2 minPos(1e30f, 1e30f);
+        Vec2 maxPos(-1e30f, -1e30f);
+        for (uint32_t k = cmd.indexOffset; k < cmd.indexOffset + cmd.indexCount; ++k) {
+            const Vec2& p = m_mergedVertices[m_mergedIndices[k]].pos;
+            minPos = Vec2(std::min(minPos.x, p.x), std::min(minPos.y, p.y));
+            maxPos = Vec2(std::max(maxPos.x, p.x), std::max(maxPos.y, p.y));
+        }
+        m_commandBounds[i] = Rect::fromMinMax(minPos, maxPos).clipped(cmd.clipRect);
+        
+        // A blur's output depends on its own backdrop, so that is its content
+        if (cmd.type == DrawCommandType::Blur) {
+            uint64_t hash = hashCombine(backdropHash(i), hashFloat(cmd.blurRadius));
+            hash = hashCombine(hash, hashFloat(cmd.rounding));
+            m_commandHashes[i] = hash;
+        }
+    }
+}
+
+uint64_t DrawList::backdropHash(size_t commandIndex) const {
+    if (commandIndex >= m_commandBounds.size()) return 0;
+    
+    const DrawCommand& blur = m_mergedCommands[commandIndex];
+    Rect sampleArea = blur.rect.expanded(blur.blurRadius + 1.0f);
+    
+    uint64_t hash = 0;
+    for (size_t i = 0; i < commandIndex; ++i) {
+        const DrawCommand& cmd = m_mergedCommands[i];
+        if (cmd.indexCount == 0 || !m_commandBounds[i].intersects(sampleArea)) continue;
+        
+        if (cmd.type == DrawCommandType::Blur) {
+            hash = hashCombine(hash, m_commandHashes[i]);
+            continue;
+        }
+        
+        // Commands are batched, so only hash the triangles that reach the
+        // sampled area; widgets elsewhere in the same batch don't count
+        uint64_t cmdHash = 0;
+        for (uint32_t k = cmd.indexOffset; k + 2 < cmd.indexOffset + cmd.indexCount; k += 3) {
+            const DrawVertex* tri[3] = {
+                &m_mergedVertices[m_mergedIndices[k]],
+                &m_mergedVertices[m_mergedIndices[k + 1]],
+                &m_mergedVertices[m_mergedIndices[k + 2]],
+            };
+            Vec2 minPos(std::min({tri[0]->pos.x, tri[1]->pos.x, tri[2]->pos.x}),
+                        std::min({tri[0]->pos.y, tri[1]->pos.y, tri[2]->pos.y}));
+            Vec2 maxPos(std::max({tri[0]->pos.x, tri[1]->pos.x, tri[2]->pos.x}),
+                        std::max({tri[0]->pos.y, tri[1]->pos.y, tri[2]->pos.y}));
+            if (!Rect::fromMinMax(minPos, maxPos).intersects(sampleArea)) continue;
+            
+            for (const DrawVertex* vertex : tri) {
+                static_assert(sizeof(DrawVertex) == 2 * sizeof(uint64_t) + sizeof(uint32_t));
+                uint64_t words[2];
+                std::memcpy(words, vertex, sizeof(words));
+                cmdHash = hashCombine(cmdHash, words[0]);
+                cmdHash = hashCombine(cmdHash, words[1]);
+                cmdHash = hashCombine(cmdHash, vertex->color);
+            }
+        }
+        if (cmdHash == 0) continue;
+        
+        hash = hashCombine(hash, cmdHash);
+        hash = hashCombine(hash, cmd.textureId);
+        hash = hashCombine(hash, Texture::contentVersion(cmd.textureId));
+        hash = hashCombine(hash, hashFloat(cmd.clipRect.x()));
+        hash = hashCombine(hash, hashFloat(cmd.clipRect.y()));
+        hash = hashCombine(hash, hashFloat(cmd.clipRect.width()));
+        hash = hashCombine(hash, hashFloat(cmd.clipRect.height()));
+    }
+    return hash;
 }
 
 void DrawList::pushClipRect(const Rect& rect) {
@@ -428,6 +523,40 @@ void DrawList::addTriangleFilled(const Vec2& p1, const Vec2& p2, const Vec2& p3,
 }
 
 void DrawList::addText(Font* font, const Vec2& pos, std::string_view text, Color color) {
+    addTextRuns(font, pos, text, nullptr, 0, color);
+}
+
+void IDrawList::addTextColored(Font* font, const Vec2& pos, std::string_view text,
+                               const std::vector<TextColorRun>& runs, Color color) {
+    if (!font) return;
+    
+    Vec2 cursor = pos;
+    const int length = static_cast<int>(text.size());
+    auto draw = [&](int begin, int end, Color partColor) {
+        if (end <= begin) return;
+        std::string_view part = text.substr(begin, end - begin);
+        addText(font, cursor, part, partColor);
+        cursor.x += font->measureText(part).x;
+    };
+    
+    int next = 0;
+    for (const TextColorRun& run : runs) {
+        int begin = std::clamp(run.begin, next, length);
+        int end = std::clamp(run.end, begin, length);
+        draw(next, begin, color);
+        draw(begin, end, run.color);
+        next = end;
+    }
+    draw(next, length, color);
+}
+
+void DrawList::addTextColored(Font* font, const Vec2& pos, std::string_view text,
+                              const std::vector<TextColorRun>& runs, Color color) {
+    addTextRuns(font, pos, text, runs.data(), runs.size(), color);
+}
+
+void DrawList::addTextRuns(Font* font, const Vec2& pos, std::string_view text,
+                           const TextColorRun* runs, size_t runCount, Color color) {
     if (!font || text.empty() || !font->isValid()) return;
     
     const char* textStart = text.data();
@@ -440,8 +569,15 @@ void DrawList::addText(Font* font, const Vec2& pos, std::string_view text, Color
     float y = pos.y;
     uint32_t prevCodepoint = 0;
     
+    // Colors are resolved once per run rather than per glyph
+    const Color defaultColor = resolveColor(color);
+    size_t run = 0;
+    Color runColor = runCount > 0 ? resolveColor(runs[0].color) : defaultColor;
+    
     const char* s = textStart;
     while (s < textEnd) {
+        const int offset = static_cast<int>(s - textStart);
+        
         // Decode UTF-8
         uint32_t codepoint;
         unsigned char c = *s++;
@@ -484,6 +620,12 @@ void DrawList::addText(Font* font, const Vec2& pos, std::string_view text, Color
         
         // Draw glyph quad
         if (glyph->atlasW > 0 && glyph->atlasH > 0) {
+            if (run < runCount && offset >= runs[run].end) {
+                while (++run < runCount && offset >= runs[run].end) {}
+                if (run < runCount) runColor = resolveColor(runs[run].color);
+            }
+            const bool inRun = run < runCount && offset >= runs[run].begin;
+            
             Rect glyphRect(
                 x + glyph->xOffset,
                 y + glyph->yOffset,
@@ -496,7 +638,7 @@ void DrawList::addText(Font* font, const Vec2& pos, std::string_view text, Color
                 glyphRect.bottomRight(), glyphRect.bottomLeft(),
                 {glyph->uvX0, glyph->uvY0}, {glyph->uvX1, glyph->uvY0},
                 {glyph->uvX1, glyph->uvY1}, {glyph->uvX0, glyph->uvY1},
-                resolveColor(color)
+                inRun ? runColor : defaultColor
             );
         }
         
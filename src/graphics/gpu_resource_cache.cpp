@@ -0,0 +1,66 @@
+#include "fastener/graphics/gpu_resource_cache.h"
+#include "fastener/core/log.h"
+
+namespace fst {
+
+GpuResourceCache::~GpuResourceCache() {
+    if (!m_entries.empty()) {
+        FST_LOGF_DEBUG("GpuResourceCache destroyed with %zu shared objects still referenced", m_entries.size());
+    }
+    clear();
+}
+
+GpuResourceCache::Handle GpuResourceCache::acquire(const std::string& key, const CreateFn& create,
+                                                   DestroyFn destroy) {
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->second.refs++;
+        return it->second.handle;
+    }
+    
+    Handle handle = create ? create() : 0;
+    if (handle == 0) {
+        return 0;
+    }
+    
+    Entry& entry = m_entries[key];
+    entry.handle = handle;
+    entry.refs = 1;
+    entry.destroy = std::move(destroy);
+    return handle;
+}
+
+void GpuResourceCache::release(const std::string& key) {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) return;
+    
+    if (--it->second.refs > 0) return;
+    
+    Entry entry = std::move(it->second);
+    m_entries.erase(it);
+    if (entry.destroy) {
+        entry.destroy(entry.handle);
+    }
+}
+
+GpuResourceCache::Handle GpuResourceCache::find(const std::string& key) const {
+    auto it = m_entries.find(key);
+    return it != m_entries.end() ? it->second.handle : 0;
+}
+
+int GpuResourceCache::refCount(const std::string& key) const {
+    auto it = m_entries.find(key);
+    return it != m_entries.end() ? it->second.refs : 0;
+}
+
+void GpuResourceCache::clear() {
+    auto entries = std::move(m_entries);
+    m_entries.clear();
+    for (auto& pair : entries) {
+        if (pair.second.destroy) {
+            pair.second.destroy(pair.second.handle);
+        }
+    }
+}
+
+} // namespace fst
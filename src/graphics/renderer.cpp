@@ -1,14 +1,22 @@
 #include "fastener/graphics/renderer.h"
 #include "fastener/graphics/draw_list.h"
+#include "fastener/graphics/gpu_resource_cache.h"
 #include "fastener/core/log.h"
+#include "fastener/core/constants.h"
+#include <cmath>
 
 #ifdef _WIN32
 #include <windows.h>
 #elif defined(__linux__)
 #include <GL/glx.h>
+#ifdef FST_HAS_EGL
+#include <EGL/egl.h>
+#endif
 #endif
 #include <GL/gl.h>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 // OpenGL 3.3 function types and constants
 typedef char GLchar;
@@ -74,6 +82,10 @@ bool hasCurrentGLContext() {
 #ifdef _WIN32
     return wglGetCurrentContext() != nullptr;
 #elif defined(__linux__)
+#ifdef FST_HAS_EGL
+    // Headless windows render through EGL instead of GLX
+    if (eglGetCurrentContext() != EGL_NO_CONTEXT) return true;
+#endif
     return glXGetCurrentContext() != nullptr;
 #else
     return true;
@@ -84,6 +96,11 @@ void* currentGLContextHandle() {
 #ifdef _WIN32
     return reinterpret_cast<void*>(wglGetCurrentContext());
 #elif defined(__linux__)
+#ifdef FST_HAS_EGL
+    if (EGLContext context = eglGetCurrentContext(); context != EGL_NO_CONTEXT) {
+        return reinterpret_cast<void*>(context);
+    }
+#endif
     return reinterpret_cast<void*>(glXGetCurrentContext());
 #else
     return nullptr;
@@ -99,9 +116,25 @@ struct Renderer::Impl {
     GLuint vbo = 0;
     GLuint ebo = 0;
     GLuint whiteTexture = 0;
-    GLuint screenTexture = 0;
     std::unordered_map<void*, GLuint> vaoByContext;
     
+    // Retained blur backdrops: the framebuffer region under a blurred rect,
+    // re-captured only when the commands drawn beneath it change
+    struct BlurBackdrop {
+        GLuint texture = 0;
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        int capacityWidth = 0;   // Allocated texture size, grow-only
+        int capacityHeight = 0;
+        uint64_t contentHash = 0;
+        uint64_t lastFrame = 0;
+    };
+    std::unordered_map<uint64_t, BlurBackdrop> blurBackdrops;
+    std::unordered_map<uint64_t, int> blurKeyUses;
+    uint64_t frameIndex = 0;
+    
     GLint locPosition = -1;
     GLint locTexCoord = -1;
     GLint locColor = -1;
@@ -110,7 +143,9 @@ struct Renderer::Impl {
     
     GLint locBlurProjection = -1;
     GLint locBlurTexture = -1;
-    GLint locBlurScreenSize = -1;
+    GLint locBlurSourcePos = -1;
+    GLint locBlurSourceSize = -1;
+    GLint locBlurSourceScale = -1;
     GLint locBlurRadius = -1;
     GLint locBlurRectPos = -1;
     GLint locBlurRectSize = -1;
@@ -118,9 +153,11 @@ struct Renderer::Impl {
     
     int viewportWidth = 0;
     int viewportHeight = 0;
+    // Size the draw list was laid out at; differs from the viewport while
+    // a live resize is stretched
+    int contentWidth = 0;
+    int contentHeight = 0;
     float dpiScale = 1.0f;
-    int screenTexWidth = 0;
-    int screenTexHeight = 0;
     
     // OpenGL function pointers
     PFNGLATTACHSHADERPROC glAttachShader;
@@ -154,11 +191,22 @@ struct Renderer::Impl {
     PFNGLVERTEXATTRIBPOINTERPROC glVertexAttribPointer;
     PFNGLACTIVETEXTUREPROC glActiveTexture;
     
+    // Programs, buffers and the white texture come from the cache when one
+    // is set; VAOs and blur backdrops stay per renderer
+    GpuResourceCache* cache = nullptr;
+    std::vector<std::string> sharedKeys;
+    
     bool loadFunctions();
+    GLuint linkProgram(const char* vertexShaderSource, const char* fragmentShaderSource, const char* label);
+    GLuint createBuffer(const char* key);
+    GLuint acquireShared(const char* key, const GpuResourceCache::CreateFn& create,
+                         GpuResourceCache::DestroyFn destroy);
+    void releaseShared();
     bool createShader();
     bool createBlurShader();
     void createWhiteTexture();
-    void ensureScreenTexture(int width, int height);
+    const BlurBackdrop* captureBackdrop(const DrawList& drawList, size_t commandIndex);
+    void evictBackdrops(bool all);
     void setupVao(GLuint vao);
     void ensureVaoForCurrentContext();
 };
@@ -166,6 +214,11 @@ struct Renderer::Impl {
 bool Renderer::Impl::loadFunctions() {
 #ifdef _WIN32
     #define LOAD_GL(name) name = (decltype(name))wglGetProcAddress(#name); if (!name) return false
+#elif defined(__linux__) && defined(FST_HAS_EGL)
+    bool useEgl = eglGetCurrentContext() != EGL_NO_CONTEXT;
+    #define LOAD_GL(name) name = useEgl ? (decltype(name))eglGetProcAddress(#name) \
+                                        : (decltype(name))glXGetProcAddressARB((const GLubyte*)#name); \
+                          if (!name) return false
 #elif defined(__linux__)
     #define LOAD_GL(name) name = (decltype(name))glXGetProcAddressARB((const GLubyte*)#name); if (!name) return false
 #else
@@ -207,6 +260,56 @@ bool Renderer::Impl::loadFunctions() {
     return true;
 }
 
+GLuint Renderer::Impl::linkProgram(const char* vertexShaderSource, const char* fragmentShaderSource,
+                                   const char* label) {
+    // Compile vertex shader
+    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
+    glCompileShader(vertexShader);
+    
+    GLint success;
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        FST_LOGF_ERROR("%s vertex shader compilation failed", label);
+        glDeleteShader(vertexShader);
+        return 0;
+    }
+    
+    // Compile fragment shader
+    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
+    glCompileShader(fragmentShader);
+    
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success) {
+        FST_LOGF_ERROR("%s fragment shader compilation failed", label);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+    
+    // Link program
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    
+    glDetachShader(program, vertexShader);
+    glDetachShader(program, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    
+    if (!success) {
+        FST_LOGF_ERROR("%s shader program linking failed", label);
+        glDeleteProgram(program);
+        return 0;
+    }
+    
+    return program;
+}
+
 bool Renderer::Impl::createShader() {
     const char* vertexShaderSource = R"(
         #version 330 core
@@ -241,49 +344,12 @@ bool Renderer::Impl::createShader() {
         }
     )";
     
-    // Compile vertex shader
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        FST_LOG_ERROR("Vertex shader compilation failed");
-        glDeleteShader(vertexShader);
-        return false;
-    }
-    
-    // Compile fragment shader
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        FST_LOG_ERROR("Fragment shader compilation failed");
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return false;
-    }
-    
-    // Link program
-    shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    
-    glDetachShader(shaderProgram, vertexShader);
-    glDetachShader(shaderProgram, fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    if (!success) {
-        FST_LOG_ERROR("Shader program linking failed");
-        glDeleteProgram(shaderProgram);
-        shaderProgram = 0;
+    shaderProgram = acquireShared("fst.program.ui", [&] {
+        return linkProgram(vertexShaderSource, fragmentShaderSource, "UI");
+    }, [fn = glDeleteProgram](uint32_t program) {
+        if (hasCurrentGLContext()) fn(program);
+    });
+    if (!shaderProgram) {
         return false;
     }
     
@@ -321,29 +387,39 @@ bool Renderer::Impl::createBlurShader() {
         out vec4 FragColor;
         
         uniform sampler2D uTexture;
-        uniform vec2 uScreenSize;
+        uniform vec2 uSourcePos;
+        uniform vec2 uSourceSize;
+        uniform vec2 uSourceScale;
         uniform float uBlurRadius;
         uniform vec2 uRectPos;
         uniform vec2 uRectSize;
         uniform float uCornerRadius;
         
+        // The region fills only the bottom-left uSourceScale of a grow-only
+        // texture; clamp to it since CLAMP_TO_EDGE no longer applies
+        vec4 sampleSource(vec2 uv) {
+            vec2 halfTexel = 0.5 / uSourceSize;
+            return texture(uTexture, clamp(uv, halfTexel, 1.0 - halfTexel) * uSourceScale);
+        }
+        
         void main() {
+            // Source texture holds the captured region, bottom row first
             vec2 screenUv = vec2(
-                FragPos.x / uScreenSize.x,
-                1.0 - (FragPos.y / uScreenSize.y)
+                (FragPos.x - uSourcePos.x) / uSourceSize.x,
+                1.0 - ((FragPos.y - uSourcePos.y) / uSourceSize.y)
             );
             
-            vec2 step = uBlurRadius / uScreenSize;
+            vec2 step = uBlurRadius / uSourceSize;
             vec4 sum = vec4(0.0);
-            sum += texture(uTexture, screenUv + step * vec2(-1.0, -1.0));
-            sum += texture(uTexture, screenUv + step * vec2(0.0, -1.0));
-            sum += texture(uTexture, screenUv + step * vec2(1.0, -1.0));
-            sum += texture(uTexture, screenUv + step * vec2(-1.0, 0.0));
-            sum += texture(uTexture, screenUv);
-            sum += texture(uTexture, screenUv + step * vec2(1.0, 0.0));
-            sum += texture(uTexture, screenUv + step * vec2(-1.0, 1.0));
-            sum += texture(uTexture, screenUv + step * vec2(0.0, 1.0));
-            sum += texture(uTexture, screenUv + step * vec2(1.0, 1.0));
+            sum += sampleSource(screenUv + step * vec2(-1.0, -1.0));
+            sum += sampleSource(screenUv + step * vec2(0.0, -1.0));
+            sum += sampleSource(screenUv + step * vec2(1.0, -1.0));
+            sum += sampleSource(screenUv + step * vec2(-1.0, 0.0));
+            sum += sampleSource(screenUv);
+            sum += sampleSource(screenUv + step * vec2(1.0, 0.0));
+            sum += sampleSource(screenUv + step * vec2(-1.0, 1.0));
+            sum += sampleSource(screenUv + step * vec2(0.0, 1.0));
+            sum += sampleSource(screenUv + step * vec2(1.0, 1.0));
             sum *= 1.0 / 9.0;
             
             float alpha = 1.0;
@@ -364,52 +440,20 @@ bool Renderer::Impl::createBlurShader() {
         }
     )";
     
-    GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, nullptr);
-    glCompileShader(vertexShader);
-    
-    GLint success;
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        FST_LOG_ERROR("Blur vertex shader compilation failed");
-        glDeleteShader(vertexShader);
-        return false;
-    }
-    
-    GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, nullptr);
-    glCompileShader(fragmentShader);
-    
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        FST_LOG_ERROR("Blur fragment shader compilation failed");
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        return false;
-    }
-    
-    blurShaderProgram = glCreateProgram();
-    glAttachShader(blurShaderProgram, vertexShader);
-    glAttachShader(blurShaderProgram, fragmentShader);
-    glLinkProgram(blurShaderProgram);
-    
-    glGetProgramiv(blurShaderProgram, GL_LINK_STATUS, &success);
-    
-    glDetachShader(blurShaderProgram, vertexShader);
-    glDetachShader(blurShaderProgram, fragmentShader);
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-    
-    if (!success) {
-        FST_LOG_ERROR("Blur shader program linking failed");
-        glDeleteProgram(blurShaderProgram);
-        blurShaderProgram = 0;
+    blurShaderProgram = acquireShared("fst.program.blur", [&] {
+        return linkProgram(vertexShaderSource, fragmentShaderSource, "Blur");
+    }, [fn = glDeleteProgram](uint32_t program) {
+        if (hasCurrentGLContext()) fn(program);
+    });
+    if (!blurShaderProgram) {
         return false;
     }
     
     locBlurProjection = glGetUniformLocation(blurShaderProgram, "uProjection");
     locBlurTexture = glGetUniformLocation(blurShaderProgram, "uTexture");
-    locBlurScreenSize = glGetUniformLocation(blurShaderProgram, "uScreenSize");
+    locBlurSourcePos = glGetUniformLocation(blurShaderProgram, "uSourcePos");
+    locBlurSourceSize = glGetUniformLocation(blurShaderProgram, "uSourceSize");
+    locBlurSourceScale = glGetUniformLocation(blurShaderProgram, "uSourceScale");
     locBlurRadius = glGetUniformLocation(blurShaderProgram, "uBlurRadius");
     locBlurRectPos = glGetUniformLocation(blurShaderProgram, "uRectPos");
     locBlurRectSize = glGetUniformLocation(blurShaderProgram, "uRectSize");
@@ -419,34 +463,147 @@ bool Renderer::Impl::createBlurShader() {
 }
 
 void Renderer::Impl::createWhiteTexture() {
-    uint32_t white = 0xFFFFFFFF;
-    
-    glGenTextures(1, &whiteTexture);
-    glBindTexture(GL_TEXTURE_2D, whiteTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    whiteTexture = acquireShared("fst.texture.white", [] {
+        uint32_t white = 0xFFFFFFFF;
+        
+        GLuint texture = 0;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return texture;
+    }, [](uint32_t texture) {
+        if (hasCurrentGLContext()) {
+            GLuint handle = texture;
+            glDeleteTextures(1, &handle);
+        }
+    });
+}
+
+GLuint Renderer::Impl::createBuffer(const char* key) {
+    return acquireShared(key, [this] {
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        return buffer;
+    }, [fn = glDeleteBuffers](uint32_t buffer) {
+        if (hasCurrentGLContext()) {
+            GLuint handle = buffer;
+            fn(1, &handle);
+        }
+    });
+}
+
+GLuint Renderer::Impl::acquireShared(const char* key, const GpuResourceCache::CreateFn& create,
+                                     GpuResourceCache::DestroyFn destroy) {
+    if (!cache) {
+        return create();
+    }
+    GLuint handle = cache->acquire(key, create, std::move(destroy));
+    if (handle) {
+        sharedKeys.push_back(key);
+    }
+    return handle;
 }
 
-void Renderer::Impl::ensureScreenTexture(int width, int height) {
-    if (width <= 0 || height <= 0) return;
-    if (screenTexture && screenTexWidth == width && screenTexHeight == height) return;
+void Renderer::Impl::releaseShared() {
+    if (!cache) return;
     
-    if (!screenTexture) {
-        glGenTextures(1, &screenTexture);
+    // The cache deletes each object with its last user; this renderer only
+    // forgets its handles
+    for (const auto& key : sharedKeys) {
+        cache->release(key);
+    }
+    sharedKeys.clear();
+    vbo = 0;
+    ebo = 0;
+    shaderProgram = 0;
+    blurShaderProgram = 0;
+    whiteTexture = 0;
+}
+
+const Renderer::Impl::BlurBackdrop* Renderer::Impl::captureBackdrop(const DrawList& drawList,
+                                                                    size_t commandIndex) {
+    const DrawCommand& cmd = drawList.commands()[commandIndex];
+    
+    // Region the blur samples from, in whole framebuffer pixels
+    float scaleX = static_cast<float>(viewportWidth) / static_cast<float>(contentWidth);
+    float scaleY = static_cast<float>(viewportHeight) / static_cast<float>(contentHeight);
+    Rect viewport(0, 0, static_cast<float>(viewportWidth), static_cast<float>(viewportHeight));
+    Rect pixelRect(cmd.rect.x() * scaleX, cmd.rect.y() * scaleY,
+                   cmd.rect.width() * scaleX, cmd.rect.height() * scaleY);
+    Rect region = pixelRect.expanded(cmd.blurRadius + 1.0f).clipped(viewport);
+    int x = static_cast<int>(std::floor(region.x()));
+    int y = static_cast<int>(std::floor(region.y()));
+    int width = static_cast<int>(std::ceil(region.right())) - x;
+    int height = static_cast<int>(std::ceil(region.bottom())) - y;
+    if (width <= 0 || height <= 0) return nullptr;
+    
+    // Surfaces are identified by rect and radius; repeats within a frame
+    // get their own entry
+    uint64_t key = hashCombine(hashFloat(cmd.rect.x()), hashFloat(cmd.rect.y()));
+    key = hashCombine(key, hashFloat(cmd.rect.width()));
+    key = hashCombine(key, hashFloat(cmd.rect.height()));
+    key = hashCombine(key, hashFloat(cmd.blurRadius));
+    key = hashCombine(key, static_cast<uint64_t>(blurKeyUses[key]++));
+    
+    uint64_t contentHash = hashCombine(drawList.backdropHash(commandIndex),
+                                       (static_cast<uint64_t>(viewportWidth) << 32) | static_cast<uint32_t>(viewportHeight));
+    contentHash = hashCombine(contentHash,
+                              (static_cast<uint64_t>(contentWidth) << 32) | static_cast<uint32_t>(contentHeight));
+    
+    BlurBackdrop& backdrop = blurBackdrops[key];
+    backdrop.lastFrame = frameIndex;
+    if (backdrop.texture && backdrop.contentHash == contentHash &&
+        backdrop.x == x && backdrop.y == y && backdrop.width == width && backdrop.height == height) {
+        return &backdrop;
+    }
+    
+    if (!backdrop.texture) {
+        glGenTextures(1, &backdrop.texture);
+        glBindTexture(GL_TEXTURE_2D, backdrop.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, backdrop.texture);
+    }
+    if (width > backdrop.capacityWidth || height > backdrop.capacityHeight) {
+        // Grow in coarse steps so a live resize does not reallocate every frame
+        auto roundUp = [](int value) {
+            int step = constants::BACKDROP_TEXTURE_GRANULARITY;
+            return (value + step - 1) / step * step;
+        };
+        if (width > backdrop.capacityWidth) backdrop.capacityWidth = roundUp(width);
+        if (height > backdrop.capacityHeight) backdrop.capacityHeight = roundUp(height);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, backdrop.capacityWidth, backdrop.capacityHeight,
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
     }
     
-    glBindTexture(GL_TEXTURE_2D, screenTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    // Copy only the sampled region (GL framebuffer origin is bottom-left)
+    glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, x, viewportHeight - (y + height), width, height);
     
-    screenTexWidth = width;
-    screenTexHeight = height;
+    backdrop.x = x;
+    backdrop.y = y;
+    backdrop.width = width;
+    backdrop.height = height;
+    backdrop.contentHash = contentHash;
+    return &backdrop;
+}
+
+void Renderer::Impl::evictBackdrops(bool all) {
+    for (auto it = blurBackdrops.begin(); it != blurBackdrops.end();) {
+        if (all || frameIndex - it->second.lastFrame > 120) {
+            if (it->second.texture && hasCurrentGLContext()) {
+                glDeleteTextures(1, &it->second.texture);
+            }
+            it = blurBackdrops.erase(it);
+        } else {
+            ++it;
+        }
+    }
 }
 
 void Renderer::Impl::setupVao(GLuint vao) {
@@ -505,12 +662,12 @@ bool Renderer::init() {
     if (!m_impl->createShader()) return false;
     if (!m_impl->createBlurShader()) return false;
     
-    // Create VBO
-    m_impl->glGenBuffers(1, &m_impl->vbo);
+    // Create VBO and EBO; contents are streamed every frame, so renderers
+    // sharing a cache can also share the buffers
+    m_impl->vbo = m_impl->createBuffer("fst.buffer.vertex");
     m_impl->glBindBuffer(GL_ARRAY_BUFFER, m_impl->vbo);
     
-    // Create EBO
-    m_impl->glGenBuffers(1, &m_impl->ebo);
+    m_impl->ebo = m_impl->createBuffer("fst.buffer.index");
     m_impl->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_impl->ebo);
 
     // Create VAO for the current context and configure attributes.
@@ -527,6 +684,8 @@ bool Renderer::init() {
 }
 
 void Renderer::shutdown() {
+    m_impl->releaseShared();
+    
     if (!hasCurrentGLContext()) {
         FST_LOG_WARN("Renderer::shutdown called without a current GL context; skipping GL deletes");
         m_impl->vao = 0;
@@ -535,9 +694,7 @@ void Renderer::shutdown() {
         m_impl->shaderProgram = 0;
         m_impl->blurShaderProgram = 0;
         m_impl->whiteTexture = 0;
-        m_impl->screenTexture = 0;
-        m_impl->screenTexWidth = 0;
-        m_impl->screenTexHeight = 0;
+        m_impl->blurBackdrops.clear();
         m_impl->vaoByContext.clear();
         return;
     }
@@ -580,19 +737,24 @@ void Renderer::shutdown() {
         glDeleteTextures(1, &m_impl->whiteTexture);
         m_impl->whiteTexture = 0;
     }
-    if (m_impl->screenTexture) {
-        glDeleteTextures(1, &m_impl->screenTexture);
-        m_impl->screenTexture = 0;
-        m_impl->screenTexWidth = 0;
-        m_impl->screenTexHeight = 0;
-    }
+    m_impl->evictBackdrops(true);
 }
 
 void Renderer::beginFrame(int width, int height, float dpiScale) {
+    beginFrame(width, height, dpiScale, width, height);
+}
+
+void Renderer::beginFrame(int width, int height, float dpiScale, int contentWidth, int contentHeight) {
     m_impl->viewportWidth = width;
     m_impl->viewportHeight = height;
+    m_impl->contentWidth = contentWidth > 0 ? contentWidth : width;
+    m_impl->contentHeight = contentHeight > 0 ? contentHeight : height;
     m_impl->dpiScale = dpiScale;
-    m_impl->ensureScreenTexture(width, height);
+    
+    // Drop backdrops of blurred surfaces that went away
+    if ((++m_impl->frameIndex & 63) == 0) {
+        m_impl->evictBackdrops(false);
+    }
     
     // Ensure a VAO exists for the current GL context (VAOs are not shared)
     m_impl->ensureVaoForCurrentContext();
@@ -627,11 +789,14 @@ void Renderer::render(const DrawList& drawList) {
         }
     };
     
-    // Setup projection matrix (orthographic)
+    // Setup projection matrix (orthographic); maps content onto the whole
+    // viewport, stretching it when the two differ
     float L = 0.0f;
-    float R = static_cast<float>(m_impl->viewportWidth);
+    float R = static_cast<float>(m_impl->contentWidth);
     float T = 0.0f;
-    float B = static_cast<float>(m_impl->viewportHeight);
+    float B = static_cast<float>(m_impl->contentHeight);
+    float scaleX = static_cast<float>(m_impl->viewportWidth) / R;
+    float scaleY = static_cast<float>(m_impl->viewportHeight) / B;
     
     float projection[16] = {
         2.0f/(R-L),   0.0f,         0.0f, 0.0f,
@@ -647,9 +812,7 @@ void Renderer::render(const DrawList& drawList) {
     useProgram(m_impl->blurShaderProgram);
     m_impl->glUniformMatrix4fv(m_impl->locBlurProjection, 1, GL_FALSE, projection);
     m_impl->glUniform1i(m_impl->locBlurTexture, 0);
-    m_impl->glUniform2f(m_impl->locBlurScreenSize,
-                        static_cast<float>(m_impl->viewportWidth),
-                        static_cast<float>(m_impl->viewportHeight));
+    m_impl->blurKeyUses.clear();
     
     m_impl->glActiveTexture(GL_TEXTURE0);
     
@@ -666,31 +829,37 @@ void Renderer::render(const DrawList& drawList) {
                           drawList.indices().data(), GL_STREAM_DRAW);
     
     // Render commands
-    for (const auto& cmd : drawList.commands()) {
+    const auto& commands = drawList.commands();
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const DrawCommand& cmd = commands[i];
         if (cmd.indexCount == 0) continue;
         
         // Set clip rect
         Rect clip = cmd.clipRect;
         glScissor(
-            static_cast<int>(clip.x()),
-            static_cast<int>(m_impl->viewportHeight - clip.bottom()),
-            static_cast<int>(clip.width()),
-            static_cast<int>(clip.height())
+            static_cast<int>(clip.x() * scaleX),
+            static_cast<int>(m_impl->viewportHeight - clip.bottom() * scaleY),
+            static_cast<int>(clip.width() * scaleX),
+            static_cast<int>(clip.height() * scaleY)
         );
         
         if (cmd.type == DrawCommandType::Blur) {
-            if (m_impl->screenTexture) {
-                glBindTexture(GL_TEXTURE_2D, m_impl->screenTexture);
-                glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, 
-                                    m_impl->viewportWidth, m_impl->viewportHeight);
-                
+            if (const auto* backdrop = m_impl->captureBackdrop(drawList, i)) {
                 useProgram(m_impl->blurShaderProgram);
+                // The shader works in content units; the backdrop is in pixels
+                m_impl->glUniform2f(m_impl->locBlurSourcePos,
+                                    backdrop->x / scaleX, backdrop->y / scaleY);
+                m_impl->glUniform2f(m_impl->locBlurSourceSize,
+                                    backdrop->width / scaleX, backdrop->height / scaleY);
+                m_impl->glUniform2f(m_impl->locBlurSourceScale,
+                                    static_cast<float>(backdrop->width) / backdrop->capacityWidth,
+                                    static_cast<float>(backdrop->height) / backdrop->capacityHeight);
                 m_impl->glUniform1f(m_impl->locBlurRadius, cmd.blurRadius);
                 m_impl->glUniform2f(m_impl->locBlurRectPos, cmd.rect.x(), cmd.rect.y());
                 m_impl->glUniform2f(m_impl->locBlurRectSize, cmd.rect.width(), cmd.rect.height());
                 m_impl->glUniform1f(m_impl->locBlurCornerRadius, cmd.rounding);
                 
-                glBindTexture(GL_TEXTURE_2D, m_impl->screenTexture);
+                glBindTexture(GL_TEXTURE_2D, backdrop->texture);
                 glDrawElements(GL_TRIANGLES, cmd.indexCount, GL_UNSIGNED_INT, 
                                reinterpret_cast<void*>(cmd.indexOffset * sizeof(uint32_t)));
             }
@@ -713,6 +882,14 @@ void Renderer::render(const DrawList& drawList) {
     glDisable(GL_BLEND);
 }
 
+void Renderer::setResourceCache(GpuResourceCache* cache) {
+    if (m_impl->shaderProgram) {
+        FST_LOG_WARN("Renderer::setResourceCache must be called before init; ignored");
+        return;
+    }
+    m_impl->cache = cache;
+}
+
 uint32_t Renderer::whiteTexture() const {
     return m_impl->whiteTexture;
 }
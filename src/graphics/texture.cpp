@@ -8,12 +8,16 @@
 #include "fastener/core/log.h"
 #include <vector>
 #include <cstdio>
+#include <unordered_map>
 
 // OpenGL function types
 #ifdef _WIN32
 #include <windows.h>
 #elif defined(__linux__)
 #include <GL/glx.h>
+#ifdef FST_HAS_EGL
+#include <EGL/egl.h>
+#endif
 #endif
 #include <GL/gl.h>
 
@@ -36,14 +40,37 @@ bool hasCurrentGLContext() {
 #ifdef _WIN32
     return wglGetCurrentContext() != nullptr;
 #elif defined(__linux__)
+#ifdef FST_HAS_EGL
+    // Headless windows render through EGL instead of GLX
+    if (eglGetCurrentContext() != EGL_NO_CONTEXT) return true;
+#endif
     return glXGetCurrentContext() != nullptr;
 #else
     return true;
 #endif
 }
 
+// Content versions by GL handle; GL objects are only touched on one thread
+uint64_t s_lastContentVersion = 0;
+std::unordered_map<uint32_t, uint64_t>& contentVersions() {
+    static std::unordered_map<uint32_t, uint64_t> versions;
+    return versions;
+}
+
 } // namespace
 
+uint64_t Texture::contentVersion(uint32_t handle) {
+    auto& versions = contentVersions();
+    auto it = versions.find(handle);
+    return it != versions.end() ? it->second : 0;
+}
+
+void Texture::markContentChanged(uint32_t handle) {
+    if (handle != 0) {
+        contentVersions()[handle] = ++s_lastContentVersion;
+    }
+}
+
 Texture::Texture() = default;
 
 Texture::~Texture() {
@@ -107,6 +134,7 @@ bool Texture::create(int width, int height, const void* data, int channels) {
     glBindTexture(GL_TEXTURE_2D, 0);
     
     m_handle = texture;
+    markContentChanged(m_handle);
     return true;
 }
 
@@ -163,6 +191,7 @@ void Texture::destroy() {
             GLuint tex = m_handle;
             glDeleteTextures(1, &tex);
         }
+        contentVersions().erase(m_handle);
         m_handle = 0;
     }
     m_width = 0;
@@ -181,6 +210,7 @@ void Texture::update(int x, int y, int width, int height, const void* data) {
     glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, GL_UNSIGNED_BYTE, data);
     
     glBindTexture(GL_TEXTURE_2D, 0);
+    markContentChanged(m_handle);
 }
 
 } // namespace fst
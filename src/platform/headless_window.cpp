@@ -0,0 +1,378 @@
+/**
+ * @file headless_window.cpp
+ * @brief EGL offscreen implementation of HeadlessWindow.
+ *
+ * Renders into a framebuffer object on an EGL context created on the
+ * surfaceless Mesa platform (or a pbuffer when that is unavailable), so the
+ * OpenGL renderer runs without a display server.
+ */
+
+#include "fastener/platform/headless_window.h"
+#include "fastener/core/log.h"
+#include <cstring>
+#include <unordered_map>
+
+#ifdef FST_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#endif
+
+namespace fst {
+
+namespace {
+
+// Shared by every headless window in the process, like a system clipboard
+std::string g_headlessClipboard;
+
+} // namespace
+
+struct HeadlessWindow::Impl {
+    int width = 0;
+    int height = 0;
+    float dpiScale = 1.0f;
+    bool isOpen = false;
+    bool surfaceless = false;
+    InputState inputState;
+
+#ifdef FST_HAS_EGL
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    EGLSurface surface = EGL_NO_SURFACE;  // 1x1 pbuffer when not surfaceless
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    
+    PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers = nullptr;
+    PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffers = nullptr;
+    PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer = nullptr;
+    PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbuffer = nullptr;
+    PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatus = nullptr;
+    PFNGLGENRENDERBUFFERSPROC glGenRenderbuffers = nullptr;
+    PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffers = nullptr;
+    PFNGLBINDRENDERBUFFERPROC glBindRenderbuffer = nullptr;
+    PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStorage = nullptr;
+    
+    bool openDisplay();
+    bool createContext();
+    bool loadFunctions();
+    bool createFramebuffer();
+    void makeCurrent();
+#endif
+};
+
+#ifdef FST_HAS_EGL
+
+// eglGetPlatformDisplay returns the same display to every window; terminate
+// it only when the last one is destroyed
+static std::unordered_map<EGLDisplay, int> g_displayRefs;
+
+static bool hasExtension(const char* list, const char* name) {
+    if (!list) return false;
+    size_t length = std::strlen(name);
+    for (const char* p = list; (p = std::strstr(p, name)) != nullptr; p += length) {
+        if ((p == list || p[-1] == ' ') && (p[length] == ' ' || p[length] == '\0')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HeadlessWindow::Impl::openDisplay() {
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (getPlatformDisplay) {
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+    }
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+        FST_LOG_ERROR("HeadlessWindow: no EGL display");
+        display = EGL_NO_DISPLAY;
+        return false;
+    }
+    g_displayRefs[display]++;
+    
+    surfaceless = hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    return true;
+}
+
+bool HeadlessWindow::Impl::createContext() {
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        FST_LOG_ERROR("HeadlessWindow: desktop OpenGL is not available through EGL");
+        return false;
+    }
+    
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint count = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &count) || count == 0) {
+        FST_LOG_ERROR("HeadlessWindow: no suitable EGL config");
+        return false;
+    }
+    
+    // The renderer's shaders need a 3.3 core profile, like the GLX backend
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        FST_LOG_ERROR("HeadlessWindow: failed to create an OpenGL 3.3 core context");
+        return false;
+    }
+    
+    if (!surfaceless) {
+        // Only needed to make the context current; drawing goes to the FBO
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            FST_LOG_ERROR("HeadlessWindow: failed to create a pbuffer surface");
+            return false;
+        }
+    }
+    return eglMakeCurrent(display, surface, surface, context) == EGL_TRUE;
+}
+
+bool HeadlessWindow::Impl::loadFunctions() {
+    #define LOAD_GL(name) name = reinterpret_cast<decltype(name)>(eglGetProcAddress(#name)); if (!name) return false
+    
+    LOAD_GL(glGenFramebuffers);
+    LOAD_GL(glDeleteFramebuffers);
+    LOAD_GL(glBindFramebuffer);
+    LOAD_GL(glFramebufferRenderbuffer);
+    LOAD_GL(glCheckFramebufferStatus);
+    LOAD_GL(glGenRenderbuffers);
+    LOAD_GL(glDeleteRenderbuffers);
+    LOAD_GL(glBindRenderbuffer);
+    LOAD_GL(glRenderbufferStorage);
+    
+    #undef LOAD_GL
+    return true;
+}
+
+bool HeadlessWindow::Impl::createFramebuffer() {
+    if (!colorBuffer) {
+        glGenRenderbuffers(1, &colorBuffer);
+    }
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    
+    if (!framebuffer) {
+        glGenFramebuffers(1, &framebuffer);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        FST_LOG_ERROR("HeadlessWindow: framebuffer is incomplete");
+        return false;
+    }
+    return true;
+}
+
+void HeadlessWindow::Impl::makeCurrent() {
+    eglMakeCurrent(display, surface, surface, context);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+#endif // FST_HAS_EGL
+
+HeadlessWindow::HeadlessWindow() : m_impl(std::make_unique<Impl>()) {}
+
+HeadlessWindow::~HeadlessWindow() {
+    destroy();
+}
+
+bool HeadlessWindow::create(int width, int height, float dpiScale) {
+    if (m_impl->isOpen) {
+        destroy();
+    }
+    m_impl->width = width > 0 ? width : 1;
+    m_impl->height = height > 0 ? height : 1;
+    m_impl->dpiScale = dpiScale;
+
+#ifdef FST_HAS_EGL
+    if (!m_impl->openDisplay() || !m_impl->createContext() ||
+        !m_impl->loadFunctions() || !m_impl->createFramebuffer()) {
+        destroy();
+        return false;
+    }
+    glViewport(0, 0, m_impl->width, m_impl->height);
+    m_impl->isOpen = true;
+    m_impl->inputState.onResize(static_cast<float>(m_impl->width), static_cast<float>(m_impl->height));
+    return true;
+#else
+    FST_LOG_ERROR("HeadlessWindow: built without EGL support");
+    return false;
+#endif
+}
+
+void HeadlessWindow::destroy() {
+#ifdef FST_HAS_EGL
+    if (m_impl->context != EGL_NO_CONTEXT) {
+        eglMakeCurrent(m_impl->display, m_impl->surface, m_impl->surface, m_impl->context);
+        if (m_impl->framebuffer) {
+            m_impl->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            m_impl->glDeleteFramebuffers(1, &m_impl->framebuffer);
+            m_impl->framebuffer = 0;
+        }
+        if (m_impl->colorBuffer) {
+            m_impl->glDeleteRenderbuffers(1, &m_impl->colorBuffer);
+            m_impl->colorBuffer = 0;
+        }
+        eglMakeCurrent(m_impl->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(m_impl->display, m_impl->context);
+        m_impl->context = EGL_NO_CONTEXT;
+    }
+    if (m_impl->surface != EGL_NO_SURFACE) {
+        eglDestroySurface(m_impl->display, m_impl->surface);
+        m_impl->surface = EGL_NO_SURFACE;
+    }
+    if (m_impl->display != EGL_NO_DISPLAY) {
+        if (--g_displayRefs[m_impl->display] <= 0) {
+            g_displayRefs.erase(m_impl->display);
+            eglTerminate(m_impl->display);
+        }
+        m_impl->display = EGL_NO_DISPLAY;
+    }
+#endif
+    m_impl->isOpen = false;
+}
+
+bool HeadlessWindow::isOpen() const {
+    return m_impl->isOpen;
+}
+
+void HeadlessWindow::close() {
+    m_impl->isOpen = false;
+}
+
+std::vector<uint8_t> HeadlessWindow::readPixels() const {
+    std::vector<uint8_t> pixels;
+#ifdef FST_HAS_EGL
+    if (m_impl->context == EGL_NO_CONTEXT) return pixels;
+    
+    m_impl->makeCurrent();
+    size_t rowBytes = static_cast<size_t>(m_impl->width) * 4;
+    pixels.resize(rowBytes * m_impl->height);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, m_impl->width, m_impl->height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    
+    // GL rows start at the bottom
+    std::vector<uint8_t> row(rowBytes);
+    for (int y = 0; y < m_impl->height / 2; ++y) {
+        uint8_t* top = pixels.data() + rowBytes * y;
+        uint8_t* bottom = pixels.data() + rowBytes * (m_impl->height - 1 - y);
+        std::memcpy(row.data(), top, rowBytes);
+        std::memcpy(top, bottom, rowBytes);
+        std::memcpy(bottom, row.data(), rowBytes);
+    }
+#endif
+    return pixels;
+}
+
+bool HeadlessWindow::isSurfaceless() const {
+    return m_impl->surfaceless;
+}
+
+void HeadlessWindow::pollEvents() {
+    m_impl->inputState.beginFrame();
+}
+
+void HeadlessWindow::waitEvents() {
+    // Nothing can arrive; behave like a poll instead of blocking forever
+    pollEvents();
+}
+
+void HeadlessWindow::swapBuffers() {
+#ifdef FST_HAS_EGL
+    // No presentation; make the frame complete for readPixels() and timing
+    if (m_impl->context != EGL_NO_CONTEXT) {
+        glFinish();
+    }
+#endif
+}
+
+void HeadlessWindow::makeContextCurrent() {
+#ifdef FST_HAS_EGL
+    if (m_impl->context != EGL_NO_CONTEXT) {
+        m_impl->makeCurrent();
+    }
+#endif
+}
+
+Vec2 HeadlessWindow::size() const {
+    return {static_cast<float>(m_impl->width), static_cast<float>(m_impl->height)};
+}
+
+Vec2 HeadlessWindow::framebufferSize() const {
+    return size();
+}
+
+float HeadlessWindow::dpiScale() const {
+    return m_impl->dpiScale;
+}
+
+int HeadlessWindow::width() const {
+    return m_impl->width;
+}
+
+int HeadlessWindow::height() const {
+    return m_impl->height;
+}
+
+void HeadlessWindow::setTitle(const std::string&) {}
+
+void HeadlessWindow::setSize(int width, int height) {
+    m_impl->width = width > 0 ? width : 1;
+    m_impl->height = height > 0 ? height : 1;
+#ifdef FST_HAS_EGL
+    if (m_impl->context != EGL_NO_CONTEXT) {
+        m_impl->makeCurrent();
+        m_impl->createFramebuffer();
+    }
+#endif
+}
+
+void HeadlessWindow::setPosition(int, int) {}
+
+std::string HeadlessWindow::getClipboardText() {
+    return g_headlessClipboard;
+}
+
+void HeadlessWindow::setClipboardText(const std::string& text) {
+    g_headlessClipboard = text;
+}
+
+InputState& HeadlessWindow::input() {
+    return m_impl->inputState;
+}
+
+const InputState& HeadlessWindow::input() const {
+    return m_impl->inputState;
+}
+
+void* HeadlessWindow::nativeHandle() const {
+#ifdef FST_HAS_EGL
+    return m_impl->context;
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace fst
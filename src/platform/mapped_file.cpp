@@ -0,0 +1,154 @@
+#include "fastener/platform/mapped_file.h"
+#include "fastener/core/log.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fst {
+
+struct MappedFile::Impl {
+    const char* data = nullptr;
+    size_t size = 0;
+    bool open = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    void* mapping = nullptr;
+#endif
+};
+
+MappedFile::MappedFile() : m_impl(std::make_unique<Impl>()) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    
+    int wideLength = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+    std::wstring widePath(static_cast<size_t>(wideLength > 0 ? wideLength : 1), L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, widePath.data(), wideLength);
+    
+    m_impl->file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_impl->file == INVALID_HANDLE_VALUE) {
+        FST_LOGF_ERROR("Cannot open %s", path.c_str());
+        return false;
+    }
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_impl->file, &fileSize)) {
+        close();
+        return false;
+    }
+    m_impl->size = static_cast<size_t>(fileSize.QuadPart);
+    m_impl->open = true;
+    
+    // Empty files cannot be mapped; they are simply empty
+    if (m_impl->size == 0) {
+        return true;
+    }
+    
+    m_impl->mapping = CreateFileMappingW(m_impl->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = m_impl->mapping ? MapViewOfFile(m_impl->mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        FST_LOGF_ERROR("Cannot map %s", path.c_str());
+        close();
+        return false;
+    }
+    m_impl->data = static_cast<const char*>(view);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_impl->data) {
+        UnmapViewOfFile(m_impl->data);
+    }
+    if (m_impl->mapping) {
+        CloseHandle(m_impl->mapping);
+    }
+    if (m_impl->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_impl->file);
+    }
+    *m_impl = Impl();
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        FST_LOGF_ERROR("Cannot open %s", path.c_str());
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        FST_LOGF_ERROR("Cannot map %s: not a regular file", path.c_str());
+        ::close(fd);
+        return false;
+    }
+    m_impl->size = static_cast<size_t>(info.st_size);
+    m_impl->open = true;
+    
+    // Empty files cannot be mapped; they are simply empty
+    if (m_impl->size == 0) {
+        ::close(fd);
+        return true;
+    }
+    
+    void* mapping = mmap(nullptr, m_impl->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        FST_LOGF_ERROR("Cannot map %s", path.c_str());
+        close();
+        return false;
+    }
+    
+    // The first pass over the file is a linear scan for line breaks
+    madvise(mapping, m_impl->size, MADV_SEQUENTIAL);
+    m_impl->mapping = mapping;
+    m_impl->data = static_cast<const char*>(mapping);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_impl->mapping) {
+        munmap(m_impl->mapping, m_impl->size);
+    }
+    *m_impl = Impl();
+}
+
+#endif
+
+bool MappedFile::isOpen() const {
+    return m_impl->open;
+}
+
+const char* MappedFile::data() const {
+    return m_impl->data;
+}
+
+size_t MappedFile::size() const {
+    return m_impl->size;
+}
+
+} // namespace fst
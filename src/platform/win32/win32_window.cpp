@@ -172,12 +172,14 @@ struct Window::Impl {
     // WGL functions
     PFNWGLCREATECONTEXTATTRIBSARBPROC wglCreateContextAttribsARB = nullptr;
     PFNWGLSWAPINTERVALEXTPROC wglSwapIntervalEXT = nullptr;
+    bool adaptiveVsync = false;
     PFNWGLCHOOSEPIXELFORMATARBPROC wglChoosePixelFormatARB = nullptr;
     
     void loadWGLExtensions();
     bool createGLContext(int msaaSamples, bool vsync);
+    void applySwapInterval(bool vsync);
     void updateDPI();
-    void updateModifiers();
+    void updateModifiers(double time);
     
     static LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
 };
@@ -185,6 +187,11 @@ struct Window::Impl {
 // Global window map for WndProc
 static std::unordered_map<HWND, Window::Impl*> g_windowMap;
 
+// Timestamp of the message being processed, in seconds
+static double messageTime() {
+    return static_cast<double>(static_cast<DWORD>(GetMessageTime())) / 1000.0;
+}
+
 void Window::Impl::loadWGLExtensions() {
     // Create dummy window to get WGL extensions
     WNDCLASSEXW wc = {};
@@ -283,13 +290,21 @@ bool Window::Impl::createGLContext(int msaaSamples, bool vsync) {
     
     wglMakeCurrent(hdc, hglrc);
     
-    if (vsync && wglSwapIntervalEXT) {
-        wglSwapIntervalEXT(1);
-    }
+    applySwapInterval(vsync);
     
     return true;
 }
 
+void Window::Impl::applySwapInterval(bool vsync) {
+    if (!vsync || !wglSwapIntervalEXT) return;
+    
+    // A negative interval needs WGL_EXT_swap_control_tear; the call fails
+    // without it, so fall back to regular vsync
+    if (!adaptiveVsync || !wglSwapIntervalEXT(-1)) {
+        wglSwapIntervalEXT(1);
+    }
+}
+
 void Window::Impl::updateDPI() {
     // Get DPI
     HDC screen = GetDC(nullptr);
@@ -303,12 +318,13 @@ void Window::Impl::updateDPI() {
     fbHeight = rect.bottom - rect.top;
 }
 
-void Window::Impl::updateModifiers() {
+void Window::Impl::updateModifiers(double time) {
     inputState.onModifiersChanged(
         (GetKeyState(VK_SHIFT) & 0x8000) != 0,
         (GetKeyState(VK_CONTROL) & 0x8000) != 0,
         (GetKeyState(VK_MENU) & 0x8000) != 0,
-        ((GetKeyState(VK_LWIN) | GetKeyState(VK_RWIN)) & 0x8000) != 0
+        ((GetKeyState(VK_LWIN) | GetKeyState(VK_RWIN)) & 0x8000) != 0,
+        time
     );
 }
 
@@ -359,22 +375,22 @@ LRESULT CALLBACK Window::Impl::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARA
         case WM_KEYDOWN:
         case WM_SYSKEYDOWN: {
             Key key = vkToKey(wParam, lParam);
-            impl->inputState.onKeyDown(key);
-            impl->updateModifiers();
+            impl->updateModifiers(messageTime());
+            impl->inputState.onKeyDown(key, messageTime());
             return 0;
         }
         
         case WM_KEYUP:
         case WM_SYSKEYUP: {
             Key key = vkToKey(wParam, lParam);
-            impl->inputState.onKeyUp(key);
-            impl->updateModifiers();
+            impl->updateModifiers(messageTime());
+            impl->inputState.onKeyUp(key, messageTime());
             return 0;
         }
         
         case WM_CHAR: {
             if (wParam >= 32 && wParam != 127) {
-                impl->inputState.onTextInput(static_cast<char32_t>(wParam));
+                impl->inputState.onTextInput(static_cast<char32_t>(wParam), messageTime());
             }
             return 0;
         }
@@ -382,49 +398,49 @@ LRESULT CALLBACK Window::Impl::WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARA
         case WM_MOUSEMOVE: {
             float x = static_cast<float>(LOWORD(lParam));
             float y = static_cast<float>(HIWORD(lParam));
-            impl->inputState.onMouseMove(x, y);
+            impl->inputState.onMouseMove(x, y, messageTime());
             return 0;
         }
         
         case WM_LBUTTONDOWN:
-            impl->inputState.onMouseDown(MouseButton::Left);
+            impl->inputState.onMouseDown(MouseButton::Left, messageTime());
             SetCapture(hwnd);
             return 0;
         
         case WM_LBUTTONUP:
-            impl->inputState.onMouseUp(MouseButton::Left);
+            impl->inputState.onMouseUp(MouseButton::Left, messageTime());
             ReleaseCapture();
             return 0;
         
         case WM_RBUTTONDOWN:
-            impl->inputState.onMouseDown(MouseButton::Right);
+            impl->inputState.onMouseDown(MouseButton::Right, messageTime());
             SetCapture(hwnd);
             return 0;
         
         case WM_RBUTTONUP:
-            impl->inputState.onMouseUp(MouseButton::Right);
+            impl->inputState.onMouseUp(MouseButton::Right, messageTime());
             ReleaseCapture();
             return 0;
         
         case WM_MBUTTONDOWN:
-            impl->inputState.onMouseDown(MouseButton::Middle);
+            impl->inputState.onMouseDown(MouseButton::Middle, messageTime());
             SetCapture(hwnd);
             return 0;
         
         case WM_MBUTTONUP:
-            impl->inputState.onMouseUp(MouseButton::Middle);
+            impl->inputState.onMouseUp(MouseButton::Middle, messageTime());
             ReleaseCapture();
             return 0;
         
         case WM_MOUSEWHEEL: {
             float delta = GET_WHEEL_DELTA_WPARAM(wParam) / 120.0f;
-            impl->inputState.onMouseScroll(0, delta);
+            impl->inputState.onMouseScroll(0, delta, messageTime());
             return 0;
         }
         
         case WM_MOUSEHWHEEL: {
             float delta = GET_WHEEL_DELTA_WPARAM(wParam) / 120.0f;
-            impl->inputState.onMouseScroll(delta, 0);
+            impl->inputState.onMouseScroll(delta, 0, messageTime());
             return 0;
         }
         
@@ -600,6 +616,7 @@ bool Window::create(const WindowConfig& config) {
     m_impl->hdc = GetDC(m_impl->hwnd);
     
     // Create OpenGL context
+    m_impl->adaptiveVsync = config.adaptiveVsync;
     if (!m_impl->createGLContext(config.msaaSamples, config.vsync)) {
         destroy();
         return false;
@@ -682,9 +699,12 @@ void Window::waitEvents() {
     m_impl->inputState.beginFrame();
     
     MSG msg;
-    GetMessageW(&msg, m_impl->hwnd, 0, 0);
-    TranslateMessage(&msg);
-    DispatchMessageW(&msg);
+    // Trickled input is already waiting in the queue
+    if (m_impl->inputState.pendingEventCount() == 0) {
+        GetMessageW(&msg, m_impl->hwnd, 0, 0);
+        TranslateMessage(&msg);
+        DispatchMessageW(&msg);
+    }
     
     while (PeekMessageW(&msg, m_impl->hwnd, 0, 0, PM_REMOVE)) {
         TranslateMessage(&msg);
@@ -692,6 +712,16 @@ void Window::waitEvents() {
     }
 }
 
+int Window::eventFd() const {
+    return -1;
+}
+
+bool Window::hasPendingEvents() const {
+    if (m_impl->inputState.pendingEventCount() > 0) return true;
+    MSG msg;
+    return m_impl->hwnd && PeekMessageW(&msg, m_impl->hwnd, 0, 0, PM_NOREMOVE);
+}
+
 void Window::swapBuffers() {
     SwapBuffers(m_impl->hdc);
 }
@@ -774,6 +804,13 @@ bool Window::isMaximized() const {
     return m_impl->isMaximized;
 }
 
+WindowVisibility Window::visibility() const {
+    if (!m_impl->isOpen || !m_impl->hwnd) return WindowVisibility::Unmapped;
+    if (m_impl->isMinimized || IsIconic(m_impl->hwnd)) return WindowVisibility::Minimized;
+    if (!IsWindowVisible(m_impl->hwnd)) return WindowVisibility::Unmapped;
+    return WindowVisibility::Visible;
+}
+
 bool Window::isFocused() const {
     return m_impl->isFocused;
 }
@@ -796,7 +833,7 @@ void Window::showCursor() {
     }
 }
 
-std::string Window::getClipboardText() const {
+std::string Window::getClipboardText() {
     if (!OpenClipboard(m_impl->hwnd)) return "";
     
     std::string result;
@@ -832,6 +869,11 @@ void Window::setClipboardText(const std::string& text) {
     CloseClipboard();
 }
 
+void Window::requestClipboardText(ClipboardCallback callback) {
+    // The Win32 clipboard is read synchronously without waiting on the owner
+    callback(getClipboardText());
+}
+
 void Window::setResizeCallback(ResizeCallback callback) {
     m_impl->resizeCallback = std::move(callback);
 }
@@ -945,6 +987,7 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
     DragAcceptFiles(m_impl->hwnd, TRUE);
     
     m_impl->hdc = GetDC(m_impl->hwnd);
+    m_impl->adaptiveVsync = config.adaptiveVsync;
     
     // Set pixel format (must match shared context)
     if (shareWindow) {
@@ -989,9 +1032,7 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
     
     wglMakeCurrent(m_impl->hdc, m_impl->hglrc);
     
-    if (config.vsync && m_impl->wglSwapIntervalEXT) {
-        m_impl->wglSwapIntervalEXT(1);
-    }
+    m_impl->applySwapInterval(config.vsync);
     
     // Load cursors
     m_impl->cursors[static_cast<int>(Cursor::Arrow)] = LoadCursorW(nullptr, IDC_ARROW);
@@ -1,17 +1,98 @@
 #include "fastener/platform/window_manager.h"
+#include "fastener/core/log.h"
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#define FST_USE_EPOLL 1
+#elif defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
 
 namespace fst {
 
 struct WindowManager::Impl {
+    // Declared first so it outlives the windows whose contexts use it
+    GpuResourceCache gpuResources;
+    
     std::vector<std::unique_ptr<Window>> windows;
     Window* mainWindow = nullptr;
     
+    // Rebuilt when windows are added or removed, not on every query
+    std::vector<Window*> windowPtrs;
+    // Rebuilt by pollAllEvents() from each window's visibility
+    std::vector<Window*> redrawList;
+    
     // Cross-window drag state
     bool crossWindowDragActive = false;
     Window* dragSourceWindow = nullptr;
+    
+    // Event loop state
+    struct Timer {
+        TimerId id;
+        Clock::time_point due;
+        Clock::duration interval;
+        bool repeat;
+        std::function<void()> callback;
+    };
+    std::vector<Timer> timers;
+    std::unordered_set<TimerId> firingTimers;  // Due this batch and not cancelled yet
+    TimerId nextTimerId = 1;
+    std::unordered_map<int, std::function<void()>> watchedFds;
+    bool quitRequested = false;
+    bool redrawRequested = false;
+    
+#ifdef FST_USE_EPOLL
+    int epollFd = -1;
+    std::unordered_set<int> epollRegistered;
+#endif
+    
+    ~Impl();
+    void rebuildWindowList();
+    void rebuildRedrawList();
+    void fireTimers(Clock::time_point now);
+    int waitTimeoutMs();
+    void waitForActivity();
 };
 
+WindowManager::Impl::~Impl() {
+#ifdef FST_USE_EPOLL
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+#endif
+}
+
+void WindowManager::Impl::rebuildWindowList() {
+    windowPtrs.clear();
+    windowPtrs.reserve(windows.size());
+    for (const auto& w : windows) {
+        windowPtrs.push_back(w.get());
+    }
+    rebuildRedrawList();
+}
+
+void WindowManager::Impl::rebuildRedrawList() {
+    redrawList.clear();
+    for (Window* w : windowPtrs) {
+        if (w->visibility() == WindowVisibility::Visible) {
+            redrawList.push_back(w);
+        }
+    }
+}
+
 WindowManager::WindowManager() : m_impl(std::make_unique<Impl>()) {}
 
 WindowManager::~WindowManager() = default;
@@ -34,6 +115,7 @@ Window* WindowManager::createWindow(const WindowConfig& config) {
     
     Window* ptr = window.get();
     m_impl->windows.push_back(std::move(window));
+    m_impl->rebuildWindowList();
     return ptr;
 }
 
@@ -55,6 +137,7 @@ Window* WindowManager::createChildWindow(const WindowConfig& config, Window* par
     
     Window* ptr = window.get();
     m_impl->windows.push_back(std::move(window));
+    m_impl->rebuildWindowList();
     return ptr;
 }
 
@@ -71,20 +154,22 @@ void WindowManager::destroyWindow(Window* window) {
                 ? (it == m_impl->windows.begin() ? m_impl->windows[1].get() : m_impl->windows[0].get())
                 : nullptr;
         }
+        if (m_impl->dragSourceWindow == window) {
+            m_impl->crossWindowDragActive = false;
+            m_impl->dragSourceWindow = nullptr;
+        }
+        // Destroys the window's GL context, surface and X/Win32 handles
         m_impl->windows.erase(it);
+        m_impl->rebuildWindowList();
     }
 }
 
 const std::vector<Window*>& WindowManager::windows() const {
-    // Note: This returns pointers, but we need to build the vector
-    // For now we store and return a cached version
-    static thread_local std::vector<Window*> windowPtrs;
-    windowPtrs.clear();
-    windowPtrs.reserve(m_impl->windows.size());
-    for (const auto& w : m_impl->windows) {
-        windowPtrs.push_back(w.get());
-    }
-    return windowPtrs;
+    return m_impl->windowPtrs;
+}
+
+const std::vector<Window*>& WindowManager::windowsNeedingRedraw() const {
+    return m_impl->redrawList;
 }
 
 Window* WindowManager::mainWindow() const {
@@ -104,7 +189,8 @@ Window* WindowManager::windowAtPosition(Vec2 screenPos) const {
     // Check windows in reverse order (topmost first - assuming later created are on top)
     for (auto it = m_impl->windows.rbegin(); it != m_impl->windows.rend(); ++it) {
         const auto& w = *it;
-        if (!w->isOpen() || w->isMinimized()) continue;
+        WindowVisibility visibility = w->visibility();
+        if (visibility == WindowVisibility::Minimized || visibility == WindowVisibility::Unmapped) continue;
         
         Vec2 pos = w->screenPosition();
         Vec2 size = w->size();
@@ -130,12 +216,218 @@ void WindowManager::pollAllEvents() {
             w->pollEvents();
         }
     }
+    m_impl->rebuildRedrawList();
+}
+
+//=============================================================================
+// Event Loop
+//=============================================================================
+
+void WindowManager::Impl::fireTimers(Clock::time_point now) {
+    // Collect first: callbacks may add or cancel timers
+    std::vector<Timer> due;
+    for (auto it = timers.begin(); it != timers.end();) {
+        if (it->due > now) {
+            ++it;
+            continue;
+        }
+        due.push_back(*it);
+        firingTimers.insert(it->id);
+        if (it->repeat) {
+            // Skip missed periods instead of firing a burst after a stall
+            do {
+                it->due += it->interval;
+            } while (it->due <= now);
+            ++it;
+        } else {
+            it = timers.erase(it);
+        }
+    }
+    
+    for (auto& timer : due) {
+        // An earlier callback may have cancelled this one
+        if (firingTimers.erase(timer.id) == 0) continue;
+        timer.callback();
+    }
+}
+
+int WindowManager::Impl::waitTimeoutMs() {
+    if (redrawRequested || quitRequested) {
+        return 0;
+    }
+    // Xlib may already have read events off the socket while rendering, and
+    // trickled input can still be waiting in a window's queue
+    for (Window* w : windowPtrs) {
+        if (w->isOpen() && w->hasPendingEvents()) {
+            return 0;
+        }
+    }
+    if (timers.empty()) {
+        return -1;
+    }
+    
+    Clock::time_point next = timers.front().due;
+    for (const auto& timer : timers) {
+        next = std::min(next, timer.due);
+    }
+    double ms = std::chrono::duration<double, std::milli>(next - Clock::now()).count();
+    // Round up so the timer is due when the wait returns
+    return ms <= 0.0 ? 0 : static_cast<int>(std::ceil(ms));
+}
+
+void WindowManager::Impl::waitForActivity() {
+    int timeout = waitTimeoutMs();
+    if (timeout == 0) {
+        return;
+    }
+    
+#ifdef FST_USE_EPOLL
+    if (epollFd < 0) {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) {
+            FST_LOG_ERROR("epoll_create1 failed");
+            return;
+        }
+    }
+    
+    // Windows sharing a context share one connection, so dedupe descriptors
+    std::unordered_set<int> wanted;
+    for (Window* w : windowPtrs) {
+        int fd = w->isOpen() ? w->eventFd() : -1;
+        if (fd >= 0) {
+            wanted.insert(fd);
+        }
+    }
+    for (const auto& entry : watchedFds) {
+        wanted.insert(entry.first);
+    }
+    for (auto it = epollRegistered.begin(); it != epollRegistered.end();) {
+        if (wanted.count(*it) == 0) {
+            // Fails harmlessly if the descriptor was already closed
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, *it, nullptr);
+            it = epollRegistered.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (int fd : wanted) {
+        if (epollRegistered.count(fd) != 0) continue;
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+            epollRegistered.insert(fd);
+        } else {
+            FST_LOGF_WARN("Cannot wait on descriptor %d", fd);
+        }
+    }
+    
+    epoll_event events[16];
+    int count = epoll_wait(epollFd, events, 16, timeout);
+    if (count < 0) {
+        if (errno != EINTR) {
+            FST_LOG_ERROR("epoll_wait failed");
+        }
+        return;
+    }
+    
+    // Window connections need no action here; pollAllEvents() reads them
+    for (int i = 0; i < count; ++i) {
+        auto it = watchedFds.find(events[i].data.fd);
+        if (it != watchedFds.end()) {
+            // Copy: the callback may unwatch its own descriptor
+            std::function<void()> callback = it->second;
+            callback();
+        }
+    }
+#elif defined(_WIN32)
+    // One message queue per thread covers every window
+    MsgWaitForMultipleObjects(0, nullptr, FALSE,
+                              timeout < 0 ? INFINITE : static_cast<DWORD>(timeout), QS_ALLINPUT);
+#endif
+}
+
+void WindowManager::run(const FrameCallback& frame) {
+    m_impl->quitRequested = false;
+    
+    while (!m_impl->quitRequested && anyWindowOpen()) {
+        pollAllEvents();
+        fireDueTimers();
+        m_impl->redrawRequested = false;
+        
+        // Copy: the callback may create or destroy windows
+        std::vector<Window*> redraw = m_impl->redrawList;
+        for (Window* w : redraw) {
+            auto& live = m_impl->windowPtrs;
+            if (std::find(live.begin(), live.end(), w) == live.end() || !w->isOpen()) continue;
+            frame(*w);
+        }
+        
+        m_impl->waitForActivity();
+    }
+}
+
+void WindowManager::quit() {
+    m_impl->quitRequested = true;
+}
+
+void WindowManager::requestRedraw() {
+    m_impl->redrawRequested = true;
+}
+
+WindowManager::TimerId WindowManager::addTimer(double seconds, std::function<void()> callback, bool repeat) {
+    auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(std::max(seconds, 0.0)));
+    if (repeat && interval.count() == 0) {
+        // A zero period would fire forever within one iteration
+        interval = std::chrono::milliseconds(1);
+    }
+    TimerId id = m_impl->nextTimerId++;
+    m_impl->timers.push_back({id, Clock::now() + interval, interval, repeat, std::move(callback)});
+    return id;
+}
+
+void WindowManager::cancelTimer(TimerId id) {
+    m_impl->firingTimers.erase(id);
+    auto& timers = m_impl->timers;
+    timers.erase(std::remove_if(timers.begin(), timers.end(),
+        [id](const Impl::Timer& timer) { return timer.id == id; }), timers.end());
+}
+
+void WindowManager::fireDueTimers(Clock::time_point now) {
+    m_impl->fireTimers(now);
+}
+
+bool WindowManager::watchFd(int fd, std::function<void()> onReadable) {
+#ifdef FST_USE_EPOLL
+    if (fd < 0 || !onReadable) return false;
+    m_impl->watchedFds[fd] = std::move(onReadable);
+    return true;
+#else
+    (void)fd;
+    (void)onReadable;
+    FST_LOG_WARN("WindowManager::watchFd is not supported on this platform");
+    return false;
+#endif
+}
+
+void WindowManager::unwatchFd(int fd) {
+    m_impl->watchedFds.erase(fd);
+#ifdef FST_USE_EPOLL
+    if (m_impl->epollRegistered.erase(fd) != 0) {
+        epoll_ctl(m_impl->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+#endif
 }
 
 size_t WindowManager::windowCount() const {
     return m_impl->windows.size();
 }
 
+GpuResourceCache& WindowManager::gpuResources() {
+    return m_impl->gpuResources;
+}
+
 void WindowManager::beginCrossWindowDrag(Window* sourceWindow) {
     m_impl->crossWindowDragActive = true;
     m_impl->dragSourceWindow = sourceWindow;
@@ -16,9 +16,16 @@
 #include <X11/cursorfont.h>
 #include <X11/keysym.h>
 #include <GL/glx.h>
+#ifdef FST_HAS_XINPUT2
+#include <X11/extensions/XInput2.h>
+#endif
 #include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 #include <unordered_map>
 #include <cstring>
+#include <cstdlib>
 
 namespace fst {
 
@@ -122,6 +129,68 @@ typedef int (*PFNGLXSWAPINTERVALMESAPROC)(int);
 #define GLX_CONTEXT_PROFILE_MASK_ARB       0x9126
 #define GLX_CONTEXT_CORE_PROFILE_BIT_ARB   0x00000001
 
+//=============================================================================
+// Clipboard Transfer State
+//=============================================================================
+
+/// Seconds without progress before a clipboard transfer is abandoned
+static constexpr double CLIPBOARD_TIMEOUT = 2.0;
+
+using ClipboardClock = std::chrono::steady_clock;
+
+/** @brief Outgoing INCR transfer to another client reading our selection. */
+struct ClipboardSend {
+    ::Window requestor = 0;
+    Atom property = None;
+    Atom type = None;
+    std::shared_ptr<const std::string> text;
+    size_t offset = 0;
+    long requestorMask = NoEventMask;  ///< Our event mask on the requestor before the transfer
+    ClipboardClock::time_point lastActivity;
+};
+
+/**
+ * @brief Catches X errors raised by requests on another client's window.
+ *
+ * Xlib's default handler exits on any error, and a clipboard requestor can be
+ * destroyed at any point. Errors from requests made while the trap is active
+ * are recorded instead; finish() syncs with the server to collect them.
+ */
+class XErrorTrap {
+public:
+    explicit XErrorTrap(Display* display) : m_display(display) {
+        // Errors from earlier requests still go to the previous handler
+        XSync(m_display, False);
+        s_failed = false;
+        m_previous = XSetErrorHandler(&XErrorTrap::onError);
+    }
+    ~XErrorTrap() { finish(); }
+    
+    XErrorTrap(const XErrorTrap&) = delete;
+    XErrorTrap& operator=(const XErrorTrap&) = delete;
+    
+    /** @brief Wait for the trapped requests and restore the handler. @return true if any failed */
+    bool finish() {
+        if (m_active) {
+            XSync(m_display, False);
+            XSetErrorHandler(m_previous);
+            m_active = false;
+        }
+        return s_failed;
+    }
+
+private:
+    static int onError(Display*, XErrorEvent*) {
+        s_failed = true;
+        return 0;
+    }
+    
+    static inline bool s_failed = false;
+    Display* m_display;
+    XErrorHandler m_previous = nullptr;
+    bool m_active = true;
+};
+
 //=============================================================================
 // Window Implementation
 //=============================================================================
@@ -133,8 +202,20 @@ struct Window::Impl {
     XIM xim = nullptr;
     XIC xic = nullptr;
     
+    // IME composition drawn by us (XIM on-the-spot preedit)
+    std::u32string preedit;
+    std::vector<XIMFeedback> preeditFeedback;
+    int preeditCaret = 0;
+    
     bool isOpen = false;
     bool isMinimized = false;
+    bool isMapped = false;
+    bool isObscured = false;
+    
+    // Shared-connection event routing: set while this window's pollEvents()
+    // runs, and when another window has already opened this one's next frame
+    bool polling = false;
+    bool frameStarted = false;
     bool isMaximized = false;
     bool isFocused = true;
     
@@ -169,26 +250,227 @@ struct Window::Impl {
     Atom netWmState;
     Atom netWmStateMaximizedVert;
     Atom netWmStateMaximizedHorz;
+    Atom wmState;
     Atom clipboard;
     Atom utf8String;
     Atom targets;
+    Atom incr;
+    Atom clipboardProperty;
+    
+    // Clipboard, selection owner side
+    std::shared_ptr<const std::string> clipboardText;
+    bool ownsClipboard = false;
+    std::vector<ClipboardSend> clipboardSends;
+    
+    // Clipboard, requestor side
+    std::vector<Window::ClipboardCallback> clipboardWaiters;
+    std::string clipboardIncoming;
+    std::string clipboardCache;
+    Atom clipboardTarget = None;
+    bool clipboardIncr = false;
+    ClipboardClock::time_point clipboardActivity;
+    
+    // Pointer motion coalesced within one poll
+    bool motionPending = false;
+    float motionX = 0.0f;
+    float motionY = 0.0f;
+    Time motionTime = 0;
+    
+    // XInput2 smooth scrolling. Core wheel clicks carry no source device, but
+    // the ones the server emulates for a device's scroll valuators share the
+    // timestamp of its XI_Motion; other devices' clicks still count
+    Time smoothScrollTime = 0;
+#ifdef FST_HAS_XINPUT2
+    struct ScrollValuator {
+        int deviceId = 0;
+        int number = 0;
+        int type = 0;
+        double increment = 1.0;
+        double last = 0.0;
+        bool valid = false;
+    };
+    int xiOpcode = -1;
+    std::vector<ScrollValuator> scrollValuators;
+#endif
     
     // GLX functions
     PFNGLXCREATECONTEXTATTRIBSARBPROC glXCreateContextAttribsARB = nullptr;
     PFNGLXSWAPINTERVALEXTPROC glXSwapIntervalEXT = nullptr;
     PFNGLXSWAPINTERVALMESAPROC glXSwapIntervalMESA = nullptr;
+    bool adaptiveVsync = false;
     
     void loadGLXExtensions();
     bool createGLContext(int msaaSamples, bool vsync, GLXContext shareContext);
     void updateDPI();
-    void updateModifiers(unsigned int state);
+    void updateModifiers(unsigned int state, double time);
+    bool isIconic() const;
+    void handleEvent(XEvent& event);
+    void acceptRouted();
     void initAtoms();
     void initCursors();
+    void openInputMethod();
+    void publishPreedit();
+    
+    size_t maxPropertyChunk() const;
+    void requestClipboard(Atom target);
+    void finishClipboardRequest(bool ok);
+    void onSelectionRequest(const XSelectionRequestEvent& request);
+    void onSelectionNotify(const XSelectionEvent& notify);
+    bool onPropertyNotify(const XPropertyEvent& property);
+    void sendClipboardChunk(ClipboardSend& send);
+    void endClipboardSend(::Window requestor, Atom property, bool restoreMask);
+    void expireClipboardTransfers();
+    
+    void queueMotion(float x, float y, Time time);
+    void flushMotion();
+    void initXInput2();
+    void resetScrollValuators();
+#ifdef FST_HAS_XINPUT2
+    void refreshScrollValuators();
+    void onXIEvent(XGenericEventCookie& cookie);
+#endif
 };
 
 // Global window map for event dispatch
 static std::unordered_map<::Window, Window::Impl*> g_windowMap;
 
+// Windows created with a shared context reuse the display connection; it is
+// closed when the last window using it is destroyed
+static std::unordered_map<Display*, int> g_displayRefs;
+
+static void releaseDisplay(Display* display) {
+    auto it = g_displayRefs.find(display);
+    if (it != g_displayRefs.end() && --it->second > 0) return;
+    if (it != g_displayRefs.end()) g_displayRefs.erase(it);
+    XCloseDisplay(display);
+}
+
+// Resolve the window an event targets; windows created with a shared
+// context share one display connection
+static Window::Impl* implForWindow(::Window window, Window::Impl* fallback) {
+    auto it = g_windowMap.find(window);
+    return it != g_windowMap.end() ? it->second : fallback;
+}
+
+static void appendUtf8(std::string& out, char32_t codepoint) {
+    if (codepoint < 0x80) {
+        out += static_cast<char>(codepoint);
+    } else if (codepoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codepoint >> 6));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codepoint >> 12));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codepoint >> 18));
+        out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codepoint & 0x3F));
+    }
+}
+
+// Preedit text from the IM, as wide chars or in the locale's multibyte
+// encoding
+static std::u32string ximTextToUtf32(const XIMText* text) {
+    std::u32string result;
+    if (!text || text->length == 0) return result;
+    
+    if (text->encoding_is_wchar) {
+        if (!text->string.wide_char) return result;
+        for (unsigned short i = 0; i < text->length; ++i) {
+            result += static_cast<char32_t>(text->string.wide_char[i]);
+        }
+        return result;
+    }
+    
+    if (!text->string.multi_byte) return result;
+    std::vector<wchar_t> wide(text->length + 1);
+    size_t count = std::mbstowcs(wide.data(), text->string.multi_byte, wide.size());
+    if (count != static_cast<size_t>(-1)) {
+        result.assign(wide.begin(), wide.begin() + static_cast<std::ptrdiff_t>(count));
+    }
+    return result;
+}
+
+//=============================================================================
+// XIM preedit callbacks (client data is the window's Impl)
+//=============================================================================
+
+// Preedit callbacks take an XIC and the start callback returns a length, so
+// none of them is an XIMProc; going through void(*)() is the sanctioned way
+// to store a different function type
+template <typename Callback>
+static XIMProc ximProc(Callback* callback) {
+    return reinterpret_cast<XIMProc>(reinterpret_cast<void (*)()>(callback));
+}
+
+static int onPreeditStart(XIC, XPointer clientData, XPointer) {
+    auto* impl = reinterpret_cast<Window::Impl*>(clientData);
+    impl->preedit.clear();
+    impl->preeditFeedback.clear();
+    impl->preeditCaret = 0;
+    return -1;  // No length limit
+}
+
+static void onPreeditDone(XIC, XPointer clientData, XPointer) {
+    auto* impl = reinterpret_cast<Window::Impl*>(clientData);
+    impl->preedit.clear();
+    impl->preeditFeedback.clear();
+    impl->preeditCaret = 0;
+    impl->publishPreedit();
+}
+
+static void onPreeditDraw(XIC, XPointer clientData, XPointer callData) {
+    auto* impl = reinterpret_cast<Window::Impl*>(clientData);
+    auto* draw = reinterpret_cast<XIMPreeditDrawCallbackStruct*>(callData);
+    if (!draw) return;
+    
+    // Replace chg_length characters at chg_first with the new text
+    size_t size = impl->preedit.size();
+    size_t first = std::min(static_cast<size_t>(std::max(draw->chg_first, 0)), size);
+    size_t length = std::min(static_cast<size_t>(std::max(draw->chg_length, 0)), size - first);
+    std::u32string inserted = ximTextToUtf32(draw->text);
+    
+    impl->preedit.replace(first, length, inserted);
+    std::vector<XIMFeedback> feedback(inserted.size(), 0);
+    if (draw->text && draw->text->feedback) {
+        for (size_t i = 0; i < feedback.size() && i < draw->text->length; ++i) {
+            feedback[i] = draw->text->feedback[i];
+        }
+    }
+    impl->preeditFeedback.erase(impl->preeditFeedback.begin() + static_cast<std::ptrdiff_t>(first),
+                                impl->preeditFeedback.begin() + static_cast<std::ptrdiff_t>(first + length));
+    impl->preeditFeedback.insert(impl->preeditFeedback.begin() + static_cast<std::ptrdiff_t>(first),
+                                 feedback.begin(), feedback.end());
+    impl->preeditCaret = std::clamp(draw->caret, 0, static_cast<int>(impl->preedit.size()));
+    impl->publishPreedit();
+}
+
+static void onPreeditCaret(XIC, XPointer clientData, XPointer callData) {
+    auto* impl = reinterpret_cast<Window::Impl*>(clientData);
+    auto* caret = reinterpret_cast<XIMPreeditCaretCallbackStruct*>(callData);
+    if (!caret) return;
+    
+    int position = impl->preeditCaret;
+    switch (caret->direction) {
+        case XIMAbsolutePosition: position = caret->position; break;
+        case XIMForwardChar: position++; break;
+        case XIMBackwardChar: position--; break;
+        case XIMLineStart: position = 0; break;
+        case XIMLineEnd: position = static_cast<int>(impl->preedit.size()); break;
+        default: break;
+    }
+    impl->preeditCaret = std::clamp(position, 0, static_cast<int>(impl->preedit.size()));
+    caret->position = impl->preeditCaret;
+    impl->publishPreedit();
+}
+
+// X server timestamps are milliseconds; input events carry seconds
+static double serverTime(Time time) {
+    return static_cast<double>(time) / 1000.0;
+}
+
 void Window::Impl::loadGLXExtensions() {
     glXCreateContextAttribsARB = (PFNGLXCREATECONTEXTATTRIBSARBPROC)
         glXGetProcAddressARB((const GLubyte*)"glXCreateContextAttribsARB");
@@ -243,7 +525,8 @@ bool Window::Impl::createGLContext(int msaaSamples, bool vsync, GLXContext share
     swa.colormap = colormap;
     swa.event_mask = ExposureMask | KeyPressMask | KeyReleaseMask | 
                      ButtonPressMask | ButtonReleaseMask | PointerMotionMask |
-                     StructureNotifyMask | FocusChangeMask | EnterWindowMask | LeaveWindowMask;
+                     StructureNotifyMask | FocusChangeMask | EnterWindowMask | LeaveWindowMask |
+                     PropertyChangeMask | VisibilityChangeMask;
     
     // Create window
     window = XCreateWindow(display, RootWindow(display, vi->screen),
@@ -275,10 +558,13 @@ bool Window::Impl::createGLContext(int msaaSamples, bool vsync, GLXContext share
     
     glXMakeCurrent(display, window, glxContext);
     
-    // Set vsync
+    // Set vsync. A negative interval (GLX_EXT_swap_control_tear) swaps
+    // immediately when a frame misses vblank instead of waiting a refresh
     if (vsync) {
+        const char* extensions = glXQueryExtensionsString(display, DefaultScreen(display));
+        bool tear = adaptiveVsync && extensions && strstr(extensions, "GLX_EXT_swap_control_tear");
         if (glXSwapIntervalEXT) {
-            glXSwapIntervalEXT(display, window, 1);
+            glXSwapIntervalEXT(display, window, tear ? -1 : 1);
         } else if (glXSwapIntervalMESA) {
             glXSwapIntervalMESA(1);
         }
@@ -311,12 +597,30 @@ void Window::Impl::updateDPI() {
     fbHeight = height;
 }
 
-void Window::Impl::updateModifiers(unsigned int state) {
+bool Window::Impl::isIconic() const {
+    // ICCCM WM_STATE: the first CARD32 is the state, 3 = IconicState
+    Atom type;
+    int format;
+    unsigned long count, remaining;
+    unsigned char* data = nullptr;
+    bool iconic = false;
+    if (XGetWindowProperty(display, window, wmState, 0, 2, False, wmState,
+                           &type, &format, &count, &remaining, &data) == Success && data) {
+        if (format == 32 && count > 0) {
+            iconic = reinterpret_cast<long*>(data)[0] == IconicState;
+        }
+        XFree(data);
+    }
+    return iconic;
+}
+
+void Window::Impl::updateModifiers(unsigned int state, double time) {
     inputState.onModifiersChanged(
         (state & ShiftMask) != 0,
         (state & ControlMask) != 0,
         (state & Mod1Mask) != 0,   // Alt
-        (state & Mod4Mask) != 0    // Super
+        (state & Mod4Mask) != 0,   // Super
+        time
     );
 }
 
@@ -326,9 +630,12 @@ void Window::Impl::initAtoms() {
     netWmState = XInternAtom(display, "_NET_WM_STATE", False);
     netWmStateMaximizedVert = XInternAtom(display, "_NET_WM_STATE_MAXIMIZED_VERT", False);
     netWmStateMaximizedHorz = XInternAtom(display, "_NET_WM_STATE_MAXIMIZED_HORZ", False);
+    wmState = XInternAtom(display, "WM_STATE", False);
     clipboard = XInternAtom(display, "CLIPBOARD", False);
     utf8String = XInternAtom(display, "UTF8_STRING", False);
     targets = XInternAtom(display, "TARGETS", False);
+    incr = XInternAtom(display, "INCR", False);
+    clipboardProperty = XInternAtom(display, "FST_CLIPBOARD", False);
 }
 
 void Window::Impl::initCursors() {
@@ -382,6 +689,7 @@ bool Window::create(const WindowConfig& config) {
     if (!m_impl->display) {
         return false;
     }
+    g_displayRefs[m_impl->display] = 1;
 
     XrmInitialize();
     
@@ -393,8 +701,9 @@ bool Window::create(const WindowConfig& config) {
     m_impl->loadGLXExtensions();
     
     // Create GL context and window
+    m_impl->adaptiveVsync = config.adaptiveVsync;
     if (!m_impl->createGLContext(config.msaaSamples, config.vsync, nullptr)) {
-        XCloseDisplay(m_impl->display);
+        releaseDisplay(m_impl->display);
         m_impl->display = nullptr;
         return false;
     }
@@ -409,15 +718,10 @@ bool Window::create(const WindowConfig& config) {
     
     // Initialize cursors
     m_impl->initCursors();
+    m_impl->initXInput2();
     
     // Create input method for text input
-    m_impl->xim = XOpenIM(m_impl->display, nullptr, nullptr, nullptr);
-    if (m_impl->xim) {
-        m_impl->xic = XCreateIC(m_impl->xim,
-                                XNInputStyle, XIMPreeditNothing | XIMStatusNothing,
-                                XNClientWindow, m_impl->window,
-                                nullptr);
-    }
+    m_impl->openInputMethod();
     
     m_impl->updateDPI();
     
@@ -427,6 +731,7 @@ bool Window::create(const WindowConfig& config) {
     }
     XMapWindow(m_impl->display, m_impl->window);
     XFlush(m_impl->display);
+    m_impl->isMapped = true;  // Assume visible until MapNotify/VisibilityNotify say otherwise
     
     m_impl->isOpen = true;
     
@@ -444,6 +749,7 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
     
     // Use same display as share window
     m_impl->display = shareWindow->m_impl->display;
+    g_displayRefs[m_impl->display]++;
     m_impl->width = config.width;
     m_impl->height = config.height;
     
@@ -452,7 +758,9 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
     m_impl->loadGLXExtensions();
     
     // Create GL context with sharing
+    m_impl->adaptiveVsync = config.adaptiveVsync;
     if (!m_impl->createGLContext(config.msaaSamples, config.vsync, shareWindow->m_impl->glxContext)) {
+        releaseDisplay(m_impl->display);
         m_impl->display = nullptr;
         return false;
     }
@@ -462,14 +770,9 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
     XStoreName(m_impl->display, m_impl->window, config.title.c_str());
     XSetWMProtocols(m_impl->display, m_impl->window, &m_impl->wmDeleteWindow, 1);
     m_impl->initCursors();
+    m_impl->initXInput2();
     
-    m_impl->xim = XOpenIM(m_impl->display, nullptr, nullptr, nullptr);
-    if (m_impl->xim) {
-        m_impl->xic = XCreateIC(m_impl->xim,
-                                XNInputStyle, XIMPreeditNothing | XIMStatusNothing,
-                                XNClientWindow, m_impl->window,
-                                nullptr);
-    }
+    m_impl->openInputMethod();
     
     m_impl->updateDPI();
     
@@ -478,6 +781,7 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
     }
     XMapWindow(m_impl->display, m_impl->window);
     XFlush(m_impl->display);
+    m_impl->isMapped = true;  // Assume visible until MapNotify/VisibilityNotify say otherwise
     
     m_impl->isOpen = true;
     
@@ -485,6 +789,11 @@ bool Window::createWithSharedContext(const WindowConfig& config, Window* shareWi
 }
 
 void Window::destroy() {
+    m_impl->clipboardWaiters.clear();
+    m_impl->clipboardSends.clear();
+    m_impl->clipboardText.reset();
+    m_impl->ownsClipboard = false;
+    
     if (m_impl->xic) {
         XDestroyIC(m_impl->xic);
         m_impl->xic = nullptr;
@@ -503,7 +812,10 @@ void Window::destroy() {
     }
     
     if (m_impl->glxContext) {
-        glXMakeCurrent(m_impl->display, None, nullptr);
+        // Other windows may still be drawing on the shared display
+        if (glXGetCurrentContext() == m_impl->glxContext) {
+            glXMakeCurrent(m_impl->display, None, nullptr);
+        }
         glXDestroyContext(m_impl->display, m_impl->glxContext);
         m_impl->glxContext = nullptr;
     }
@@ -520,7 +832,7 @@ void Window::destroy() {
     }
     
     if (m_impl->display) {
-        XCloseDisplay(m_impl->display);
+        releaseDisplay(m_impl->display);
         m_impl->display = nullptr;
     }
     
@@ -535,193 +847,377 @@ void Window::close() {
     if (m_impl->window) {
         XUnmapWindow(m_impl->display, m_impl->window);
     }
+    m_impl->isMapped = false;
     m_impl->isOpen = false;
 }
 
-void Window::pollEvents() {
-    m_impl->inputState.beginFrame();
-    
-    while (XPending(m_impl->display) > 0) {
-        XEvent event;
-        XNextEvent(m_impl->display, &event);
-        
-        // Filter for input method
-        if (m_impl->xic && XFilterEvent(&event, m_impl->window)) {
-            continue;
+void Window::Impl::openInputMethod() {
+    // Honour XMODIFIERS (@im=...) so a running IME server is picked up
+    XSetLocaleModifiers("");
+    xim = XOpenIM(display, nullptr, nullptr, nullptr);
+    if (!xim) return;
+    
+    // Prefer on-the-spot: the IM sends the composition and we draw it at
+    // the caret. Otherwise the IM shows its own window (or has none).
+    XIMStyles* styles = nullptr;
+    bool onTheSpot = false;
+    if (!XGetIMValues(xim, XNQueryInputStyle, &styles, nullptr) && styles) {
+        for (unsigned short i = 0; i < styles->count_styles; ++i) {
+            if (styles->supported_styles[i] == (XIMPreeditCallbacks | XIMStatusNothing)) {
+                onTheSpot = true;
+                break;
+            }
         }
-        
-        switch (event.type) {
-            case ClientMessage:
-                if (static_cast<Atom>(event.xclient.data.l[0]) == m_impl->wmDeleteWindow) {
-                    if (m_impl->closeCallback) {
-                        m_impl->closeCallback({});
-                    }
-                    m_impl->isOpen = false;
+        XFree(styles);
+    }
+    
+    if (onTheSpot) {
+        XIMCallback start{reinterpret_cast<XPointer>(this), ximProc(onPreeditStart)};
+        XIMCallback done{reinterpret_cast<XPointer>(this), ximProc(onPreeditDone)};
+        XIMCallback draw{reinterpret_cast<XPointer>(this), ximProc(onPreeditDraw)};
+        XIMCallback caret{reinterpret_cast<XPointer>(this), ximProc(onPreeditCaret)};
+        XVaNestedList preeditAttributes = XVaCreateNestedList(0,
+                                                              XNPreeditStartCallback, &start,
+                                                              XNPreeditDoneCallback, &done,
+                                                              XNPreeditDrawCallback, &draw,
+                                                              XNPreeditCaretCallback, &caret,
+                                                              nullptr);
+        xic = XCreateIC(xim,
+                        XNInputStyle, XIMPreeditCallbacks | XIMStatusNothing,
+                        XNClientWindow, window,
+                        XNFocusWindow, window,
+                        XNPreeditAttributes, preeditAttributes,
+                        nullptr);
+        XFree(preeditAttributes);
+    }
+    if (!xic) {
+        xic = XCreateIC(xim,
+                        XNInputStyle, XIMPreeditNothing | XIMStatusNothing,
+                        XNClientWindow, window,
+                        nullptr);
+    }
+}
+
+void Window::Impl::publishPreedit() {
+    // Convert to UTF-8 and express the caret and the segment being converted
+    // (reverse/highlight feedback) as byte offsets
+    std::string text;
+    int caretByte = 0;
+    int segmentBegin = -1;
+    int segmentEnd = -1;
+    for (size_t i = 0; i < preedit.size(); ++i) {
+        if (static_cast<int>(i) == preeditCaret) caretByte = static_cast<int>(text.size());
+        bool selected = i < preeditFeedback.size() &&
+                        (preeditFeedback[i] & (XIMReverse | XIMHighlight)) != 0;
+        if (selected && segmentBegin < 0) segmentBegin = static_cast<int>(text.size());
+        appendUtf8(text, preedit[i]);
+        if (selected) segmentEnd = static_cast<int>(text.size());
+    }
+    if (preeditCaret >= static_cast<int>(preedit.size())) caretByte = static_cast<int>(text.size());
+    
+    acceptRouted();
+    if (segmentBegin >= 0) {
+        inputState.onPreeditChanged(text, segmentBegin, segmentEnd);
+    } else {
+        inputState.onPreeditChanged(text, caretByte, caretByte);
+    }
+}
+
+void Window::Impl::acceptRouted() {
+    // Events read through another window's pollEvents() arrive between this
+    // window's frames; open its next frame now so they survive beginFrame()
+    if (!polling && !frameStarted) {
+        inputState.beginFrame();
+        frameStarted = true;
+    }
+}
+
+void Window::Impl::handleEvent(XEvent& event) {
+    switch (event.type) {
+        case ClientMessage:
+            if (static_cast<Atom>(event.xclient.data.l[0]) == wmDeleteWindow) {
+                if (closeCallback) {
+                    closeCallback({});
                 }
-                break;
-                
-            case ConfigureNotify:
-                if (event.xconfigure.width != m_impl->width || event.xconfigure.height != m_impl->height) {
-                    m_impl->width = event.xconfigure.width;
-                    m_impl->height = event.xconfigure.height;
-                    m_impl->updateDPI();
-                    if (m_impl->resizeCallback) {
-                        m_impl->resizeCallback({m_impl->width, m_impl->height});
-                    }
+                isOpen = false;
+            }
+            break;
+            
+        case ConfigureNotify:
+            if (event.xconfigure.width != width || event.xconfigure.height != height) {
+                width = event.xconfigure.width;
+                height = event.xconfigure.height;
+                updateDPI();
+                if (resizeCallback) {
+                    resizeCallback({width, height});
                 }
-                m_impl->posX = event.xconfigure.x;
-                m_impl->posY = event.xconfigure.y;
-                break;
-                
-            case FocusIn:
-                m_impl->isFocused = true;
-                if (m_impl->focusCallback) {
-                    m_impl->focusCallback({true});
+            }
+            posX = event.xconfigure.x;
+            posY = event.xconfigure.y;
+            break;
+            
+        case MapNotify:
+            isMapped = true;
+            isMinimized = false;
+            break;
+            
+        case UnmapNotify:
+            isMapped = false;
+            isMinimized = isIconic();
+            break;
+            
+        case VisibilityNotify:
+            isObscured = event.xvisibility.state == VisibilityFullyObscured;
+            break;
+            
+        case FocusIn:
+            isFocused = true;
+            if (xic) XSetICFocus(xic);
+            if (focusCallback) {
+                focusCallback({true});
+            }
+            break;
+            
+        case FocusOut:
+            isFocused = false;
+            if (xic) XUnsetICFocus(xic);
+            if (focusCallback) {
+                focusCallback({false});
+            }
+            break;
+            
+        case KeyPress: {
+            flushMotion();
+            KeySym keysym = NoSymbol;
+            char buffer[64];
+            std::string text;
+            
+            if (xic) {
+                // An IME commit can exceed the stack buffer; ask again with
+                // the size the IM reports instead of dropping it
+                Status status = 0;
+                int count = Xutf8LookupString(xic, &event.xkey, buffer, sizeof(buffer), &keysym, &status);
+                if (status == XBufferOverflow) {
+                    std::vector<char> large(static_cast<size_t>(count));
+                    count = Xutf8LookupString(xic, &event.xkey, large.data(), count, &keysym, &status);
+                    text.assign(large.data(), static_cast<size_t>(std::max(count, 0)));
+                } else if (status == XLookupChars || status == XLookupBoth) {
+                    text.assign(buffer, static_cast<size_t>(std::max(count, 0)));
                 }
-                break;
-                
-            case FocusOut:
-                m_impl->isFocused = false;
-                if (m_impl->focusCallback) {
-                    m_impl->focusCallback({false});
+                if (status != XLookupKeySym && status != XLookupBoth) {
+                    keysym = NoSymbol;
                 }
-                break;
-                
-            case KeyPress: {
-                KeySym keysym;
-                char buffer[32];
-                int count = 0;
-                
-                if (m_impl->xic) {
-                    Status status;
-                    count = Xutf8LookupString(m_impl->xic, &event.xkey, buffer, sizeof(buffer) - 1, &keysym, &status);
-                } else {
-                    count = XLookupString(&event.xkey, buffer, sizeof(buffer) - 1, &keysym, nullptr);
+            } else {
+                int count = XLookupString(&event.xkey, buffer, sizeof(buffer), &keysym, nullptr);
+                text.assign(buffer, static_cast<size_t>(std::max(count, 0)));
+            }
+            
+            // The event's state is what was held when the key went down, so
+            // it is queued first and the key is stamped with it
+            Key key = xkeyToKey(keysym);
+            updateModifiers(event.xkey.state, serverTime(event.xkey.time));
+            inputState.onKeyDown(key, serverTime(event.xkey.time));
+            
+            // Text input arrives as one event per lookup, however long;
+            // control characters are left to the key events
+            text.erase(std::remove_if(text.begin(), text.end(), [](char c) {
+                unsigned char byte = static_cast<unsigned char>(c);
+                return byte < 32 || byte == 127;
+            }), text.end());
+            inputState.onTextCommit(text, serverTime(event.xkey.time));
+            break;
+        }
+            
+        case KeyRelease: {
+            flushMotion();
+            // Check for key repeat
+            if (XEventsQueued(display, QueuedAfterReading)) {
+                XEvent next;
+                XPeekEvent(display, &next);
+                if (next.type == KeyPress && 
+                    next.xkey.time == event.xkey.time &&
+                    next.xkey.keycode == event.xkey.keycode) {
+                    // Key repeat - skip the release
+                    break;
                 }
-                
-                Key key = xkeyToKey(keysym);
-                m_impl->inputState.onKeyDown(key);
-                m_impl->updateModifiers(event.xkey.state);
-                
-                // Text input
-                if (count > 0) {
-                    buffer[count] = '\0';
-                    // Convert UTF-8 to char32_t (simplified - handles ASCII + basic multibyte)
-                    const unsigned char* p = reinterpret_cast<const unsigned char*>(buffer);
-                    while (*p) {
-                        char32_t codepoint;
-                        if ((*p & 0x80) == 0) {
-                            codepoint = *p++;
-                        } else if ((*p & 0xE0) == 0xC0) {
-                            codepoint = (*p++ & 0x1F) << 6;
-                            codepoint |= (*p++ & 0x3F);
-                        } else if ((*p & 0xF0) == 0xE0) {
-                            codepoint = (*p++ & 0x0F) << 12;
-                            codepoint |= (*p++ & 0x3F) << 6;
-                            codepoint |= (*p++ & 0x3F);
-                        } else if ((*p & 0xF8) == 0xF0) {
-                            codepoint = (*p++ & 0x07) << 18;
-                            codepoint |= (*p++ & 0x3F) << 12;
-                            codepoint |= (*p++ & 0x3F) << 6;
-                            codepoint |= (*p++ & 0x3F);
-                        } else {
-                            ++p;
-                            continue;
-                        }
-                        if (codepoint >= 32 && codepoint != 127) {
-                            m_impl->inputState.onTextInput(codepoint);
-                        }
-                    }
+            }
+            
+            KeySym keysym = XLookupKeysym(&event.xkey, 0);
+            Key key = xkeyToKey(keysym);
+            updateModifiers(event.xkey.state, serverTime(event.xkey.time));
+            inputState.onKeyUp(key, serverTime(event.xkey.time));
+            break;
+        }
+            
+        case MotionNotify:
+            queueMotion(
+                static_cast<float>(event.xmotion.x),
+                static_cast<float>(event.xmotion.y),
+                event.xmotion.time
+            );
+            break;
+            
+        case EnterNotify:
+            resetScrollValuators();
+            break;
+            
+        case GenericEvent:
+#ifdef FST_HAS_XINPUT2
+            if (event.xcookie.extension == xiOpcode &&
+                XGetEventData(display, &event.xcookie)) {
+                // XI2 events carry their window inside the cookie data
+                Impl* target = this;
+                if (event.xcookie.evtype == XI_Motion) {
+                    auto* device = static_cast<XIDeviceEvent*>(event.xcookie.data);
+                    target = implForWindow(device->event, this);
+                    target->acceptRouted();
                 }
+                target->onXIEvent(event.xcookie);
+                XFreeEventData(display, &event.xcookie);
+            }
+#endif
+            break;
+            
+        case ButtonPress:
+            flushMotion();
+            // Wheel clicks are emulated from the XI2 valuators handled above
+            if (event.xbutton.button >= Button4 && event.xbutton.button <= 7 &&
+                smoothScrollTime != 0 && event.xbutton.time == smoothScrollTime) {
                 break;
             }
-                
-            case KeyRelease: {
-                // Check for key repeat
-                if (XEventsQueued(m_impl->display, QueuedAfterReading)) {
-                    XEvent next;
-                    XPeekEvent(m_impl->display, &next);
-                    if (next.type == KeyPress && 
-                        next.xkey.time == event.xkey.time &&
-                        next.xkey.keycode == event.xkey.keycode) {
-                        // Key repeat - skip the release
+            switch (event.xbutton.button) {
+                case Button1:
+                    inputState.onMouseDown(MouseButton::Left, serverTime(event.xbutton.time));
+                    break;
+                case Button2:
+                    inputState.onMouseDown(MouseButton::Middle, serverTime(event.xbutton.time));
+                    break;
+                case Button3:
+                    inputState.onMouseDown(MouseButton::Right, serverTime(event.xbutton.time));
+                    break;
+                case Button4: // Scroll up
+                    inputState.onMouseScroll(0, 1, serverTime(event.xbutton.time));
+                    break;
+                case Button5: // Scroll down
+                    inputState.onMouseScroll(0, -1, serverTime(event.xbutton.time));
+                    break;
+                case 6: // Scroll left (horizontal)
+                    inputState.onMouseScroll(-1, 0, serverTime(event.xbutton.time));
+                    break;
+                case 7: // Scroll right (horizontal)
+                    inputState.onMouseScroll(1, 0, serverTime(event.xbutton.time));
+                    break;
+            }
+            break;
+            
+        case ButtonRelease:
+            flushMotion();
+            switch (event.xbutton.button) {
+                case Button1:
+                    inputState.onMouseUp(MouseButton::Left, serverTime(event.xbutton.time));
+                    break;
+                case Button2:
+                    inputState.onMouseUp(MouseButton::Middle, serverTime(event.xbutton.time));
+                    break;
+                case Button3:
+                    inputState.onMouseUp(MouseButton::Right, serverTime(event.xbutton.time));
+                    break;
+            }
+            break;
+            
+        case SelectionRequest:
+            if (Impl* owner = implForWindow(event.xselectionrequest.owner, this)) {
+                owner->onSelectionRequest(event.xselectionrequest);
+            }
+            break;
+            
+        case SelectionNotify:
+            if (Impl* requestor = implForWindow(event.xselection.requestor, this)) {
+                requestor->onSelectionNotify(event.xselection);
+            }
+            break;
+            
+        case SelectionClear:
+            if (Impl* owner = implForWindow(event.xselectionclear.window, this)) {
+                owner->ownsClipboard = false;
+            }
+            break;
+            
+        case PropertyNotify:
+            // Foreign windows report outgoing INCR progress; try every
+            // window sharing this display
+            if (!onPropertyNotify(event.xproperty)) {
+                for (auto& entry : g_windowMap) {
+                    if (entry.second != this && entry.second->display == display &&
+                        entry.second->onPropertyNotify(event.xproperty)) {
                         break;
                     }
                 }
-                
-                KeySym keysym = XLookupKeysym(&event.xkey, 0);
-                Key key = xkeyToKey(keysym);
-                m_impl->inputState.onKeyUp(key);
-                m_impl->updateModifiers(event.xkey.state);
-                break;
             }
-                
-            case MotionNotify:
-                m_impl->inputState.onMouseMove(
-                    static_cast<float>(event.xmotion.x),
-                    static_cast<float>(event.xmotion.y)
-                );
-                break;
-                
-            case ButtonPress:
-                switch (event.xbutton.button) {
-                    case Button1:
-                        m_impl->inputState.onMouseDown(MouseButton::Left);
-                        break;
-                    case Button2:
-                        m_impl->inputState.onMouseDown(MouseButton::Middle);
-                        break;
-                    case Button3:
-                        m_impl->inputState.onMouseDown(MouseButton::Right);
-                        break;
-                    case Button4: // Scroll up
-                        m_impl->inputState.onMouseScroll(0, 1);
-                        break;
-                    case Button5: // Scroll down
-                        m_impl->inputState.onMouseScroll(0, -1);
-                        break;
-                    case 6: // Scroll left (horizontal)
-                        m_impl->inputState.onMouseScroll(-1, 0);
-                        break;
-                    case 7: // Scroll right (horizontal)
-                        m_impl->inputState.onMouseScroll(1, 0);
-                        break;
-                }
-                break;
-                
-            case ButtonRelease:
-                switch (event.xbutton.button) {
-                    case Button1:
-                        m_impl->inputState.onMouseUp(MouseButton::Left);
-                        break;
-                    case Button2:
-                        m_impl->inputState.onMouseUp(MouseButton::Middle);
-                        break;
-                    case Button3:
-                        m_impl->inputState.onMouseUp(MouseButton::Right);
-                        break;
-                }
-                break;
-                
-            case Expose:
-                if (m_impl->refreshCallback && event.xexpose.count == 0) {
-                    m_impl->refreshCallback();
-                }
-                break;
+            break;
+            
+        case Expose:
+            if (refreshCallback && event.xexpose.count == 0) {
+                refreshCallback();
+            }
+            break;
+    }
+}
+
+void Window::pollEvents() {
+    // Another window sharing the connection may already have opened this
+    // window's frame while routing events to it
+    if (!m_impl->frameStarted) {
+        m_impl->inputState.beginFrame();
+    }
+    m_impl->frameStarted = false;
+    m_impl->polling = true;
+    
+    while (XPending(m_impl->display) > 0) {
+        XEvent event;
+        XNextEvent(m_impl->display, &event);
+        
+        Impl* target = implForWindow(event.xany.window, m_impl.get());
+        
+        // Filter for input method; preedit callbacks run from here
+        target->acceptRouted();
+        if (target->xic && XFilterEvent(&event, target->window)) {
+            continue;
         }
+        
+        target->handleEvent(event);
     }
+    
+    m_impl->polling = false;
+    for (auto& entry : g_windowMap) {
+        if (entry.second->display == m_impl->display) {
+            entry.second->flushMotion();
+        }
+    }
+    m_impl->flushMotion();
+    m_impl->expireClipboardTransfers();
 }
 
 void Window::waitEvents() {
-    m_impl->inputState.beginFrame();
-    
-    XEvent event;
-    XNextEvent(m_impl->display, &event);
-    XPutBackEvent(m_impl->display, &event);
+    // pollEvents() opens the input frame; trickled input needs no new event
+    if (m_impl->inputState.pendingEventCount() == 0) {
+        XEvent event;
+        XNextEvent(m_impl->display, &event);
+        XPutBackEvent(m_impl->display, &event);
+    }
     
     pollEvents();
 }
 
+int Window::eventFd() const {
+    return m_impl->display ? ConnectionNumber(m_impl->display) : -1;
+}
+
+bool Window::hasPendingEvents() const {
+    if (m_impl->inputState.pendingEventCount() > 0) return true;
+    return m_impl->display && XEventsQueued(m_impl->display, QueuedAfterFlush) > 0;
+}
+
 void Window::swapBuffers() {
     glXSwapBuffers(m_impl->display, m_impl->window);
 }
@@ -812,6 +1308,7 @@ void Window::restore() {
                SubstructureRedirectMask | SubstructureNotifyMask, &event);
     
     XMapWindow(m_impl->display, m_impl->window);
+    m_impl->isMapped = true;
     m_impl->isMaximized = false;
     m_impl->isMinimized = false;
 }
@@ -829,6 +1326,14 @@ bool Window::isMaximized() const {
     return m_impl->isMaximized;
 }
 
+WindowVisibility Window::visibility() const {
+    if (!m_impl->isOpen) return WindowVisibility::Unmapped;
+    if (m_impl->isMinimized) return WindowVisibility::Minimized;
+    if (!m_impl->isMapped) return WindowVisibility::Unmapped;
+    if (m_impl->isObscured) return WindowVisibility::Obscured;
+    return WindowVisibility::Visible;
+}
+
 bool Window::isFocused() const {
     return m_impl->isFocused;
 }
@@ -860,53 +1365,435 @@ void Window::showCursor() {
     }
 }
 
-std::string Window::getClipboardText() const {
-    // Request clipboard data
-    ::Window owner = XGetSelectionOwner(m_impl->display, m_impl->clipboard);
-    if (owner == None) {
-        // Try PRIMARY selection
-        owner = XGetSelectionOwner(m_impl->display, XA_PRIMARY);
+//=============================================================================
+// Pointer Motion and Smooth Scrolling
+//=============================================================================
+
+void Window::Impl::queueMotion(float x, float y, Time time) {
+    if (motionPending) {
+        if (x == motionX && y == motionY) return;
+        // Superseded position stays visible in the raw history
+        inputState.recordMouseSample(motionX, motionY, serverTime(motionTime));
+    } else if (Vec2(x, y) == inputState.mousePos()) {
+        return;
+    }
+    motionPending = true;
+    motionX = x;
+    motionY = y;
+    motionTime = time;
+}
+
+void Window::Impl::flushMotion() {
+    // Called before every button, key and scroll event so they see the
+    // pointer where it was when they happened
+    if (!motionPending) return;
+    motionPending = false;
+    inputState.onMouseMove(motionX, motionY, serverTime(motionTime));
+}
+
+void Window::Impl::initXInput2() {
+#ifdef FST_HAS_XINPUT2
+    int event, error;
+    if (!XQueryExtension(display, "XInputExtension", &xiOpcode, &event, &error)) {
+        xiOpcode = -1;
+        return;
     }
-    if (owner == None) return "";
     
-    Atom property = XInternAtom(m_impl->display, "FST_CLIPBOARD", False);
-    XConvertSelection(m_impl->display, m_impl->clipboard, m_impl->utf8String, property, m_impl->window, CurrentTime);
-    XFlush(m_impl->display);
+    // Scroll valuators need XI 2.1
+    int major = 2, minor = 1;
+    if (XIQueryVersion(display, &major, &minor) != Success || major * 10 + minor < 21) {
+        xiOpcode = -1;
+        return;
+    }
     
-    // Wait for SelectionNotify
-    XEvent event;
-    for (int i = 0; i < 100; ++i) {
-        if (XCheckTypedWindowEvent(m_impl->display, m_impl->window, SelectionNotify, &event)) {
-            if (event.xselection.property == None) return "";
-            
-            Atom actualType;
-            int actualFormat;
-            unsigned long nitems, bytesAfter;
-            unsigned char* data = nullptr;
+    unsigned char maskBits[XIMaskLen(XI_LASTEVENT)] = {};
+    XISetMask(maskBits, XI_Motion);
+    XISetMask(maskBits, XI_DeviceChanged);
+    XIEventMask mask;
+    mask.deviceid = XIAllMasterDevices;
+    mask.mask_len = sizeof(maskBits);
+    mask.mask = maskBits;
+    XISelectEvents(display, window, &mask, 1);
+    
+    refreshScrollValuators();
+#endif
+}
+
+void Window::Impl::resetScrollValuators() {
+#ifdef FST_HAS_XINPUT2
+    // Valuators keep counting while the pointer is elsewhere
+    for (auto& valuator : scrollValuators) {
+        valuator.valid = false;
+    }
+#endif
+}
+
+#ifdef FST_HAS_XINPUT2
+void Window::Impl::refreshScrollValuators() {
+    scrollValuators.clear();
+    
+    int count = 0;
+    XIDeviceInfo* devices = XIQueryDevice(display, XIAllDevices, &count);
+    if (!devices) return;
+    
+    for (int i = 0; i < count; ++i) {
+        const XIDeviceInfo& device = devices[i];
+        for (int c = 0; c < device.num_classes; ++c) {
+            if (device.classes[c]->type != XIScrollClass) continue;
+            auto* scroll = reinterpret_cast<XIScrollClassInfo*>(device.classes[c]);
             
-            XGetWindowProperty(m_impl->display, m_impl->window, property,
-                              0, (~0L), True, AnyPropertyType,
-                              &actualType, &actualFormat, &nitems, &bytesAfter, &data);
+            ScrollValuator valuator;
+            valuator.deviceId = device.deviceid;
+            valuator.number = scroll->number;
+            valuator.type = scroll->scroll_type;
+            valuator.increment = scroll->increment != 0.0 ? scroll->increment : 1.0;
             
-            std::string result;
-            if (data) {
-                result = reinterpret_cast<char*>(data);
-                XFree(data);
+            // Seed with the current value so the first motion is not a jump
+            for (int v = 0; v < device.num_classes; ++v) {
+                if (device.classes[v]->type != XIValuatorClass) continue;
+                auto* info = reinterpret_cast<XIValuatorClassInfo*>(device.classes[v]);
+                if (info->number == scroll->number) {
+                    valuator.last = info->value;
+                    valuator.valid = true;
+                }
             }
-            return result;
+            scrollValuators.push_back(valuator);
+        }
+    }
+    XIFreeDeviceInfo(devices);
+}
+
+void Window::Impl::onXIEvent(XGenericEventCookie& cookie) {
+    if (cookie.evtype == XI_DeviceChanged) {
+        refreshScrollValuators();
+        return;
+    }
+    if (cookie.evtype != XI_Motion) return;
+    
+    auto* event = static_cast<XIDeviceEvent*>(cookie.data);
+    queueMotion(static_cast<float>(event->event_x), static_cast<float>(event->event_y), event->time);
+    
+    // Scroll valuators are absolute; the delta since the last event divided
+    // by the increment gives detents, fractions included
+    double dx = 0.0, dy = 0.0;
+    const double* values = event->valuators.values;
+    for (int i = 0; i < event->valuators.mask_len * 8; ++i) {
+        if (!XIMaskIsSet(event->valuators.mask, i)) continue;
+        double value = *values++;
+        for (auto& valuator : scrollValuators) {
+            if (valuator.deviceId != event->sourceid || valuator.number != i) continue;
+            if (valuator.valid) {
+                double delta = (value - valuator.last) / valuator.increment;
+                if (valuator.type == XIScrollTypeVertical) {
+                    dy -= delta;
+                } else {
+                    dx += delta;
+                }
+            }
+            valuator.last = value;
+            valuator.valid = true;
         }
-        usleep(1000); // 1ms
     }
     
-    return "";
+    if (dx != 0.0 || dy != 0.0) {
+        flushMotion();
+        smoothScrollTime = event->time;
+        inputState.onMouseScroll(static_cast<float>(dx), static_cast<float>(dy), serverTime(event->time), event->sourceid);
+    }
+}
+#endif
+
+//=============================================================================
+// Clipboard
+//=============================================================================
+
+size_t Window::Impl::maxPropertyChunk() const {
+    // XMaxRequestSize is in 4-byte units; leave room for the request header
+    return static_cast<size_t>(XMaxRequestSize(display)) * 4 - 64;
+}
+
+void Window::Impl::requestClipboard(Atom target) {
+    Atom selection = clipboard;
+    if (XGetSelectionOwner(display, selection) == None) {
+        // Fall back to the PRIMARY selection
+        selection = XA_PRIMARY;
+        if (XGetSelectionOwner(display, selection) == None) {
+            finishClipboardRequest(false);
+            return;
+        }
+    }
+    
+    clipboardTarget = target;
+    clipboardIncr = false;
+    clipboardIncoming.clear();
+    clipboardActivity = ClipboardClock::now();
+    
+    XDeleteProperty(display, window, clipboardProperty);
+    XConvertSelection(display, selection, target, clipboardProperty, window, CurrentTime);
+    XFlush(display);
+}
+
+void Window::Impl::finishClipboardRequest(bool ok) {
+    std::string text;
+    if (ok) {
+        text = std::move(clipboardIncoming);
+        clipboardCache = text;
+    }
+    clipboardIncoming.clear();
+    clipboardIncr = false;
+    clipboardTarget = None;
+    
+    // Callbacks may issue a new request, so detach the waiters first
+    std::vector<Window::ClipboardCallback> waiters;
+    waiters.swap(clipboardWaiters);
+    for (auto& callback : waiters) {
+        if (callback) callback(text);
+    }
+}
+
+void Window::Impl::onSelectionNotify(const XSelectionEvent& notify) {
+    if (clipboardWaiters.empty() || notify.requestor != window) return;
+    
+    if (notify.property == None) {
+        // Owner refused UTF-8; older clients may still offer Latin-1 STRING
+        if (clipboardTarget == utf8String) {
+            requestClipboard(XA_STRING);
+        } else {
+            finishClipboardRequest(false);
+        }
+        return;
+    }
+    
+    Atom actualType;
+    int actualFormat;
+    unsigned long nitems, bytesAfter;
+    unsigned char* data = nullptr;
+    XGetWindowProperty(display, window, clipboardProperty,
+                      0, (~0L), True, AnyPropertyType,
+                      &actualType, &actualFormat, &nitems, &bytesAfter, &data);
+    
+    if (actualType == incr) {
+        // Deleting the INCR property (done above) tells the owner to start
+        // sending chunks, which arrive as PropertyNotify(NewValue)
+        if (data) XFree(data);
+        clipboardIncr = true;
+        clipboardActivity = ClipboardClock::now();
+        XFlush(display);
+        return;
+    }
+    
+    if (data) {
+        clipboardIncoming.assign(reinterpret_cast<char*>(data), nitems * (actualFormat / 8));
+        XFree(data);
+    }
+    finishClipboardRequest(true);
+}
+
+bool Window::Impl::onPropertyNotify(const XPropertyEvent& property) {
+    // Incoming INCR chunk on our own window
+    if (clipboardIncr && property.window == window &&
+        property.atom == clipboardProperty && property.state == PropertyNewValue) {
+        Atom actualType;
+        int actualFormat;
+        unsigned long nitems, bytesAfter;
+        unsigned char* data = nullptr;
+        XGetWindowProperty(display, window, clipboardProperty,
+                          0, (~0L), True, AnyPropertyType,
+                          &actualType, &actualFormat, &nitems, &bytesAfter, &data);
+        
+        size_t bytes = nitems * (actualFormat / 8);
+        if (data) {
+            clipboardIncoming.append(reinterpret_cast<char*>(data), bytes);
+            XFree(data);
+        }
+        clipboardActivity = ClipboardClock::now();
+        
+        // A zero-length chunk terminates the transfer
+        if (bytes == 0) {
+            finishClipboardRequest(true);
+        } else {
+            XFlush(display);
+        }
+        return true;
+    }
+    
+    // Requestor consumed our previous outgoing chunk
+    if (property.state == PropertyDelete) {
+        for (auto& send : clipboardSends) {
+            if (send.requestor == property.window && send.property == property.atom) {
+                sendClipboardChunk(send);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Window::Impl::sendClipboardChunk(ClipboardSend& send) {
+    size_t remaining = send.text->size() - send.offset;
+    size_t chunk = std::min(remaining, maxPropertyChunk());
+    
+    XErrorTrap trap(display);
+    XChangeProperty(display, send.requestor, send.property, send.type, 8, PropModeReplace,
+                    reinterpret_cast<const unsigned char*>(send.text->data() + send.offset),
+                    static_cast<int>(chunk));
+    // The requestor was destroyed mid-transfer
+    if (trap.finish()) {
+        endClipboardSend(send.requestor, send.property, false);
+        return;
+    }
+    send.offset += chunk;
+    send.lastActivity = ClipboardClock::now();
+    
+    // The zero-length chunk has been written: transfer complete
+    if (chunk == 0) {
+        endClipboardSend(send.requestor, send.property, true);
+    }
+    XFlush(display);
+}
+
+void Window::Impl::endClipboardSend(::Window requestor, Atom property, bool restoreMask) {
+    auto it = std::find_if(clipboardSends.begin(), clipboardSends.end(), [&](const ClipboardSend& s) {
+        return s.requestor == requestor && s.property == property;
+    });
+    if (it == clipboardSends.end()) return;
+    long mask = it->requestorMask;
+    clipboardSends.erase(it);
+    
+    // Give the requestor back the mask it had once its last transfer ends; it
+    // may be one of our own windows on the shared display
+    bool busy = std::any_of(clipboardSends.begin(), clipboardSends.end(),
+                            [&](const ClipboardSend& s) { return s.requestor == requestor; });
+    if (restoreMask && !busy) {
+        XErrorTrap trap(display);
+        XSelectInput(display, requestor, mask);
+    }
+}
+
+void Window::Impl::onSelectionRequest(const XSelectionRequestEvent& request) {
+    XSelectionEvent reply = {};
+    reply.type = SelectionNotify;
+    reply.display = request.display;
+    reply.requestor = request.requestor;
+    reply.selection = request.selection;
+    reply.target = request.target;
+    reply.time = request.time;
+    reply.property = None;
+    
+    // Obsolete clients pass None and expect the target as property name
+    Atom property = request.property != None ? request.property : request.target;
+    
+    // Every request below goes to the requestor, which may vanish at any time
+    XErrorTrap trap(display);
+    bool startedIncr = false;
+    if (ownsClipboard && clipboardText && request.selection == clipboard) {
+        if (request.target == targets) {
+            Atom supported[] = { targets, utf8String, XA_STRING };
+            XChangeProperty(display, request.requestor, property, XA_ATOM, 32, PropModeReplace,
+                            reinterpret_cast<unsigned char*>(supported), 3);
+            reply.property = property;
+        } else if (request.target == utf8String || request.target == XA_STRING) {
+            const std::string& text = *clipboardText;
+            if (text.size() > maxPropertyChunk()) {
+                // Announce an INCR transfer; chunks follow as the requestor
+                // deletes the property. Add PropertyChangeMask to whatever we
+                // already select on the requestor rather than replacing it
+                long requestorMask = NoEventMask;
+                auto running = std::find_if(clipboardSends.begin(), clipboardSends.end(),
+                    [&](const ClipboardSend& s) { return s.requestor == request.requestor; });
+                if (running != clipboardSends.end()) {
+                    requestorMask = running->requestorMask;
+                } else {
+                    XWindowAttributes attributes;
+                    if (XGetWindowAttributes(display, request.requestor, &attributes)) {
+                        requestorMask = attributes.your_event_mask;
+                    }
+                }
+                XSelectInput(display, request.requestor, requestorMask | PropertyChangeMask);
+                long size = static_cast<long>(text.size());
+                XChangeProperty(display, request.requestor, property, incr, 32, PropModeReplace,
+                                reinterpret_cast<unsigned char*>(&size), 1);
+                
+                ClipboardSend send;
+                send.requestor = request.requestor;
+                send.property = property;
+                send.type = request.target;
+                send.text = clipboardText;
+                send.requestorMask = requestorMask;
+                send.lastActivity = ClipboardClock::now();
+                clipboardSends.push_back(std::move(send));
+                startedIncr = true;
+            } else {
+                XChangeProperty(display, request.requestor, property, request.target, 8, PropModeReplace,
+                                reinterpret_cast<const unsigned char*>(text.data()),
+                                static_cast<int>(text.size()));
+            }
+            reply.property = property;
+        }
+    }
+    
+    XSendEvent(display, request.requestor, False, NoEventMask, reinterpret_cast<XEvent*>(&reply));
+    if (trap.finish() && startedIncr) {
+        endClipboardSend(request.requestor, property, false);
+    }
+}
+
+void Window::Impl::expireClipboardTransfers() {
+    auto now = ClipboardClock::now();
+    auto expired = [&](ClipboardClock::time_point since) {
+        return std::chrono::duration<double>(now - since).count() > CLIPBOARD_TIMEOUT;
+    };
+    
+    if (!clipboardWaiters.empty() && expired(clipboardActivity)) {
+        finishClipboardRequest(false);
+    }
+    
+    // Drop outgoing transfers whose requestor stopped reading
+    std::vector<std::pair<::Window, Atom>> stale;
+    for (const auto& send : clipboardSends) {
+        if (expired(send.lastActivity)) stale.emplace_back(send.requestor, send.property);
+    }
+    for (const auto& [requestor, property] : stale) {
+        // A requestor that stopped reading may be gone; restoring its mask is
+        // trapped, so a BadWindow is harmless
+        endClipboardSend(requestor, property, true);
+    }
+}
+
+std::string Window::getClipboardText() {
+    if (m_impl->ownsClipboard && m_impl->clipboardText) {
+        return *m_impl->clipboardText;
+    }
+    
+    // Never block on another client: return the last received contents and
+    // refresh them in the background
+    if (m_impl->clipboardWaiters.empty()) {
+        m_impl->clipboardWaiters.push_back(nullptr);
+        m_impl->requestClipboard(m_impl->utf8String);
+    }
+    return m_impl->clipboardCache;
+}
+
+void Window::requestClipboardText(ClipboardCallback callback) {
+    if (m_impl->ownsClipboard && m_impl->clipboardText) {
+        callback(*m_impl->clipboardText);
+        return;
+    }
+    
+    // Requests issued while a transfer is in flight share its result
+    bool idle = m_impl->clipboardWaiters.empty();
+    m_impl->clipboardWaiters.push_back(std::move(callback));
+    if (idle) {
+        m_impl->requestClipboard(m_impl->utf8String);
+    }
 }
 
 void Window::setClipboardText(const std::string& text) {
-    // Store text locally and claim ownership
-    static std::string s_clipboardText;
-    s_clipboardText = text;
+    // Keep a snapshot; running INCR transfers hold on to the previous one
+    m_impl->clipboardText = std::make_shared<const std::string>(text);
     
     XSetSelectionOwner(m_impl->display, m_impl->clipboard, m_impl->window, CurrentTime);
+    m_impl->ownsClipboard = XGetSelectionOwner(m_impl->display, m_impl->clipboard) == m_impl->window;
     XFlush(m_impl->display);
 }
 
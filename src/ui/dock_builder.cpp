@@ -61,12 +61,9 @@ DockNode::Id DockBuilder::SplitNode(Context& ctx,
     DockNode::Id childId0 = docking.generateNodeId();
     DockNode::Id childId1 = docking.generateNodeId();
     
-    DockNode* newNode = node->splitNode(direction, childId0, childId1, sizeRatio);
-    if (newNode) {
-        docking.refreshMappings(nodeId);
-        return newNode->id;
-    }
-    return DockNode::INVALID_ID;
+    DockTree* tree = node->tree;
+    const DockNode* newNode = tree->node(node->splitNode(direction, childId0, childId1, sizeRatio));
+    return newNode ? newNode->id : DockNode::INVALID_ID;
 }
 
 void DockBuilder::DockWindow(Context& ctx, const std::string& windowId, DockNode::Id nodeId) {
@@ -105,25 +102,30 @@ DockNode::Id DockBuilder::GetNode(Context& ctx, DockNode::Id parentId, DockDirec
         childIdx = (direction == DockDirection::Bottom) ? 1 : 0;
     }
     
-    return parent->children[childIdx] ? parent->children[childIdx]->id : DockNode::INVALID_ID;
+    DockNode* child = parent->child(childIdx);
+    return child ? child->id : DockNode::INVALID_ID;
 }
 
 void DockBuilder::ClearDockSpace(Context& ctx, DockNode::Id dockspaceId) {
     auto& docking = ctx.docking();
     DockNode* root = docking.getDockNode(dockspaceId);
     
-    if (root) {
-        // Clear all windows and children
-        root->forEachLeaf([&docking](DockNode* leaf) {
-            for (auto winId : leaf->dockedWindows) {
-                docking.undockWindow(winId);
-            }
+    if (root && root->tree) {
+        // Collect first: undocking merges nodes and recycles their slots
+        std::vector<WidgetId> windows;
+        root->forEachLeaf([&windows](DockNode* leaf) {
+            windows.insert(windows.end(), leaf->dockedWindows.begin(), leaf->dockedWindows.end());
         });
         
-        root->children[0].reset();
-        root->children[1].reset();
-        root->type = DockNodeType::Leaf;
-        root->dockedWindows.clear();
+        DockTree* tree = root->tree;
+        for (auto winId : windows) {
+            docking.undockWindow(winId);
+        }
+        
+        // Clear remaining children (the node may have moved while merging)
+        if (DockNode* node = tree->findNode(dockspaceId)) {
+            tree->reset(node->index);
+        }
     }
 }
 
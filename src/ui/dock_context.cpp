@@ -1,8 +1,11 @@
 #include "fastener/ui/dock_context.h"
 #include "fastener/core/context.h"
 #include "fastener/core/input.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include <unordered_map>
-#include <sstream>
+#include <unordered_set>
 
 namespace fst {
 
@@ -11,18 +14,19 @@ namespace fst {
 //=============================================================================
 
 struct DockContext::Impl {
-    // Dock spaces indexed by string ID
-    std::unordered_map<std::string, std::unique_ptr<DockNode>> dockSpaces;
+    // Dock spaces indexed by string ID; each tree caches its own layout
+    // and window-to-node mapping
+    std::unordered_map<std::string, std::unique_ptr<DockTree>> dockSpaces;
     
     // String ID to node ID mapping
     std::unordered_map<std::string, DockNode::Id> dockSpaceIds;
     
-    // Window to node mapping for quick lookups
-    std::unordered_map<WidgetId, DockNode::Id> windowToNode;
-    
     // Window titles for UI
     std::unordered_map<WidgetId, std::string> windowTitles;
     
+    // Last known floating rects, persisted with the layout
+    std::unordered_map<WidgetId, Rect> floatingRects;
+    
     // Drag state
     DragState dragState;
     
@@ -32,6 +36,24 @@ struct DockContext::Impl {
     DockNode::Id generateId() {
         return nextNodeId++;
     }
+    
+    DockTree* findTree(DockNode::Id nodeId) {
+        for (auto& [name, tree] : dockSpaces) {
+            if (tree->findNode(nodeId)) {
+                return tree.get();
+            }
+        }
+        return nullptr;
+    }
+    
+    DockNode* findWindow(WidgetId windowId) {
+        for (auto& [name, tree] : dockSpaces) {
+            if (DockNode* node = tree->findWindow(windowId)) {
+                return node;
+            }
+        }
+        return nullptr;
+    }
 };
 
 //=============================================================================
@@ -49,37 +71,37 @@ DockNode::Id DockContext::createDockSpace(const std::string& id, const Rect& bou
     auto it = m_impl->dockSpaces.find(id);
     
     if (it != m_impl->dockSpaces.end()) {
-        // Existing dock space - update bounds
-        it->second->bounds = bounds;
-        it->second->updateLayout(bounds);
-        return it->second->id;
+        // Existing dock space - relayout only if bounds or splits changed
+        it->second->setBounds(bounds);
+        it->second->updateLayout();
+        return it->second->root().id;
     }
     
     // Create new dock space
     auto nodeId = m_impl->generateId();
-    auto node = std::make_unique<DockNode>(nodeId);
-    node->type = DockNodeType::Leaf;
-    node->bounds = bounds;
+    auto tree = std::make_unique<DockTree>(nodeId);
+    tree->setBounds(bounds);
+    tree->updateLayout();
     
     m_impl->dockSpaceIds[id] = nodeId;
-    m_impl->dockSpaces[id] = std::move(node);
+    m_impl->dockSpaces[id] = std::move(tree);
     
     return nodeId;
 }
 
 DockNode* DockContext::getDockSpace(const std::string& id) {
     auto it = m_impl->dockSpaces.find(id);
-    return it != m_impl->dockSpaces.end() ? it->second.get() : nullptr;
+    return it != m_impl->dockSpaces.end() ? &it->second->root() : nullptr;
 }
 
 const DockNode* DockContext::getDockSpace(const std::string& id) const {
     auto it = m_impl->dockSpaces.find(id);
-    return it != m_impl->dockSpaces.end() ? it->second.get() : nullptr;
+    return it != m_impl->dockSpaces.end() ? &it->second->root() : nullptr;
 }
 
 DockNode* DockContext::getDockNode(DockNode::Id nodeId) {
-    for (auto& [name, root] : m_impl->dockSpaces) {
-        if (auto* found = root->findNodeById(nodeId)) {
+    for (auto& [name, tree] : m_impl->dockSpaces) {
+        if (auto* found = tree->findNode(nodeId)) {
             return found;
         }
     }
@@ -93,13 +115,7 @@ const DockNode* DockContext::getDockNode(DockNode::Id nodeId) const {
 void DockContext::removeDockSpace(const std::string& id) {
     auto it = m_impl->dockSpaces.find(id);
     if (it != m_impl->dockSpaces.end()) {
-        // Remove all window mappings for this dock space
-        it->second->forEachLeaf([this](DockNode* leaf) {
-            for (auto winId : leaf->dockedWindows) {
-                m_impl->windowToNode.erase(winId);
-            }
-        });
-        
+        // Window mappings are owned by the tree and go away with it
         m_impl->dockSpaceIds.erase(id);
         m_impl->dockSpaces.erase(it);
     }
@@ -122,85 +138,59 @@ void DockContext::dockWindow(WidgetId windowId, DockNode::Id targetNodeId,
     if (direction == DockDirection::Center || direction == DockDirection::None) {
         // Tab docking - add to existing node
         targetNode->addWindow(windowId);
-        m_impl->windowToNode[windowId] = targetNode->id;
     } else {
         // Split docking - create new split
         DockNode::Id childId0 = generateNodeId();
         DockNode::Id childId1 = generateNodeId();
-        DockNode* newNode = targetNode->splitNode(direction, childId0, childId1);
-        if (newNode) {
+        DockTree* tree = targetNode->tree;
+        if (DockNode* newNode = tree->node(targetNode->splitNode(direction, childId0, childId1))) {
             newNode->addWindow(windowId);
-            m_impl->windowToNode[windowId] = newNode->id;
-            
-            // Also refresh mappings for the targetNode (which now has children)
-            refreshMappings(targetNodeId);
         }
     }
 }
 
 void DockContext::undockWindow(WidgetId windowId) {
-    auto it = m_impl->windowToNode.find(windowId);
-    if (it == m_impl->windowToNode.end()) {
+    DockNode* node = m_impl->findWindow(windowId);
+    if (!node) {
         return;
     }
     
-    DockNode::Id nodeId = it->second;
-    m_impl->windowToNode.erase(it); // Erase first to avoid using invalid iterator
-
-    DockNode* node = getDockNode(nodeId);
-    if (node) {
-        node->removeWindow(windowId);
+    DockTree* tree = node->tree;
+    node->removeWindow(windowId);
+    
+    // Merge parents while the current node is empty; merging recycles
+    // slots, so walk by index rather than by pointer
+    DockNode::Index currentIndex = node->index;
+    while (DockNode* current = tree->node(currentIndex)) {
+        if (!current->isEmpty() || current->isRootNode()) break;
         
-        // Merge parent if this node is now empty
-        DockNode::Id currentId = nodeId;
-        while (currentId != DockNode::INVALID_ID) {
-            DockNode* current = getDockNode(currentId);
-            if (!current || !current->isEmpty() || !current->parent) break;
-            
-            DockNode* parent = current->parent;
-            DockNode::Id parentId = parent->id;
-            
-            parent->mergeNodes();
-            refreshMappings(parentId);
-            currentId = parentId;
-        }
+        DockNode::Index parentIndex = current->parentIndex;
+        tree->merge(parentIndex);
+        currentIndex = parentIndex;
     }
 }
 
 void DockContext::refreshMappings(DockNode::Id nodeId) {
+    // Mappings are cached per tree and rebuilt lazily on the next lookup;
+    // this only forces that for trees edited behind the tree's back.
     if (nodeId == DockNode::INVALID_ID) {
-        // Refresh all dock spaces
-        for (auto& [name, root] : m_impl->dockSpaces) {
-            refreshMappings(root->id);
+        for (auto& [name, tree] : m_impl->dockSpaces) {
+            tree->markStructureDirty();
         }
         return;
     }
-
-    DockNode* node = getDockNode(nodeId);
-    if (!node) return;
-
-    // Update mappings for this node
-    for (auto winId : node->dockedWindows) {
-        m_impl->windowToNode[winId] = node->id;
-    }
-
-    // Recursively update children
-    if (node->isSplitNode()) {
-        if (node->children[0]) refreshMappings(node->children[0]->id);
-        if (node->children[1]) refreshMappings(node->children[1]->id);
+    
+    if (DockTree* tree = m_impl->findTree(nodeId)) {
+        tree->markStructureDirty();
     }
 }
 
 bool DockContext::isWindowDocked(WidgetId windowId) const {
-    return m_impl->windowToNode.find(windowId) != m_impl->windowToNode.end();
+    return m_impl->findWindow(windowId) != nullptr;
 }
 
 DockNode* DockContext::getWindowDockNode(WidgetId windowId) {
-    auto it = m_impl->windowToNode.find(windowId);
-    if (it != m_impl->windowToNode.end()) {
-        return getDockNode(it->second);
-    }
-    return nullptr;
+    return m_impl->findWindow(windowId);
 }
 
 void DockContext::setWindowTitle(WidgetId windowId, const std::string& title) {
@@ -215,6 +205,19 @@ std::string DockContext::getWindowTitle(WidgetId windowId) const {
     return "Window";
 }
 
+void DockContext::setFloatingRect(WidgetId windowId, const Rect& rect) {
+    m_impl->floatingRects[windowId] = rect;
+}
+
+bool DockContext::getFloatingRect(WidgetId windowId, Rect& outRect) const {
+    auto it = m_impl->floatingRects.find(windowId);
+    if (it == m_impl->floatingRects.end()) {
+        return false;
+    }
+    outRect = it->second;
+    return true;
+}
+
 const DockNode* DockContext::getWindowDockNode(WidgetId windowId) const {
     return const_cast<DockContext*>(this)->getWindowDockNode(windowId);
 }
@@ -249,8 +252,9 @@ void DockContext::updateDrag(const Vec2& mousePos, DockNode* /*hoveredNode*/,
     m_impl->dragState.hoveredNodeId = DockNode::INVALID_ID;
     m_impl->dragState.hoveredDirection = DockDirection::None;
     
-    for (auto& [name, root] : m_impl->dockSpaces) {
-        root->forEachLeaf([&](DockNode* leaf) {
+    for (auto& [name, tree] : m_impl->dockSpaces) {
+        for (DockNode::Index leafIndex : tree->leaves()) {
+            DockNode* leaf = tree->node(leafIndex);
             if (leaf->bounds.contains(mousePos)) {
                 m_impl->dragState.hoveredNodeId = leaf->id;
                 
@@ -265,7 +269,7 @@ void DockContext::updateDrag(const Vec2& mousePos, DockNode* /*hoveredNode*/,
                 else if (relY > 1.0f - t) m_impl->dragState.hoveredDirection = DockDirection::Bottom;
                 else m_impl->dragState.hoveredDirection = DockDirection::Center;
             }
-        });
+        }
         if (m_impl->dragState.hoveredNodeId != DockNode::INVALID_ID) break;
     }
 }
@@ -294,9 +298,9 @@ void DockContext::endDrag(bool commit) {
 void DockContext::beginFrame(Context& ctx) {
     auto& input = ctx.input();
     
-    // Update layouts for all dock spaces
-    for (auto& [name, root] : m_impl->dockSpaces) {
-        root->updateLayout(root->bounds);
+    // Relayout dock spaces whose bounds, splits or structure changed
+    for (auto& [name, tree] : m_impl->dockSpaces) {
+        tree->updateLayout();
     }
 
     // Update drag state if active
@@ -311,13 +315,9 @@ void DockContext::beginFrame(Context& ctx) {
 }
 
 void DockContext::endFrame() {
-    // Cleanup empty nodes
-    for (auto& [name, root] : m_impl->dockSpaces) {
-        root->forEachNode([](DockNode* node) {
-            if (node->isSplitNode()) {
-                node->mergeNodes();
-            }
-        });
+    // Cleanup empty nodes (only after windows were removed)
+    for (auto& [name, tree] : m_impl->dockSpaces) {
+        tree->collapseEmptyNodes();
     }
 }
 
@@ -325,23 +325,296 @@ void DockContext::endFrame() {
 // Persistence
 //=============================================================================
 
+// Binary layout format (all integers little-endian):
+//
+//   header    "FSTD" u16 version u16 reserved u32 nextNodeId
+//   spaces    u32 count, then per space:
+//               str name, rect bounds, u32 nodeCount, nodes in pre-order
+//   node      u32 id u8 type u8 flags f32 splitRatio i32 selectedTab
+//             u32 windowCount u64 windowIds[windowCount]
+//   floating  u32 count, then per window: u64 id, rect bounds
+//
+// Pre-order lets the reader attach every node to the innermost split that
+// still has a free child slot, so the tree is rebuilt in one pass.
+
+namespace {
+
+constexpr char LAYOUT_MAGIC[4] = {'F', 'S', 'T', 'D'};
+constexpr size_t MIN_NODE_RECORD_SIZE = 4 + 1 + 1 + 4 + 4 + 4;
+
+class LayoutWriter {
+public:
+    void u8(uint8_t v) { m_out.push_back(static_cast<char>(v)); }
+    void u16(uint16_t v) { write(v, 2); }
+    void u32(uint32_t v) { write(v, 4); }
+    void u64(uint64_t v) { write(v, 8); }
+    void f32(float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u32(bits);
+    }
+    void str(const std::string& v) {
+        u32(static_cast<uint32_t>(v.size()));
+        m_out.append(v);
+    }
+    void rect(const Rect& r) {
+        f32(r.x()); f32(r.y()); f32(r.width()); f32(r.height());
+    }
+    void bytes(const char* data, size_t size) { m_out.append(data, size); }
+    
+    std::string take() { return std::move(m_out); }
+    
+private:
+    void write(uint64_t v, int size) {
+        for (int i = 0; i < size; ++i) {
+            u8(static_cast<uint8_t>(v >> (8 * i)));
+        }
+    }
+    
+    std::string m_out;
+};
+
+// Reads past the end yield zeroes and mark the reader as failed
+class LayoutReader {
+public:
+    explicit LayoutReader(const std::string& data) : m_data(data) {}
+    
+    uint8_t u8() { return static_cast<uint8_t>(read(1)); }
+    uint16_t u16() { return static_cast<uint16_t>(read(2)); }
+    uint32_t u32() { return static_cast<uint32_t>(read(4)); }
+    uint64_t u64() { return read(8); }
+    float f32() {
+        uint32_t bits = u32();
+        float v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    std::string str() {
+        uint32_t size = u32();
+        if (size > remaining()) {
+            m_failed = true;
+            return {};
+        }
+        std::string v = m_data.substr(m_pos, size);
+        m_pos += size;
+        return v;
+    }
+    Rect rect() {
+        float x = f32(), y = f32(), w = f32(), h = f32();
+        return Rect(x, y, w, h);
+    }
+    bool expect(const char* data, size_t size) {
+        if (size > remaining() || m_data.compare(m_pos, size, data, size) != 0) {
+            m_failed = true;
+            return false;
+        }
+        m_pos += size;
+        return true;
+    }
+    
+    size_t remaining() const { return m_data.size() - m_pos; }
+    bool failed() const { return m_failed; }
+    
+private:
+    uint64_t read(int size) {
+        if (m_failed || static_cast<size_t>(size) > remaining()) {
+            m_failed = true;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < size; ++i) {
+            v |= static_cast<uint64_t>(static_cast<uint8_t>(m_data[m_pos + i])) << (8 * i);
+        }
+        m_pos += size;
+        return v;
+    }
+    
+    const std::string& m_data;
+    size_t m_pos = 0;
+    bool m_failed = false;
+};
+
+uint8_t packFlags(const DockNodeFlags& flags) {
+    return static_cast<uint8_t>((flags.noSplit ? 1 : 0) |
+                                (flags.noResize ? 2 : 0) |
+                                (flags.noTabBar ? 4 : 0) |
+                                (flags.keepAliveOnly ? 8 : 0) |
+                                (flags.passthruCentralNode ? 16 : 0));
+}
+
+DockNodeFlags unpackFlags(uint8_t bits) {
+    DockNodeFlags flags;
+    flags.noSplit = (bits & 1) != 0;
+    flags.noResize = (bits & 2) != 0;
+    flags.noTabBar = (bits & 4) != 0;
+    flags.keepAliveOnly = (bits & 8) != 0;
+    flags.passthruCentralNode = (bits & 16) != 0;
+    return flags;
+}
+
+} // namespace
+
 std::string DockContext::serializeLayout() const {
-    std::stringstream ss;
+    LayoutWriter out;
+    out.bytes(LAYOUT_MAGIC, sizeof(LAYOUT_MAGIC));
+    out.u16(LAYOUT_FORMAT_VERSION);
+    out.u16(0);
+    out.u32(m_impl->nextNodeId);
+    
+    // Sorted so identical layouts produce identical bytes
+    std::vector<const std::string*> names;
+    names.reserve(m_impl->dockSpaces.size());
+    for (const auto& [name, tree] : m_impl->dockSpaces) {
+        names.push_back(&name);
+    }
+    std::sort(names.begin(), names.end(), [](const std::string* a, const std::string* b) { return *a < *b; });
     
-    for (const auto& [name, root] : m_impl->dockSpaces) {
-        ss << "[DockSpace:" << name << "]\n";
-        ss << root->debugPrint();
-        ss << "\n";
+    out.u32(static_cast<uint32_t>(names.size()));
+    for (const std::string* name : names) {
+        DockTree& tree = *m_impl->dockSpaces.at(*name);
+        out.str(*name);
+        out.rect(tree.bounds());
+        out.u32(static_cast<uint32_t>(tree.nodeCount()));
+        
+        tree.root().forEachNode([&out](DockNode* node) {
+            out.u32(node->id);
+            out.u8(static_cast<uint8_t>(node->type));
+            out.u8(packFlags(node->flags));
+            out.f32(node->splitRatio());
+            out.u32(static_cast<uint32_t>(node->selectedTabIndex));
+            out.u32(static_cast<uint32_t>(node->dockedWindows.size()));
+            for (WidgetId windowId : node->dockedWindows) {
+                out.u64(windowId);
+            }
+        });
     }
     
-    return ss.str();
+    std::vector<std::pair<WidgetId, Rect>> floating(m_impl->floatingRects.begin(), m_impl->floatingRects.end());
+    std::sort(floating.begin(), floating.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    
+    out.u32(static_cast<uint32_t>(floating.size()));
+    for (const auto& [windowId, rect] : floating) {
+        out.u64(windowId);
+        out.rect(rect);
+    }
+    
+    return out.take();
 }
 
 bool DockContext::deserializeLayout(const std::string& data) {
-    // TODO: Implement proper deserialization
-    // For now, this is a placeholder
-    (void)data;
-    return false;
+    LayoutReader in(data);
+    if (!in.expect(LAYOUT_MAGIC, sizeof(LAYOUT_MAGIC))) {
+        return false;
+    }
+    
+    uint16_t version = in.u16();
+    in.u16();  // Reserved
+    DockNode::Id nextNodeId = in.u32();
+    if (in.failed() || version == 0 || version > LAYOUT_FORMAT_VERSION) {
+        return false;
+    }
+    
+    // Build into locals so a malformed blob leaves the current layout intact
+    std::unordered_map<std::string, std::unique_ptr<DockTree>> dockSpaces;
+    std::unordered_map<std::string, DockNode::Id> dockSpaceIds;
+    std::unordered_set<DockNode::Id> seenNodes;
+    std::unordered_set<WidgetId> seenWindows;
+    
+    uint32_t spaceCount = in.u32();
+    for (uint32_t s = 0; s < spaceCount && !in.failed(); ++s) {
+        std::string name = in.str();
+        Rect bounds = in.rect();
+        uint32_t nodeCount = in.u32();
+        if (in.failed() || nodeCount == 0 || nodeCount > in.remaining() / MIN_NODE_RECORD_SIZE ||
+            dockSpaces.count(name)) {
+            return false;
+        }
+        
+        std::unique_ptr<DockTree> tree;
+        std::vector<DockNode::Index> openSplits;  // Splits still missing a child
+        
+        for (uint32_t i = 0; i < nodeCount; ++i) {
+            DockNode::Id id = in.u32();
+            uint8_t type = in.u8();
+            uint8_t flags = in.u8();
+            float splitRatio = in.f32();
+            int selectedTab = static_cast<int32_t>(in.u32());
+            uint32_t windowCount = in.u32();
+            // The largest id would wrap nextNodeId back to INVALID_ID
+            if (in.failed() || id == DockNode::INVALID_ID || id == std::numeric_limits<DockNode::Id>::max() ||
+                !seenNodes.insert(id).second ||
+                type > static_cast<uint8_t>(DockNodeType::Leaf) ||
+                windowCount > in.remaining() / sizeof(WidgetId)) {
+                return false;
+            }
+            
+            DockNode* node = nullptr;
+            if (i == 0) {
+                tree = std::make_unique<DockTree>(id);
+                node = &tree->root();
+            } else {
+                if (openSplits.empty()) {
+                    return false;
+                }
+                DockNode::Index parentIndex = openSplits.back();
+                int slot = tree->node(parentIndex)->childIndices[0] == DockNode::NO_INDEX ? 0 : 1;
+                if (slot == 1) {
+                    openSplits.pop_back();
+                }
+                node = tree->attach(parentIndex, slot, id);
+            }
+            
+            node->type = static_cast<DockNodeType>(type);
+            node->flags = unpackFlags(flags);
+            node->setSplitRatio(splitRatio);
+            node->dockedWindows.reserve(windowCount);
+            for (uint32_t w = 0; w < windowCount; ++w) {
+                WidgetId windowId = in.u64();
+                if (!seenWindows.insert(windowId).second) {
+                    return false;
+                }
+                node->dockedWindows.push_back(windowId);
+            }
+            node->selectedTabIndex = std::clamp(selectedTab, 0, std::max(0, static_cast<int>(windowCount) - 1));
+            
+            if (node->isSplitNode()) {
+                if (windowCount > 0) {
+                    return false;
+                }
+                openSplits.push_back(node->index);
+            }
+            nextNodeId = std::max(nextNodeId, id + 1);
+        }
+        
+        if (in.failed() || !openSplits.empty()) {
+            return false;
+        }
+        
+        tree->setBounds(bounds);
+        tree->updateLayout();
+        dockSpaceIds[name] = tree->root().id;
+        dockSpaces[name] = std::move(tree);
+    }
+    
+    std::unordered_map<WidgetId, Rect> floatingRects;
+    uint32_t floatingCount = in.u32();
+    if (in.failed() || floatingCount > in.remaining() / (sizeof(WidgetId) + 4 * sizeof(float))) {
+        return false;
+    }
+    for (uint32_t i = 0; i < floatingCount; ++i) {
+        WidgetId windowId = in.u64();
+        floatingRects[windowId] = in.rect();
+    }
+    if (in.failed()) {
+        return false;
+    }
+    
+    m_impl->dockSpaces = std::move(dockSpaces);
+    m_impl->dockSpaceIds = std::move(dockSpaceIds);
+    m_impl->floatingRects = std::move(floatingRects);
+    m_impl->nextNodeId = std::max(m_impl->nextNodeId, nextNodeId);
+    m_impl->dragState = DragState{};
+    return true;
 }
 
 //=============================================================================
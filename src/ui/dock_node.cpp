@@ -1,5 +1,6 @@
 #include "fastener/ui/dock_node.h"
 #include <algorithm>
+#include <cmath>
 #include <sstream>
 
 namespace fst {
@@ -17,8 +18,8 @@ DockNode* DockNode::findNodeByWindowId(WidgetId windowId) {
     
     // Check children
     for (int i = 0; i < 2; ++i) {
-        if (children[i]) {
-            DockNode* found = children[i]->findNodeByWindowId(windowId);
+        if (DockNode* c = child(i)) {
+            DockNode* found = c->findNodeByWindowId(windowId);
             if (found) {
                 return found;
             }
@@ -38,8 +39,8 @@ DockNode* DockNode::findNodeById(Id nodeId) {
     }
     
     for (int i = 0; i < 2; ++i) {
-        if (children[i]) {
-            DockNode* found = children[i]->findNodeById(nodeId);
+        if (DockNode* c = child(i)) {
+            DockNode* found = c->findNodeById(nodeId);
             if (found) {
                 return found;
             }
@@ -63,6 +64,9 @@ void DockNode::addWindow(WidgetId windowId) {
         if (type == DockNodeType::Unknown || type == DockNodeType::Leaf) {
             type = dockedWindows.size() > 1 ? DockNodeType::TabContainer : DockNodeType::Leaf;
         }
+        if (tree) {
+            tree->markStructureDirty();
+        }
     }
 }
 
@@ -85,6 +89,11 @@ void DockNode::removeWindow(WidgetId windowId) {
         } else if (dockedWindows.size() == 1) {
             type = DockNodeType::Leaf;
         }
+        
+        if (tree) {
+            tree->markStructureDirty();
+            tree->m_needsCollapse = true;
+        }
     }
 }
 
@@ -96,107 +105,17 @@ bool DockNode::hasWindow(WidgetId windowId) const {
 // Split operations
 //=============================================================================
 
-
-
-DockNode* DockNode::splitNode(DockDirection direction, Id childId0, Id childId1, float ratio) {
-    if (direction == DockDirection::None || direction == DockDirection::Center) {
-        return nullptr;
+DockNode::Index DockNode::splitNode(DockDirection direction, Id childId0, Id childId1, float ratio) {
+    if (!tree) {
+        return NO_INDEX;
     }
-    
-    // Create two new child nodes
-    auto newChild0 = std::make_unique<DockNode>(childId0);
-    auto newChild1 = std::make_unique<DockNode>(childId1);
-    
-    newChild0->parent = this;
-    newChild1->parent = this;
-    
-    // Move current contents to appropriate child
-    DockNode* existingContent = nullptr;
-    DockNode* newContent = nullptr;
-    
-    if (direction == DockDirection::Left || direction == DockDirection::Top) {
-        existingContent = newChild1.get();  // Existing goes to right/bottom
-        newContent = newChild0.get();       // New goes to left/top
-        splitRatio = ratio;
-    } else {
-        existingContent = newChild0.get();  // Existing goes to left/top
-        newContent = newChild1.get();       // New goes to right/bottom
-        splitRatio = 1.0f - ratio;
-    }
-    
-    // Transfer windows to existing content child
-    existingContent->dockedWindows = std::move(dockedWindows);
-    existingContent->selectedTabIndex = selectedTabIndex;
-    existingContent->type = existingContent->dockedWindows.size() > 1 
-        ? DockNodeType::TabContainer 
-        : DockNodeType::Leaf;
-    
-    // Clear this node's windows
-    dockedWindows.clear();
-    selectedTabIndex = 0;
-    
-    // Set new content as empty leaf
-    newContent->type = DockNodeType::Leaf;
-    
-    // Set this node as split
-    type = (direction == DockDirection::Left || direction == DockDirection::Right) 
-        ? DockNodeType::SplitHorizontal 
-        : DockNodeType::SplitVertical;
-    
-    children[0] = std::move(newChild0);
-    children[1] = std::move(newChild1);
-    
-    return newContent;
+    // May reallocate the node array; `this` must not be used afterwards
+    return tree->split(index, direction, childId0, childId1, ratio);
 }
 
 void DockNode::mergeNodes() {
-    // Only merge if this is a split node with one empty child
-    if (!isSplitNode()) {
-        return;
-    }
-    
-    DockNode* nonEmptyChild = nullptr;
-    int emptyCount = 0;
-    
-    for (int i = 0; i < 2; ++i) {
-        if (children[i] && children[i]->isEmpty()) {
-            emptyCount++;
-        } else if (children[i]) {
-            nonEmptyChild = children[i].get();
-        }
-    }
-    
-    // If one child is empty, absorb the non-empty child's contents
-    if (emptyCount == 1 && nonEmptyChild) {
-        // Move data into local variables first to avoid use-after-free
-        // when children pointers are reset
-        auto childWindows = std::move(nonEmptyChild->dockedWindows);
-        int childSelected = nonEmptyChild->selectedTabIndex;
-        DockNodeType childType = nonEmptyChild->type;
-        auto grandchild0 = std::move(nonEmptyChild->children[0]);
-        auto grandchild1 = std::move(nonEmptyChild->children[1]);
-        
-        // Reset children - this destroys nonEmptyChild
-        children[0].reset();
-        children[1].reset();
-        
-        // Apply to self
-        dockedWindows = std::move(childWindows);
-        selectedTabIndex = childSelected;
-        type = childType;
-        children[0] = std::move(grandchild0);
-        children[1] = std::move(grandchild1);
-        
-        // Update parent pointers for grandchildren
-        if (children[0]) children[0]->parent = this;
-        if (children[1]) children[1]->parent = this;
-    }
-    
-    // If both children are empty, become an empty leaf
-    if (emptyCount == 2) {
-        type = DockNodeType::Leaf;
-        children[0].reset();
-        children[1].reset();
+    if (tree) {
+        tree->merge(index);
     }
 }
 
@@ -204,6 +123,23 @@ void DockNode::mergeNodes() {
 // Layout calculation
 //=============================================================================
 
+// NaN passes through std::clamp, so non-finite ratios fall back to an even split
+static float validRatio(float ratio) {
+    return std::isfinite(ratio) ? std::clamp(ratio, 0.0f, 1.0f) : 0.5f;
+}
+
+bool DockNode::setSplitRatio(float ratio) {
+    ratio = validRatio(ratio);
+    if (ratio == m_splitRatio) {
+        return false;
+    }
+    m_splitRatio = ratio;
+    if (tree) {
+        tree->markLayoutDirty();
+    }
+    return true;
+}
+
 void DockNode::updateLayout(const Rect& availableBounds) {
     bounds = availableBounds;
     
@@ -215,11 +151,11 @@ void DockNode::updateLayout(const Rect& availableBounds) {
     Rect child0Bounds = getChildBounds(0);
     Rect child1Bounds = getChildBounds(1);
     
-    if (children[0]) {
-        children[0]->updateLayout(child0Bounds);
+    if (DockNode* c = child(0)) {
+        c->updateLayout(child0Bounds);
     }
-    if (children[1]) {
-        children[1]->updateLayout(child1Bounds);
+    if (DockNode* c = child(1)) {
+        c->updateLayout(child1Bounds);
     }
 }
 
@@ -232,12 +168,12 @@ Rect DockNode::getChildBounds(int childIndex) const {
     
     if (type == DockNodeType::SplitHorizontal) {
         // Left-right split
-        float splitX = bounds.x() + bounds.width() * splitRatio;
+        float splitX = bounds.x() + bounds.width() * m_splitRatio;
         
         if (childIndex == 0) {
             // Left child
-            return Rect(bounds.x(), bounds.y(), 
-                       splitX - bounds.x() - splitterSize * 0.5f, 
+            return Rect(bounds.x(), bounds.y(),
+                       splitX - bounds.x() - splitterSize * 0.5f,
                        bounds.height());
         } else {
             // Right child
@@ -247,7 +183,7 @@ Rect DockNode::getChildBounds(int childIndex) const {
         }
     } else {
         // Top-bottom split
-        float splitY = bounds.y() + bounds.height() * splitRatio;
+        float splitY = bounds.y() + bounds.height() * m_splitRatio;
         
         if (childIndex == 0) {
             // Top child
@@ -263,32 +199,6 @@ Rect DockNode::getChildBounds(int childIndex) const {
     }
 }
 
-//=============================================================================
-// Traversal
-//=============================================================================
-
-void DockNode::forEachNode(const std::function<void(DockNode*)>& callback) {
-    callback(this);
-    
-    for (int i = 0; i < 2; ++i) {
-        if (children[i]) {
-            children[i]->forEachNode(callback);
-        }
-    }
-}
-
-void DockNode::forEachLeaf(const std::function<void(DockNode*)>& callback) {
-    if (isLeafNode() || (!children[0] && !children[1])) {
-        callback(this);
-    } else {
-        for (int i = 0; i < 2; ++i) {
-            if (children[i]) {
-                children[i]->forEachLeaf(callback);
-            }
-        }
-    }
-}
-
 //=============================================================================
 // Debug
 //=============================================================================
@@ -307,7 +217,7 @@ std::string DockNode::debugPrint(int depth) const {
         case DockNodeType::Leaf: ss << "Leaf"; break;
     }
     
-    ss << " bounds(" << bounds.x() << "," << bounds.y() 
+    ss << " bounds(" << bounds.x() << "," << bounds.y()
        << "," << bounds.width() << "," << bounds.height() << ")";
     
     if (!dockedWindows.empty()) {
@@ -322,12 +232,312 @@ std::string DockNode::debugPrint(int depth) const {
     ss << "\n";
     
     for (int i = 0; i < 2; ++i) {
-        if (children[i]) {
-            ss << children[i]->debugPrint(depth + 1);
+        if (const DockNode* c = child(i)) {
+            ss << c->debugPrint(depth + 1);
         }
     }
     
     return ss.str();
 }
 
+//=============================================================================
+// DockTree - Node storage
+//=============================================================================
+
+DockTree::DockTree(DockNode::Id rootId) {
+    m_nodes.reserve(16);
+    DockNode::Index rootIndex = allocate(rootId);
+    m_nodes[rootIndex].type = DockNodeType::Leaf;
+}
+
+DockNode::Index DockTree::allocate(DockNode::Id id) {
+    DockNode::Index index;
+    if (!m_freeList.empty()) {
+        index = m_freeList.back();
+        m_freeList.pop_back();
+        m_nodes[index] = DockNode(id);
+    } else {
+        index = static_cast<DockNode::Index>(m_nodes.size());
+        m_nodes.emplace_back(id);
+    }
+    
+    DockNode& node = m_nodes[index];
+    node.tree = this;
+    node.index = index;
+    m_idToIndex[id] = index;
+    return index;
+}
+
+void DockTree::release(DockNode::Index index) {
+    if (index <= 0 || index >= static_cast<DockNode::Index>(m_nodes.size())) {
+        return;  // Never release the root
+    }
+    auto it = m_idToIndex.find(m_nodes[index].id);
+    if (it != m_idToIndex.end() && it->second == index) {
+        m_idToIndex.erase(it);
+    }
+    m_nodes[index] = DockNode();
+    m_freeList.push_back(index);
+}
+
+void DockTree::releaseSubtree(DockNode::Index index) {
+    DockNode* n = node(index);
+    if (!n) return;
+    
+    DockNode::Index children[2] = {n->childIndices[0], n->childIndices[1]};
+    release(index);
+    releaseSubtree(children[0]);
+    releaseSubtree(children[1]);
+}
+
+void DockTree::reparentChildren(DockNode::Index index) {
+    for (DockNode::Index c : m_nodes[index].childIndices) {
+        if (c != DockNode::NO_INDEX) {
+            m_nodes[c].parentIndex = index;
+        }
+    }
+}
+
+DockNode* DockTree::node(DockNode::Index index) {
+    if (index < 0 || index >= static_cast<DockNode::Index>(m_nodes.size())) {
+        return nullptr;
+    }
+    DockNode& n = m_nodes[index];
+    return n.tree ? &n : nullptr;
+}
+
+const DockNode* DockTree::node(DockNode::Index index) const {
+    return const_cast<DockTree*>(this)->node(index);
+}
+
+DockNode* DockTree::findNode(DockNode::Id id) {
+    auto it = m_idToIndex.find(id);
+    return it != m_idToIndex.end() ? &m_nodes[it->second] : nullptr;
+}
+
+const DockNode* DockTree::findNode(DockNode::Id id) const {
+    return const_cast<DockTree*>(this)->findNode(id);
+}
+
+DockNode* DockTree::findWindow(WidgetId windowId) {
+    rebuildCaches();
+    auto it = m_windowToNode.find(windowId);
+    return it != m_windowToNode.end() ? &m_nodes[it->second] : nullptr;
+}
+
+const DockNode* DockTree::findWindow(WidgetId windowId) const {
+    return const_cast<DockTree*>(this)->findWindow(windowId);
+}
+
+//=============================================================================
+// DockTree - Structure
+//=============================================================================
+
+DockNode::Index DockTree::split(DockNode::Index index, DockDirection direction,
+                                DockNode::Id childId0, DockNode::Id childId1, float ratio) {
+    if (direction == DockDirection::None || direction == DockDirection::Center || !node(index)) {
+        return DockNode::NO_INDEX;
+    }
+    
+    // Allocate first: this may grow the array and move every node
+    DockNode::Index index0 = allocate(childId0);
+    DockNode::Index index1 = allocate(childId1);
+    
+    DockNode& target = m_nodes[index];
+    DockNode& child0 = m_nodes[index0];
+    DockNode& child1 = m_nodes[index1];
+    child0.parentIndex = index;
+    child1.parentIndex = index;
+    float previousRatio = target.m_splitRatio;
+    ratio = validRatio(ratio);
+    
+    // Move current contents to appropriate child
+    DockNode* existingContent = nullptr;
+    DockNode* newContent = nullptr;
+    
+    if (direction == DockDirection::Left || direction == DockDirection::Top) {
+        existingContent = &child1;  // Existing goes to right/bottom
+        newContent = &child0;       // New goes to left/top
+        target.m_splitRatio = ratio;
+    } else {
+        existingContent = &child0;  // Existing goes to left/top
+        newContent = &child1;       // New goes to right/bottom
+        target.m_splitRatio = 1.0f - ratio;
+    }
+    
+    // Transfer windows, or an existing split, to the existing content child
+    if (target.isSplitNode()) {
+        existingContent->type = target.type;
+        existingContent->m_splitRatio = previousRatio;
+        existingContent->childIndices[0] = target.childIndices[0];
+        existingContent->childIndices[1] = target.childIndices[1];
+        reparentChildren(existingContent->index);
+    } else {
+        existingContent->dockedWindows = std::move(target.dockedWindows);
+        existingContent->selectedTabIndex = target.selectedTabIndex;
+        existingContent->type = existingContent->dockedWindows.size() > 1
+            ? DockNodeType::TabContainer
+            : DockNodeType::Leaf;
+    }
+    
+    // Clear this node's windows
+    target.dockedWindows.clear();
+    target.selectedTabIndex = 0;
+    
+    // Set new content as empty leaf
+    newContent->type = DockNodeType::Leaf;
+    
+    // Set this node as split
+    target.type = (direction == DockDirection::Left || direction == DockDirection::Right)
+        ? DockNodeType::SplitHorizontal
+        : DockNodeType::SplitVertical;
+    target.childIndices[0] = index0;
+    target.childIndices[1] = index1;
+    
+    markStructureDirty();
+    return newContent->index;
+}
+
+void DockTree::merge(DockNode::Index index) {
+    DockNode* target = node(index);
+    
+    // Only merge if this is a split node with an empty child
+    if (!target || !target->isSplitNode()) {
+        return;
+    }
+    
+    DockNode* children[2] = {target->child(0), target->child(1)};
+    bool empty0 = !children[0] || children[0]->isEmpty();
+    bool empty1 = !children[1] || children[1]->isEmpty();
+    
+    if (empty0 && empty1) {
+        // Both children are empty: become an empty leaf
+        release(target->childIndices[0]);
+        release(target->childIndices[1]);
+        target->childIndices[0] = DockNode::NO_INDEX;
+        target->childIndices[1] = DockNode::NO_INDEX;
+        target->type = DockNodeType::Leaf;
+    } else if (empty0 != empty1) {
+        // One child is empty: absorb the other child's contents
+        DockNode& keep = *children[empty0 ? 1 : 0];
+        DockNode::Index keepIndex = keep.index;
+        DockNode::Index dropIndex = target->childIndices[empty0 ? 0 : 1];
+        
+        target->dockedWindows = std::move(keep.dockedWindows);
+        target->selectedTabIndex = keep.selectedTabIndex;
+        target->type = keep.type;
+        target->m_splitRatio = keep.m_splitRatio;
+        target->childIndices[0] = keep.childIndices[0];
+        target->childIndices[1] = keep.childIndices[1];
+        reparentChildren(index);
+        
+        release(keepIndex);
+        release(dropIndex);
+    } else {
+        return;
+    }
+    
+    markStructureDirty();
+}
+
+DockNode* DockTree::attach(DockNode::Index parentIndex, int slot, DockNode::Id id) {
+    DockNode* parent = node(parentIndex);
+    if (!parent || slot < 0 || slot > 1 || parent->childIndices[slot] != DockNode::NO_INDEX) {
+        return nullptr;
+    }
+    
+    DockNode::Index index = allocate(id);
+    m_nodes[index].parentIndex = parentIndex;
+    m_nodes[parentIndex].childIndices[slot] = index;
+    
+    markStructureDirty();
+    return &m_nodes[index];
+}
+
+void DockTree::collapseEmptyNodes() {
+    if (!m_needsCollapse) {
+        return;
+    }
+    m_needsCollapse = false;
+    
+    // Deepest splits first so merges cascade towards the root
+    std::vector<DockNode::Index> order = splits();
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        merge(*it);
+    }
+}
+
+void DockTree::reset(DockNode::Index index) {
+    DockNode* target = node(index);
+    if (!target) return;
+    
+    DockNode& r = *target;
+    DockNode::Index children[2] = {r.childIndices[0], r.childIndices[1]};
+    r.childIndices[0] = DockNode::NO_INDEX;
+    r.childIndices[1] = DockNode::NO_INDEX;
+    r.type = DockNodeType::Leaf;
+    r.dockedWindows.clear();
+    r.selectedTabIndex = 0;
+    releaseSubtree(children[0]);
+    releaseSubtree(children[1]);
+    markStructureDirty();
+}
+
+//=============================================================================
+// DockTree - Cached layout
+//=============================================================================
+
+void DockTree::setBounds(const Rect& bounds) {
+    if (!(bounds == m_bounds)) {
+        m_bounds = bounds;
+        m_layoutDirty = true;
+    }
+}
+
+bool DockTree::updateLayout() {
+    if (!m_layoutDirty) {
+        return false;
+    }
+    root().updateLayout(m_bounds);
+    m_layoutDirty = false;
+    return true;
+}
+
+void DockTree::markStructureDirty() {
+    ++m_structureVersion;
+    m_layoutDirty = true;
+}
+
+const std::vector<DockNode::Index>& DockTree::leaves() const {
+    rebuildCaches();
+    return m_leaves;
+}
+
+const std::vector<DockNode::Index>& DockTree::splits() const {
+    rebuildCaches();
+    return m_splits;
+}
+
+void DockTree::rebuildCaches() const {
+    if (m_cachedVersion == m_structureVersion) {
+        return;
+    }
+    m_cachedVersion = m_structureVersion;
+    m_leaves.clear();
+    m_splits.clear();
+    m_windowToNode.clear();
+    
+    const_cast<DockTree*>(this)->root().forEachNode([this](DockNode* n) {
+        if (n->isSplitNode()) {
+            m_splits.push_back(n->index);
+        }
+        if (n->isLeafNode() || !n->hasChildren()) {
+            m_leaves.push_back(n->index);
+        }
+        for (WidgetId windowId : n->dockedWindows) {
+            m_windowToNode[windowId] = n->index;
+        }
+    });
+}
+
 } // namespace fst
@@ -15,57 +15,71 @@
 namespace fst {
 
 //=============================================================================
-// HStack Implementation
+// Shared Container Setup
 //=============================================================================
 
-HStackScope::HStackScope(Context& ctx, const FlexOptions& options)
-    : m_ctx(&ctx)
-{
-    BeginHStack(ctx, options);
-}
-
-HStackScope::~HStackScope() {
-    if (m_ctx) {
-        EndHStack(*m_ctx);
-    }
-}
-
-void BeginHStack(Context& ctx, const FlexOptions& options) {
+// Allocate container bounds, draw the optional background and return the
+// padded content rect.
+static Rect allocateContainerBounds(Context& ctx, const Style& style, const Vec4& padding,
+                              float defaultHeight) {
     LayoutContext& lc = ctx.layout();
     const Theme& theme = ctx.theme();
     
     // Determine container bounds
     Rect bounds;
-    if (options.style.width > 0 || options.style.height > 0) {
-        float w = options.style.width > 0 ? options.style.width : lc.currentBounds().width();
-        float h = options.style.height > 0 ? options.style.height : theme.metrics.buttonHeight;
-        bounds = allocateWidgetBounds(ctx, options.style, w, h);
+    if (style.width > 0 || style.height > 0) {
+        float w = style.width > 0 ? style.width : lc.currentBounds().width();
+        float h = style.height > 0 ? style.height : defaultHeight;
+        bounds = allocateWidgetBounds(ctx, style, w, h);
     } else {
-        bounds = lc.allocateRemaining();
+        bounds = lc.allocateContainer();
     }
     
     // Draw background if specified
-    if (options.style.backgroundColor.a > 0) {
+    if (style.backgroundColor.a > 0) {
         IDrawList& dl = *ctx.activeDrawList();
-        float radius = options.style.borderRadius > 0 ? options.style.borderRadius : 0.0f;
-        dl.addRectFilled(bounds, options.style.backgroundColor, radius);
+        float radius = style.borderRadius > 0 ? style.borderRadius : 0.0f;
+        dl.addRectFilled(bounds, style.backgroundColor, radius);
         
-        if (options.style.borderWidth > 0) {
-            Color borderColor = options.style.borderColor.a > 0 
-                ? options.style.borderColor 
+        if (style.borderWidth > 0) {
+            Color borderColor = style.borderColor.a > 0 
+                ? style.borderColor 
                 : theme.colors.border;
             dl.addRect(bounds, borderColor, radius);
         }
     }
     
     // Apply padding
-    Rect contentBounds = bounds;
-    if (options.padding.x > 0 || options.padding.y > 0 || 
-        options.padding.z > 0 || options.padding.w > 0) {
-        contentBounds = bounds.shrunk(options.padding);
-    } else if (options.style.padding.x > 0) {
-        contentBounds = bounds.shrunk(options.style.padding);
+    if (padding.x > 0 || padding.y > 0 || padding.z > 0 || padding.w > 0) {
+        return bounds.shrunk(padding);
+    }
+    if (style.padding.x > 0) {
+        return bounds.shrunk(style.padding);
     }
+    return bounds;
+}
+
+//=============================================================================
+// HStack Implementation
+//=============================================================================
+
+HStackScope::HStackScope(Context& ctx, const FlexOptions& options)
+    : m_ctx(&ctx)
+{
+    BeginHStack(ctx, options);
+}
+
+HStackScope::~HStackScope() {
+    if (m_ctx) {
+        EndHStack(*m_ctx);
+    }
+}
+
+void BeginHStack(Context& ctx, const FlexOptions& options) {
+    LayoutContext& lc = ctx.layout();
+    const Theme& theme = ctx.theme();
+    
+    Rect contentBounds = allocateContainerBounds(ctx, options.style, options.padding, theme.metrics.buttonHeight);
     
     // Begin horizontal container
     lc.beginContainer(contentBounds, LayoutDirection::Horizontal);
@@ -74,8 +88,9 @@ void BeginHStack(Context& ctx, const FlexOptions& options) {
     float gap = options.gap > 0 ? options.gap : theme.metrics.itemSpacing;
     lc.setSpacing(gap);
     
-    // Set alignment
+    // Set alignment and wrapping
     lc.setAlignment(options.mainAlign, options.crossAlign);
+    lc.setWrap(options.wrap);
 }
 
 void EndHStack(Context& ctx) {
@@ -102,38 +117,7 @@ void BeginVStack(Context& ctx, const FlexOptions& options) {
     LayoutContext& lc = ctx.layout();
     const Theme& theme = ctx.theme();
     
-    // Determine container bounds
-    Rect bounds;
-    if (options.style.width > 0 || options.style.height > 0) {
-        float w = options.style.width > 0 ? options.style.width : lc.currentBounds().width();
-        float h = options.style.height > 0 ? options.style.height : 200.0f;
-        bounds = allocateWidgetBounds(ctx, options.style, w, h);
-    } else {
-        bounds = lc.allocateRemaining();
-    }
-    
-    // Draw background if specified
-    if (options.style.backgroundColor.a > 0) {
-        IDrawList& dl = *ctx.activeDrawList();
-        float radius = options.style.borderRadius > 0 ? options.style.borderRadius : 0.0f;
-        dl.addRectFilled(bounds, options.style.backgroundColor, radius);
-        
-        if (options.style.borderWidth > 0) {
-            Color borderColor = options.style.borderColor.a > 0 
-                ? options.style.borderColor 
-                : theme.colors.border;
-            dl.addRect(bounds, borderColor, radius);
-        }
-    }
-    
-    // Apply padding
-    Rect contentBounds = bounds;
-    if (options.padding.x > 0 || options.padding.y > 0 || 
-        options.padding.z > 0 || options.padding.w > 0) {
-        contentBounds = bounds.shrunk(options.padding);
-    } else if (options.style.padding.x > 0) {
-        contentBounds = bounds.shrunk(options.style.padding);
-    }
+    Rect contentBounds = allocateContainerBounds(ctx, options.style, options.padding, 200.0f);
     
     // Begin vertical container
     lc.beginContainer(contentBounds, LayoutDirection::Vertical);
@@ -142,8 +126,9 @@ void BeginVStack(Context& ctx, const FlexOptions& options) {
     float gap = options.gap > 0 ? options.gap : theme.metrics.itemSpacing;
     lc.setSpacing(gap);
     
-    // Set alignment
+    // Set alignment and wrapping
     lc.setAlignment(options.mainAlign, options.crossAlign);
+    lc.setWrap(options.wrap);
 }
 
 void EndVStack(Context& ctx) {
@@ -154,29 +139,6 @@ void EndVStack(Context& ctx) {
 // Grid Implementation
 //=============================================================================
 
-// Grid tracking state (thread-local for nested grids)
-struct GridState {
-    Context* ctx = nullptr;
-    int columns = 2;
-    int currentColumn = 0;
-    int currentRow = 0;
-    float columnWidth = 0.0f;
-    float rowHeight = 0.0f;
-    float columnGap = 0.0f;
-    float rowGap = 0.0f;
-    Rect bounds;
-    Vec2 startPos;
-    Vec2 currentPos;
-    float maxRowHeight = 0.0f;  // Track max height in current row
-};
-
-static thread_local std::vector<GridState> s_gridStack;
-
-// Helper to get current grid state
-static GridState* currentGrid() {
-    return s_gridStack.empty() ? nullptr : &s_gridStack.back();
-}
-
 GridScope::GridScope(Context& ctx, const GridOptions& options)
     : m_ctx(&ctx)
 {
@@ -193,105 +155,48 @@ void BeginGrid(Context& ctx, const GridOptions& options) {
     LayoutContext& lc = ctx.layout();
     const Theme& theme = ctx.theme();
     
-    // Determine container bounds
-    Rect bounds;
-    if (options.style.width > 0 || options.style.height > 0) {
-        float w = options.style.width > 0 ? options.style.width : lc.currentBounds().width();
-        float h = options.style.height > 0 ? options.style.height : 200.0f;
-        bounds = allocateWidgetBounds(ctx, options.style, w, h);
-    } else {
-        bounds = lc.allocateRemaining();
-    }
-    
-    // Draw background if specified
-    if (options.style.backgroundColor.a > 0) {
-        IDrawList& dl = *ctx.activeDrawList();
-        float radius = options.style.borderRadius > 0 ? options.style.borderRadius : 0.0f;
-        dl.addRectFilled(bounds, options.style.backgroundColor, radius);
-        
-        if (options.style.borderWidth > 0) {
-            Color borderColor = options.style.borderColor.a > 0 
-                ? options.style.borderColor 
-                : theme.colors.border;
-            dl.addRect(bounds, borderColor, radius);
-        }
-    }
-    
-    // Apply padding
-    Rect contentBounds = bounds;
-    if (options.padding.x > 0 || options.padding.y > 0 || 
-        options.padding.z > 0 || options.padding.w > 0) {
-        contentBounds = bounds.shrunk(options.padding);
-    } else if (options.style.padding.x > 0) {
-        contentBounds = bounds.shrunk(options.style.padding);
-    }
+    Rect contentBounds = allocateContainerBounds(ctx, options.style, options.padding, 200.0f);
     
     // Calculate gaps
     float colGap = options.columnGap > 0 ? options.columnGap : theme.metrics.itemSpacing;
     float rGap = options.rowGap > 0 ? options.rowGap : theme.metrics.itemSpacing;
     
-    // Calculate column width
-    int cols = options.columns > 0 ? options.columns : 2;
-    float totalGapWidth = colGap * (cols - 1);
-    float columnWidth = (contentBounds.width() - totalGapWidth) / cols;
-    
-    // Push grid state
-    GridState state;
-    state.ctx = &ctx;
-    state.columns = cols;
-    state.currentColumn = 0;
-    state.currentRow = 0;
-    state.columnWidth = columnWidth;
-    state.rowHeight = theme.metrics.buttonHeight;  // Default row height
-    state.columnGap = colGap;
-    state.rowGap = rGap;
-    state.bounds = contentBounds;
-    state.startPos = contentBounds.pos;
-    state.currentPos = contentBounds.pos;
-    state.maxRowHeight = 0.0f;
-    s_gridStack.push_back(state);
-    
-    // Begin a vertical container for rows
+    // Grid is a layout container placing allocations cell by cell
     lc.beginContainer(contentBounds, LayoutDirection::Vertical);
-    lc.setSpacing(rGap);
+    lc.setGrid(options.columns > 0 ? options.columns : 2, colGap, rGap);
 }
 
 void EndGrid(Context& ctx) {
-    if (!s_gridStack.empty()) {
-        s_gridStack.pop_back();
-    }
     ctx.layout().endContainer();
 }
 
-// Custom allocate function for grid items - called by widgets inside Grid
-Rect GridAllocate(Context& ctx, float width, float height) {
-    GridState* grid = currentGrid();
-    if (!grid) {
-        // Fallback to normal allocation
-        return ctx.layout().allocate(width, height);
-    }
-    
-    // Calculate position
-    float x = grid->currentPos.x + grid->currentColumn * (grid->columnWidth + grid->columnGap);
-    float y = grid->currentPos.y + grid->currentRow * (grid->rowHeight + grid->rowGap);
+//=============================================================================
+// Virtual Grid Implementation
+//=============================================================================
+
+ItemRange BeginVirtualGrid(Context& ctx, int itemCount, const VirtualGridOptions& options) {
+    LayoutContext& lc = ctx.layout();
+    const Theme& theme = ctx.theme();
     
-    // Clamp width to column width
-    float itemWidth = std::min(width, grid->columnWidth);
-    float itemHeight = height;
+    Rect contentBounds = allocateContainerBounds(ctx, options.style, options.padding, 200.0f);
     
-    // Track max height for this row
-    grid->maxRowHeight = std::max(grid->maxRowHeight, itemHeight);
+    float colGap = options.columnGap > 0 ? options.columnGap : theme.metrics.itemSpacing;
+    float rGap = options.rowGap > 0 ? options.rowGap : theme.metrics.itemSpacing;
     
-    // Move to next column
-    grid->currentColumn++;
-    if (grid->currentColumn >= grid->columns) {
-        grid->currentColumn = 0;
-        grid->currentRow++;
-        grid->rowHeight = std::max(grid->rowHeight, grid->maxRowHeight);
-        grid->maxRowHeight = 0.0f;
+    // Wrapping flow: as many cells as fit the content width
+    int cols = options.columns;
+    if (cols <= 0) {
+        float cellWidth = options.cellSize.x > 0 ? options.cellSize.x : contentBounds.width();
+        cols = std::max(1, static_cast<int>((contentBounds.width() + colGap) / (cellWidth + colGap)));
     }
     
-    return Rect(x, y, itemWidth, itemHeight);
+    lc.beginContainer(contentBounds, LayoutDirection::Vertical);
+    lc.setGrid(cols, colGap, rGap);
+    return lc.virtualizeGrid(itemCount, options.cellSize.y, ctx.activeDrawList()->currentClipRect());
+}
+
+void EndVirtualGrid(Context& ctx) {
+    ctx.layout().endContainer();
 }
 
 //=============================================================================
@@ -299,17 +204,9 @@ Rect GridAllocate(Context& ctx, float width, float height) {
 //=============================================================================
 
 void Spacer(Context& ctx, float flex) {
-    LayoutContext& lc = ctx.layout();
-    
-    // Get remaining space and allocate it
-    float remaining = lc.remainingSpace();
-    if (remaining > 0) {
-        if (lc.currentDirection() == LayoutDirection::Horizontal) {
-            lc.allocate(remaining, 0, flex);
-        } else {
-            lc.allocate(0, remaining, flex);
-        }
-    }
+    // Zero base size; the layout grows it into the free space measured for
+    // this container last frame, shared with other flex items by factor.
+    ctx.layout().allocate(0, 0, flex);
 }
 
 void FixedSpacer(Context& ctx, float size) {
@@ -1,5 +1,6 @@
 #include "fastener/ui/layout.h"
 #include "fastener/core/context.h"
+#include "fastener/core/log.h"
 #include "fastener/ui/theme.h"
 #include <cmath>
 
@@ -8,176 +9,454 @@ namespace fst {
 LayoutContext::LayoutContext() = default;
 LayoutContext::~LayoutContext() = default;
 
-void LayoutContext::beginContainer(const Rect& bounds, LayoutDirection direction) {
-    ContainerState state;
+// Measures of containers not seen for this many frames are dropped
+static constexpr uint64_t kMeasureMaxAge = 60;
+
+static float mainAxis(LayoutDirection direction, float width, float height) {
+    return direction == LayoutDirection::Horizontal ? width : height;
+}
+
+static float alignOffset(Alignment align, float freeSpace) {
+    switch (align) {
+        case Alignment::Center: return freeSpace * 0.5f;
+        case Alignment::End:    return freeSpace;
+        default:                return 0.0f;
+    }
+}
+
+// Converts a fractional row position to a row in [0, rows]. Clamped before
+// the cast, which is undefined for a huge scroll offset or a tiny stride;
+// fmax/fmin also map NaN to a bound
+static int clampRow(float row, int rows) {
+    return static_cast<int>(std::fmin(std::fmax(static_cast<double>(row), 0.0), static_cast<double>(rows)));
+}
+
+void LayoutContext::beginFrame() {
+    m_frame++;
+    m_rootCount = 0;
+    
+    // Periodically drop measures of containers that are no longer submitted
+    if ((m_frame & 63) == 0) {
+        for (auto it = m_measures.begin(); it != m_measures.end();) {
+            if (m_frame - it->second.lastFrame > kMeasureMaxAge) {
+                it = m_measures.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void LayoutContext::beginContainer(const Rect& bounds, LayoutDirection direction, WidgetId id) {
+    if (m_depth >= constants::MAX_LAYOUT_DEPTH) {
+        if (m_overflow++ == 0) {
+            FST_LOG_ERROR("LayoutContext::beginContainer exceeded MAX_LAYOUT_DEPTH");
+        }
+        return;
+    }
+    
+    if (id == INVALID_WIDGET_ID) {
+        if (m_depth == 0) {
+            id = combineIds("layout_root"_id, static_cast<WidgetId>(++m_rootCount));
+        } else {
+            ContainerState& parent = current();
+            id = combineIds(parent.id, static_cast<WidgetId>(++parent.containerCount));
+        }
+    }
+    
+    ContainerState& state = m_stack[m_depth++];
+    state = ContainerState{};
     state.bounds = bounds;
+    state.content = bounds;
     state.cursor = bounds.pos;
     state.direction = direction;
-    state.remainingSize = (direction == LayoutDirection::Horizontal) 
-        ? bounds.width() : bounds.height();
-    m_stack.push_back(state);
+    state.id = id;
+    state.remainingSize = mainAxis(direction, bounds.width(), bounds.height());
+    
+    auto it = m_measures.find(id);
+    if (it != m_measures.end()) {
+        state.hasMeasure = true;
+        state.measure = it->second;
+    }
 }
 
-void LayoutContext::endContainer() {
-    if (m_stack.size() < 2) {
-        if (!m_stack.empty()) m_stack.pop_back();
-        return;
+Vec2 LayoutContext::endContainer(bool reportToParent) {
+    if (m_overflow > 0) {
+        m_overflow--;
+        return Vec2::zero();
+    }
+    if (m_depth == 0) {
+        return Vec2::zero();
     }
     
-    // Get size of container that just finished
-    ContainerState finished = m_stack.back();
-    m_stack.pop_back();
-    
-    // Report size to parent and advance its cursor
-    ContainerState& parent = m_stack.back();
+    // Container that just finished (slot stays valid until the next begin)
+    const ContainerState& finished = m_stack[--m_depth];
     
+    // Record children totals for next frame's flex and alignment pass
     float usedW = finished.maxInnerWidth + finished.padding.left() + finished.padding.right();
     float usedH = finished.maxInnerHeight + finished.padding.top() + finished.padding.bottom();
     
-    // Position reporting logic (similar to allocate)
-    if (parent.direction == LayoutDirection::Horizontal) {
-        parent.cursor.x += usedW + parent.spacing;
-        parent.remainingSize -= usedW + parent.spacing;
-        parent.maxInnerWidth = std::max(parent.maxInnerWidth, parent.cursor.x - (parent.bounds.x() + parent.padding.left()));
-        parent.maxInnerHeight = std::max(parent.maxInnerHeight, usedH);
+    float innerMain = mainAxis(finished.direction, finished.content.width(), finished.content.height());
+    ContainerMeasure& measure = m_measures[finished.id];
+    measure.freeSpace = innerMain - finished.baseMainSize;
+    measure.totalFlex = finished.totalFlex;
+    measure.rowHeight = finished.maxRowHeight;
+    measure.size = Vec2(usedW, usedH);
+    measure.lastFrame = m_frame;
+    
+    if (m_depth == 0 || !reportToParent) {
+        return Vec2(usedW, usedH);
+    }
+    
+    // Report size to parent and advance its cursor
+    ContainerState& parent = current();
+    
+    if (parent.columns > 0) {
+        allocateCell(parent, usedW, usedH);
+    } else if (parent.direction == LayoutDirection::Horizontal) {
+        advance(parent, usedW, usedW, usedH);
     } else {
-        parent.cursor.y += usedH + parent.spacing;
-        parent.remainingSize -= usedH + parent.spacing;
-        parent.maxInnerWidth = std::max(parent.maxInnerWidth, usedW);
-        parent.maxInnerHeight = std::max(parent.maxInnerHeight, parent.cursor.y - (parent.bounds.y() + parent.padding.top()));
+        advance(parent, usedH, usedH, usedW);
     }
+    return Vec2(usedW, usedH);
 }
 
-Rect LayoutContext::allocate(float width, float height, float flexGrow) {
-    if (m_stack.empty()) {
-        return Rect(0, 0, width, height);
+void LayoutContext::beginItem(ContainerState& state) {
+    if (state.started) {
+        return;
     }
-    
-    auto& state = current();
-    Rect result;
+    state.started = true;
     
     // Apply padding to cursor on first item
-    if (state.cursor == state.bounds.pos) {
-        state.cursor.x += state.padding.left();
-        state.cursor.y += state.padding.top();
+    state.cursor = state.content.pos;
+    
+    // Main-axis alignment only applies when no child grows into the free space
+    if (!state.wrap && state.hasMeasure && state.measure.totalFlex <= 0.0f &&
+        state.measure.freeSpace > 0.0f) {
+        float offset = alignOffset(state.mainAlign, state.measure.freeSpace);
+        if (state.direction == LayoutDirection::Horizontal) {
+            state.cursor.x += offset;
+        } else {
+            state.cursor.y += offset;
+        }
+        state.remainingSize -= offset;
+    }
+}
+
+void LayoutContext::startLine(ContainerState& state) {
+    if (state.direction == LayoutDirection::Horizontal) {
+        state.cursor.x = state.content.x();
+        state.cursor.y += state.lineCross + state.spacing;
+    } else {
+        state.cursor.y = state.content.y();
+        state.cursor.x += state.lineCross + state.spacing;
+    }
+    state.lineCross = 0.0f;
+    state.remainingSize = mainAxis(state.direction, state.content.width(), state.content.height());
+}
+
+void LayoutContext::advance(ContainerState& state, float baseMain, float mainSize, float crossSize) {
+    state.started = true;
+    if (state.itemCount > 0) {
+        state.baseMainSize += state.spacing;
     }
+    state.baseMainSize += baseMain;
+    state.itemCount++;
     
-    // Apply scroll offset
-    Vec2 pos = state.cursor - state.scrollOffset;
+    // Wrapped lines stack along the cross axis
+    float crossExtent = crossSize;
+    if (state.wrap) {
+        state.lineCross = std::max(state.lineCross, crossSize);
+        crossExtent = (state.direction == LayoutDirection::Horizontal
+            ? state.cursor.y - state.content.y()
+            : state.cursor.x - state.content.x()) + state.lineCross;
+    }
     
     if (state.direction == LayoutDirection::Horizontal) {
-        result = Rect(pos.x, pos.y, width, height);
-        state.cursor.x += width + state.spacing;
-        state.remainingSize -= width + state.spacing;
+        state.cursor.x += mainSize + state.spacing;
+        state.remainingSize -= mainSize + state.spacing;
         
-        state.maxInnerWidth = std::max(state.maxInnerWidth, state.cursor.x - (state.bounds.x() + state.padding.left()));
-        state.maxInnerHeight = std::max(state.maxInnerHeight, height);
+        state.maxInnerWidth = std::max(state.maxInnerWidth, state.cursor.x - state.content.x());
+        state.maxInnerHeight = std::max(state.maxInnerHeight, crossExtent);
     } else {
-        result = Rect(pos.x, pos.y, width, height);
-        state.cursor.y += height + state.spacing;
-        state.remainingSize -= height + state.spacing;
+        state.cursor.y += mainSize + state.spacing;
+        state.remainingSize -= mainSize + state.spacing;
         
-        state.maxInnerWidth = std::max(state.maxInnerWidth, width);
-        state.maxInnerHeight = std::max(state.maxInnerHeight, state.cursor.y - (state.bounds.y() + state.padding.top()));
+        state.maxInnerWidth = std::max(state.maxInnerWidth, crossExtent);
+        state.maxInnerHeight = std::max(state.maxInnerHeight, state.cursor.y - state.content.y());
+    }
+}
+
+Rect LayoutContext::allocateCell(ContainerState& state, float width, float height) {
+    beginItem(state);
+    
+    // Cursor tracks the top-left of the current row
+    float x = state.content.x() + state.column * (state.columnWidth + state.columnGap);
+    Rect result(x - state.scrollOffset.x, state.cursor.y - state.scrollOffset.y,
+                std::min(width, state.columnWidth), height);
+    
+    state.rowHeight = std::max(state.rowHeight, height);
+    state.maxRowHeight = std::max(state.maxRowHeight, height);
+    state.maxInnerWidth = std::max(state.maxInnerWidth, x + result.width() - state.content.x());
+    state.maxInnerHeight = std::max(state.maxInnerHeight, state.cursor.y + state.rowHeight - state.content.y());
+    state.itemCount++;
+    
+    if (++state.column >= state.columns) {
+        state.column = 0;
+        state.cursor.y += state.rowHeight + state.spacing;
+        state.remainingSize -= state.rowHeight + state.spacing;
+        state.baseMainSize += state.rowHeight + state.spacing;
+        state.rowHeight = 0.0f;
     }
     
+    return result;
+}
+
+Rect LayoutContext::allocate(float width, float height, float flexGrow) {
+    if (m_depth == 0) {
+        return Rect(0, 0, width, height);
+    }
+    
+    auto& state = current();
+    if (state.columns > 0) {
+        return allocateCell(state, width, height);
+    }
+    beginItem(state);
+    
+    bool horizontal = state.direction == LayoutDirection::Horizontal;
+    float baseMain = horizontal ? width : height;
+    float mainSize = baseMain;
+    float crossSize = horizontal ? height : width;
+    
+    // Grow into last frame's free space in proportion to flex factors
+    if (flexGrow > 0.0f && !state.wrap && state.hasMeasure && state.measure.totalFlex > 0.0f &&
+        state.measure.freeSpace > 0.0f) {
+        mainSize += state.measure.freeSpace * (flexGrow / state.measure.totalFlex);
+    }
+    
+    // Start a new line when the item would overflow the main axis
+    if (state.wrap && state.itemCount > 0) {
+        float lineEnd = horizontal ? state.content.right() : state.content.bottom();
+        if ((horizontal ? state.cursor.x : state.cursor.y) + mainSize > lineEnd) {
+            startLine(state);
+        }
+    }
+    
+    // Cross-axis alignment only needs the container's own size
+    float crossOffset = 0.0f;
+    if (state.crossAlign != Alignment::Start) {
+        float innerCross = horizontal ? state.content.height() : state.content.width();
+        if (state.crossAlign == Alignment::Stretch) {
+            crossSize = std::max(crossSize, innerCross);
+        } else if (innerCross > crossSize) {
+            crossOffset = alignOffset(state.crossAlign, innerCross - crossSize);
+        }
+    }
+    
+    // Apply scroll offset
+    Vec2 pos = state.cursor - state.scrollOffset;
+    
+    Rect result = horizontal
+        ? Rect(pos.x, pos.y + crossOffset, mainSize, crossSize)
+        : Rect(pos.x + crossOffset, pos.y, crossSize, mainSize);
+    
+    advance(state, baseMain, mainSize, crossSize);
     state.totalFlex += flexGrow;
     
     return result;
 }
 
 Rect LayoutContext::allocateRemaining() {
-    if (m_stack.empty()) {
+    if (m_depth == 0) {
         return Rect();
     }
     
     auto& state = current();
-    Rect result;
+    beginItem(state);
     
     Vec2 pos = state.cursor - state.scrollOffset;
     
-    float innerWidth = state.bounds.width() - state.padding.left() - state.padding.right();
-    float innerHeight = state.bounds.height() - state.padding.top() - state.padding.bottom();
+    if (state.columns > 0) {
+        float x = state.content.x() + state.column * (state.columnWidth + state.columnGap);
+        return Rect(x - state.scrollOffset.x, pos.y, state.columnWidth,
+                    std::max(0.0f, state.content.bottom() - state.cursor.y));
+    }
     
     if (state.direction == LayoutDirection::Horizontal) {
-        float width = std::max(0.0f, state.remainingSize);
-        result = Rect(pos.x, pos.y, width, innerHeight);
-    } else {
-        float height = std::max(0.0f, state.remainingSize);
-        result = Rect(pos.x, pos.y, innerWidth, height);
+        return Rect(pos.x, pos.y, std::max(0.0f, state.remainingSize), state.content.height());
+    }
+    return Rect(pos.x, pos.y, state.content.width(), std::max(0.0f, state.remainingSize));
+}
+
+Rect LayoutContext::allocateContainer() {
+    if (m_depth == 0) {
+        return Rect();
     }
     
-    return result;
+    // The child has not begun yet, but its id (and so last frame's size) is known
+    auto& state = current();
+    if (state.wrap && state.columns == 0 && state.itemCount > 0) {
+        WidgetId childId = combineIds(state.id, static_cast<WidgetId>(state.containerCount + 1));
+        auto it = m_measures.find(childId);
+        if (it != m_measures.end()) {
+            bool horizontal = state.direction == LayoutDirection::Horizontal;
+            float size = mainAxis(state.direction, it->second.size.x, it->second.size.y);
+            float lineEnd = horizontal ? state.content.right() : state.content.bottom();
+            if ((horizontal ? state.cursor.x : state.cursor.y) + size > lineEnd) {
+                startLine(state);
+            }
+        }
+    }
+    return allocateRemaining();
 }
 
 void LayoutContext::setSpacing(float spacing) {
-    if (!m_stack.empty()) {
+    if (m_depth > 0) {
         current().spacing = spacing;
     }
 }
 
 void LayoutContext::setPadding(float top, float right, float bottom, float left) {
-    if (!m_stack.empty()) {
-        current().padding = Vec4(top, right, bottom, left);
+    if (m_depth > 0) {
+        ContainerState& state = current();
+        state.padding = Vec4(top, right, bottom, left);
+        state.content = state.bounds.shrunk(state.padding);
+        if (state.columns > 0) {
+            setGrid(state.columns, state.columnGap, state.spacing);
+        }
     }
 }
 
 void LayoutContext::setAlignment(Alignment mainAxis, Alignment crossAxis) {
-    if (!m_stack.empty()) {
+    if (m_depth > 0) {
         current().mainAlign = mainAxis;
         current().crossAlign = crossAxis;
     }
 }
 
+void LayoutContext::setGrid(int columns, float columnGap, float rowGap) {
+    if (m_depth == 0) {
+        return;
+    }
+    ContainerState& state = current();
+    state.columns = std::max(1, columns);
+    state.columnGap = columnGap;
+    state.spacing = rowGap;
+    state.direction = LayoutDirection::Vertical;
+    float totalGap = columnGap * static_cast<float>(state.columns - 1);
+    state.columnWidth = std::max(0.0f, (state.content.width() - totalGap) / static_cast<float>(state.columns));
+}
+
+void LayoutContext::setWrap(bool wrap) {
+    if (m_depth > 0) {
+        current().wrap = wrap;
+    }
+}
+
+ItemRange LayoutContext::virtualizeGrid(int itemCount, float cellHeight, const Rect& visible) {
+    if (m_depth == 0 || itemCount <= 0) {
+        return {};
+    }
+    ContainerState& state = current();
+    if (state.columns <= 0) {
+        setGrid(1, 0.0f, state.spacing);
+    }
+    beginItem(state);
+    
+    // Unknown cell size: lay out one row this frame and measure it
+    if (cellHeight <= 0.0f) {
+        cellHeight = state.hasMeasure ? state.measure.rowHeight : 0.0f;
+        if (cellHeight <= 0.0f) {
+            return {0, std::min(itemCount, state.columns)};
+        }
+    }
+    
+    int rows = (itemCount + state.columns - 1) / state.columns;
+    float stride = cellHeight + state.spacing;
+    
+    // Visible span relative to the first row. Rows may extend past the
+    // container bounds (e.g. inside scroll content), so only `visible` clips.
+    float originY = state.cursor.y - state.scrollOffset.y;
+    float top = visible.top() - originY;
+    float bottom = visible.bottom() - originY;
+    
+    int firstRow = clampRow(std::floor(top / stride), rows);
+    int lastRow = std::max(clampRow(std::ceil(bottom / stride), rows), firstRow);
+    
+    // Report the full extent so scrolling containers see every row
+    float fullHeight = rows * stride - state.spacing;
+    float fullWidth = state.columns * (state.columnWidth + state.columnGap) - state.columnGap;
+    state.maxInnerHeight = std::max(state.maxInnerHeight, state.cursor.y - state.content.y() + fullHeight);
+    state.maxInnerWidth = std::max(state.maxInnerWidth, fullWidth);
+    state.maxRowHeight = std::max(state.maxRowHeight, cellHeight);
+    
+    // Skip the rows above the visible span
+    state.cursor.y += firstRow * stride;
+    state.column = 0;
+    state.rowHeight = 0.0f;
+    
+    return {firstRow * state.columns, std::min(itemCount, lastRow * state.columns)};
+}
+
 Rect LayoutContext::currentBounds() const {
-    if (m_stack.empty()) {
+    if (m_depth == 0) {
         return Rect();
     }
     return current().bounds;
 }
 
+Rect LayoutContext::currentContentBounds() const {
+    if (m_depth == 0) {
+        return Rect();
+    }
+    return current().content;
+}
+
 Vec2 LayoutContext::currentPosition() const {
-    if (m_stack.empty()) {
+    if (m_depth == 0) {
         return Vec2::zero();
     }
     return current().cursor;
 }
 
 float LayoutContext::remainingSpace() const {
-    if (m_stack.empty()) {
+    if (m_depth == 0) {
         return 0.0f;
     }
     return current().remainingSize;
 }
 
 LayoutDirection LayoutContext::currentDirection() const {
-    if (m_stack.empty()) {
+    if (m_depth == 0) {
         return LayoutDirection::Vertical;
     }
     return current().direction;
 }
 
+WidgetId LayoutContext::currentId() const {
+    if (m_depth == 0) {
+        return INVALID_WIDGET_ID;
+    }
+    return current().id;
+}
+
+bool LayoutContext::hasMeasure() const {
+    return m_depth > 0 && current().hasMeasure;
+}
+
 void LayoutContext::setScroll(float scrollX, float scrollY) {
-    if (!m_stack.empty()) {
+    if (m_depth > 0) {
         current().scrollOffset = {scrollX, scrollY};
     }
 }
 
 Vec2 LayoutContext::scroll() const {
-    if (m_stack.empty()) {
+    if (m_depth == 0) {
         return Vec2::zero();
     }
     return current().scrollOffset;
 }
 
-LayoutContext::ContainerState& LayoutContext::current() {
-    return m_stack.back();
-}
-
-const LayoutContext::ContainerState& LayoutContext::current() const {
-    return m_stack.back();
-}
-
 //=============================================================================
 // Global Layout Helpers
 //=============================================================================
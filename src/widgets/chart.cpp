@@ -269,7 +269,6 @@ void drawPieChart(IDrawList& dl, const Rect& plot, const std::vector<float>& val
 
 void Chart(Context& ctx, std::string_view id, const std::vector<float>& values,
            const ChartOptions& options) {
-    (void)id;
     auto wc = WidgetContext::make(ctx);
     const Theme& theme = *wc.theme;
     IDrawList& dl = *wc.dl;
@@ -298,10 +297,17 @@ void Chart(Context& ctx, std::string_view id, const std::vector<float>& values,
     bool legendEnabled = options.showLegend && font && !options.labels.empty();
 
     if (legendEnabled) {
-        float maxLabelWidth = 0.0f;
+        uint64_t labelsHash = 0;
         for (const auto& label : options.labels) {
-            maxLabelWidth = std::max(maxLabelWidth, font->measureText(label).x);
+            labelsHash = hashCombine(labelsHash, hashString(label));
         }
+        float maxLabelWidth = ctx.measureCache<float>(ctx.makeId(id), labelsHash, [&] {
+            float maxWidth = 0.0f;
+            for (const auto& label : options.labels) {
+                maxWidth = std::max(maxWidth, font->measureText(label).x);
+            }
+            return maxWidth;
+        });
         float padding = std::max(0.0f, options.legendPadding);
         float swatch = std::max(0.0f, options.legendSwatchSize);
         float spacing = std::max(0.0f, options.legendItemSpacing);
@@ -112,8 +112,8 @@ const CommandPaletteCommand* CommandPalette::render(Context& ctx, const CommandP
     IDrawList& dl = *wc.dl;
     Font* font = wc.font;
 
-    float windowW = static_cast<float>(ctx.window().width());
-    float windowH = static_cast<float>(ctx.window().height());
+    float windowW = ctx.layoutSize().x;
+    float windowH = ctx.layoutSize().y;
 
     float padding = options.padding > 0.0f ? options.padding : theme.metrics.paddingMedium;
     float inputHeight = options.inputHeight > 0.0f ? options.inputHeight : theme.metrics.inputHeight;
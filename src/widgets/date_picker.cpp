@@ -319,8 +319,8 @@ bool DatePicker(Context& ctx, std::string_view label, Date& date, const DatePick
             }
         }
 
-        if (popupRect.contains(input.mousePos()) && input.scrollDelta().y != 0.0f) {
-            float scroll = input.scrollDelta().y;
+        if (popupRect.contains(input.mousePos()) && input.scrollSteps().y != 0.0f) {
+            float scroll = input.scrollSteps().y;
             int direction = scroll > 0.0f ? -1 : 1;
             stepMonth(state, direction);
             cells = buildCells(options, state.displayYear, state.displayMonth);
@@ -22,7 +22,8 @@ DockNode::Id DockSpace(Context& ctx, const std::string& id, const Rect& bounds,
     const auto& theme = ctx.theme();
 
     
-    // Create or get the dock space
+    // Create or get the dock space; layout is only recomputed when the
+    // bounds, a split ratio or the docked windows changed
     auto nodeId = docking.createDockSpace(id, bounds);
     DockNode* root = docking.getDockSpace(id);
     
@@ -34,9 +35,6 @@ DockNode::Id DockSpace(Context& ctx, const std::string& id, const Rect& bounds,
     root->flags = options.nodeFlags;
     root->flags.passthruCentralNode = options.passthruCentralNode;
     
-    // Update layout
-    root->updateLayout(bounds);
-    
     // Render background if not passthru
     if (!options.passthruCentralNode) {
         dl.addRectFilled(bounds, theme.colors.panelBackground);
@@ -47,11 +45,13 @@ DockNode::Id DockSpace(Context& ctx, const std::string& id, const Rect& bounds,
 
     
     // Render tab bars for nodes with multiple windows
-    root->forEachLeaf([&ctx](DockNode* leaf) {
+    DockTree& tree = *root->tree;
+    for (DockNode::Index leafIndex : tree.leaves()) {
+        DockNode* leaf = tree.node(leafIndex);
         if (leaf->dockedWindows.size() > 1 || !leaf->flags.noTabBar) {
             RenderDockTabBar(ctx, leaf);
         }
-    });
+    }
     
     return nodeId;
 }
@@ -69,11 +69,11 @@ DockNode::Id DockSpaceOverViewport(Context& ctx, const DockSpaceOptions& options
 //=============================================================================
 
 void RenderDockSplitters(Context& ctx, DockNode* rootNode) {
-    if (!rootNode) return;
+    if (!rootNode || !rootNode->tree) return;
     
-    rootNode->forEachNode([&ctx](DockNode* node) {
-
-        if (!node->isSplitNode()) return;
+    DockTree& tree = *rootNode->tree;
+    for (DockNode::Index splitIndex : tree.splits()) {
+        DockNode* node = tree.node(splitIndex);
         
         const float splitterSize = 4.0f;
         Rect splitterRect;
@@ -81,7 +81,7 @@ void RenderDockSplitters(Context& ctx, DockNode* rootNode) {
         
         if (node->type == DockNodeType::SplitHorizontal) {
             // Vertical splitter (resizes horizontally)
-            float splitX = node->bounds.x() + node->bounds.width() * node->splitRatio;
+            float splitX = node->bounds.x() + node->bounds.width() * node->splitRatio();
             splitterRect = Rect(
                 splitX - splitterSize * 0.5f,
                 node->bounds.y(),
@@ -91,7 +91,7 @@ void RenderDockSplitters(Context& ctx, DockNode* rootNode) {
             isVertical = true;
         } else {
             // Horizontal splitter (resizes vertically)
-            float splitY = node->bounds.y() + node->bounds.height() * node->splitRatio;
+            float splitY = node->bounds.y() + node->bounds.height() * node->splitRatio();
             splitterRect = Rect(
                 node->bounds.x(),
                 splitY - splitterSize * 0.5f,
@@ -102,7 +102,7 @@ void RenderDockSplitters(Context& ctx, DockNode* rootNode) {
         }
         
         HandleDockSplitter(ctx, node, splitterRect, isVertical);
-    });
+    }
 }
 
 
@@ -136,18 +136,17 @@ bool HandleDockSplitter(Context& ctx, DockNode* node, const Rect& splitterRect,
         } else if (input.isMouseDown(MouseButton::Left)) {
 
             isDragging = true;
+            ctx.beginInteractiveResize();
             
             // Update split ratio based on mouse position
-            if (isVertical) {
-                float newRatio = (input.mousePos().x - node->bounds.x()) / node->bounds.width();
-                node->splitRatio = std::clamp(newRatio, 0.1f, 0.9f);
-            } else {
-                float newRatio = (input.mousePos().y - node->bounds.y()) / node->bounds.height();
-                node->splitRatio = std::clamp(newRatio, 0.1f, 0.9f);
-            }
+            float newRatio = isVertical
+                ? (input.mousePos().x - node->bounds.x()) / node->bounds.width()
+                : (input.mousePos().y - node->bounds.y()) / node->bounds.height();
             
-            // Re-layout after resize
-            node->updateLayout(node->bounds);
+            // Re-layout only when the ratio actually moved
+            if (node->setSplitRatio(std::clamp(newRatio, 0.1f, 0.9f)) && node->tree) {
+                node->tree->updateLayout();
+            }
         }
     }
     
@@ -210,7 +209,7 @@ void RenderDockTabBar(Context& ctx, DockNode* node) {
         static WidgetId s_activeDockTab = INVALID_WIDGET_ID;
         static Vec2 s_dragStartPos;
         static int s_dragTabIndex = -1;
-        static DockNode* s_dragNode = nullptr;
+        static DockNode::Id s_dragNode = DockNode::INVALID_ID;
         
         WidgetId tabId = combineIds(hashString("##DockTab"), node->id ^ i);
         
@@ -220,7 +219,7 @@ void RenderDockTabBar(Context& ctx, DockNode* node) {
             s_activeDockTab = tabId;
             s_dragStartPos = input.mousePos();
             s_dragTabIndex = i;
-            s_dragNode = node;
+            s_dragNode = node->id;
             ctx.setActiveWidget(tabId);
         }
         
@@ -228,16 +227,16 @@ void RenderDockTabBar(Context& ctx, DockNode* node) {
         if (s_activeDockTab == tabId) {
             if (input.isMouseReleased(MouseButton::Left)) {
                 s_activeDockTab = INVALID_WIDGET_ID;
-                s_dragNode = nullptr;
+                s_dragNode = DockNode::INVALID_ID;
                 s_dragTabIndex = -1;
                 ctx.clearActiveWidget();
-            } else if (input.isMouseDown(MouseButton::Left) && s_dragNode == node && s_dragTabIndex == i) {
+            } else if (input.isMouseDown(MouseButton::Left) && s_dragNode == node->id && s_dragTabIndex == i) {
                 float dragDistSq = (input.mousePos() - s_dragStartPos).lengthSquared();
                 if (dragDistSq > 25.0f) { // 5 pixel threshold
                     // Start dragging the window out of the dock
                     ctx.docking().beginDrag(node->dockedWindows[i], input.mousePos());
                     s_activeDockTab = INVALID_WIDGET_ID;
-                    s_dragNode = nullptr;
+                    s_dragNode = DockNode::INVALID_ID;
                     s_dragTabIndex = -1;
                     ctx.clearActiveWidget();
                 }
@@ -62,6 +62,9 @@ bool BeginDockableWindow(Context& ctx, const std::string& id, const DockableWind
         state.floatingBounds = Rect(100, 100, 400, 300);  // Default floating size
     }
     
+    // The dock context owns the persisted floating rect (restored layouts)
+    docking.getFloatingRect(widgetId, state.floatingBounds);
+    
     // Register title even if invisible/docked so DockSpace knows labels for tabs
     docking.setWindowTitle(widgetId, state.title);
 
@@ -216,6 +219,7 @@ bool BeginDockableWindow(Context& ctx, const std::string& id, const DockableWind
 
         // Register occlusion
         ctx.addFloatingWindowRect(state.floatingBounds);
+        docking.setFloatingRect(widgetId, state.floatingBounds);
     }
 
 
@@ -51,8 +51,8 @@ bool BeginModal(Context& ctx, const std::string& id, bool& isOpen, const ModalOp
     ctx.pushId(id);
     
     // Get window size
-    float windowW = static_cast<float>(ctx.window().width());
-    float windowH = static_cast<float>(ctx.window().height());
+    float windowW = ctx.layoutSize().x;
+    float windowH = ctx.layoutSize().y;
     
     // Switch to overlay layer to render on top of everything
     dl.setLayer(DrawLayer::Overlay);
@@ -17,11 +17,11 @@ void ShowProfilerOverlay(Context& ctx, bool* open) {
     if (open && !*open) return;
 
     const float width = 180.0f;
-    const float height = 80.0f;
+    const float height = 96.0f;
     const float margin = 10.0f;
     
     PanelOptions opt;
-    opt.style.withPos(ctx.window().width() - width - margin, margin).withSize(width, height);
+    opt.style.withPos(ctx.layoutSize().x - width - margin, margin).withSize(width, height);
     opt.title = "Profiler Overlay";
 
     // Using a simple panel for overlay
@@ -36,6 +36,12 @@ void ShowProfilerOverlay(Context& ctx, bool* open) {
         snprintf(buf, sizeof(buf), "Frame: %.2f ms", avgTime);
         Label(ctx, buf);
 
+        float latency = ctx.profiler().getAverageLatency();
+        if (latency > 0.0f) {
+            snprintf(buf, sizeof(buf), "Latency: %.2f ms", latency);
+            Label(ctx, buf);
+        }
+
         // Simple sparkline using frame history
         float history[128];
         ctx.profiler().getFrameHistory(history, 128);
@@ -79,6 +85,12 @@ void ShowProfilerWindow(Context& ctx, const char* title, bool* open) {
         char buf[128];
         snprintf(buf, sizeof(buf), "Average Frame Time: %.2f ms (%.1f FPS)", avgTime, avgTime > 0 ? 1000.0f / avgTime : 0);
         Label(ctx, buf);
+
+        float latency = ctx.profiler().getAverageLatency();
+        if (latency > 0.0f) {
+            snprintf(buf, sizeof(buf), "Input-to-Present Latency: %.2f ms", latency);
+            Label(ctx, buf);
+        }
         
         Separator(ctx);
         
@@ -774,9 +774,19 @@ void RichTextPreview(Context& ctx, const char* id, std::string_view text, const
     Rect contentRect = bounds.shrunk(padding);
     if (contentRect.width() <= 0.0f || contentRect.height() <= 0.0f) return;
 
-    auto lines = rich_text::internal::parseRichText(text, options.format);
-    rich_text::internal::LayoutResult layout = rich_text::internal::layoutRichText(
-        lines, *font, contentRect.width(), options, theme);
+    // Parsing and wrapping only depend on these inputs; reuse last result.
+    // Width changes from a splitter drag re-wrap at a throttled rate and the
+    // stale wrap is drawn clipped in between.
+    uint64_t inputsHash = hashString(text);
+    inputsHash = hashCombine(inputsHash, static_cast<uint64_t>(options.format));
+    inputsHash = hashCombine(inputsHash, hashFloat(options.lineSpacing));
+    inputsHash = hashCombine(inputsHash, options.wordWrap ? 1u : 0u);
+    uint64_t sizeHash = hashFloat(contentRect.width());
+    const rich_text::internal::LayoutResult& layout = ctx.measureCache<rich_text::internal::LayoutResult>(
+        widgetId, inputsHash, sizeHash, [&] {
+            auto lines = rich_text::internal::parseRichText(text, options.format);
+            return rich_text::internal::layoutRichText(lines, *font, contentRect.width(), options, theme);
+        });
 
     InputState& input = ctx.input();
     if (bounds.contains(input.mousePos()) && !ctx.isOccluded(input.mousePos())) {
@@ -7,10 +7,12 @@
 #include "fastener/widgets/menu.h"
 #include "fastener/core/context.h"
 #include "fastener/graphics/draw_list.h"
+#include "fastener/ui/layout.h"
 #include "fastener/ui/theme.h"
 #include "fastener/ui/widget_utils.h"
 
 #include <algorithm>
+#include <cmath>
 
 namespace fst {
 
@@ -27,10 +29,60 @@ ScrollArea::~ScrollArea() = default;
  */
 void ScrollArea::setScrollOffset(const Vec2& offset) {
     m_scrollOffset = offset;
+    m_hasScrollTarget = false;
 }
 
-void ScrollArea::scrollTo(const Rect& area) {
-    // TODO: Implement logic to make a specific sub-rect visible
+/**
+ * @brief Scroll so that a content-space rect becomes visible.
+ * @param area Rect relative to the content origin
+ * @param smooth Animate over the next frames instead of jumping
+ */
+void ScrollArea::scrollTo(const Rect& area, bool smooth) {
+    Vec2 target = m_hasScrollTarget ? m_scrollTarget : m_scrollOffset;
+    Vec2 view = m_viewport.size;
+    
+    // Minimal movement: align the nearest edge, prefer the top-left edge
+    // when the area is larger than the viewport
+    if (area.right() > target.x + view.x) target.x = area.right() - view.x;
+    if (area.left() < target.x) target.x = area.left();
+    if (area.bottom() > target.y + view.y) target.y = area.bottom() - view.y;
+    if (area.top() < target.y) target.y = area.top();
+    
+    target.x = std::clamp(target.x, 0.0f, std::max(0.0f, m_contentSize.x - view.x));
+    target.y = std::clamp(target.y, 0.0f, std::max(0.0f, m_contentSize.y - view.y));
+    
+    if (smooth) {
+        m_scrollTarget = target;
+        m_hasScrollTarget = true;
+    } else {
+        m_scrollOffset = target;
+        m_hasScrollTarget = false;
+    }
+}
+
+ItemRange ScrollArea::visibleRange(float itemHeight, int itemCount) const {
+    if (itemHeight <= 0.0f || itemCount <= 0) {
+        return {};
+    }
+    int first = static_cast<int>(std::floor(m_scrollOffset.y / itemHeight));
+    int last = static_cast<int>(std::ceil((m_scrollOffset.y + m_viewport.height()) / itemHeight));
+    first = std::clamp(first, 0, itemCount);
+    return {first, std::clamp(last, first, itemCount)};
+}
+
+void ScrollArea::updateScrollTarget(float deltaTime, const ScrollAreaOptions& options) {
+    if (!m_hasScrollTarget) {
+        return;
+    }
+    Vec2 delta = m_scrollTarget - m_scrollOffset;
+    if (options.smoothScrollSpeed <= 0.0f || delta.lengthSquared() < 0.25f) {
+        m_scrollOffset = m_scrollTarget;
+        m_hasScrollTarget = false;
+        return;
+    }
+    // Frame-rate independent exponential approach
+    float t = 1.0f - std::exp(-options.smoothScrollSpeed * deltaTime);
+    m_scrollOffset += delta * t;
 }
 
 void ScrollArea::render(Context& ctx, const std::string& id, const Rect& bounds, 
@@ -59,14 +111,26 @@ void ScrollArea::render(Context& ctx, const std::string& id, const Rect& bounds,
     if (showV) viewport.size.x -= sbSize;
     if (showH) viewport.size.y -= sbSize;
 
+    m_viewport = viewport;
+    updateScrollTarget(ctx.deltaTime(), options);
     clampScroll(viewport);
     handleInteraction(ctx, id, bounds, viewport, options);
 
 
-    // Content Rendering
+    // Content Rendering - layout allocations inside are shifted by the
+    // scroll offset and measured for next frame's content size
+    LayoutContext& lc = ctx.layout();
     dl.pushClipRect(viewport);
+    lc.beginContainer(viewport, LayoutDirection::Vertical, ctx.makeId("##content"));
+    lc.setScroll(m_scrollOffset.x, m_scrollOffset.y);
     contentRenderer(viewport);
+    Vec2 measured = lc.endContainer(false);
     dl.popClipRect();
+    
+    // Empty content measures zero, which drops stale extents and scrollbars
+    if (options.measureContent && !m_explicitContentSize) {
+        m_contentSize = measured;
+    }
 
     // Scrollbar Tracks and Thumbs
     if (showV) {
@@ -127,6 +191,9 @@ void ScrollArea::handleInteraction(Context& ctx, const std::string& id, const Re
     if (bounds.contains(mp) && !ctx.isOccluded(mp)) {
 
         Vec2 delta = input.scrollDelta();
+        if (delta.x != 0.0f || delta.y != 0.0f) {
+            m_hasScrollTarget = false;
+        }
         if (input.modifiers().shift || !showV) {
             m_scrollOffset.x -= delta.y * 30.0f; 
         } else {
@@ -144,6 +211,7 @@ void ScrollArea::handleInteraction(Context& ctx, const std::string& id, const Re
         if (input.isMousePressed(MouseButton::Left) && track.contains(mp) && !ctx.isOccluded(mp)) {
 
             m_draggingV = true;
+            m_hasScrollTarget = false;
             m_dragStartPos = mp.y;
             m_dragStartOffset = m_scrollOffset.y;
         }
@@ -168,6 +236,7 @@ void ScrollArea::handleInteraction(Context& ctx, const std::string& id, const Re
         if (input.isMousePressed(MouseButton::Left) && track.contains(mp) && !ctx.isOccluded(mp)) {
 
             m_draggingH = true;
+            m_hasScrollTarget = false;
             m_dragStartPos = mp.x;
             m_dragStartOffset = m_scrollOffset.x;
         }
@@ -77,6 +77,8 @@ bool Splitter(Context& ctx, const char* id_str, float& splitPosition, const Rect
 
     // Handle drag to update split position
     if (state.active && !options.disabled) {
+        ctx.beginInteractiveResize();
+        
         Vec2 mousePos = ctx.input().mousePos();
         float newPos = splitPosition;
 
@@ -45,7 +45,7 @@ bool BeginStatusBar(Context& ctx, const StatusBarOptions& options) {
     
     // Calculate dimensions
     float height = options.height > 0 ? options.height : 24.0f;
-    float width = options.style.width > 0 ? options.style.width : ctx.window().width();
+    float width = options.style.width > 0 ? options.style.width : ctx.layoutSize().x;
     
     // Allocate bounds (typically at bottom)
     Rect bounds = allocateWidgetBounds(ctx, options.style, width, height);
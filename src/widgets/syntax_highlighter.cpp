@@ -0,0 +1,712 @@
+/**
+ * @file syntax_highlighter.cpp
+ * @brief Line-state syntax highlighting and the per-line cache.
+ */
+
+#include "fastener/widgets/syntax_highlighter.h"
+#include "fastener/widgets/text_buffer.h"
+#include "fastener/core/constants.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+#include <unordered_set>
+
+namespace fst {
+
+//=============================================================================
+// Scanning Helpers
+//=============================================================================
+
+namespace {
+
+bool isIdentStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+bool isDigit(char c) {
+    return std::isdigit(static_cast<unsigned char>(c)) != 0;
+}
+
+bool isBracket(char c) {
+    return c == '(' || c == ')' || c == '{' || c == '}' || c == '[' || c == ']';
+}
+
+void addSegment(std::vector<TextSegment>& segments, size_t begin, size_t end, Color color) {
+    if (end > begin) {
+        segments.push_back({static_cast<int>(begin), static_cast<int>(end), color});
+    }
+}
+
+size_t scanIdentifier(std::string_view line, size_t i) {
+    while (i < line.size() && isIdentChar(line[i])) ++i;
+    return i;
+}
+
+// Digits, radix prefixes, suffixes, digit separators and signed exponents
+size_t scanNumber(std::string_view line, size_t i) {
+    while (i < line.size()) {
+        char c = line[i];
+        if ((c == '+' || c == '-') && i > 0 &&
+            (line[i - 1] == 'e' || line[i - 1] == 'E' || line[i - 1] == 'p' || line[i - 1] == 'P')) {
+            ++i;
+        } else if (isIdentChar(c) || c == '.' || c == '\'') {
+            ++i;
+        } else {
+            break;
+        }
+    }
+    return i;
+}
+
+// From an opening quote to just past the closing one (or the line end)
+size_t scanQuoted(std::string_view line, size_t i, char quote) {
+    for (++i; i < line.size(); ++i) {
+        if (line[i] == '\\') {
+            ++i;
+        } else if (line[i] == quote) {
+            return i + 1;
+        }
+    }
+    return line.size();
+}
+
+//=============================================================================
+// C++
+//=============================================================================
+
+class CppHighlighter : public SyntaxHighlighter {
+public:
+    explicit CppHighlighter(const SyntaxColors& colors) : m_colors(colors) {}
+
+    // Low byte: construct; raw strings keep a hash of their delimiter above it
+    enum : State { Normal = 0, BlockComment = 1, RawString = 2 };
+
+    State highlightLine(std::string_view line, State state, std::vector<TextSegment>& segments) const override {
+        size_t i = 0;
+        if (state == BlockComment) {
+            size_t end = line.find("*/");
+            if (end == std::string_view::npos) {
+                addSegment(segments, 0, line.size(), m_colors.comment);
+                return BlockComment;
+            }
+            addSegment(segments, 0, end + 2, m_colors.comment);
+            i = end + 2;
+        } else if ((state & 0xFF) == RawString) {
+            size_t end = findRawEnd(line, 0, state >> 8);
+            if (end == std::string_view::npos) {
+                addSegment(segments, 0, line.size(), m_colors.string);
+                return state;
+            }
+            addSegment(segments, 0, end, m_colors.string);
+            i = end;
+        }
+
+        size_t firstNonSpace = line.find_first_not_of(" \t");
+        while (i < line.size()) {
+            char c = line[i];
+            char next = i + 1 < line.size() ? line[i + 1] : '\0';
+
+            if (c == '/' && next == '/') {
+                addSegment(segments, i, line.size(), m_colors.comment);
+                break;
+            }
+            if (c == '/' && next == '*') {
+                size_t end = line.find("*/", i + 2);
+                if (end == std::string_view::npos) {
+                    addSegment(segments, i, line.size(), m_colors.comment);
+                    return BlockComment;
+                }
+                addSegment(segments, i, end + 2, m_colors.comment);
+                i = end + 2;
+            } else if (c == '#' && i == firstNonSpace) {
+                size_t start = i;
+                i = line.find_first_not_of(" \t", i + 1);
+                if (i == std::string_view::npos) i = line.size();
+                size_t end = scanIdentifier(line, i);
+                addSegment(segments, start, end, m_colors.preprocessor);
+                std::string_view directive = line.substr(i, end - i);
+                i = end;
+                if (directive == "include") {
+                    size_t open = line.find_first_not_of(" \t", i);
+                    if (open != std::string_view::npos && line[open] == '<') {
+                        size_t close = line.find('>', open);
+                        size_t stop = close == std::string_view::npos ? line.size() : close + 1;
+                        addSegment(segments, open, stop, m_colors.string);
+                        i = stop;
+                    }
+                }
+            } else if (c == '"' || c == '\'') {
+                size_t end = scanQuoted(line, i, c);
+                addSegment(segments, i, end, m_colors.string);
+                i = end;
+            } else if (isDigit(c) || (c == '.' && isDigit(next))) {
+                size_t end = scanNumber(line, i);
+                addSegment(segments, i, end, m_colors.number);
+                i = end;
+            } else if (isIdentStart(c)) {
+                size_t end = scanIdentifier(line, i);
+                std::string_view word = line.substr(i, end - i);
+                char after = end < line.size() ? line[end] : '\0';
+
+                if (after == '"' && (word == "R" || word == "u8R" || word == "uR" || word == "UR" || word == "LR")) {
+                    State rawState = 0;
+                    size_t stop = scanRawString(line, end, rawState);
+                    addSegment(segments, i, stop, m_colors.string);
+                    if (rawState != 0) return rawState;
+                    i = stop;
+                    continue;
+                }
+                if ((after == '"' || after == '\'') && (word == "u8" || word == "u" || word == "U" || word == "L")) {
+                    size_t stop = scanQuoted(line, end, after);
+                    addSegment(segments, i, stop, m_colors.string);
+                    i = stop;
+                    continue;
+                }
+
+                if (keywords().count(word)) {
+                    addSegment(segments, i, end, m_colors.keyword);
+                } else if (types().count(word)) {
+                    addSegment(segments, i, end, m_colors.type);
+                }
+                i = end;
+            } else {
+                if (isBracket(c)) {
+                    addSegment(segments, i, i + 1, m_colors.punctuation);
+                }
+                ++i;
+            }
+        }
+        return Normal;
+    }
+
+private:
+    static State delimiterHash(std::string_view delimiter) {
+        uint32_t hash = 2166136261u;
+        for (char c : delimiter) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+        }
+        return (hash ^ (hash >> 24)) & 0xFFFFFFu;
+    }
+
+    // From the opening quote of R"delim( ... )delim"; returns the end of
+    // the literal on this line, or the line end with rawState set
+    static size_t scanRawString(std::string_view line, size_t quote, State& rawState) {
+        size_t open = line.find('(', quote + 1);
+        if (open == std::string_view::npos || open - quote - 1 > 16) {
+            return scanQuoted(line, quote, '"');  // Malformed; treat as ordinary
+        }
+        State hash = delimiterHash(line.substr(quote + 1, open - quote - 1));
+        size_t end = findRawEnd(line, open + 1, hash);
+        if (end == std::string_view::npos) {
+            rawState = RawString | (hash << 8);
+            return line.size();
+        }
+        return end;
+    }
+
+    // Position just past the )delim" whose delimiter hashes to @p hash
+    static size_t findRawEnd(std::string_view line, size_t from, State hash) {
+        for (size_t close = line.find(')', from); close != std::string_view::npos; close = line.find(')', close + 1)) {
+            size_t quote = line.find('"', close + 1);
+            if (quote == std::string_view::npos) break;
+            if (quote - close - 1 <= 16 && delimiterHash(line.substr(close + 1, quote - close - 1)) == hash) {
+                return quote + 1;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    static const std::unordered_set<std::string_view>& keywords() {
+        static const std::unordered_set<std::string_view> words = {
+            "alignas", "alignof", "auto", "break", "case", "catch", "class", "co_await", "co_return",
+            "co_yield", "concept", "const", "consteval", "constexpr", "constinit", "const_cast",
+            "continue", "decltype", "default", "delete", "do", "dynamic_cast", "else", "enum",
+            "explicit", "export", "extern", "false", "final", "for", "friend", "goto", "if", "inline",
+            "mutable", "namespace", "new", "noexcept", "nullptr", "operator", "override", "private",
+            "protected", "public", "reinterpret_cast", "requires", "return", "sizeof", "static",
+            "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local",
+            "throw", "true", "try", "typedef", "typeid", "typename", "union", "using", "virtual",
+            "volatile", "while"
+        };
+        return words;
+    }
+
+    static const std::unordered_set<std::string_view>& types() {
+        static const std::unordered_set<std::string_view> words = {
+            "bool", "char", "char8_t", "char16_t", "char32_t", "double", "float", "int", "long",
+            "short", "signed", "unsigned", "void", "wchar_t", "size_t", "ptrdiff_t", "int8_t",
+            "int16_t", "int32_t", "int64_t", "uint8_t", "uint16_t", "uint32_t", "uint64_t", "std"
+        };
+        return words;
+    }
+
+    SyntaxColors m_colors;
+};
+
+//=============================================================================
+// JSON
+//=============================================================================
+
+class JsonHighlighter : public SyntaxHighlighter {
+public:
+    explicit JsonHighlighter(const SyntaxColors& colors) : m_colors(colors) {}
+
+    // Nothing in JSON spans lines
+    State highlightLine(std::string_view line, State, std::vector<TextSegment>& segments) const override {
+        size_t i = 0;
+        while (i < line.size()) {
+            char c = line[i];
+            char next = i + 1 < line.size() ? line[i + 1] : '\0';
+            if (c == '"') {
+                size_t end = scanQuoted(line, i, '"');
+                size_t after = line.find_first_not_of(" \t", end);
+                bool isKey = after != std::string_view::npos && line[after] == ':';
+                addSegment(segments, i, end, isKey ? m_colors.type : m_colors.string);
+                i = end;
+            } else if (isDigit(c) || (c == '-' && isDigit(next))) {
+                size_t end = scanNumber(line, i + 1);
+                addSegment(segments, i, end, m_colors.number);
+                i = end;
+            } else if (isIdentStart(c)) {
+                size_t end = scanIdentifier(line, i);
+                std::string_view word = line.substr(i, end - i);
+                if (word == "true" || word == "false" || word == "null") {
+                    addSegment(segments, i, end, m_colors.keyword);
+                }
+                i = end;
+            } else {
+                if (isBracket(c)) {
+                    addSegment(segments, i, i + 1, m_colors.punctuation);
+                }
+                ++i;
+            }
+        }
+        return 0;
+    }
+
+private:
+    SyntaxColors m_colors;
+};
+
+//=============================================================================
+// Python
+//=============================================================================
+
+class PythonHighlighter : public SyntaxHighlighter {
+public:
+    explicit PythonHighlighter(const SyntaxColors& colors) : m_colors(colors) {}
+
+    enum : State { Normal = 0, TripleDouble = 1, TripleSingle = 2 };
+
+    State highlightLine(std::string_view line, State state, std::vector<TextSegment>& segments) const override {
+        size_t i = 0;
+        if (state == TripleDouble || state == TripleSingle) {
+            size_t end = findTripleEnd(line, 0, state == TripleDouble ? '"' : '\'');
+            if (end == std::string_view::npos) {
+                addSegment(segments, 0, line.size(), m_colors.string);
+                return state;
+            }
+            addSegment(segments, 0, end, m_colors.string);
+            i = end;
+        }
+
+        while (i < line.size()) {
+            char c = line[i];
+            char next = i + 1 < line.size() ? line[i + 1] : '\0';
+
+            if (c == '#') {
+                addSegment(segments, i, line.size(), m_colors.comment);
+                break;
+            }
+            if (c == '"' || c == '\'') {
+                State open = Normal;
+                size_t end = scanString(line, i, open);
+                addSegment(segments, i, end, m_colors.string);
+                if (open != Normal) return open;
+                i = end;
+            } else if (c == '@' && isIdentStart(next) && line.find_first_not_of(" \t") == i) {
+                size_t end = i + 1;
+                while (end < line.size() && (isIdentChar(line[end]) || line[end] == '.')) ++end;
+                addSegment(segments, i, end, m_colors.preprocessor);
+                i = end;
+            } else if (isDigit(c) || (c == '.' && isDigit(next))) {
+                size_t end = scanNumber(line, i);
+                addSegment(segments, i, end, m_colors.number);
+                i = end;
+            } else if (isIdentStart(c)) {
+                size_t end = scanIdentifier(line, i);
+                std::string_view word = line.substr(i, end - i);
+                char after = end < line.size() ? line[end] : '\0';
+
+                // String prefixes: r"", b'', f"""...""", rb'' and so on
+                if ((after == '"' || after == '\'') && word.size() <= 2 &&
+                    word.find_first_not_of("rRbBfFuU") == std::string_view::npos) {
+                    State open = Normal;
+                    size_t stop = scanString(line, end, open);
+                    addSegment(segments, i, stop, m_colors.string);
+                    if (open != Normal) return open;
+                    i = stop;
+                    continue;
+                }
+
+                if (keywords().count(word)) {
+                    addSegment(segments, i, end, m_colors.keyword);
+                } else if (builtins().count(word)) {
+                    addSegment(segments, i, end, m_colors.type);
+                }
+                i = end;
+            } else {
+                if (isBracket(c)) {
+                    addSegment(segments, i, i + 1, m_colors.punctuation);
+                }
+                ++i;
+            }
+        }
+        return Normal;
+    }
+
+private:
+    // From an opening quote; sets @p open when a triple-quoted string runs
+    // past the end of the line
+    static size_t scanString(std::string_view line, size_t quote, State& open) {
+        char q = line[quote];
+        if (line.substr(quote, 3) == std::string(3, q)) {
+            size_t end = findTripleEnd(line, quote + 3, q);
+            if (end == std::string_view::npos) {
+                open = q == '"' ? TripleDouble : TripleSingle;
+                return line.size();
+            }
+            return end;
+        }
+        return scanQuoted(line, quote, q);
+    }
+
+    static size_t findTripleEnd(std::string_view line, size_t from, char quote) {
+        for (size_t i = from; i < line.size(); ++i) {
+            if (line[i] == '\\') {
+                ++i;
+            } else if (line[i] == quote && line.substr(i, 3) == std::string(3, quote)) {
+                return i + 3;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    static const std::unordered_set<std::string_view>& keywords() {
+        static const std::unordered_set<std::string_view> words = {
+            "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class",
+            "continue", "def", "del", "elif", "else", "except", "finally", "for", "from", "global",
+            "if", "import", "in", "is", "lambda", "match", "case", "nonlocal", "not", "or", "pass",
+            "raise", "return", "self", "try", "while", "with", "yield"
+        };
+        return words;
+    }
+
+    static const std::unordered_set<std::string_view>& builtins() {
+        static const std::unordered_set<std::string_view> words = {
+            "bool", "bytes", "dict", "float", "frozenset", "int", "len", "list", "object", "print",
+            "range", "set", "str", "super", "tuple", "type"
+        };
+        return words;
+    }
+
+    SyntaxColors m_colors;
+};
+
+} // namespace
+
+std::unique_ptr<SyntaxHighlighter> SyntaxHighlighter::cpp(const SyntaxColors& colors) {
+    return std::make_unique<CppHighlighter>(colors);
+}
+
+std::unique_ptr<SyntaxHighlighter> SyntaxHighlighter::json(const SyntaxColors& colors) {
+    return std::make_unique<JsonHighlighter>(colors);
+}
+
+std::unique_ptr<SyntaxHighlighter> SyntaxHighlighter::python(const SyntaxColors& colors) {
+    return std::make_unique<PythonHighlighter>(colors);
+}
+
+//=============================================================================
+// HighlightCache
+//=============================================================================
+
+void HighlightCache::setHighlighter(std::shared_ptr<const SyntaxHighlighter> highlighter) {
+    m_highlighter = std::move(highlighter);
+    reset();
+}
+
+void HighlightCache::reset() {
+    m_window.clear();
+    m_windowFirst = 0;
+    m_checkpoints.clear();
+    m_validLines = 0;
+    m_validState = 0;
+    m_knownLines = 0;
+    m_dirtyEnd = 0;
+}
+
+void HighlightCache::linesChanged(int first, int oldCount, int newCount) {
+    if (first < 0) return;
+    const int end = first + oldCount;  // First line after the replaced ones
+    const int delta = newCount - oldCount;
+
+    // Where the walk had got to: the lines after the edit may converge back to it
+    if (first < m_validLines && m_knownLines == m_validLines) {
+        auto next = checkpointAfter(m_validLines);
+        if (next != m_checkpoints.begin() && (next - 1)->line == m_validLines) {
+            (next - 1)->state = m_validState;
+        } else {
+            m_checkpoints.insert(next, {m_validLines, m_validState});
+        }
+        m_dirtyEnd = 0;
+    }
+    if (first < m_knownLines) {
+        const int dirtyEnd = m_dirtyEnd >= end ? m_dirtyEnd + delta : m_dirtyEnd;
+        m_dirtyEnd = std::max(dirtyEnd, first + newCount);
+    }
+
+    // A line's start state only depends on the lines above it, so a
+    // checkpoint on the first replaced line survives
+    m_checkpoints.erase(std::remove_if(m_checkpoints.begin(), m_checkpoints.end(), [&](const Checkpoint& checkpoint) {
+        return checkpoint.line > first && checkpoint.line < end;
+    }), m_checkpoints.end());
+    for (Checkpoint& checkpoint : m_checkpoints) {
+        if (checkpoint.line >= end) checkpoint.line += delta;
+    }
+    m_knownLines = m_knownLines >= end ? m_knownLines + delta : std::min(m_knownLines, first);
+
+    // Resume from the line above if it is cached, else from the checkpoint before the edit
+    if (first < m_validLines) {
+        const Line* above = cachedLine(first - 1);
+        if (first == 0) {
+            m_validLines = 0;
+            m_validState = 0;
+        } else if (above && above->tokenized && !above->provisional) {
+            m_validLines = first;
+            m_validState = above->endState;
+        } else {
+            auto next = checkpointAfter(first);
+            m_validLines = next != m_checkpoints.begin() ? (next - 1)->line : 0;
+            m_validState = next != m_checkpoints.begin() ? (next - 1)->state : 0;
+        }
+    }
+
+    // The known range ends on a checkpoint; nothing past it is known
+    if (m_knownLines > m_validLines) {
+        auto next = checkpointAfter(m_knownLines);
+        m_knownLines = (next != m_checkpoints.begin() && (next - 1)->line > m_validLines) ? (next - 1)->line : m_validLines;
+    }
+    m_knownLines = std::max(m_knownLines, m_validLines);
+    m_checkpoints.erase(checkpointAfter(m_knownLines), m_checkpoints.end());
+
+    // Reuse window entries in place; only a change in line count shifts the rest
+    const int windowEnd = m_windowFirst + static_cast<int>(m_window.size());
+    if (end <= m_windowFirst) {
+        m_windowFirst += delta;
+    } else if (first >= m_windowFirst && end <= windowEnd) {
+        const int common = std::min(oldCount, newCount);
+        for (int i = first; i < first + common; ++i) {
+            m_window[i - m_windowFirst].tokenized = false;
+        }
+        auto at = m_window.begin() + (first - m_windowFirst) + common;
+        if (oldCount > newCount) {
+            m_window.erase(at, at + (oldCount - newCount));
+        } else if (newCount > oldCount) {
+            m_window.insert(at, static_cast<size_t>(newCount - oldCount), Line());
+        }
+        if (m_window.size() > static_cast<size_t>(constants::TEXT_HIGHLIGHT_CACHED_LINES)) {
+            m_window.resize(static_cast<size_t>(constants::TEXT_HIGHLIGHT_CACHED_LINES));
+        }
+    } else if (first < windowEnd) {
+        // The edit straddles an edge of the window
+        m_window.clear();
+        m_windowFirst = first;
+    }
+}
+
+int HighlightCache::update(const TextBuffer& buffer, int lastLine, int budget) {
+    if (!m_highlighter) return 0;
+
+    lastLine = std::min(lastLine, buffer.lineCount() - 1);
+    int used = 0;
+    while (m_validLines <= lastLine) {
+        const int index = m_validLines;
+
+        auto next = checkpointAfter(index);
+        if (next != m_checkpoints.begin() && (next - 1)->line == index) {
+            // Past the edits and in the recorded state: the rest of the known lines hold
+            if (index < m_knownLines && index >= m_dirtyEnd && (next - 1)->state == m_validState) {
+                const int windowEnd = m_windowFirst + static_cast<int>(m_window.size());
+                for (int i = std::max(index, m_windowFirst); i < std::min(m_knownLines, windowEnd); ++i) {
+                    Line& line = m_window[i - m_windowFirst];
+                    if (line.provisional) line.tokenized = false;
+                }
+                m_validLines = m_knownLines;
+                m_validState = (checkpointAfter(m_knownLines) - 1)->state;
+                continue;
+            }
+            (next - 1)->state = m_validState;
+        } else if (next == m_checkpoints.begin() || index - (next - 1)->line >= CHECKPOINT_INTERVAL) {
+            m_checkpoints.insert(next, {index, m_validState});
+        }
+
+        Line* line = cachedLine(index);
+        if (!line && index == m_windowFirst + static_cast<int>(m_window.size()) &&
+            m_window.size() < static_cast<size_t>(constants::TEXT_HIGHLIGHT_CACHED_LINES)) {
+            m_window.emplace_back();
+            line = &m_window.back();
+        }
+
+        // Unchanged text entered in the same state: the cached result holds
+        if (line && line->tokenized && line->startState == m_validState) {
+            line->provisional = false;
+            m_validState = line->endState;
+        } else {
+            if (used >= budget) break;
+            m_validState = tokenize(buffer, index, m_validState, line);
+            used++;
+        }
+        m_validLines++;
+    }
+    m_knownLines = std::max(m_knownLines, m_validLines);
+    return used;
+}
+
+int HighlightCache::update(const TextBuffer& buffer, int firstLine, int lastLine, int budget) {
+    if (!m_highlighter) return 0;
+
+    firstLine = std::max(firstLine, 0);
+    lastLine = std::min({lastLine, buffer.lineCount() - 1, firstLine + constants::TEXT_HIGHLIGHT_CACHED_LINES - 1});
+    if (firstLine > lastLine) return 0;
+    placeWindow(firstLine, lastLine);
+
+    // A walk this close highlights the view exactly
+    int used = 0;
+    if (firstLine - m_validLines <= CHECKPOINT_INTERVAL) {
+        used = update(buffer, lastLine, budget);
+    }
+
+    // Lines the walk did not reach, or that scrolled back into the window
+    for (int index = firstLine; index <= lastLine; ++index) {
+        Line& line = *cachedLine(index);
+        if (line.tokenized) {
+            if (index < m_validLines) continue;
+            const Line* above = cachedLine(index - 1);
+            SyntaxHighlighter::State start = index == m_validLines ? m_validState
+                : (above && above->tokenized ? above->endState : line.startState);
+            if (line.startState == start) continue;
+        }
+
+        SyntaxHighlighter::State start = 0;
+        bool provisional = false;
+        if (used >= budget || !viewStartState(buffer, index, budget - 1, used, start, provisional)) break;
+        tokenize(buffer, index, start, &line);
+        line.provisional = provisional;
+        used++;
+    }
+    return used;
+}
+
+const std::vector<TextSegment>* HighlightCache::segments(int line) const {
+    const Line* cached = cachedLine(line);
+    return cached && cached->tokenized ? &cached->segments : nullptr;
+}
+
+HighlightCache::Line* HighlightCache::cachedLine(int line) {
+    const int index = line - m_windowFirst;
+    return (index >= 0 && index < static_cast<int>(m_window.size())) ? &m_window[index] : nullptr;
+}
+
+const HighlightCache::Line* HighlightCache::cachedLine(int line) const {
+    const int index = line - m_windowFirst;
+    return (index >= 0 && index < static_cast<int>(m_window.size())) ? &m_window[index] : nullptr;
+}
+
+std::vector<HighlightCache::Checkpoint>::iterator HighlightCache::checkpointAfter(int line) {
+    return std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), line, [](int value, const Checkpoint& checkpoint) {
+        return value < checkpoint.line;
+    });
+}
+
+SyntaxHighlighter::State HighlightCache::tokenize(const TextBuffer& buffer, int index, SyntaxHighlighter::State start, Line* line) {
+    std::vector<TextSegment>& segments = line ? line->segments : m_scratch;
+    segments.clear();
+    SyntaxHighlighter::State end = m_highlighter->highlightLine(buffer.line(index), start, segments);
+    if (line) {
+        std::stable_sort(segments.begin(), segments.end(), [](const TextSegment& a, const TextSegment& b) {
+            return a.startColumn < b.startColumn;
+        });
+        line->startState = start;
+        line->endState = end;
+        line->tokenized = true;
+        line->provisional = false;
+    }
+    return end;
+}
+
+bool HighlightCache::viewStartState(const TextBuffer& buffer, int index, int budget, int& used,
+                                    SyntaxHighlighter::State& state, bool& provisional) {
+    provisional = index > m_validLines;
+    if (index == m_validLines) {
+        state = m_validState;
+        return true;
+    }
+    const Line* above = cachedLine(index - 1);
+    if (above && above->tokenized) {
+        state = above->endState;
+        provisional = provisional || above->provisional;
+        return true;
+    }
+
+    // Tokenize from the nearest known state: a checkpoint, or where the walk is
+    int from = 0;
+    state = 0;
+    auto next = checkpointAfter(index);
+    if (next != m_checkpoints.begin()) {
+        from = (next - 1)->line;
+        state = (next - 1)->state;
+    }
+    if (m_validLines < index && m_validLines > from) {
+        from = m_validLines;
+        state = m_validState;
+    }
+
+    // Too far ahead of the walk: assume the known state carries over
+    if (provisional && index - from > CHECKPOINT_INTERVAL) return true;
+    if (used + (index - from) > budget) return false;
+    for (int i = from; i < index; ++i) {
+        state = tokenize(buffer, i, state, nullptr);
+    }
+    used += index - from;
+    return true;
+}
+
+void HighlightCache::placeWindow(int firstLine, int lastLine) {
+    const int capacity = constants::TEXT_HIGHLIGHT_CACHED_LINES;
+    if (firstLine < m_windowFirst || lastLine >= m_windowFirst + capacity) {
+        // Centre the range, keeping the lines already cached there
+        const int windowFirst = std::max(0, firstLine - (capacity - (lastLine - firstLine + 1)) / 2);
+        const int shift = windowFirst - m_windowFirst;
+        if (shift >= static_cast<int>(m_window.size()) || -shift >= capacity) {
+            m_window.clear();
+        } else if (shift > 0) {
+            m_window.erase(m_window.begin(), m_window.begin() + shift);
+        } else if (shift < 0) {
+            m_window.insert(m_window.begin(), static_cast<size_t>(-shift), Line());
+        }
+        m_windowFirst = windowFirst;
+        if (m_window.size() > static_cast<size_t>(capacity)) {
+            m_window.resize(static_cast<size_t>(capacity));
+        }
+    }
+    if (static_cast<int>(m_window.size()) <= lastLine - m_windowFirst) {
+        m_window.resize(static_cast<size_t>(lastLine - m_windowFirst + 1));
+    }
+}
+
+} // namespace fst
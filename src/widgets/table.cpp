@@ -44,6 +44,23 @@ static std::unordered_map<WidgetId, TableState> s_tableStates;
 static TableState* s_currentTable = nullptr;
 static WidgetId s_currentTableId = 0;
 
+// Header label widths, measured once until the headers or the font change
+static const std::vector<float>& headerTextWidths(Context& ctx, WidgetId key,
+                                                  const std::vector<TableColumn>& columns, Font* font) {
+    uint64_t headersHash = columns.size();
+    for (const auto& col : columns) {
+        headersHash = hashCombine(headersHash, hashString(col.header));
+    }
+    return ctx.measureCache<std::vector<float>>(key, headersHash, [&] {
+        std::vector<float> widths;
+        widths.reserve(columns.size());
+        for (const auto& col : columns) {
+            widths.push_back(font->measureText(col.header).x);
+        }
+        return widths;
+    });
+}
+
 //=============================================================================
 // Table Class Implementation
 //=============================================================================
@@ -128,6 +145,11 @@ void Table::renderHeader(Context& ctx) {
         theme.colors.border
     );
 
+    static const std::vector<float> kNoWidths;
+    const std::vector<float>& headerWidths = font
+        ? headerTextWidths(ctx, ctx.makeId("##header_widths"), m_columns, font)
+        : kNoWidths;
+
     float x = headerRect.x();
     for (size_t i = 0; i < m_columns.size(); ++i) {
         const TableColumn& col = m_columns[i];
@@ -157,7 +179,7 @@ void Table::renderHeader(Context& ctx) {
         // Draw header text
         if (font) {
             Vec2 textPos;
-            Vec2 textSize = font->measureText(col.header);
+            Vec2 textSize(headerWidths[i], font->lineHeight());
             float padding = theme.metrics.paddingSmall;
 
             switch (col.alignment) {
@@ -471,6 +493,11 @@ void TableHeader(Context& ctx, int sortColumn, bool sortAscending) {
                Vec2(headerRect.right(), headerRect.bottom()),
                theme.colors.border);
 
+    static const std::vector<float> kNoWidths;
+    const std::vector<float>& headerWidths = font
+        ? headerTextWidths(ctx, combineIds(s_currentTableId, "header_widths"_id), state.columns, font)
+        : kNoWidths;
+
     float x = headerRect.x();
     for (size_t i = 0; i < state.columns.size(); ++i) {
         const TableColumn& col = state.columns[i];
@@ -493,7 +520,7 @@ void TableHeader(Context& ctx, int sortColumn, bool sortAscending) {
         }
 
         if (font) {
-            Vec2 textSize = font->measureText(col.header);
+            Vec2 textSize(headerWidths[i], font->lineHeight());
             float padding = theme.metrics.paddingSmall;
             Vec2 textPos;
 
@@ -32,6 +32,8 @@ struct TextAreaState {
     size_t selectionEnd = 0;
     size_t selectionAnchor = 0;
     bool selecting = false;
+    bool pasteReady = false;     ///< Clipboard answer waiting to be inserted
+    std::string pasteText;
 };
 
 static std::unordered_map<WidgetId, TextAreaState> s_textAreaStates;
@@ -252,7 +254,20 @@ bool TextArea(Context& ctx, const char* id, std::string& value, const TextAreaOp
         }
 
         if (ctrl && input.isKeyPressed(Key::V)) {
-            std::string clip = ctx.window().getClipboardText();
+            // The clipboard owner may answer in a later frame
+            ctx.window().requestClipboardText([widgetId](const std::string& text) {
+                auto it = s_textAreaStates.find(widgetId);
+                if (it != s_textAreaStates.end()) {
+                    it->second.pasteText = text;
+                    it->second.pasteReady = true;
+                }
+            });
+        }
+
+        if (state.pasteReady) {
+            std::string clip = std::move(state.pasteText);
+            state.pasteText.clear();
+            state.pasteReady = false;
             if (!clip.empty()) {
                 deleteSelection(state, value);
                 value.insert(state.cursorPos, clip);
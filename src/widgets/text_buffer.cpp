@@ -0,0 +1,438 @@
+/**
+ * @file text_buffer.cpp
+ * @brief Piece table text storage for TextEditor.
+ */
+
+#include "fastener/widgets/text_buffer.h"
+#include "fastener/platform/mapped_file.h"
+#include <algorithm>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FST_TEXT_SCAN_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace fst {
+
+//=============================================================================
+// Line Break Scan
+//=============================================================================
+
+static unsigned lowestBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+static void scanLineBreaks(const char* data, size_t begin, size_t end, std::vector<size_t>& out) {
+    size_t i = begin;
+#ifdef FST_TEXT_SCAN_SSE2
+    // 16 bytes per compare; the mask has one bit per newline
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 16 <= end; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline)));
+        while (mask != 0) {
+            out.push_back(i + lowestBit(mask));
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i < end; ++i) {
+        if (data[i] == '\n') out.push_back(i);
+    }
+}
+
+std::vector<size_t> TextBuffer::indexLines(const char* data, size_t size) {
+    std::vector<size_t> breaks;
+    if (!data || size == 0) return breaks;
+    
+    // Large inputs are scanned in parallel slices and joined in order
+    const size_t sliceBytes = 8u << 20;
+    size_t slices = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()),
+                                     (size + sliceBytes - 1) / sliceBytes);
+    if (slices <= 1) {
+        scanLineBreaks(data, 0, size, breaks);
+        return breaks;
+    }
+    
+    std::vector<std::vector<size_t>> parts(slices);
+    std::vector<std::thread> workers;
+    size_t step = size / slices;
+    for (size_t i = 0; i < slices; ++i) {
+        size_t begin = i * step;
+        size_t end = (i + 1 == slices) ? size : begin + step;
+        workers.emplace_back([data, begin, end, &part = parts[i]] {
+            scanLineBreaks(data, begin, end, part);
+        });
+    }
+    size_t total = 0;
+    for (size_t i = 0; i < slices; ++i) {
+        workers[i].join();
+        total += parts[i].size();
+    }
+    breaks.reserve(total);
+    for (const auto& part : parts) {
+        breaks.insert(breaks.end(), part.begin(), part.end());
+    }
+    return breaks;
+}
+
+//=============================================================================
+// TextBuffer - Document
+//=============================================================================
+
+void TextBuffer::setText(const std::string& text) {
+    m_mapping.reset();
+    auto original = std::make_shared<std::string>();
+    original->reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') continue;
+        *original += text[i];
+    }
+    m_originalSize = original->size();
+    m_originalBreaks = std::make_shared<const std::vector<size_t>>(indexLines(original->data(), original->size()));
+    m_original = std::move(original);
+    m_added.clear();
+    m_addedBreaks.clear();
+
+    m_nodes.clear();
+    m_free.clear();
+    m_root = m_originalSize == 0 ? -1 : newNode(0, 0, m_originalSize);
+}
+
+void TextBuffer::setMapped(std::shared_ptr<const MappedFile> file, std::vector<size_t> lineBreaks) {
+    m_original.reset();
+    m_mapping = std::move(file);
+    m_originalSize = m_mapping && m_mapping->data() ? m_mapping->size() : 0;
+    m_originalBreaks = std::make_shared<const std::vector<size_t>>(std::move(lineBreaks));
+    m_added.clear();
+    m_addedBreaks.clear();
+
+    m_nodes.clear();
+    m_free.clear();
+    m_root = m_originalSize == 0 ? -1 : newNode(0, 0, m_originalSize);
+}
+
+std::string TextBuffer::text() const {
+    std::string result;
+    result.reserve(length());
+    appendRange(m_root, 0, length(), result);
+    return result;
+}
+
+size_t TextBuffer::length() const {
+    return subLength(m_root);
+}
+
+int TextBuffer::lineCount() const {
+    return static_cast<int>(subNewlines(m_root)) + 1;
+}
+
+size_t TextBuffer::lineStart(int index) const {
+    if (index <= 0) return 0;
+    if (index >= lineCount()) return length();
+
+    // Find the index-th newline; the line starts right after it
+    size_t remaining = static_cast<size_t>(index);
+    size_t offset = 0;
+    int node = m_root;
+    while (node >= 0) {
+        const Node& n = m_nodes[node];
+        size_t leftNewlines = subNewlines(n.left);
+        if (remaining <= leftNewlines) {
+            node = n.left;
+            continue;
+        }
+        remaining -= leftNewlines;
+        offset += subLength(n.left);
+        if (remaining <= n.newlines) {
+            const std::vector<size_t>& breaks = sourceBreaks(n.source);
+            auto first = std::lower_bound(breaks.begin(), breaks.end(), n.start);
+            size_t breakPos = *(first + static_cast<std::ptrdiff_t>(remaining - 1));
+            return offset + (breakPos - n.start) + 1;
+        }
+        remaining -= n.newlines;
+        offset += n.length;
+        node = n.right;
+    }
+    return length();
+}
+
+size_t TextBuffer::lineEnd(int index) const {
+    if (index + 1 >= lineCount()) return length();
+    size_t end = lineStart(index + 1) - 1;
+    if (end > lineStart(index) && charAt(end - 1) == '\r') end--;
+    return end;
+}
+
+int TextBuffer::lineLength(int index) const {
+    if (index < 0 || index >= lineCount()) return 0;
+    return static_cast<int>(lineEnd(index) - lineStart(index));
+}
+
+std::string TextBuffer::line(int index) const {
+    if (index < 0 || index >= lineCount()) return std::string();
+    size_t start = lineStart(index);
+    return substr(start, static_cast<size_t>(lineLength(index)));
+}
+
+size_t TextBuffer::offsetOf(TextPosition pos) const {
+    int lineIndex = std::clamp(pos.line, 0, lineCount() - 1);
+    int column = std::clamp(pos.column, 0, lineLength(lineIndex));
+    return lineStart(lineIndex) + static_cast<size_t>(column);
+}
+
+TextPosition TextBuffer::positionOf(size_t offset) const {
+    offset = std::min(offset, length());
+    int lineIndex = static_cast<int>(newlinesBefore(offset));
+    return {lineIndex, static_cast<int>(offset - lineStart(lineIndex))};
+}
+
+std::string TextBuffer::substr(size_t offset, size_t count) const {
+    std::string result;
+    size_t total = length();
+    if (offset >= total || count == 0) return result;
+    size_t end = offset + std::min(count, total - offset);
+    result.reserve(end - offset);
+    appendRange(m_root, offset, end, result);
+    return result;
+}
+
+std::string TextBuffer::range(TextPosition start, TextPosition end) const {
+    size_t a = offsetOf(start);
+    size_t b = offsetOf(end);
+    if (b < a) std::swap(a, b);
+    return substr(a, b - a);
+}
+
+void TextBuffer::insert(size_t offset, const std::string& text) {
+    if (text.empty()) return;
+    offset = std::min(offset, length());
+
+    size_t addedEnd = m_added.size();
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') m_addedBreaks.push_back(addedEnd + i);
+    }
+    m_added += text;
+
+    int left = -1;
+    int right = -1;
+    split(m_root, offset, left, right);
+
+    // Typing appends to the added buffer right where the previous insert
+    // ended; grow that piece instead of adding one per keystroke
+    if (!extendLast(left, text.size())) {
+        left = merge(left, newNode(1, addedEnd, text.size()));
+    }
+    m_root = merge(left, right);
+}
+
+void TextBuffer::erase(size_t offset, size_t count) {
+    size_t total = length();
+    if (offset >= total || count == 0) return;
+    count = std::min(count, total - offset);
+
+    int left = -1;
+    int middle = -1;
+    int right = -1;
+    split(m_root, offset, left, middle);
+    int removed = -1;
+    split(middle, count, removed, right);
+    freeTree(removed);
+    m_root = merge(left, right);
+}
+
+//=============================================================================
+// TextBuffer - Piece tree
+//=============================================================================
+
+const char* TextBuffer::sourceData(uint8_t source) const {
+    if (source == 1) return m_added.data();
+    return m_mapping ? m_mapping->data() : (m_original ? m_original->data() : nullptr);
+}
+
+char TextBuffer::charAt(size_t offset) const {
+    int node = m_root;
+    while (node >= 0) {
+        const Node& n = m_nodes[node];
+        size_t leftLength = subLength(n.left);
+        if (offset < leftLength) {
+            node = n.left;
+            continue;
+        }
+        offset -= leftLength;
+        if (offset < n.length) {
+            return sourceData(n.source)[n.start + offset];
+        }
+        offset -= n.length;
+        node = n.right;
+    }
+    return '\0';
+}
+
+size_t TextBuffer::countBreaks(uint8_t source, size_t begin, size_t end) const {
+    const std::vector<size_t>& breaks = sourceBreaks(source);
+    auto first = std::lower_bound(breaks.begin(), breaks.end(), begin);
+    auto last = std::lower_bound(first, breaks.end(), end);
+    return static_cast<size_t>(last - first);
+}
+
+int TextBuffer::newNode(uint8_t source, size_t start, size_t length) {
+    // xorshift32: priorities only need to be well spread
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    Node node;
+    node.source = source;
+    node.start = start;
+    node.length = length;
+    node.newlines = countBreaks(source, start, start + length);
+    node.priority = m_seed;
+    node.subLength = length;
+    node.subNewlines = node.newlines;
+
+    if (!m_free.empty()) {
+        int index = m_free.back();
+        m_free.pop_back();
+        m_nodes[index] = node;
+        return index;
+    }
+    m_nodes.push_back(node);
+    return static_cast<int>(m_nodes.size() - 1);
+}
+
+void TextBuffer::freeTree(int node) {
+    if (node < 0) return;
+    freeTree(m_nodes[node].left);
+    freeTree(m_nodes[node].right);
+    m_free.push_back(node);
+}
+
+void TextBuffer::update(int node) {
+    Node& n = m_nodes[node];
+    n.subLength = subLength(n.left) + n.length + subLength(n.right);
+    n.subNewlines = subNewlines(n.left) + n.newlines + subNewlines(n.right);
+}
+
+int TextBuffer::merge(int a, int b) {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    if (m_nodes[a].priority > m_nodes[b].priority) {
+        m_nodes[a].right = merge(m_nodes[a].right, b);
+        update(a);
+        return a;
+    }
+    m_nodes[b].left = merge(a, m_nodes[b].left);
+    update(b);
+    return b;
+}
+
+void TextBuffer::split(int node, size_t offset, int& left, int& right) {
+    if (node < 0) {
+        left = right = -1;
+        return;
+    }
+
+    // Indices only: newNode() may grow m_nodes while we recurse
+    size_t leftLength = subLength(m_nodes[node].left);
+    size_t pieceLength = m_nodes[node].length;
+    int a = -1;
+    int b = -1;
+
+    if (offset <= leftLength) {
+        split(m_nodes[node].left, offset, a, b);
+        m_nodes[node].left = b;
+        update(node);
+        left = a;
+        right = node;
+    } else if (offset >= leftLength + pieceLength) {
+        split(m_nodes[node].right, offset - leftLength - pieceLength, a, b);
+        m_nodes[node].right = a;
+        update(node);
+        left = node;
+        right = b;
+    } else {
+        // The cut falls inside this piece
+        size_t head = offset - leftLength;
+        int tail = newNode(m_nodes[node].source, m_nodes[node].start + head, pieceLength - head);
+        Node& n = m_nodes[node];
+        n.length = head;
+        n.newlines = countBreaks(n.source, n.start, n.start + head);
+        int oldRight = n.right;
+        n.right = -1;
+        update(node);
+        left = node;
+        right = merge(tail, oldRight);
+    }
+}
+
+bool TextBuffer::extendLast(int node, size_t extra) {
+    if (node < 0) return false;
+    Node& n = m_nodes[node];
+    if (n.right >= 0) {
+        if (!extendLast(n.right, extra)) return false;
+        update(node);
+        return true;
+    }
+
+    // Only the piece ending exactly where the new text was appended
+    if (n.source != 1 || n.start + n.length != m_added.size() - extra) return false;
+    n.length += extra;
+    n.newlines = countBreaks(1, n.start, n.start + n.length);
+    update(node);
+    return true;
+}
+
+size_t TextBuffer::newlinesBefore(size_t offset) const {
+    size_t count = 0;
+    int node = m_root;
+    while (node >= 0) {
+        const Node& n = m_nodes[node];
+        size_t leftLength = subLength(n.left);
+        if (offset <= leftLength) {
+            node = n.left;
+            continue;
+        }
+        count += subNewlines(n.left);
+        offset -= leftLength;
+        if (offset <= n.length) {
+            return count + countBreaks(n.source, n.start, n.start + offset);
+        }
+        count += n.newlines;
+        offset -= n.length;
+        node = n.right;
+    }
+    return count;
+}
+
+void TextBuffer::appendRange(int node, size_t begin, size_t end, std::string& out) const {
+    // [begin, end) is relative to this subtree; skip subtrees outside it
+    if (node < 0 || begin >= end) return;
+    const Node& n = m_nodes[node];
+    size_t leftLength = subLength(n.left);
+
+    if (begin < leftLength) {
+        appendRange(n.left, begin, std::min(end, leftLength), out);
+    }
+    size_t pieceBegin = std::max(begin, leftLength);
+    size_t pieceEnd = std::min(end, leftLength + n.length);
+    if (pieceBegin < pieceEnd) {
+        out.append(sourceData(n.source) + n.start + (pieceBegin - leftLength), pieceEnd - pieceBegin);
+    }
+    size_t rightBegin = leftLength + n.length;
+    if (end > rightBegin) {
+        appendRange(n.right, begin > rightBegin ? begin - rightBegin : 0, end - rightBegin, out);
+    }
+}
+
+} // namespace fst
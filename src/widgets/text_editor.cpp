@@ -7,6 +7,7 @@
  */
 
 #include "fastener/widgets/text_editor.h"
+#include "fastener/core/constants.h"
 #include "fastener/core/context.h"
 #include "fastener/graphics/draw_list.h"
 #include "fastener/graphics/font.h"
@@ -15,8 +16,10 @@
 #include "fastener/ui/theme.h"
 
 #include "fastener/platform/window.h"
-#include <sstream>
+#include "fastener/platform/mapped_file.h"
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstdint>
 
 namespace fst {
@@ -25,49 +28,71 @@ namespace fst {
 // TextEditor - Construction
 //=============================================================================
 
-TextEditor::TextEditor() {
-    m_lines.push_back("");
-}
+TextEditor::TextEditor() = default;
 
 TextEditor::~TextEditor() = default;
+TextEditor::TextEditor(TextEditor&&) noexcept = default;
 
 void TextEditor::setText(const std::string& text) {
-    m_lines.clear();
-    std::stringstream ss(text);
-    std::string line;
-    while (std::getline(ss, line, '\n')) {
-        if (!line.empty() && line.back() == '\r') {
-            line.pop_back();
-        }
-        m_lines.push_back(line);
-    }
-    if (m_lines.empty()) m_lines.push_back("");
-    if (!text.empty() && text.back() == '\n') {
-        m_lines.push_back("");
-    }
-
-    m_cursor = {0, 0};
-    m_selection.clear();
-    m_undoStack.clear();
-    m_redoStack.clear();
+    resetDocumentState();
+    m_buffer.setText(text);
+    m_highlights.reset();
 }
 
 std::string TextEditor::getText() const {
-    std::string result;
-    for (size_t i = 0; i < m_lines.size(); ++i) {
-        result += m_lines[i];
-        if (i < m_lines.size() - 1) result += "\n";
-    }
-    return result;
+    return m_buffer.text();
 }
 
 void TextEditor::clear() {
-    m_lines.clear();
-    m_lines.push_back("");
+    resetDocumentState();
+    m_buffer.setText(std::string());
+    m_highlights.reset();
+}
+
+bool TextEditor::openFile(const std::string& path, bool readOnly) {
+    auto file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        return false;
+    }
+    
+    resetDocumentState();
+    m_buffer.setText(std::string());
+    m_highlights.reset();
+    m_readOnly = readOnly;
+    m_pendingFile = file;
+    m_pendingIndex = std::async(std::launch::async, [file] {
+        return TextBuffer::indexLines(file->data(), file->size());
+    });
+    return true;
+}
+
+void TextEditor::waitUntilLoaded() {
+    finishLoading(true);
+}
+
+void TextEditor::finishLoading(bool wait) {
+    if (!m_pendingIndex.valid()) return;
+    if (!wait && m_pendingIndex.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return;
+    
+    m_buffer.setMapped(std::move(m_pendingFile), m_pendingIndex.get());
+    m_pendingFile.reset();
+    m_highlights.reset();
+    markSearchStale();
+}
+
+void TextEditor::resetDocumentState() {
+    // Waits for an indexing thread that is still running
+    m_pendingIndex = {};
+    m_pendingFile.reset();
+    m_readOnly = false;
     m_cursor = {0, 0};
     m_selection.clear();
     m_undoStack.clear();
     m_redoStack.clear();
+    m_typingGroupOpen = false;
+    m_scrollOffset = {0, 0};
+    m_matches.clear();
+    markSearchStale();
 }
 
 void TextEditor::setLineAnnotations(std::vector<TextLineAnnotation> annotations) {
@@ -99,13 +124,23 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
     dl.addRectFilled(bounds, theme.colors.windowBackground);
     dl.addRect(bounds, theme.colors.border);
 
+    finishLoading(false);
+    if (isLoading()) {
+        const char* placeholder = "Indexing lines...";
+        Vec2 size = font->measureText(placeholder);
+        dl.addText(font, bounds.center() - size * 0.5f, placeholder, theme.colors.textSecondary);
+        return;
+    }
+
     float rowHeight = font->lineHeight() * options.lineHeight;
     float charWidth = font->measureText("M").x; 
     float gutterWidth = options.showLineNumbers ? 50.0f : 0.0f;
     m_lastRowHeight = rowHeight;
     m_lastViewportHeight = bounds.height();
 
-    handleInput(ctx, bounds, rowHeight, charWidth, gutterWidth, widgetState.focused, options.suppressNavigationKeys);
+    handleInput(ctx, bounds, rowHeight, charWidth, gutterWidth, widgetState.focused, options.suppressNavigationKeys,
+                !m_readOnly && !options.readOnly);
+    pollSearch(false);
 
     dl.pushClipRect(bounds);
 
@@ -122,7 +157,7 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
 
     int startLine = static_cast<int>(m_scrollOffset.y / rowHeight);
     int visibleLines = static_cast<int>(bounds.height() / rowHeight) + 1;
-    int endLine = std::min(static_cast<int>(m_lines.size()), startLine + visibleLines);
+    int endLine = std::min(m_buffer.lineCount(), startLine + visibleLines);
     const auto findLineAnnotation = [&](int line) -> const TextLineAnnotation* {
         auto it = std::lower_bound(
             m_lineAnnotations.begin(),
@@ -139,13 +174,32 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
     const Vec2 mousePos = input.mousePos();
     const bool isMouseInside = bounds.contains(mousePos);
     const int hoveredLine = isMouseInside
-        ? std::clamp(static_cast<int>((mousePos.y - bounds.y() + m_scrollOffset.y) / rowHeight), 0, static_cast<int>(m_lines.size() - 1))
+        ? std::clamp(static_cast<int>((mousePos.y - bounds.y() + m_scrollOffset.y) / rowHeight), 0, m_buffer.lineCount() - 1)
         : -1;
     const TextLineAnnotation* hoveredAnnotation = nullptr;
 
+    // Visible lines first, then whatever budget is left on the lines below
+    if (m_highlights.highlighter()) {
+        int budget = constants::TEXT_HIGHLIGHT_LINES_PER_FRAME;
+        budget -= m_highlights.update(m_buffer, startLine, endLine - 1, budget);
+        if (options.highlightAhead && budget > 0) {
+            m_highlights.update(m_buffer, m_highlights.validLines() + budget, budget);
+        }
+    }
+
+    // Matches are sorted and disjoint: start at the first one not ending above the view
+    const size_t viewStart = startLine < endLine ? m_buffer.lineStart(startLine) : 0;
+    size_t matchIndex = static_cast<size_t>(std::partition_point(m_matches.begin(), m_matches.end(), [&](const TextMatch& match) {
+        return match.offset + match.length <= viewStart;
+    }) - m_matches.begin());
+    const size_t selectionBegin = m_buffer.offsetOf(m_selection.min());
+    const size_t selectionEnd = m_buffer.offsetOf(m_selection.max());
+
+    std::vector<TextColorRun> colorRuns;  // Reused across lines
     for (int i = startLine; i < endLine; ++i) {
         float y = bounds.y() + (i * rowHeight) - m_scrollOffset.y;
         if (y + rowHeight < bounds.y() || y > bounds.bottom()) continue;
+        const std::string lineText = m_buffer.line(i);
 
         if (const TextLineAnnotation* annotation = findLineAnnotation(i)) {
             dl.addRectFilled(Rect(bounds.x(), y, bounds.width(), rowHeight), annotation->highlightColor);
@@ -154,6 +208,28 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
             }
         }
 
+        if (matchIndex < m_matches.size()) {
+            const std::string_view lineView(lineText);
+            const size_t lineBegin = m_buffer.lineStart(i);
+            const size_t lineEnd = lineBegin + lineText.size();
+            while (matchIndex < m_matches.size() && m_matches[matchIndex].offset + m_matches[matchIndex].length <= lineBegin) {
+                ++matchIndex;
+            }
+            for (size_t k = matchIndex; k < m_matches.size() && m_matches[k].offset <= lineEnd; ++k) {
+                const TextMatch& match = m_matches[k];
+                const size_t begin = std::max(match.offset, lineBegin) - lineBegin;
+                const size_t end = std::min(match.offset + match.length, lineEnd) - lineBegin;
+                const float x1 = font->measureText(lineView.substr(0, begin)).x;
+                const float x2 = match.offset + match.length > lineEnd
+                    ? font->measureText(lineView).x + charWidth * 0.5f  // Continues past the line break
+                    : font->measureText(lineView.substr(0, end)).x;
+                const bool current = match.offset == selectionBegin && match.offset + match.length == selectionEnd;
+                Color color = theme.colors.warning;
+                color.a = current ? 140 : 60;
+                dl.addRectFilled(Rect(textBounds.x() + 5 + x1, y, std::max(2.0f, x2 - x1), rowHeight), color);
+            }
+        }
+
         if (options.showLineNumbers) {
             std::string lineNum = std::to_string(i + 1);
             float tw = font->measureText(lineNum).x;
@@ -166,9 +242,9 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
             TextPosition maxP = m_selection.max();
             if (i >= minP.line && i <= maxP.line) {
                 float x1 = 0, x2 = 0;
-                if (i == minP.line) x1 = font->measureText(m_lines[i].substr(0, std::min((int)m_lines[i].length(), minP.column))).x;
-                if (i == maxP.line) x2 = font->measureText(m_lines[i].substr(0, std::min((int)m_lines[i].length(), maxP.column))).x;
-                else x2 = font->measureText(m_lines[i]).x + charWidth * 0.5f;
+                if (i == minP.line) x1 = font->measureText(lineText.substr(0, std::min((int)lineText.length(), minP.column))).x;
+                if (i == maxP.line) x2 = font->measureText(lineText.substr(0, std::min((int)lineText.length(), maxP.column))).x;
+                else x2 = font->measureText(lineText).x + charWidth * 0.5f;
                 dl.addRectFilled(Rect(textBounds.x() + 5 + x1, y, std::max(2.0f, x2 - x1), rowHeight), 
                                  Color(theme.colors.primary.r, theme.colors.primary.g, theme.colors.primary.b, 80));
             }
@@ -177,7 +253,7 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
         if (i == m_cursor.line) {
             dl.addRectFilled(Rect(textBounds.x(), y, textBounds.width(), rowHeight), Color(255, 255, 255, 10));
             if (widgetState.focused && ctx.window().isFocused() && static_cast<int>(ctx.time() * 2) % 2 == 0) {
-                float cx = textBounds.x() + 5 + font->measureText(m_lines[i].substr(0, m_cursor.column)).x;
+                float cx = textBounds.x() + 5 + font->measureText(lineText.substr(0, m_cursor.column)).x;
                 dl.addLine(Vec2(cx, y + 2), Vec2(cx, y + rowHeight - 2), theme.colors.primary, 2.0f);
             }
         }
@@ -185,15 +261,26 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
 
         // Text rendering (styled or plain)
         Vec2 textPos(textBounds.x() + 5, y + (rowHeight - font->lineHeight()) / 2);
-        const std::string& lineText = m_lines[i];
 
-        if (m_styleProvider) {
-            std::vector<TextSegment> segments = m_styleProvider(i, lineText);
+        std::vector<TextSegment> providedSegments;
+        const std::vector<TextSegment>* lineSegments = nullptr;
+        if (m_highlights.highlighter()) {
+            lineSegments = m_highlights.segments(i);  // Already sorted; null until tokenized
+        } else if (m_styleProvider) {
+            providedSegments = m_styleProvider(i, lineText);
             
             // Sort segments by start column to ensure correct rendering order
-            std::sort(segments.begin(), segments.end(), [](const TextSegment& a, const TextSegment& b) {
+            std::sort(providedSegments.begin(), providedSegments.end(), [](const TextSegment& a, const TextSegment& b) {
                 return a.startColumn < b.startColumn;
             });
+            lineSegments = &providedSegments;
+        }
+
+        if (lineSegments) {
+            const std::vector<TextSegment>& segments = *lineSegments;
+
+            const std::string_view lineView(lineText);
+            const int lineLength = static_cast<int>(lineText.length());
 
             // Draw segment backgrounds first so syntax colors remain unchanged.
             for (const auto& segment : segments) {
@@ -201,18 +288,15 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
                     continue;
                 }
 
-                const int start = std::clamp(segment.startColumn, 0, static_cast<int>(lineText.length()));
-                const int end = std::clamp(segment.endColumn, 0, static_cast<int>(lineText.length()));
+                const int start = std::clamp(segment.startColumn, 0, lineLength);
+                const int end = std::clamp(segment.endColumn, 0, lineLength);
                 if (end <= start) {
                     continue;
                 }
 
-                const std::string before = lineText.substr(0, static_cast<size_t>(start));
-                const std::string highlighted = lineText.substr(
-                    static_cast<size_t>(start),
-                    static_cast<size_t>(end - start));
-                const float x1 = textPos.x + font->measureText(before).x;
-                const float width = std::max(1.0f, font->measureText(highlighted).x);
+                const float x1 = textPos.x + font->measureText(lineView.substr(0, static_cast<size_t>(start))).x;
+                const float width = std::max(1.0f, font->measureText(
+                    lineView.substr(static_cast<size_t>(start), static_cast<size_t>(end - start))).x);
                 const Rect highlightRect(
                     x1,
                     y + rowHeight * 0.14f,
@@ -221,42 +305,48 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
                 dl.addRectFilled(highlightRect, segment.background, 2.0f);
             }
 
+            // One pass over the line; overlapping segments start where the previous one ended
+            colorRuns.clear();
             int currentColumn = 0;
-            float currentX = textPos.x;
-
             for (const auto& segment : segments) {
-                const int start = std::clamp(segment.startColumn, 0, static_cast<int>(lineText.length()));
-                const int end = std::clamp(segment.endColumn, 0, static_cast<int>(lineText.length()));
+                const int start = std::clamp(segment.startColumn, currentColumn, lineLength);
+                const int end = std::clamp(segment.endColumn, 0, lineLength);
                 if (end <= start) {
                     continue;
                 }
-
-                // Render unstyled text before this segment
-                if (start > currentColumn) {
-                    std::string plain = lineText.substr(currentColumn, start - currentColumn);
-                    dl.addText(font, Vec2(currentX, textPos.y), plain, theme.colors.text);
-                    currentX += font->measureText(plain).x;
-                }
-
-                // Render styled segment
-                const int len = end - start;
-                std::string styled = lineText.substr(start, len);
-                dl.addText(font, Vec2(currentX, textPos.y), styled, segment.color);
-                currentX += font->measureText(styled).x;
-
-                currentColumn = std::max(currentColumn, end);
-            }
-
-            // Render remaining unstyled text
-            if (currentColumn < (int)lineText.length()) {
-                std::string plain = lineText.substr(currentColumn);
-                dl.addText(font, Vec2(currentX, textPos.y), plain, theme.colors.text);
+                colorRuns.push_back({start, end, segment.color});
+                currentColumn = end;
             }
+            dl.addTextColored(font, textPos, lineText, colorRuns, theme.colors.text);
         } else {
             dl.addText(font, textPos, lineText, theme.colors.text);
         }
     }
 
+    // IME composition floats over the text at the caret until committed
+    if (widgetState.focused && input.hasPreedit() && m_cursor.line >= startLine && m_cursor.line < endLine) {
+        const std::string& preedit = input.preeditText();
+        float y = bounds.y() + (m_cursor.line * rowHeight) - m_scrollOffset.y;
+        float x = textBounds.x() + 5 + font->measureText(m_buffer.line(m_cursor.line).substr(0, m_cursor.column)).x;
+        float textY = y + (rowHeight - font->lineHeight()) / 2;
+        float width = font->measureText(preedit).x;
+        
+        dl.addRectFilled(Rect(x, y, width, rowHeight), theme.colors.windowBackground);
+        dl.addText(font, Vec2(x, textY), preedit, theme.colors.text);
+        dl.addLine(Vec2(x, y + rowHeight - 2), Vec2(x + width, y + rowHeight - 2), theme.colors.textSecondary);
+        
+        // Segment being converted, or the caret inside the composition
+        int begin = input.preeditCursorBegin();
+        int end = input.preeditCursorEnd();
+        float x1 = x + font->measureText(preedit.substr(0, static_cast<size_t>(begin))).x;
+        if (end > begin) {
+            float x2 = x + font->measureText(preedit.substr(0, static_cast<size_t>(end))).x;
+            dl.addLine(Vec2(x1, y + rowHeight - 2), Vec2(x2, y + rowHeight - 2), theme.colors.primary, 2.0f);
+        } else {
+            dl.addLine(Vec2(x1, y + 2), Vec2(x1, y + rowHeight - 2), theme.colors.primary, 2.0f);
+        }
+    }
+
     dl.popClipRect();
 
     if (hoveredAnnotation &&
@@ -318,27 +408,49 @@ void TextEditor::render(Context& ctx, const Rect& bounds, const TextEditorOption
 
 void TextEditor::undo() {
     if (m_undoStack.empty()) return;
+    m_typingGroupOpen = false;
     m_isUndoingRedoing = true;
-    EditAction action = m_undoStack.back();
+    EditAction action = std::move(m_undoStack.back());
     m_undoStack.pop_back();
     applyAction(action, true);
-    m_redoStack.push_back(action);
+    m_redoStack.push_back(std::move(action));
     m_isUndoingRedoing = false;
 }
 
 void TextEditor::redo() {
     if (m_redoStack.empty()) return;
+    m_typingGroupOpen = false;
     m_isUndoingRedoing = true;
-    EditAction action = m_redoStack.back();
+    EditAction action = std::move(m_redoStack.back());
     m_redoStack.pop_back();
     applyAction(action, false);
-    m_undoStack.push_back(action);
+    m_undoStack.push_back(std::move(action));
     m_isUndoingRedoing = false;
 }
 
-void TextEditor::recordAction(EditActionType type, const std::string& text, TextPosition start, TextPosition end, TextPosition cursorBefore) {
+void TextEditor::recordAction(EditActionType type, const std::string& text, TextPosition start, TextPosition end, TextPosition cursorBefore, bool typed) {
     if (m_isUndoingRedoing) return;
     
+    // Typing continues the previous typed insert unless the caret moved, a
+    // line was broken or a new word starts
+    bool mergeable = typed && m_typingGroupOpen && type == EditActionType::Insert &&
+                     !m_undoStack.empty() && text.find('\n') == std::string::npos;
+    if (mergeable) {
+        EditAction& last = m_undoStack.back();
+        bool startsWord = !text.empty() && !last.text.empty() &&
+                          std::isspace(static_cast<unsigned char>(last.text.back())) &&
+                          !std::isspace(static_cast<unsigned char>(text.front()));
+        if (last.typed && last.type == EditActionType::Insert &&
+            last.cursorAfter == start && last.end == start && !startsWord) {
+            last.text += text;
+            last.end = end;
+            last.cursorAfter = m_cursor;
+            m_redoStack.clear();
+            return;
+        }
+    }
+    m_typingGroupOpen = typed;
+    
     EditAction action;
     action.type = type;
     action.text = text;
@@ -346,8 +458,12 @@ void TextEditor::recordAction(EditActionType type, const std::string& text, Text
     action.end = end;
     action.cursorBefore = cursorBefore;
     action.cursorAfter = m_cursor;
+    action.typed = typed;
+    pushAction(std::move(action));
+}
 
-    m_undoStack.push_back(action);
+void TextEditor::pushAction(EditAction action) {
+    m_undoStack.push_back(std::move(action));
     m_redoStack.clear();
 
     if (m_undoStack.size() > m_maxHistorySize) {
@@ -359,20 +475,11 @@ void TextEditor::applyAction(const EditAction& action, bool undo) {
     bool isInsert = (action.type == EditActionType::Insert);
     if (undo) isInsert = !isInsert;
 
-    if (isInsert) {
-        // Apply insertion
+    if (action.type == EditActionType::Replace) {
+        applyReplacements(action.replacements, undo);
+    } else if (isInsert) {
         m_cursor = action.start;
-        // Text is a single string but might contain newlines
-        // insertText handles single lines, so we need a more robust insert for multi-line actions
-        std::stringstream ss(action.text);
-        std::string segment;
-        bool first = true;
-        while (std::getline(ss, segment, '\n')) {
-            if (!segment.empty() && segment.back() == '\r') segment.pop_back();
-            if (!first) enter();
-            insertText(segment);
-            first = false;
-        }
+        insertText(action.text);
     } else {
         // Apply deletion
         m_selection.start = action.start;
@@ -384,17 +491,185 @@ void TextEditor::applyAction(const EditAction& action, bool undo) {
     m_selection.clear();
 }
 
+//=============================================================================
+// TextEditor - Find / Replace
+//=============================================================================
+
+bool TextEditor::find(const SearchQuery& query) {
+    if (!m_search) {
+        m_search = std::make_unique<TextSearch>();
+    }
+    m_matches.clear();
+    m_searchStale = false;
+    m_query = query;
+    if (!m_search->start(m_buffer, query)) {
+        m_query = {};
+        return false;
+    }
+    return true;
+}
+
+void TextEditor::clearFind() {
+    if (m_search) m_search->cancel();
+    m_query = {};
+    m_matches.clear();
+    m_searchStale = false;
+}
+
+void TextEditor::waitForSearch() {
+    pollSearch(true);
+    if (m_search) {
+        m_search->wait();
+        m_search->collect(m_matches);
+    }
+}
+
+void TextEditor::markSearchStale() {
+    if (m_query.pattern.empty()) return;
+    
+    // The previous results describe text that no longer exists
+    m_searchStale = true;
+    m_lastSearchEdit = std::chrono::steady_clock::now();
+    m_matches.clear();
+    if (m_search) m_search->cancel();
+}
+
+void TextEditor::pollSearch(bool restartNow) {
+    if (m_query.pattern.empty() || isLoading()) return;
+    
+    // Each restart scans the whole document, so wait for typing to pause
+    if (m_searchStale) {
+        const std::chrono::duration<float> idle = std::chrono::steady_clock::now() - m_lastSearchEdit;
+        if (!restartNow && idle.count() < constants::TEXT_SEARCH_RESTART_DELAY) return;
+        m_searchStale = false;
+        m_search->start(m_buffer, m_query);
+        return;
+    }
+    m_search->collect(m_matches);
+}
+
+void TextEditor::selectMatch(const TextMatch& match) {
+    m_typingGroupOpen = false;
+    m_selection.start = m_buffer.positionOf(match.offset);
+    m_selection.end = m_buffer.positionOf(match.offset + match.length);
+    m_cursor = m_selection.end;
+    
+    int first = firstVisibleLine();
+    if (m_cursor.line < first || m_cursor.line >= first + visibleLineCount() - 1) {
+        centerViewOnLine(m_cursor.line);
+    }
+}
+
+bool TextEditor::findNext() {
+    pollSearch(true);
+    if (m_matches.empty()) return false;
+    
+    size_t from = m_buffer.offsetOf(m_selection.isEmpty() ? m_cursor : m_selection.max());
+    auto it = std::lower_bound(m_matches.begin(), m_matches.end(), from, [](const TextMatch& match, size_t offset) {
+        return match.offset < offset;
+    });
+    selectMatch(it != m_matches.end() ? *it : m_matches.front());
+    return true;
+}
+
+bool TextEditor::findPrevious() {
+    pollSearch(true);
+    if (m_matches.empty()) return false;
+    
+    size_t from = m_buffer.offsetOf(m_selection.isEmpty() ? m_cursor : m_selection.min());
+    auto it = std::lower_bound(m_matches.begin(), m_matches.end(), from, [](const TextMatch& match, size_t offset) {
+        return match.offset < offset;
+    });
+    selectMatch(it != m_matches.begin() ? *(it - 1) : m_matches.back());
+    return true;
+}
+
+bool TextEditor::replace(const std::string& replacement) {
+    waitForSearch();
+    if (m_matches.empty() || m_readOnly) return false;
+    
+    size_t begin = m_buffer.offsetOf(m_selection.min());
+    size_t end = m_buffer.offsetOf(m_selection.max());
+    auto it = std::lower_bound(m_matches.begin(), m_matches.end(), begin, [](const TextMatch& match, size_t offset) {
+        return match.offset < offset;
+    });
+    if (m_selection.isEmpty() || it == m_matches.end() || it->offset != begin || it->length != end - begin) {
+        findNext();
+        return false;
+    }
+    
+    TextPosition cursorBefore = m_cursor;
+    std::vector<TextReplacement> replacements = {{begin, m_buffer.substr(begin, it->length), replacement}};
+    const ptrdiff_t shift = static_cast<ptrdiff_t>(replacement.size()) - static_cast<ptrdiff_t>(it->length);
+    const size_t index = static_cast<size_t>(it - m_matches.begin());
+    m_matches.erase(it);
+    
+    // The search is complete, so shift the later matches instead of searching again
+    std::vector<TextMatch> matches;
+    matches.swap(m_matches);
+    applyReplacements(replacements, false);
+    m_matches.swap(matches);
+    for (size_t i = index; i < m_matches.size(); ++i) {
+        m_matches[i].offset = static_cast<size_t>(static_cast<ptrdiff_t>(m_matches[i].offset) + shift);
+    }
+    m_searchStale = false;
+    m_cursor = m_buffer.positionOf(begin + replacement.size());
+    m_selection.clear();
+    
+    EditAction action;
+    action.type = EditActionType::Replace;
+    action.start = m_buffer.positionOf(begin);
+    action.end = m_cursor;
+    action.cursorBefore = cursorBefore;
+    action.cursorAfter = m_cursor;
+    action.replacements = std::move(replacements);
+    m_typingGroupOpen = false;
+    pushAction(std::move(action));
+    
+    if (index < m_matches.size()) selectMatch(m_matches[index]);
+    return true;
+}
+
+size_t TextEditor::replaceAll(const std::string& replacement) {
+    waitForSearch();
+    if (m_matches.empty() || m_readOnly) return 0;
+    
+    std::vector<TextReplacement> replacements;
+    replacements.reserve(m_matches.size());
+    for (const TextMatch& match : m_matches) {
+        replacements.push_back({match.offset, m_buffer.substr(match.offset, match.length), replacement});
+    }
+    
+    TextPosition cursorBefore = m_cursor;
+    applyReplacements(replacements, false);
+    m_cursor = m_buffer.positionOf(m_buffer.offsetOf(m_cursor));
+    m_selection.clear();
+    
+    EditAction action;
+    action.type = EditActionType::Replace;
+    action.start = m_buffer.positionOf(replacements.front().offset);
+    action.end = action.start;
+    action.cursorBefore = cursorBefore;
+    action.cursorAfter = m_cursor;
+    action.replacements = std::move(replacements);
+    size_t count = action.replacements.size();
+    m_typingGroupOpen = false;
+    pushAction(std::move(action));
+    return count;
+}
+
 void TextEditor::setCursor(const TextPosition& pos) {
-    m_cursor.line = std::clamp(pos.line, 0, static_cast<int>(m_lines.size() - 1));
-    m_cursor.column = std::clamp(pos.column, 0, static_cast<int>(m_lines[m_cursor.line].length()));
+    m_typingGroupOpen = false;
+    m_cursor.line = std::clamp(pos.line, 0, m_buffer.lineCount() - 1);
+    m_cursor.column = std::clamp(pos.column, 0, m_buffer.lineLength(m_cursor.line));
 }
 
 int TextEditor::firstVisibleLine() const {
-    if (m_lines.empty() || m_lastRowHeight <= 0.0f) {
+    if (m_lastRowHeight <= 0.0f) {
         return 0;
     }
     const int line = static_cast<int>(m_scrollOffset.y / m_lastRowHeight);
-    return std::clamp(line, 0, static_cast<int>(m_lines.size() - 1));
+    return std::clamp(line, 0, m_buffer.lineCount() - 1);
 }
 
 int TextEditor::visibleLineCount() const {
@@ -405,20 +680,16 @@ int TextEditor::visibleLineCount() const {
 }
 
 void TextEditor::centerViewOnLine(int line) {
-    if (m_lines.empty()) {
-        return;
-    }
-
-    const int clampedLine = std::clamp(line, 0, static_cast<int>(m_lines.size() - 1));
+    const int clampedLine = std::clamp(line, 0, m_buffer.lineCount() - 1);
     m_cursor.line = clampedLine;
-    m_cursor.column = std::clamp(m_cursor.column, 0, static_cast<int>(m_lines[m_cursor.line].length()));
+    m_cursor.column = std::clamp(m_cursor.column, 0, m_buffer.lineLength(m_cursor.line));
 
     if (m_lastRowHeight <= 0.0f || m_lastViewportHeight <= 0.0f) {
         return;
     }
 
     const float visibleLines = std::max(1.0f, m_lastViewportHeight / m_lastRowHeight);
-    const float maxTopLine = std::max(0.0f, static_cast<float>(m_lines.size()) - visibleLines);
+    const float maxTopLine = std::max(0.0f, static_cast<float>(m_buffer.lineCount()) - visibleLines);
     const float targetTopLine = std::clamp(static_cast<float>(clampedLine) - visibleLines * 0.5f, 0.0f, maxTopLine);
     m_scrollOffset.y = targetTopLine * m_lastRowHeight;
 }
@@ -430,12 +701,13 @@ void TextEditor::handleInput(
     float charWidth,
     float gutterWidth,
     bool focused,
-    bool suppressNavigationKeys) {
+    bool suppressNavigationKeys,
+    bool editable) {
     float dt = ctx.deltaTime();
     
     handleMouse(ctx, bounds, rowHeight, charWidth, gutterWidth);
     if (focused) {
-        handleKeyboard(ctx, bounds, rowHeight, dt, suppressNavigationKeys);
+        handleKeyboard(ctx, bounds, rowHeight, dt, suppressNavigationKeys, editable);
     }
     
     InputState& input = ctx.input();
@@ -446,13 +718,14 @@ void TextEditor::handleInput(
 
 
 
-void TextEditor::handleKeyboard(Context& ctx, const Rect& bounds, float rowHeight, float deltaTime, bool suppressNavigationKeys) {
+void TextEditor::handleKeyboard(Context& ctx, const Rect& bounds, float rowHeight, float deltaTime, bool suppressNavigationKeys, bool editable) {
     InputState& input = ctx.input();
     bool shift = input.modifiers().shift;
     bool ctrl = input.modifiers().ctrl;
 
 
     auto move = [&](TextPosition p, bool extend) {
+        m_typingGroupOpen = false;
         if (extend) {
             if (m_selection.isEmpty()) m_selection.start = m_cursor;
             m_cursor = p;
@@ -483,49 +756,54 @@ void TextEditor::handleKeyboard(Context& ctx, const Rect& bounds, float rowHeigh
     if (!suppressNavigationKeys) {
         if (shouldTrigger(Key::Down)) {
             TextPosition p = m_cursor;
-            p.line = std::min(p.line + 1, (int)m_lines.size() - 1);
-            p.column = std::min(p.column, (int)m_lines[p.line].length());
+            p.line = std::min(p.line + 1, m_buffer.lineCount() - 1);
+            p.column = std::min(p.column, m_buffer.lineLength(p.line));
             move(p, shift);
         }
         if (shouldTrigger(Key::Up)) {
             TextPosition p = m_cursor;
             p.line = std::max(p.line - 1, 0);
-            p.column = std::min(p.column, (int)m_lines[p.line].length());
+            p.column = std::min(p.column, m_buffer.lineLength(p.line));
             move(p, shift);
         }
     }
     if (shouldTrigger(Key::Left)) {
         TextPosition p = m_cursor;
         if (p.column > 0) p.column--;
-        else if (p.line > 0) { p.line--; p.column = (int)m_lines[p.line].length(); }
+        else if (p.line > 0) { p.line--; p.column = m_buffer.lineLength(p.line); }
         move(p, shift);
     }
     if (shouldTrigger(Key::Right)) {
         TextPosition p = m_cursor;
-        if (p.column < (int)m_lines[p.line].length()) p.column++;
-        else if (p.line < (int)m_lines.size() - 1) { p.line++; p.column = 0; }
+        if (p.column < m_buffer.lineLength(p.line)) p.column++;
+        else if (p.line < m_buffer.lineCount() - 1) { p.line++; p.column = 0; }
         move(p, shift);
     }
     
     if (input.isKeyPressed(Key::Home)) move({m_cursor.line, 0}, shift);
-    if (input.isKeyPressed(Key::End)) move({m_cursor.line, (int)m_lines[m_cursor.line].length()}, shift);
+    if (input.isKeyPressed(Key::End)) move({m_cursor.line, m_buffer.lineLength(m_cursor.line)}, shift);
     
     if (ctrl && input.isKeyPressed(Key::C)) copyToClipboard(ctx);
-    if (ctrl && input.isKeyPressed(Key::V)) pasteFromClipboard(ctx);
-    if (ctrl && input.isKeyPressed(Key::X)) cutToClipboard(ctx);
 
     if (ctrl && input.isKeyPressed(Key::A)) {
         m_selection.start = {0, 0};
-        m_selection.end = {(int)m_lines.size() - 1, (int)m_lines.back().length()};
+        m_selection.end = m_buffer.positionOf(m_buffer.length());
         m_cursor = m_selection.end;
     }
 
+    // Navigation, selection and copy only from here on
+    if (!editable) return;
+
+    if (ctrl && input.isKeyPressed(Key::V)) pasteFromClipboard(ctx);
+    else applyPendingPaste();
+    if (ctrl && input.isKeyPressed(Key::X)) cutToClipboard(ctx);
+
     if (ctrl && shouldTrigger(Key::Z)) undo();
     if (ctrl && shouldTrigger(Key::Y)) redo();
 
     if (!input.textInput().empty() && !ctrl) {
         if (!m_selection.isEmpty()) deleteSelection();
-        insertText(input.textInput());
+        insertText(input.textInput(), true);
         m_selection.clear();
         ensureCursorVisible(bounds, rowHeight);
     }
@@ -537,11 +815,12 @@ void TextEditor::handleKeyboard(Context& ctx, const Rect& bounds, float rowHeigh
     if (shouldTrigger(Key::Delete)) {
         if (!m_selection.isEmpty()) deleteSelection();
         else {
-            if (m_cursor.column < (int)m_lines[m_cursor.line].length()) m_lines[m_cursor.line].erase(m_cursor.column, 1);
-            else if (m_cursor.line < (int)m_lines.size() - 1) {
-                m_lines[m_cursor.line] += m_lines[m_cursor.line+1];
-                m_lines.erase(m_lines.begin() + m_cursor.line + 1);
-            }
+            TextPosition next = m_cursor;
+            if (m_cursor.column < m_buffer.lineLength(m_cursor.line)) next.column++;
+            else if (m_cursor.line < m_buffer.lineCount() - 1) next = {m_cursor.line + 1, 0};
+            m_selection.start = m_cursor;
+            m_selection.end = next;
+            deleteSelection();
         }
         ensureCursorVisible(bounds, rowHeight);
     }
@@ -561,6 +840,7 @@ void TextEditor::handleMouse(Context& ctx, const Rect& bounds, float rowHeight,
     if (input.isMousePressed(MouseButton::Left) && bounds.contains(mp)) {
 
         m_isSelecting = true;
+        m_typingGroupOpen = false;
         m_cursor = screenToTextPos(ctx, mp, bounds, rowHeight, charWidth, gutterWidth);
         if (!input.modifiers().shift) {
             m_selection.clear();
@@ -580,11 +860,58 @@ void TextEditor::handleMouse(Context& ctx, const Rect& bounds, float rowHeight,
 }
 
 
-void TextEditor::insertText(const std::string& text) {
+void TextEditor::bufferInsert(size_t offset, const std::string& text) {
+    int line = m_buffer.positionOf(offset).line;
+    int newlines = static_cast<int>(std::count(text.begin(), text.end(), '\n'));
+    m_buffer.insert(offset, text);
+    m_highlights.linesChanged(line, 1, 1 + newlines);
+    markSearchStale();
+}
+
+void TextEditor::bufferErase(size_t offset, size_t count) {
+    int first = m_buffer.positionOf(offset).line;
+    int last = m_buffer.positionOf(offset + count).line;
+    m_buffer.erase(offset, count);
+    m_highlights.linesChanged(first, last - first + 1, 1);
+    markSearchStale();
+}
+
+void TextEditor::applyReplacements(const std::vector<TextReplacement>& replacements, bool undo) {
+    if (replacements.empty()) return;
+    
+    // The span from the first to the last replacement, before and after
+    ptrdiff_t totalShift = 0;
+    for (const TextReplacement& r : replacements) {
+        totalShift += static_cast<ptrdiff_t>(r.inserted.size()) - static_cast<ptrdiff_t>(r.removed.size());
+    }
+    const size_t preEnd = replacements.back().offset + replacements.back().removed.size();
+    const size_t postEnd = static_cast<size_t>(static_cast<ptrdiff_t>(preEnd) + totalShift);
+    const int firstLine = m_buffer.positionOf(replacements.front().offset).line;
+    const int oldLastLine = m_buffer.positionOf(undo ? postEnd : preEnd).line;
+    
+    // In ascending order: redoing shifts later offsets by the edits before
+    // them, undoing restores the original text in front of each one
+    ptrdiff_t shift = 0;
+    for (const TextReplacement& r : replacements) {
+        const std::string& from = undo ? r.inserted : r.removed;
+        const std::string& to = undo ? r.removed : r.inserted;
+        const size_t at = undo ? r.offset : static_cast<size_t>(static_cast<ptrdiff_t>(r.offset) + shift);
+        if (!from.empty()) m_buffer.erase(at, from.size());
+        if (!to.empty()) m_buffer.insert(at, to);
+        shift += static_cast<ptrdiff_t>(to.size()) - static_cast<ptrdiff_t>(from.size());
+    }
+    
+    const int newLastLine = m_buffer.positionOf(undo ? preEnd : postEnd).line;
+    m_highlights.linesChanged(firstLine, oldLastLine - firstLine + 1, newLastLine - firstLine + 1);
+    markSearchStale();
+}
+
+void TextEditor::insertText(const std::string& text, bool typed) {
     TextPosition start = m_cursor;
-    m_lines[m_cursor.line].insert(m_cursor.column, text);
-    m_cursor.column += (int)text.length();
-    recordAction(EditActionType::Insert, text, start, m_cursor, start);
+    size_t offset = m_buffer.offsetOf(m_cursor);
+    bufferInsert(offset, text);
+    m_cursor = m_buffer.positionOf(offset + text.size());
+    recordAction(EditActionType::Insert, text, start, m_cursor, start, typed);
 }
 
 void TextEditor::deleteSelection() {
@@ -593,11 +920,8 @@ void TextEditor::deleteSelection() {
     TextPosition cursorBefore = m_cursor;
     std::string deletedText = getTextRange(minP, maxP);
     
-    if (minP.line == maxP.line) m_lines[minP.line].erase(minP.column, maxP.column - minP.column);
-    else {
-        m_lines[minP.line] = m_lines[minP.line].substr(0, minP.column) + m_lines[maxP.line].substr(maxP.column);
-        m_lines.erase(m_lines.begin() + minP.line + 1, m_lines.begin() + maxP.line + 1);
-    }
+    size_t begin = m_buffer.offsetOf(minP);
+    bufferErase(begin, m_buffer.offsetOf(maxP) - begin);
     m_cursor = minP;
     recordAction(EditActionType::Delete, deletedText, minP, maxP, cursorBefore);
     m_selection.clear();
@@ -608,28 +932,28 @@ void TextEditor::backspace() {
     if (m_cursor.column > 0) {
         TextPosition start = {m_cursor.line, m_cursor.column - 1};
         std::string deleted = getTextRange(start, m_cursor);
-        m_lines[m_cursor.line].erase(m_cursor.column - 1, 1);
+        bufferErase(m_buffer.offsetOf(start), 1);
         m_cursor.column--;
         recordAction(EditActionType::Delete, deleted, start, cursorBefore, cursorBefore);
     }
     else if (m_cursor.line > 0) {
-        TextPosition start = {m_cursor.line - 1, (int)m_lines[m_cursor.line - 1].length()};
-        int oldLen = (int)m_lines[m_cursor.line - 1].length();
-        m_lines[m_cursor.line - 1] += m_lines[m_cursor.line];
-        m_lines.erase(m_lines.begin() + m_cursor.line);
-        m_cursor.line--; m_cursor.column = oldLen;
-        recordAction(EditActionType::Delete, "\n", start, cursorBefore, cursorBefore);
+        // Join with the previous line; the break may be "\r\n" in a mapped file
+        TextPosition start = {m_cursor.line - 1, m_buffer.lineLength(m_cursor.line - 1)};
+        size_t begin = m_buffer.offsetOf(start);
+        size_t end = m_buffer.lineStart(m_cursor.line);
+        std::string deleted = m_buffer.substr(begin, end - begin);
+        bufferErase(begin, end - begin);
+        m_cursor = start;
+        recordAction(EditActionType::Delete, deleted, start, cursorBefore, cursorBefore);
     }
 }
 
 void TextEditor::enter() {
     TextPosition cursorBefore = m_cursor;
-    std::string line = m_lines[m_cursor.line];
+    std::string line = m_buffer.line(m_cursor.line);
     size_t first = line.find_first_not_of(" \t");
     std::string indent = (m_cursor.column > (int)first) ? line.substr(0, first) : "";
-    std::string rem = line.substr(m_cursor.column);
-    m_lines[m_cursor.line].erase(m_cursor.column);
-    m_lines.insert(m_lines.begin() + m_cursor.line + 1, indent + rem);
+    bufferInsert(m_buffer.offsetOf(m_cursor), "\n" + indent);
     m_cursor.line++; m_cursor.column = (int)indent.length();
     recordAction(EditActionType::Insert, "\n" + indent, cursorBefore, m_cursor, cursorBefore);
 }
@@ -645,19 +969,23 @@ void TextEditor::cutToClipboard(Context& ctx) {
 
 
 void TextEditor::pasteFromClipboard(Context& ctx) {
-    std::string text = ctx.window().getClipboardText();
+    // The owner may answer in a later frame; the shared slot keeps the
+    // callback safe if the editor is gone by then
+    auto slot = std::make_shared<std::optional<std::string>>();
+    m_pendingPaste = slot;
+    ctx.window().requestClipboardText([slot](const std::string& text) { *slot = text; });
+    applyPendingPaste();
+}
+
+void TextEditor::applyPendingPaste() {
+    if (!m_pendingPaste || !m_pendingPaste->has_value()) return;
+    std::string text = std::move(**m_pendingPaste);
+    m_pendingPaste.reset();
 
     if (text.empty()) return;
     if (!m_selection.isEmpty()) deleteSelection();
-    std::stringstream ss(text);
-    std::string segment;
-    bool first = true;
-    while (std::getline(ss, segment, '\n')) {
-        if (!segment.empty() && segment.back() == '\r') segment.pop_back();
-        if (!first) enter();
-        insertText(segment);
-        first = false;
-    }
+    text.erase(std::remove(text.begin(), text.end(), '\r'), text.end());
+    insertText(text);
 }
 
 std::string TextEditor::getSelectedText() const {
@@ -666,14 +994,7 @@ std::string TextEditor::getSelectedText() const {
 
 std::string TextEditor::getTextRange(TextPosition start, TextPosition end) const {
     if (start == end) return "";
-    if (end < start) std::swap(start, end);
-
-    if (start.line == end.line) return m_lines[start.line].substr(start.column, end.column - start.column);
-    
-    std::string result = m_lines[start.line].substr(start.column) + "\n";
-    for (int i = start.line + 1; i < end.line; ++i) result += m_lines[i] + "\n";
-    result += m_lines[end.line].substr(0, end.column);
-    return result;
+    return m_buffer.range(start, end);
 }
 
 void TextEditor::ensureCursorVisible(const Rect& bounds, float rowHeight) {
@@ -684,9 +1005,9 @@ void TextEditor::ensureCursorVisible(const Rect& bounds, float rowHeight) {
 
 TextPosition TextEditor::screenToTextPos(Context& ctx, const Vec2& mp, const Rect& bounds, float rowHeight, float charWidth, float gutterWidth) {
     float ly = mp.y - bounds.y() + m_scrollOffset.y;
-    int line = std::clamp((int)(ly / rowHeight), 0, (int)m_lines.size() - 1);
+    int line = std::clamp((int)(ly / rowHeight), 0, m_buffer.lineCount() - 1);
     float lx = mp.x - bounds.x() - gutterWidth - 5 + m_scrollOffset.x;
-    const std::string& s = m_lines[line];
+    const std::string s = m_buffer.line(line);
     int col = 0;
     float curX = 0;
     Font* f = ctx.font();
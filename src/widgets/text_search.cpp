@@ -0,0 +1,272 @@
+/**
+ * @file text_search.cpp
+ * @brief Background literal and regex search for TextEditor.
+ */
+
+#include "fastener/widgets/text_search.h"
+#include "fastener/core/constants.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <regex>
+
+namespace fst {
+
+namespace {
+
+using Publish = std::function<void(std::vector<TextMatch>&)>;
+
+unsigned char foldAscii(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c + ('a' - 'A')) : c;
+}
+
+// Finds the next occurrence of either of two bytes with memchr, remembering
+// the next hit of each so neither range is scanned twice
+class ByteScanner {
+public:
+    ByteScanner(const char* begin, const char* end, unsigned char a, unsigned char b)
+        : m_end(end), m_a(a), m_b(b), m_nextA(scan(begin, a)), m_nextB(a == b ? end : scan(begin, b)) {}
+
+    const char* find(const char* from) {
+        if (from >= m_end) return m_end;
+        if (m_nextA < from) m_nextA = scan(from, m_a);
+        if (m_a == m_b) return m_nextA;
+        if (m_nextB < from) m_nextB = scan(from, m_b);
+        return std::min(m_nextA, m_nextB);
+    }
+
+private:
+    const char* scan(const char* from, unsigned char c) const {
+        const void* hit = std::memchr(from, c, static_cast<size_t>(m_end - from));
+        return hit ? static_cast<const char*>(hit) : m_end;
+    }
+
+    const char* m_end;
+    unsigned char m_a;
+    unsigned char m_b;
+    const char* m_nextA;
+    const char* m_nextB;
+};
+
+void searchLiteral(const TextBuffer& text, const SearchQuery& query, const std::atomic<bool>& cancel,
+                   const Publish& publish) {
+    std::string pattern = query.pattern;
+    const bool fold = !query.caseSensitive;
+    if (fold) {
+        std::transform(pattern.begin(), pattern.end(), pattern.begin(), [](char c) {
+            return static_cast<char>(foldAscii(static_cast<unsigned char>(c)));
+        });
+    }
+
+    const size_t n = pattern.size();
+    const size_t total = text.length();
+    if (n == 0 || n > total) return;
+
+    const unsigned char first = static_cast<unsigned char>(pattern[0]);
+    const unsigned char firstUpper = (fold && first >= 'a' && first <= 'z')
+        ? static_cast<unsigned char>(first - ('a' - 'A')) : first;
+    const size_t lastStart = total - n;  // Last offset a match can start at
+
+    std::vector<TextMatch> found;
+    size_t nextAllowed = 0;  // Matches do not overlap
+    for (size_t begin = 0; begin <= lastStart; begin += constants::TEXT_SEARCH_WINDOW_BYTES) {
+        if (cancel.load(std::memory_order_relaxed)) return;
+
+        // Candidate starts in this window, plus enough text to finish a match
+        const size_t starts = std::min(constants::TEXT_SEARCH_WINDOW_BYTES, lastStart - begin + 1);
+        const std::string window = text.substr(begin, starts + n - 1);
+        const char* data = window.data();
+        const char* startsEnd = data + starts;
+
+        const char* p = data + (nextAllowed > begin ? std::min(nextAllowed - begin, starts) : 0);
+        ByteScanner scanner(p, startsEnd, first, firstUpper);
+        while ((p = scanner.find(p)) < startsEnd) {
+            bool equal;
+            if (fold) {
+                equal = true;
+                for (size_t i = 1; i < n; ++i) {
+                    if (foldAscii(static_cast<unsigned char>(p[i])) != static_cast<unsigned char>(pattern[i])) {
+                        equal = false;
+                        break;
+                    }
+                }
+            } else {
+                equal = std::memcmp(p + 1, pattern.data() + 1, n - 1) == 0;
+            }
+
+            if (equal) {
+                found.push_back({begin + static_cast<size_t>(p - data), n});
+                p += n;
+            } else {
+                ++p;
+            }
+        }
+        if (!found.empty()) {
+            nextAllowed = found.back().offset + n;
+        }
+        publish(found);
+    }
+}
+
+// Searches one line a window of two chunks at a time, taking only matches
+// that start in the first chunk, so a single line (which can be the whole
+// file) is checked for cancellation every chunk even when nothing matches
+bool searchLine(const std::string& line, size_t lineStart, const std::regex& regex,
+                const std::atomic<bool>& cancel, std::vector<TextMatch>& found) {
+    namespace rc = std::regex_constants;
+    const size_t chunk = constants::TEXT_SEARCH_REGEX_CHUNK_BYTES;
+    auto flagsAt = [&](size_t from, size_t to) {
+        rc::match_flag_type flags = rc::match_default;
+        if (from > 0) flags |= rc::match_prev_avail;
+        if (to < line.size()) flags |= rc::match_not_eol;
+        return flags;
+    };
+
+    size_t pos = 0;
+    while (pos <= line.size()) {
+        if (cancel.load(std::memory_order_relaxed)) return false;
+
+        const size_t end = std::min(line.size(), pos + 2 * chunk);
+        const size_t startLimit = end == line.size() ? end : pos + chunk;
+        const auto last = line.begin() + static_cast<std::ptrdiff_t>(end);
+        std::smatch match;
+        if (!std::regex_search(line.begin() + static_cast<std::ptrdiff_t>(pos), last, match, regex,
+                               flagsAt(pos, end)) ||
+            pos + static_cast<size_t>(match.position()) >= startLimit) {
+            if (end == line.size()) break;
+            pos += chunk;
+            continue;
+        }
+
+        const size_t start = pos + static_cast<size_t>(match.position());
+        size_t length = static_cast<size_t>(match.length());
+        if (length == 0) {
+            // Like sregex_iterator, prefer a non-empty match at the same place
+            if (std::regex_search(line.begin() + static_cast<std::ptrdiff_t>(start), last, match, regex,
+                                  flagsAt(start, end) | rc::match_not_null | rc::match_continuous)) {
+                length = static_cast<size_t>(match.length());
+            }
+        }
+
+        // Empty matches (e.g. "x*") have nothing to highlight or replace
+        if (length > 0) {
+            found.push_back({lineStart + start, length});
+            pos = start + length;
+        } else {
+            pos = start + 1;
+        }
+    }
+    return true;
+}
+
+void searchRegex(const TextBuffer& text, const std::regex& regex, const std::atomic<bool>& cancel,
+                 const Publish& publish) {
+    std::vector<TextMatch> found;
+    size_t scanned = 0;
+    const int lineCount = text.lineCount();
+    for (int i = 0; i < lineCount; ++i) {
+        if (cancel.load(std::memory_order_relaxed)) return;
+
+        const std::string line = text.line(i);
+        if (!searchLine(line, text.lineStart(i), regex, cancel, found)) return;
+
+        scanned += line.size() + 1;
+        if (scanned >= constants::TEXT_SEARCH_WINDOW_BYTES) {
+            publish(found);
+            scanned = 0;
+        }
+    }
+    publish(found);
+}
+
+} // namespace
+
+//=============================================================================
+// TextSearch
+//=============================================================================
+
+TextSearch::~TextSearch() {
+    cancel();
+    joinStopped(true);
+}
+
+bool TextSearch::start(TextBuffer snapshot, const SearchQuery& query) {
+    cancel();
+    if (query.pattern.empty()) return true;
+
+    std::shared_ptr<const std::regex> regex;
+    if (query.regex) {
+        auto flags = std::regex::ECMAScript;
+        if (!query.caseSensitive) flags |= std::regex::icase;
+        try {
+            regex = std::make_shared<const std::regex>(query.pattern, flags);
+        } catch (const std::regex_error&) {
+            return false;
+        }
+    }
+
+    auto job = std::make_shared<Job>();
+    m_job = job;
+    m_worker = std::thread([job, snapshot = std::move(snapshot), query, regex]() {
+        Publish publish = [&job](std::vector<TextMatch>& found) { job->publish(found); };
+        if (regex) {
+            searchRegex(snapshot, *regex, job->cancel, publish);
+        } else {
+            searchLiteral(snapshot, query, job->cancel, publish);
+        }
+        job->running.store(false, std::memory_order_release);
+    });
+    return true;
+}
+
+void TextSearch::cancel() {
+    if (m_job) {
+        m_job->cancel.store(true, std::memory_order_relaxed);
+    }
+    // The worker holds its own reference to the job and the snapshot
+    if (m_worker.joinable()) {
+        m_stopped.push_back({std::move(m_worker), m_job});
+    }
+    m_job.reset();
+    joinStopped(false);
+}
+
+void TextSearch::joinStopped(bool all) {
+    for (size_t i = 0; i < m_stopped.size();) {
+        if (!all && m_stopped[i].job->running.load(std::memory_order_acquire)) {
+            ++i;
+            continue;
+        }
+        m_stopped[i].worker.join();
+        m_stopped.erase(m_stopped.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+}
+
+void TextSearch::wait() {
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+size_t TextSearch::collect(std::vector<TextMatch>& out) {
+    if (!m_job) return 0;
+    std::lock_guard<std::mutex> lock(m_job->mutex);
+    size_t count = m_job->found.size();
+    out.insert(out.end(), m_job->found.begin(), m_job->found.end());
+    m_job->found.clear();
+    return count;
+}
+
+void TextSearch::Job::publish(std::vector<TextMatch>& matches) {
+    if (matches.empty()) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    if (found.empty()) {
+        found.swap(matches);
+    } else {
+        found.insert(found.end(), matches.begin(), matches.end());
+    }
+    matches.clear();
+}
+
+} // namespace fst
@@ -230,8 +230,8 @@ bool TimePicker(Context& ctx, std::string_view label, TimeOfDay& time, const Tim
             ampmCol = columnRect(columnIndex++);
         }
 
-        if (!options.disabled && popupRect.contains(input.mousePos()) && input.scrollDelta().y != 0.0f) {
-            float scroll = input.scrollDelta().y;
+        if (!options.disabled && popupRect.contains(input.mousePos()) && input.scrollSteps().y != 0.0f) {
+            float scroll = input.scrollSteps().y;
             int direction = scroll > 0.0f ? -1 : 1;
             Vec2 mousePos = input.mousePos();
 
@@ -282,8 +282,8 @@ void RenderToasts(Context& ctx, const ToastContainerOptions& options) {
     if (!font) return;
     
     float lineHeight = font->lineHeight();
-    float windowW = static_cast<float>(ctx.window().width());
-    float windowH = static_cast<float>(ctx.window().height());
+    float windowW = ctx.layoutSize().x;
+    float windowH = ctx.layoutSize().y;
     
     // NOTE: Mouse consumption is handled in renderToast AFTER the close button
     // processes its interaction. This ensures the close button can receive clicks
@@ -380,8 +380,8 @@ void UpdateToastInput(Context& ctx, const ToastContainerOptions& options) {
     if (!font) return;
     
     float lineHeight = font->lineHeight();
-    float windowW = static_cast<float>(ctx.window().width());
-    float windowH = static_cast<float>(ctx.window().height());
+    float windowW = ctx.layoutSize().x;
+    float windowH = ctx.layoutSize().y;
     Vec2 mousePos = ctx.input().mousePos();
     
     // Pre-register all visible toast bounds as floating windows for input blocking
@@ -44,6 +44,9 @@ public:
     
     // Text
     MOCK_METHOD(void, addText, (Font* font, const Vec2& pos, std::string_view text, Color color), (override));
+    MOCK_METHOD(void, addTextColored, 
+                (Font* font, const Vec2& pos, std::string_view text, const std::vector<TextColorRun>& runs, Color color), 
+                (override));
     
     // Images
     MOCK_METHOD(void, addImage, (const Texture* texture, const Rect& rect, Color tint), (override));
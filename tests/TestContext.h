@@ -17,19 +17,19 @@ namespace fst::testing {
  */
 class StubWindow : public fst::IPlatformWindow {
 public:
-    int width() const override { return 800; }
-    int height() const override { return 600; }
+    int width() const override { return m_width; }
+    int height() const override { return m_height; }
     bool isOpen() const override { return true; }
     void close() override {}
     void pollEvents() override {}
     void waitEvents() override {}
     void swapBuffers() override {}
     void makeContextCurrent() override {}
-    Vec2 size() const override { return {800.0f, 600.0f}; }
-    Vec2 framebufferSize() const override { return {800.0f, 600.0f}; }
+    Vec2 size() const override { return {static_cast<float>(m_width), static_cast<float>(m_height)}; }
+    Vec2 framebufferSize() const override { return size(); }
     float dpiScale() const override { return 1.0f; }
     void setTitle(const std::string&) override {}
-    void setSize(int, int) override {}
+    void setSize(int width, int height) override { m_width = width; m_height = height; }
     void setPosition(int, int) override {}
     void minimize() override {}
     void maximize() override {}
@@ -41,7 +41,7 @@ public:
     void setCursor(Cursor) override {}
     void hideCursor() override {}
     void showCursor() override {}
-    std::string getClipboardText() const override { return ""; }
+    std::string getClipboardText() override { return ""; }
     void setClipboardText(const std::string&) override {}
     void* nativeHandle() const override { return nullptr; }
     InputState& input() override { return m_input; }
@@ -49,6 +49,8 @@ public:
     
 private:
     InputState m_input;
+    int m_width = 800;
+    int m_height = 600;
 };
 
 /**
@@ -106,6 +108,12 @@ public:
         m_frameActive = true;
     }
     
+    /** @brief Begin a frame at an explicit time. */
+    void beginFrame(Context::Clock::time_point now) {
+        m_ctx.beginFrame(m_window, now);
+        m_frameActive = true;
+    }
+    
     /**
      * @brief End the current frame.
      */
@@ -5,9 +5,12 @@
 
 #include <gtest/gtest.h>
 #include <fastener/core/context.h>
+#include <fastener/core/constants.h>
+#include <fastener/ui/theme.h>
 #include <fastener/ui/widget_scope.h>
 #include <fastener/ui/widget_utils.h>
 #include "TestContext.h"
+#include <chrono>
 
 using namespace fst;
 using namespace fst::testing;
@@ -74,3 +77,204 @@ TEST(TestContextTest, MockDrawListAvailable) {
 //=============================================================================
 // TestContext Helper Tests (Stack Integration removed)
 //=============================================================================
+
+//=============================================================================
+// Measure Cache Tests
+//=============================================================================
+
+TEST(MeasureCacheTest, ComputesOnlyWhenInputsChange) {
+    Context ctx(false);
+    int computeCount = 0;
+    auto measure = [&](uint64_t inputs) {
+        return ctx.measureCache<float>("label"_id, inputs, [&] {
+            ++computeCount;
+            return 42.0f;
+        });
+    };
+    
+    EXPECT_FLOAT_EQ(measure(1), 42.0f);
+    EXPECT_FLOAT_EQ(measure(1), 42.0f);
+    EXPECT_EQ(computeCount, 1);
+    
+    measure(2);
+    EXPECT_EQ(computeCount, 2);
+}
+
+TEST(MeasureCacheTest, ThemeChangeInvalidates) {
+    Context ctx(false);
+    int computeCount = 0;
+    auto compute = [&] { return ++computeCount; };
+    
+    ctx.measureCache<int>("label"_id, 1, compute);
+    ctx.setTheme(Theme::light());
+    EXPECT_EQ(ctx.measureCache<int>("label"_id, 1, compute), 2);
+}
+
+TEST(MeasureCacheTest, ValueTypesAreKeptApart) {
+    Context ctx(false);
+    ctx.measureCache<int>("label"_id, 1, [] { return 7; });
+    const auto& widths = ctx.measureCache<std::vector<float>>("label"_id, 1, [] {
+        return std::vector<float>{1.0f, 2.0f};
+    });
+    EXPECT_EQ(widths.size(), 2u);
+    EXPECT_EQ(ctx.measureCache<int>("label"_id, 1, [] { return 0; }), 7);
+}
+
+TEST(MeasureCacheTest, GenerationsBumpOnlyOnRealChanges) {
+    TestContext tc;
+    Context& ctx = tc.context();
+    uint64_t theme = ctx.themeGeneration();
+    
+    ctx.setTheme(ctx.theme());
+    EXPECT_EQ(ctx.themeGeneration(), theme);
+    
+    ctx.setTheme(Theme::light());
+    EXPECT_EQ(ctx.themeGeneration(), theme + 1);
+    
+    // In-place edits are picked up at the next frame
+    ctx.theme().metrics.itemSpacing += 1.0f;
+    tc.beginFrame();
+    tc.endFrame();
+    EXPECT_EQ(ctx.themeGeneration(), theme + 2);
+    
+    uint64_t dpi = ctx.dpiGeneration();
+    tc.beginFrame();
+    tc.endFrame();
+    EXPECT_EQ(ctx.dpiGeneration(), dpi);
+}
+
+TEST(MeasureCacheTest, SizeChangesAreThrottledDuringInteractiveResize) {
+    TestContext tc;
+    Context& ctx = tc.context();
+    WidgetId id = ctx.makeId("wrap");
+    int computes = 0;
+    auto measure = [&](uint64_t inputs, float width) {
+        return ctx.measureCache<float>(id, inputs, hashFloat(width), [&] {
+            ++computes;
+            return width;
+        });
+    };
+    
+    tc.beginFrame();
+    EXPECT_FLOAT_EQ(measure(1, 100.0f), 100.0f);
+    EXPECT_FALSE(ctx.isInteractiveResizing());
+    
+    // Without a drag, size changes recompute immediately
+    EXPECT_FLOAT_EQ(measure(1, 110.0f), 110.0f);
+    EXPECT_EQ(computes, 2);
+    
+    // During a drag the stale value is kept until the interval passes...
+    ctx.beginInteractiveResize();
+    EXPECT_TRUE(ctx.isInteractiveResizing());
+    EXPECT_FLOAT_EQ(measure(1, 150.0f), 110.0f);
+    EXPECT_EQ(computes, 2);
+    
+    // ...but content changes still recompute right away
+    EXPECT_FLOAT_EQ(measure(2, 160.0f), 160.0f);
+    EXPECT_EQ(computes, 3);
+    EXPECT_FLOAT_EQ(measure(2, 170.0f), 160.0f);
+    tc.endFrame();
+    
+    // The drag still counts for one frame, then the final size is computed
+    tc.beginFrame();
+    EXPECT_TRUE(ctx.isInteractiveResizing());
+    tc.endFrame();
+    tc.beginFrame();
+    EXPECT_FALSE(ctx.isInteractiveResizing());
+    EXPECT_FLOAT_EQ(measure(2, 170.0f), 170.0f);
+    EXPECT_EQ(computes, 4);
+    tc.endFrame();
+}
+
+//=============================================================================
+// Live Window Resize Tests
+//=============================================================================
+
+TEST(WindowResizeTest, RelayoutFollowsWindowImmediately) {
+    TestContext tc;
+    Context& ctx = tc.context();
+    tc.beginFrame();
+    tc.endFrame();
+    
+    tc.window().setSize(1000, 700);
+    tc.beginFrame();
+    EXPECT_TRUE(ctx.isWindowResizing());
+    EXPECT_TRUE(ctx.isInteractiveResizing());
+    EXPECT_EQ(ctx.layoutSize(), Vec2(1000.0f, 700.0f));
+    tc.endFrame();
+}
+
+TEST(WindowResizeTest, StretchKeepsLayoutUntilResizeSettles) {
+    TestContext tc;
+    Context& ctx = tc.context();
+    ctx.setResizeMode(ResizeMode::Stretch);
+    tc.beginFrame();
+    EXPECT_FALSE(ctx.isWindowResizing());
+    EXPECT_EQ(ctx.layoutSize(), Vec2(800.0f, 600.0f));
+    tc.endFrame();
+    
+    const auto resized = Context::Clock::now();
+    tc.window().setSize(1000, 700);
+    tc.window().input().onMouseMove(500.0f, 350.0f);
+    tc.window().input().recordMouseSample(250.0f, 175.0f);
+    tc.beginFrame(resized);
+    EXPECT_TRUE(ctx.isWindowResizing());
+    EXPECT_EQ(ctx.layoutSize(), Vec2(800.0f, 600.0f));
+    EXPECT_EQ(ctx.input().windowSize(), Vec2(800.0f, 600.0f));
+    
+    // The pointer is mapped from the stretched window into layout space
+    EXPECT_EQ(ctx.input().mousePos(), Vec2(400.0f, 300.0f));
+    ASSERT_EQ(ctx.input().mouseHistory().size(), 2u);
+    EXPECT_EQ(ctx.input().mouseHistory()[1].pos, Vec2(200.0f, 150.0f));
+    ASSERT_FALSE(ctx.input().events().empty());
+    EXPECT_EQ(ctx.input().events().back().type, InputEventType::MouseMove);
+    EXPECT_EQ(ctx.input().events().back().value, Vec2(400.0f, 300.0f));
+    
+    // Scaling is applied once, not again on a repeated call
+    tc.window().input().setPointerScale(ctx.input().pointerScale());
+    EXPECT_EQ(ctx.input().mouseHistory()[1].pos, Vec2(200.0f, 150.0f));
+    tc.endFrame();
+    
+    auto settled = resized + std::chrono::duration_cast<Context::Clock::duration>(
+        std::chrono::duration<float>(constants::RESIZE_SETTLE_TIME + 0.05f));
+    tc.beginFrame(settled);
+    EXPECT_FALSE(ctx.isWindowResizing());
+    EXPECT_EQ(ctx.layoutSize(), Vec2(1000.0f, 700.0f));
+    EXPECT_EQ(ctx.input().mousePos(), Vec2(500.0f, 350.0f));
+    tc.endFrame();
+}
+
+TEST(WindowResizeTest, WindowsSharingAContextKeepTheirOwnSize) {
+    TestContext tc;
+    Context& ctx = tc.context();
+    ctx.setResizeMode(ResizeMode::Stretch);
+    StubWindow small;
+    small.setSize(350, 300);
+    
+    // Alternating windows of different sizes is not a resize
+    auto now = Context::Clock::now();
+    for (int frame = 0; frame < 20; ++frame) {
+        now += std::chrono::milliseconds(16);
+        tc.beginFrame(now);
+        EXPECT_FALSE(ctx.isWindowResizing());
+        EXPECT_EQ(ctx.layoutSize(), Vec2(800.0f, 600.0f));
+        tc.endFrame();
+        
+        ctx.beginFrame(small, now);
+        EXPECT_FALSE(ctx.isWindowResizing());
+        EXPECT_FALSE(ctx.isInteractiveResizing());
+        EXPECT_EQ(ctx.layoutSize(), Vec2(350.0f, 300.0f));
+        ctx.endFrame();
+    }
+    
+    // A real resize of one window leaves the other settled
+    small.setSize(400, 300);
+    ctx.beginFrame(small, now);
+    EXPECT_TRUE(ctx.isWindowResizing());
+    EXPECT_EQ(ctx.layoutSize(), Vec2(350.0f, 300.0f));
+    ctx.endFrame();
+    tc.beginFrame(now);
+    EXPECT_FALSE(ctx.isWindowResizing());
+    EXPECT_EQ(ctx.layoutSize(), Vec2(800.0f, 600.0f));
+    tc.endFrame();
+}
@@ -2,6 +2,9 @@
 #include <fastener/ui/dock_context.h>
 #include <fastener/ui/dock_node.h>
 #include <fastener/core/context.h>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 
 using namespace fst;
 
@@ -32,15 +35,16 @@ TEST_F(DockingTest, MultipleSplitsDoNotRecursivelyLoop) {
     // First split
     DockNode::Id childId1 = docking.generateNodeId();
     DockNode::Id childId2 = docking.generateNodeId();
-    DockNode* newNode = root->splitNode(DockDirection::Left, childId1, childId2, 0.5f);
-    ASSERT_NE(newNode, nullptr);
+    DockTree& tree = *root->tree;
+    DockNode::Index newIndex = root->splitNode(DockDirection::Left, childId1, childId2, 0.5f);
+    ASSERT_NE(newIndex, DockNode::NO_INDEX);
     docking.refreshMappings(rootId);
     
     // Second split on a child
     DockNode::Id childId3 = docking.generateNodeId();
     DockNode::Id childId4 = docking.generateNodeId();
-    DockNode* newNode2 = newNode->splitNode(DockDirection::Top, childId3, childId4, 0.5f);
-    ASSERT_NE(newNode2, nullptr);
+    DockNode::Index newIndex2 = tree.node(newIndex)->splitNode(DockDirection::Top, childId3, childId4, 0.5f);
+    ASSERT_NE(newIndex2, DockNode::NO_INDEX);
     
     // This call used to trigger infinite recursion if IDs collided
     docking.refreshMappings(rootId);
@@ -64,3 +68,233 @@ TEST_F(DockingTest, IdUniqueness) {
         }
     }
 }
+
+TEST_F(DockingTest, LayoutRecomputedOnlyWhenInputsChange) {
+    DockContext docking;
+    DockNode::Id rootId = docking.createDockSpace("Main", Rect(0, 0, 1000, 500));
+    docking.dockWindow(1, rootId, DockDirection::Center);
+    docking.dockWindow(2, rootId, DockDirection::Right);
+    
+    DockTree& tree = *docking.getDockNode(rootId)->tree;
+    EXPECT_TRUE(tree.updateLayout());
+    EXPECT_FALSE(tree.updateLayout());
+    
+    // Same bounds and ratio: nothing to do
+    docking.createDockSpace("Main", Rect(0, 0, 1000, 500));
+    EXPECT_FALSE(tree.layoutDirty());
+    EXPECT_FALSE(tree.root().setSplitRatio(tree.root().splitRatio()));
+    EXPECT_FALSE(tree.layoutDirty());
+    
+    // Ratio change updates the cached leaf rects
+    EXPECT_TRUE(tree.root().setSplitRatio(0.25f));
+    EXPECT_TRUE(tree.updateLayout());
+    EXPECT_FLOAT_EQ(docking.getWindowDockNode(1)->bounds.width(), 248.0f);
+    EXPECT_FLOAT_EQ(docking.getWindowDockNode(2)->bounds.x(), 252.0f);
+    
+    // Bounds change
+    docking.createDockSpace("Main", Rect(0, 0, 2000, 500));
+    EXPECT_FALSE(tree.layoutDirty());
+    EXPECT_FLOAT_EQ(docking.getWindowDockNode(1)->bounds.width(), 498.0f);
+}
+
+TEST_F(DockingTest, SplitReturnsIndexThatSurvivesGrowth) {
+    DockContext docking;
+    DockNode::Id rootId = docking.createDockSpace("Main", Rect(0, 0, 1000, 500));
+    DockTree& tree = *docking.getDockNode(rootId)->tree;
+    
+    // Every split grows the node array; keep splitting the newest leaf by index
+    DockNode::Index leaf = 0;
+    for (int i = 0; i < 32; ++i) {
+        DockNode::Index parent = leaf;
+        leaf = tree.node(leaf)->splitNode(i % 2 ? DockDirection::Right : DockDirection::Bottom,
+                                          docking.generateNodeId(), docking.generateNodeId(), 0.4f);
+        ASSERT_NE(leaf, DockNode::NO_INDEX);
+        const DockNode* node = tree.node(leaf);
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->index, leaf);
+        EXPECT_EQ(node->parentIndex, parent);
+        EXPECT_TRUE(node->isLeafNode());
+        EXPECT_FLOAT_EQ(tree.node(parent)->splitRatio(), 0.6f);
+    }
+    EXPECT_EQ(tree.nodeCount(), 65u);
+}
+
+TEST_F(DockingTest, WindowMappingFollowsDockAndUndock) {
+    DockContext docking;
+    DockNode::Id rootId = docking.createDockSpace("Main", Rect(0, 0, 800, 600));
+    docking.dockWindow(10, rootId, DockDirection::Center);
+    docking.dockWindow(11, rootId, DockDirection::Left);
+    docking.dockWindow(12, docking.getWindowDockNode(11)->id, DockDirection::Bottom);
+    
+    DockTree& tree = *docking.getDockNode(rootId)->tree;
+    EXPECT_EQ(tree.leaves().size(), 3u);
+    EXPECT_EQ(tree.splits().size(), 2u);
+    for (WidgetId w : {10u, 11u, 12u}) {
+        ASSERT_TRUE(docking.isWindowDocked(w));
+        EXPECT_TRUE(docking.getWindowDockNode(w)->hasWindow(w));
+    }
+    
+    docking.undockWindow(12);
+    EXPECT_FALSE(docking.isWindowDocked(12));
+    EXPECT_EQ(tree.leaves().size(), 2u);
+    EXPECT_TRUE(docking.getWindowDockNode(11)->isLeafNode());
+    
+    docking.undockWindow(11);
+    EXPECT_EQ(tree.nodeCount(), 1u);
+    EXPECT_EQ(docking.getWindowDockNode(10), &tree.root());
+}
+
+TEST_F(DockingTest, FlatNodeArrayRecyclesSlots) {
+    DockContext docking;
+    DockNode::Id rootId = docking.createDockSpace("Main", Rect(0, 0, 800, 600));
+    docking.dockWindow(1, rootId, DockDirection::Center);
+    DockTree& tree = *docking.getDockNode(rootId)->tree;
+    
+    docking.dockWindow(2, rootId, DockDirection::Right);
+    size_t capacity = tree.capacity();
+    
+    for (int i = 0; i < 50; ++i) {
+        docking.undockWindow(2);
+        docking.dockWindow(2, docking.getWindowDockNode(1)->id, DockDirection::Right);
+    }
+    
+    EXPECT_EQ(tree.capacity(), capacity);
+    EXPECT_EQ(tree.nodeCount(), 3u);
+    EXPECT_NE(docking.getWindowDockNode(1), docking.getWindowDockNode(2));
+}
+
+// Builds a layout with `windowCount` windows, two tabs per leaf
+static DockNode::Id buildLayout(DockContext& docking, int windowCount) {
+    DockNode::Id rootId = docking.createDockSpace("Main", Rect(0, 0, 1920, 1080));
+    docking.dockWindow(1, rootId, DockDirection::Center);
+    
+    const DockDirection dirs[] = {DockDirection::Right, DockDirection::Bottom,
+                                  DockDirection::Left, DockDirection::Top};
+    for (int w = 2; w <= windowCount; ++w) {
+        DockNode::Id target = docking.getWindowDockNode(w - 1)->id;
+        if (w % 2 == 0) {
+            docking.dockWindow(w, target, dirs[(w / 2) % 4]);
+        } else {
+            docking.dockWindow(w, target, DockDirection::Center);
+        }
+    }
+    return rootId;
+}
+
+TEST_F(DockingTest, LayoutRoundTrip) {
+    DockContext docking;
+    DockNode::Id rootId = buildLayout(docking, 12);
+    docking.getDockNode(rootId)->setSplitRatio(0.3f);
+    docking.getWindowDockNode(5)->selectedTabIndex = 1;
+    docking.getWindowDockNode(7)->flags.noTabBar = true;
+    docking.createDockSpace("Side", Rect(0, 0, 300, 600));
+    docking.setFloatingRect(99, Rect(10, 20, 300, 200));
+    
+    std::string blob = docking.serializeLayout();
+    ASSERT_GE(blob.size(), 4u);
+    EXPECT_EQ(blob.substr(0, 4), "FSTD");
+    
+    DockContext restored;
+    ASSERT_TRUE(restored.deserializeLayout(blob));
+    EXPECT_EQ(restored.serializeLayout(), blob);
+    
+    // Restored trees are laid out immediately; the source lays out lazily
+    docking.getDockNode(rootId)->tree->updateLayout();
+    for (WidgetId w = 1; w <= 12; ++w) {
+        const DockNode* original = docking.getWindowDockNode(w);
+        const DockNode* node = restored.getWindowDockNode(w);
+        ASSERT_NE(node, nullptr) << "window " << w;
+        EXPECT_EQ(node->id, original->id);
+        EXPECT_EQ(node->dockedWindows, original->dockedWindows);
+        EXPECT_EQ(node->selectedTabIndex, original->selectedTabIndex);
+        EXPECT_EQ(node->flags.noTabBar, original->flags.noTabBar);
+        EXPECT_EQ(node->bounds, original->bounds);
+    }
+    EXPECT_FLOAT_EQ(restored.getDockNode(rootId)->splitRatio(), 0.3f);
+    EXPECT_NE(restored.getNodeIdFromString("Side"), DockNode::INVALID_ID);
+    
+    Rect floating;
+    ASSERT_TRUE(restored.getFloatingRect(99, floating));
+    EXPECT_EQ(floating, Rect(10, 20, 300, 200));
+    
+    // New nodes never collide with restored ones
+    DockNode::Id fresh = restored.generateNodeId();
+    EXPECT_EQ(restored.getDockNode(fresh), nullptr);
+}
+
+TEST_F(DockingTest, NonFiniteSplitRatioFallsBackToEven) {
+    DockContext docking;
+    DockNode::Id rootId = buildLayout(docking, 4);
+    DockNode* root = docking.getDockNode(rootId);
+    root->setSplitRatio(std::nanf(""));
+    EXPECT_FLOAT_EQ(root->splitRatio(), 0.5f);
+    root->setSplitRatio(INFINITY);
+    EXPECT_FLOAT_EQ(root->splitRatio(), 0.5f);
+    root->setSplitRatio(1.5f);
+    EXPECT_FLOAT_EQ(root->splitRatio(), 1.0f);
+    
+    // A stored NaN is replaced on load rather than clamped through
+    root->setSplitRatio(0.3f);
+    std::string blob = docking.serializeLayout();
+    auto bytes = [](float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        std::string out;
+        for (int i = 0; i < 4; ++i) out += static_cast<char>(bits >> (8 * i));
+        return out;
+    };
+    size_t at = blob.find(bytes(0.3f));
+    ASSERT_NE(at, std::string::npos);
+    blob.replace(at, 4, bytes(std::nanf("")));
+    
+    DockContext restored;
+    ASSERT_TRUE(restored.deserializeLayout(blob));
+    EXPECT_FLOAT_EQ(restored.getDockNode(rootId)->splitRatio(), 0.5f);
+}
+
+TEST_F(DockingTest, MalformedLayoutIsRejected) {
+    DockContext source;
+    buildLayout(source, 6);
+    std::string blob = source.serializeLayout();
+    
+    DockContext docking;
+    DockNode::Id rootId = docking.createDockSpace("Keep", Rect(0, 0, 100, 100));
+    
+    EXPECT_FALSE(docking.deserializeLayout(""));
+    EXPECT_FALSE(docking.deserializeLayout("not a layout"));
+    EXPECT_FALSE(docking.deserializeLayout(blob.substr(0, blob.size() - 3)));
+    
+    std::string newer = blob;
+    newer[4] = static_cast<char>(DockContext::LAYOUT_FORMAT_VERSION + 1);
+    EXPECT_FALSE(docking.deserializeLayout(newer));
+    
+    // Root node id after the header, space count, "Main" and its bounds
+    std::string maxId = blob;
+    maxId.replace(44, 4, 4, '\xFF');
+    EXPECT_FALSE(docking.deserializeLayout(maxId));
+    
+    // Failed restores leave the current layout alone
+    EXPECT_EQ(docking.getNodeIdFromString("Keep"), rootId);
+    EXPECT_EQ(docking.getDockSpace("Main"), nullptr);
+}
+
+TEST_F(DockingTest, RestoreBenchmark200Windows) {
+    DockContext source;
+    buildLayout(source, 200);
+    std::string blob = source.serializeLayout();
+    
+    const int iterations = 50;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        DockContext docking;
+        ASSERT_TRUE(docking.deserializeLayout(blob));
+    }
+    double ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count() / iterations;
+    
+    RecordProperty("restore_us", static_cast<int>(ms * 1000.0));
+    RecordProperty("layout_bytes", static_cast<int>(blob.size()));
+    
+    // Generous bound; a 200-window restore is well under a millisecond
+    EXPECT_LT(ms, 20.0);
+}
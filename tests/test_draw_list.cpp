@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <fastener/graphics/draw_list.h>
+#include <fastener/graphics/font.h>
+#include <fastener/graphics/texture.h>
+#include <fastener/platform/headless_window.h>
+#include <filesystem>
+
+using namespace fst;
+
+namespace {
+
+// Background, an unrelated widget far away and a blurred panel on top.
+// Returns the index of the blur command.
+size_t buildFrame(DrawList& dl, Color background, Vec2 farPos, Rect panel) {
+    dl.clear();
+    dl.pushClipRectFullScreen(Vec2(800, 600));
+    dl.addRectFilled(Rect(0, 0, 400, 300), background);
+    dl.addRectFilled(Rect(farPos.x, farPos.y, 50, 50), Color(255, 0, 0));
+    dl.addBlurRect(panel, 8.0f, 4.0f);
+    dl.popClipRect();
+    dl.mergeLayers();
+    
+    for (size_t i = 0; i < dl.commands().size(); ++i) {
+        if (dl.commands()[i].type == DrawCommandType::Blur) return i;
+    }
+    return dl.commands().size();
+}
+
+std::string testFontPath() {
+    namespace fs = std::filesystem;
+    fs::path root = fs::path(__FILE__).parent_path().parent_path();
+    return (root / "assets" / "arial.ttf").string();
+}
+
+// Color of each glyph quad in the merged vertex data
+std::vector<uint32_t> glyphColors(const DrawList& dl) {
+    std::vector<uint32_t> colors;
+    for (size_t i = 0; i < dl.vertices().size(); i += 4) {
+        colors.push_back(dl.vertices()[i].color);
+    }
+    return colors;
+}
+
+} // namespace
+
+TEST(DrawListBackdropTest, UnchangedBackdropKeepsHash) {
+    DrawList dl;
+    Rect panel(50, 50, 100, 100);
+    
+    size_t blur = buildFrame(dl, Color(20, 20, 20), Vec2(700, 500), panel);
+    ASSERT_LT(blur, dl.commands().size());
+    uint64_t first = dl.backdropHash(blur);
+    
+    blur = buildFrame(dl, Color(20, 20, 20), Vec2(700, 500), panel);
+    EXPECT_EQ(dl.backdropHash(blur), first);
+    
+    // Changes outside the sampled area do not invalidate the backdrop
+    blur = buildFrame(dl, Color(20, 20, 20), Vec2(650, 450), panel);
+    EXPECT_EQ(dl.backdropHash(blur), first);
+}
+
+TEST(DrawListBackdropTest, ChangesBeneathInvalidate) {
+    DrawList dl;
+    Rect panel(50, 50, 100, 100);
+    
+    size_t blur = buildFrame(dl, Color(20, 20, 20), Vec2(700, 500), panel);
+    uint64_t first = dl.backdropHash(blur);
+    
+    blur = buildFrame(dl, Color(30, 20, 20), Vec2(700, 500), panel);
+    EXPECT_NE(dl.backdropHash(blur), first);
+    
+    // Content moving into the blur radius counts too
+    blur = buildFrame(dl, Color(20, 20, 20), Vec2(155, 60), panel);
+    EXPECT_NE(dl.backdropHash(blur), first);
+}
+
+TEST(DrawListBackdropTest, TextureUploadsBeneathInvalidate) {
+    HeadlessWindow window;
+    if (!window.create(16, 16)) {
+        GTEST_SKIP() << "No EGL display available";
+    }
+    window.makeContextCurrent();
+    
+    std::vector<uint8_t> pixels(4 * 4 * 4, 255);
+    Texture texture;
+    ASSERT_TRUE(texture.create(4, 4, pixels.data()));
+    
+    // An image under the blurred panel
+    auto build = [&](DrawList& dl) {
+        dl.clear();
+        dl.pushClipRectFullScreen(Vec2(800, 600));
+        dl.addImage(&texture, Rect(60, 60, 40, 40));
+        dl.addBlurRect(Rect(50, 50, 100, 100), 8.0f);
+        dl.popClipRect();
+        dl.mergeLayers();
+        return dl.commands().size() - 1;
+    };
+    
+    DrawList dl;
+    size_t blur = build(dl);
+    ASSERT_EQ(dl.commands()[blur].type, DrawCommandType::Blur);
+    uint64_t first = dl.backdropHash(blur);
+    EXPECT_EQ(dl.backdropHash(build(dl)), first);
+    
+    // Same geometry, new pixels
+    pixels.assign(pixels.size(), 0);
+    texture.update(0, 0, 4, 4, pixels.data());
+    uint64_t uploaded = dl.backdropHash(build(dl));
+    EXPECT_NE(uploaded, first);
+    EXPECT_EQ(dl.backdropHash(build(dl)), uploaded);
+}
+
+TEST(DrawListTextTest, ColoredRunsMatchPlainGeometry) {
+    Font font;
+    ASSERT_TRUE(font.loadFromFile(testFontPath(), 16.0f));
+    const std::string text = "int x = 42;";
+    const Color plain(200, 200, 200);
+    const Color keyword(86, 156, 214);
+    const Color number(181, 206, 168);
+    
+    DrawList reference;
+    reference.addText(&font, Vec2(10, 20), text, plain);
+    reference.mergeLayers();
+    
+    DrawList colored;
+    colored.addTextColored(&font, Vec2(10, 20), text, {{0, 3, keyword}, {8, 10, number}}, plain);
+    colored.mergeLayers();
+    
+    ASSERT_EQ(colored.vertices().size(), reference.vertices().size());
+    for (size_t i = 0; i < colored.vertices().size(); ++i) {
+        EXPECT_EQ(colored.vertices()[i].pos, reference.vertices()[i].pos);
+    }
+    EXPECT_EQ(colored.commands().size(), 1u);
+    
+    // Spaces have no quad: "int" "x" "=" "42" ";"
+    std::vector<uint32_t> expected = {
+        keyword.toABGR(), keyword.toABGR(), keyword.toABGR(),
+        plain.toABGR(), plain.toABGR(),
+        number.toABGR(), number.toABGR(),
+        plain.toABGR()
+    };
+    EXPECT_EQ(glyphColors(colored), expected);
+}
+
+TEST(DrawListTextTest, DefaultColoredTextDrawsEachRun) {
+    Font font;
+    ASSERT_TRUE(font.loadFromFile(testFontPath(), 16.0f));
+    const std::string text = "int x = 42;";
+    const Color plain(200, 200, 200);
+    const Color keyword(86, 156, 214);
+    const Color number(181, 206, 168);
+    const std::vector<TextColorRun> runs = {{0, 3, keyword}, {8, 10, number}};
+    
+    DrawList batched;
+    batched.addTextColored(&font, Vec2(10, 20), text, runs, plain);
+    batched.mergeLayers();
+    
+    // The interface's fallback for draw lists without a batched override
+    DrawList perRun;
+    perRun.IDrawList::addTextColored(&font, Vec2(10, 20), text, runs, plain);
+    perRun.mergeLayers();
+    
+    ASSERT_EQ(perRun.vertices().size(), batched.vertices().size());
+    EXPECT_EQ(perRun.vertices().front().pos, batched.vertices().front().pos);
+    EXPECT_EQ(glyphColors(perRun), glyphColors(batched));
+}
+
+TEST(DrawListTextTest, RunsUseByteOffsets) {
+    Font font;
+    ASSERT_TRUE(font.loadFromFile(testFontPath(), 16.0f));
+    const Color highlight(255, 0, 0);
+    
+    // "\xC3\xA9" is one two-byte glyph; the run starts after it
+    DrawList dl;
+    dl.pushColor(Color(0, 0, 255));
+    dl.addTextColored(&font, Vec2(0, 0), "\xC3\xA9" "ab", {{2, 3, highlight}});
+    dl.popColor();
+    dl.mergeLayers();
+    
+    std::vector<uint32_t> colors = glyphColors(dl);
+    ASSERT_EQ(colors.size(), 3u);
+    EXPECT_EQ(colors[0], Color(0, 0, 255).toABGR());
+    EXPECT_EQ(colors[1], highlight.toABGR());
+    EXPECT_EQ(colors[2], Color(0, 0, 255).toABGR());
+}
@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+#include <fastener/core/frame_pacer.h>
+#include <fastener/core/profiler.h>
+
+using namespace fst;
+
+namespace {
+
+using Clock = FramePacer::Clock;
+
+Clock::time_point at(float ms) {
+    return Clock::time_point() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<float, std::milli>(ms));
+}
+
+float msUntil(Clock::time_point from, Clock::time_point to) {
+    return std::chrono::duration<float, std::milli>(to - from).count();
+}
+
+// Simulates an unpaced vsynced 60 Hz loop where building a frame takes workMs
+void runFrames(FramePacer& pacer, int frames, float workMs, float& clockMs) {
+    const float interval = 1000.0f / 60.0f;
+    for (int i = 0; i < frames; ++i) {
+        pacer.markInputSampled(at(clockMs));
+        pacer.markFrameBuilt(at(clockMs + workMs));
+        clockMs += interval;  // swap returns on the next vblank
+        pacer.framePresented(at(clockMs));
+    }
+}
+
+} // namespace
+
+//=============================================================================
+// FramePacer Tests
+//=============================================================================
+
+TEST(FramePacerTest, NoWaitUntilIntervalIsKnown) {
+    FramePacer pacer;
+    EXPECT_FLOAT_EQ(pacer.presentInterval(), 0.0f);
+    Clock::time_point wake = pacer.wakeTime();
+    EXPECT_LE(wake, Clock::now());
+}
+
+TEST(FramePacerTest, WakesBeforeDeadlineByWorkAndMargin) {
+    Profiler profiler;
+    FramePacer pacer(&profiler);
+    pacer.setSafetyMargin(2.0f);
+
+    const float interval = 1000.0f / 60.0f;
+    float clockMs = 0.0f;
+    runFrames(pacer, 2, 3.0f, clockMs);
+    
+    // Unpaced, input waits almost a whole refresh before scan-out
+    EXPECT_NEAR(pacer.lastLatency(), interval, 0.01f);
+    
+    for (int i = 0; i < 30; ++i) {
+        // Sample input when the pacer wakes; building takes 3 ms
+        float start = msUntil(Clock::time_point(), pacer.wakeTime());
+        pacer.markInputSampled(at(start));
+        pacer.markFrameBuilt(at(start + 3.0f));
+        clockMs += interval;
+        pacer.framePresented(at(clockMs));
+    }
+
+    EXPECT_NEAR(pacer.presentInterval(), interval, 0.01f);
+    EXPECT_NEAR(pacer.predictedWork(), 3.0f, 0.01f);
+
+    // Wake at deadline - work - margin: latency is work + margin
+    EXPECT_NEAR(msUntil(at(clockMs), pacer.wakeTime()), interval - 5.0f, 0.01f);
+    EXPECT_NEAR(pacer.lastLatency(), 5.0f, 0.01f);
+    EXPECT_GT(profiler.getAverageLatency(), 0.0f);
+}
+
+TEST(FramePacerTest, MissedVblankDoesNotSkewInterval) {
+    FramePacer pacer;
+    float clockMs = 0.0f;
+    runFrames(pacer, 10, 3.0f, clockMs);
+    float interval = pacer.presentInterval();
+
+    // One frame that took two refreshes
+    pacer.markInputSampled(at(clockMs));
+    pacer.markFrameBuilt(at(clockMs + 20.0f));
+    clockMs += 2.0f * 1000.0f / 60.0f;
+    pacer.framePresented(at(clockMs));
+
+    EXPECT_NEAR(pacer.presentInterval(), interval, 0.01f);
+}
+
+TEST(FramePacerTest, DisabledNeverSleeps) {
+    FramePacer pacer;
+    float clockMs = 0.0f;
+    runFrames(pacer, 10, 1.0f, clockMs);
+    pacer.setEnabled(false);
+    Clock::time_point wake = pacer.wakeTime();
+    EXPECT_LE(wake, Clock::now());
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <fastener/graphics/gpu_resource_cache.h>
+#include <vector>
+
+using namespace fst;
+
+//=============================================================================
+// GpuResourceCache Tests
+//=============================================================================
+
+TEST(GpuResourceCacheTest, SecondAcquireSharesTheObject) {
+    GpuResourceCache cache;
+    int creates = 0;
+    auto create = [&] { return static_cast<GpuResourceCache::Handle>(++creates + 10); };
+    
+    EXPECT_EQ(cache.acquire("program", create, nullptr), 11u);
+    EXPECT_EQ(cache.acquire("program", create, nullptr), 11u);
+    EXPECT_EQ(creates, 1);
+    EXPECT_EQ(cache.refCount("program"), 2);
+    EXPECT_EQ(cache.find("program"), 11u);
+}
+
+TEST(GpuResourceCacheTest, LastReleaseDestroys) {
+    GpuResourceCache cache;
+    std::vector<GpuResourceCache::Handle> destroyed;
+    auto destroy = [&](GpuResourceCache::Handle handle) { destroyed.push_back(handle); };
+    
+    cache.acquire("texture", [] { return 7u; }, destroy);
+    cache.acquire("texture", [] { return 8u; }, destroy);
+    
+    cache.release("texture");
+    EXPECT_TRUE(destroyed.empty());
+    cache.release("texture");
+    ASSERT_EQ(destroyed.size(), 1u);
+    EXPECT_EQ(destroyed[0], 7u);
+    EXPECT_EQ(cache.find("texture"), 0u);
+    
+    // Releasing unknown keys is harmless
+    cache.release("texture");
+    EXPECT_EQ(destroyed.size(), 1u);
+}
+
+TEST(GpuResourceCacheTest, FailedCreateIsNotCached) {
+    GpuResourceCache cache;
+    EXPECT_EQ(cache.acquire("program", [] { return 0u; }, nullptr), 0u);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.acquire("program", [] { return 3u; }, nullptr), 3u);
+}
+
+TEST(GpuResourceCacheTest, ClearDestroysEverything) {
+    int destroyed = 0;
+    {
+        GpuResourceCache cache;
+        auto destroy = [&](GpuResourceCache::Handle) { ++destroyed; };
+        cache.acquire("a", [] { return 1u; }, destroy);
+        cache.acquire("b", [] { return 2u; }, destroy);
+        cache.acquire("b", [] { return 2u; }, destroy);
+    }
+    EXPECT_EQ(destroyed, 2);
+}
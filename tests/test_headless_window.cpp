@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <fastener/platform/headless_window.h>
+#include <fastener/core/context.h>
+#include <fastener/graphics/draw_list.h>
+#include <fastener/ui/drag_drop.h>
+
+using namespace fst;
+
+//=============================================================================
+// HeadlessWindow Tests
+//=============================================================================
+
+TEST(HeadlessWindowTest, RendersFrameToReadablePixels) {
+    HeadlessWindow window;
+    if (!window.create(64, 32)) {
+        GTEST_SKIP() << "No EGL display available";
+    }
+    EXPECT_EQ(window.width(), 64);
+    EXPECT_EQ(window.height(), 32);
+    
+    // Drag-drop state is global; a drag left over from another test would
+    // draw its preview into this frame
+    CancelDragDrop();
+    
+    Context ctx;
+    ctx.beginFrame(window);
+    ctx.drawList().addRectFilled(Rect(0, 0, 16, 16), Color(255, 0, 0));
+    ctx.endFrame();
+    window.swapBuffers();
+    
+    std::vector<uint8_t> pixels = window.readPixels();
+    ASSERT_EQ(pixels.size(), 64u * 32u * 4u);
+    
+    // Top-left is the red rect, bottom-right the renderer's clear color
+    const uint8_t* rect = &pixels[(4 * 64 + 4) * 4];
+    EXPECT_GT(rect[0], 200);
+    EXPECT_LT(rect[1], 50);
+    const uint8_t* clear = &pixels[(28 * 64 + 60) * 4];
+    EXPECT_NEAR(clear[0], 26, 2);
+    EXPECT_NEAR(clear[1], 26, 2);
+    EXPECT_NEAR(clear[2], 26, 2);
+}
+
+TEST(HeadlessWindowTest, ResizeReallocatesTarget) {
+    HeadlessWindow window;
+    if (!window.create(32, 32)) {
+        GTEST_SKIP() << "No EGL display available";
+    }
+    window.setSize(48, 24);
+    EXPECT_EQ(window.width(), 48);
+    EXPECT_EQ(window.height(), 24);
+    EXPECT_EQ(window.readPixels().size(), 48u * 24u * 4u);
+    
+    window.close();
+    EXPECT_FALSE(window.isOpen());
+}
@@ -205,3 +205,221 @@ TEST(InputStateTest, TextInputCleared) {
     input.beginFrame();
     EXPECT_EQ(input.textInput(), "");  // Cleared at frame start
 }
+
+TEST(InputStateTest, TextCommitIsOneEvent) {
+    InputState input;
+    
+    input.onTextCommit("\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E");  // A whole IME commit
+    input.onTextInput('!');
+    EXPECT_EQ(input.textInput(), "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E!");
+    ASSERT_EQ(input.events().size(), 2u);
+    EXPECT_EQ(input.events()[0].type, InputEventType::TextCommit);
+    
+    input.onTextCommit("");
+    EXPECT_EQ(input.events().size(), 2u);
+}
+
+TEST(InputStateTest, PreeditPersistsUntilCleared) {
+    InputState input;
+    
+    input.onPreeditChanged("nihon", 2, 2);
+    EXPECT_TRUE(input.hasPreedit());
+    EXPECT_EQ(input.preeditText(), "nihon");
+    EXPECT_EQ(input.preeditCursorBegin(), 2);
+    
+    // Composition state outlives the frame; the range is clamped to the text
+    input.beginFrame();
+    input.onPreeditChanged("nihon", 0, 99);
+    EXPECT_EQ(input.preeditCursorEnd(), 5);
+    EXPECT_TRUE(input.textInput().empty());
+    
+    input.onPreeditChanged("", 0, 0);
+    input.onTextCommit("nihon");
+    EXPECT_FALSE(input.hasPreedit());
+    EXPECT_EQ(input.textInput(), "nihon");
+}
+
+//=============================================================================
+// InputState Event Queue Tests
+//=============================================================================
+
+TEST(InputStateTest, EventsKeepArrivalOrderAndTimestamps) {
+    InputState input;
+    
+    input.onMouseMove(10.0f, 20.0f, 5.000);
+    input.onMouseDown(MouseButton::Left, 5.010);
+    input.onKeyDown(Key::A, 5.020);
+    input.onMouseUp(MouseButton::Left, 5.030);
+    
+    const auto& events = input.events();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[0].type, InputEventType::MouseMove);
+    EXPECT_EQ(events[1].type, InputEventType::MouseDown);
+    EXPECT_EQ(events[2].type, InputEventType::KeyDown);
+    EXPECT_EQ(events[3].type, InputEventType::MouseUp);
+    EXPECT_DOUBLE_EQ(events[1].time, 5.010);
+    
+    input.consumeEvent(2);
+    EXPECT_TRUE(input.events()[2].consumed);
+    
+    input.beginFrame();
+    EXPECT_TRUE(input.events().empty());
+}
+
+TEST(InputStateTest, DoubleClickUsesEventTime) {
+    InputState input;
+    
+    // Both clicks arrive in one frame: frame time cannot tell them apart
+    input.setFrameTime(1.0f);
+    input.onMouseDown(MouseButton::Left, 100.00);
+    input.onMouseUp(MouseButton::Left, 100.05);
+    input.onMouseDown(MouseButton::Left, 100.15);
+    EXPECT_TRUE(input.isMouseDoubleClicked(MouseButton::Left));
+    
+    // Same frame time, but the events are far apart
+    InputState slow;
+    slow.setFrameTime(1.0f);
+    slow.onMouseDown(MouseButton::Left, 100.0);
+    slow.onMouseUp(MouseButton::Left, 100.1);
+    slow.beginFrame();
+    slow.onMouseDown(MouseButton::Left, 101.0);
+    EXPECT_FALSE(slow.isMouseDoubleClicked(MouseButton::Left));
+}
+
+TEST(InputStateTest, ScrollEventsAccumulate) {
+    InputState input;
+    
+    input.onMouseScroll(0.0f, 1.0f);
+    input.onMouseScroll(0.0f, 1.0f);
+    EXPECT_FLOAT_EQ(input.scrollDelta().y, 2.0f);
+}
+
+TEST(InputStateTest, TricklingSpreadsFastClickAcrossFrames) {
+    InputState input;
+    input.setInputTrickling(true);
+    
+    input.onMouseMove(10.0f, 10.0f, 1.00);
+    input.onMouseDown(MouseButton::Left, 1.01);
+    input.onMouseMove(50.0f, 50.0f, 1.02);
+    input.onMouseUp(MouseButton::Left, 1.03);
+    
+    // Frame 1: the press lands at its own position, the rest waits
+    EXPECT_TRUE(input.isMousePressed(MouseButton::Left));
+    EXPECT_FALSE(input.isMouseReleased(MouseButton::Left));
+    EXPECT_FLOAT_EQ(input.mousePos().x, 10.0f);
+    EXPECT_EQ(input.pendingEventCount(), 2u);
+    
+    // Frame 2: the deferred move and release are applied in order
+    input.beginFrame();
+    EXPECT_FALSE(input.isMousePressed(MouseButton::Left));
+    EXPECT_TRUE(input.isMouseReleased(MouseButton::Left));
+    EXPECT_FLOAT_EQ(input.mousePos().x, 50.0f);
+    EXPECT_EQ(input.pendingEventCount(), 0u);
+    ASSERT_EQ(input.events().size(), 2u);
+    EXPECT_EQ(input.events()[0].type, InputEventType::MouseMove);
+}
+
+TEST(InputStateTest, TrickledKeysKeepTheirModifiers) {
+    InputState input;
+    input.setInputTrickling(true);
+    
+    // Tap A, then Ctrl+A, all before the next frame
+    input.onKeyDown(Key::A, 1.00);
+    input.onKeyUp(Key::A, 1.01);
+    input.onModifiersChanged(false, true, false, false, 1.02);
+    input.onKeyDown(Key::A, 1.03);
+    
+    // Frame 1: only the first press; Ctrl is not down yet
+    EXPECT_TRUE(input.isKeyPressed(Key::A));
+    EXPECT_FALSE(input.modifiers().ctrl);
+    EXPECT_EQ(input.pendingEventCount(), 3u);
+    
+    // Frame 2: the release, then Ctrl
+    input.beginFrame();
+    EXPECT_TRUE(input.isKeyReleased(Key::A));
+    EXPECT_TRUE(input.modifiers().ctrl);
+    ASSERT_EQ(input.events().size(), 2u);
+    EXPECT_FALSE(input.events()[0].modifiers.ctrl);
+    EXPECT_EQ(input.events()[1].type, InputEventType::Modifiers);
+    
+    // Frame 3: the second press carries Ctrl
+    input.beginFrame();
+    EXPECT_TRUE(input.isKeyPressed(Key::A));
+    ASSERT_EQ(input.events().size(), 1u);
+    EXPECT_TRUE(input.events()[0].modifiers.ctrl);
+}
+
+TEST(InputStateTest, MouseDeltaIncludesTrickledMoves) {
+    InputState input;
+    input.setInputTrickling(true);
+    
+    input.onMouseMove(10.0f, 10.0f);
+    input.beginFrame();
+    input.onMouseDown(MouseButton::Left);
+    input.onMouseMove(30.0f, 15.0f);
+    EXPECT_EQ(input.pendingEventCount(), 1u);
+    
+    // The held-back move is applied and measured in the same frame
+    input.beginFrame();
+    EXPECT_FLOAT_EQ(input.mousePos().x, 30.0f);
+    EXPECT_FLOAT_EQ(input.mouseDelta().x, 20.0f);
+    EXPECT_FLOAT_EQ(input.mouseDelta().y, 5.0f);
+}
+
+TEST(InputStateTest, WithoutTricklingFastClickCollapses) {
+    InputState input;
+    
+    input.onMouseDown(MouseButton::Left, 1.00);
+    input.onMouseUp(MouseButton::Left, 1.01);
+    EXPECT_TRUE(input.isMousePressed(MouseButton::Left));
+    EXPECT_TRUE(input.isMouseReleased(MouseButton::Left));
+    EXPECT_EQ(input.pendingEventCount(), 0u);
+}
+
+TEST(InputStateTest, FractionalScrollAccumulatesIntoSteps) {
+    InputState input;
+    
+    input.onMouseScroll(0.0f, 0.4f);
+    input.onMouseScroll(0.0f, 0.4f);
+    EXPECT_FLOAT_EQ(input.scrollDelta().y, 0.8f);
+    EXPECT_FLOAT_EQ(input.scrollSteps().y, 0.0f);
+    
+    // The remainder carries into the next frame
+    input.beginFrame();
+    input.onMouseScroll(0.0f, 0.4f);
+    EXPECT_FLOAT_EQ(input.scrollSteps().y, 1.0f);
+}
+
+TEST(InputStateTest, ScrollRemainderResetsOnNewDeviceOrDirection) {
+    InputState input;
+    
+    // A fraction a touchpad left behind does not complete a wheel's half detent
+    input.onMouseScroll(0.0f, 0.7f, -1.0, 12);
+    input.onMouseScroll(0.0f, 0.5f);
+    EXPECT_FLOAT_EQ(input.scrollSteps().y, 0.0f);
+    input.onMouseScroll(0.0f, 0.5f);
+    EXPECT_FLOAT_EQ(input.scrollSteps().y, 1.0f);
+    
+    // Reversing drops the fraction accumulated the other way
+    input.beginFrame();
+    input.onMouseScroll(0.0f, 0.7f, -1.0, 12);
+    input.onMouseScroll(0.0f, -0.5f, -1.0, 12);
+    input.onMouseScroll(0.0f, -0.5f, -1.0, 12);
+    EXPECT_FLOAT_EQ(input.scrollSteps().y, -1.0f);
+}
+
+TEST(InputStateTest, MouseHistoryKeepsCoalescedSamples) {
+    InputState input;
+    
+    input.recordMouseSample(1.0f, 1.0f, 0.001);
+    input.recordMouseSample(2.0f, 2.0f, 0.002);
+    input.onMouseMove(3.0f, 3.0f, 0.003);
+    
+    ASSERT_EQ(input.mouseHistory().size(), 3u);
+    EXPECT_FLOAT_EQ(input.mouseHistory()[1].pos.x, 2.0f);
+    EXPECT_FLOAT_EQ(input.mousePos().x, 3.0f);
+    EXPECT_EQ(input.events().size(), 1u);
+    
+    input.beginFrame();
+    EXPECT_TRUE(input.mouseHistory().empty());
+}
@@ -95,3 +95,203 @@ TEST_F(LayoutTest, TestAllocateRemaining) {
     
     lc.endContainer();
 }
+
+TEST_F(LayoutTest, FlexGrowUsesPreviousFrameMeasure) {
+    LayoutContext lc;
+    Rect root(0, 0, 500, 100);
+    
+    auto frame = [&](Rect& grown, Rect& last) {
+        lc.beginFrame();
+        lc.beginContainer(root, LayoutDirection::Horizontal);
+        lc.setSpacing(10);
+        lc.allocate(100, 20);
+        grown = lc.allocate(0, 20, 1.0f);
+        last = lc.allocate(100, 20);
+        lc.endContainer();
+    };
+    
+    Rect grown, last;
+    frame(grown, last);
+    EXPECT_FLOAT_EQ(grown.width(), 0.0f);  // No measure on first frame
+    
+    frame(grown, last);
+    EXPECT_FLOAT_EQ(grown.x(), 110.0f);
+    EXPECT_FLOAT_EQ(grown.width(), 500.0f - 100.0f - 100.0f - 20.0f);
+    EXPECT_FLOAT_EQ(last.right(), 500.0f);
+}
+
+TEST_F(LayoutTest, MainAlignmentUsesPreviousFrameMeasure) {
+    LayoutContext lc;
+    Rect root(0, 0, 300, 100);
+    
+    Rect item;
+    for (int i = 0; i < 2; ++i) {
+        lc.beginFrame();
+        lc.beginContainer(root, LayoutDirection::Horizontal);
+        lc.setAlignment(Alignment::End, Alignment::Start);
+        item = lc.allocate(100, 20);
+        lc.endContainer();
+    }
+    EXPECT_FLOAT_EQ(item.x(), 200.0f);
+}
+
+TEST_F(LayoutTest, CrossAlignment) {
+    LayoutContext lc;
+    lc.beginContainer(Rect(0, 0, 300, 100), LayoutDirection::Horizontal);
+    lc.setAlignment(Alignment::Start, Alignment::Center);
+    Rect centered = lc.allocate(50, 20);
+    EXPECT_FLOAT_EQ(centered.y(), 40.0f);
+    
+    lc.setAlignment(Alignment::Start, Alignment::Stretch);
+    Rect stretched = lc.allocate(50, 20);
+    EXPECT_FLOAT_EQ(stretched.y(), 0.0f);
+    EXPECT_FLOAT_EQ(stretched.height(), 100.0f);
+    lc.endContainer();
+}
+
+TEST_F(LayoutTest, NestedContainersKeepSeparateMeasures) {
+    LayoutContext lc;
+    Rect first, second;
+    for (int i = 0; i < 2; ++i) {
+        lc.beginFrame();
+        lc.beginContainer(Rect(0, 0, 400, 400), LayoutDirection::Vertical);
+        
+        lc.beginContainer(lc.allocateRemaining(), LayoutDirection::Horizontal);
+        lc.allocate(100, 20);
+        first = lc.allocate(0, 20, 1.0f);
+        lc.endContainer();
+        
+        lc.beginContainer(lc.allocateRemaining(), LayoutDirection::Horizontal);
+        second = lc.allocate(0, 20, 1.0f);
+        lc.endContainer();
+        
+        lc.endContainer();
+    }
+    EXPECT_FLOAT_EQ(first.width(), 300.0f);
+    EXPECT_FLOAT_EQ(second.width(), 400.0f);
+}
+
+TEST_F(LayoutTest, GridPlacesItemsInCells) {
+    LayoutContext lc;
+    lc.beginContainer(Rect(0, 0, 320, 400), LayoutDirection::Vertical);
+    lc.setGrid(3, 10, 5);
+    
+    Rect a = lc.allocate(200, 20);
+    Rect b = lc.allocate(50, 30);
+    lc.allocate(50, 20);
+    Rect d = lc.allocate(50, 20);
+    
+    EXPECT_FLOAT_EQ(a.x(), 0.0f);
+    EXPECT_FLOAT_EQ(a.width(), 100.0f);  // Clamped to column width
+    EXPECT_FLOAT_EQ(b.x(), 110.0f);
+    EXPECT_FLOAT_EQ(d.x(), 0.0f);
+    EXPECT_FLOAT_EQ(d.y(), 35.0f);       // Tallest item in row + row gap
+    
+    lc.endContainer();
+}
+
+TEST_F(LayoutTest, NestingBeyondMaxDepthIsIgnored) {
+    LayoutContext lc;
+    Rect root(0, 0, 100, 100);
+    for (int i = 0; i < constants::MAX_LAYOUT_DEPTH + 4; ++i) {
+        lc.beginContainer(root, LayoutDirection::Vertical);
+    }
+    EXPECT_EQ(lc.depth(), constants::MAX_LAYOUT_DEPTH);
+    for (int i = 0; i < constants::MAX_LAYOUT_DEPTH + 4; ++i) {
+        lc.endContainer();
+    }
+    EXPECT_EQ(lc.depth(), 0);
+}
+
+TEST_F(LayoutTest, WrapMovesOverflowToNextLine) {
+    LayoutContext lc;
+    lc.beginContainer(Rect(0, 0, 250, 400), LayoutDirection::Horizontal);
+    lc.setSpacing(10);
+    lc.setWrap(true);
+    
+    lc.allocate(100, 20);
+    lc.allocate(100, 30);
+    Rect wrapped = lc.allocate(100, 20);
+    EXPECT_FLOAT_EQ(wrapped.x(), 0.0f);
+    EXPECT_FLOAT_EQ(wrapped.y(), 40.0f);  // Tallest item in line + spacing
+    
+    lc.endContainer();
+}
+
+TEST_F(LayoutTest, WrapAppliesToNestedContainers) {
+    LayoutContext lc;
+    Rect items[3];
+    
+    // Nested containers wrap by last frame's size, so the second frame settles
+    for (int frame = 0; frame < 2; ++frame) {
+        lc.beginFrame();
+        lc.beginContainer(Rect(0, 0, 250, 400), LayoutDirection::Horizontal);
+        lc.setSpacing(10);
+        lc.setWrap(true);
+        for (Rect& item : items) {
+            lc.beginContainer(lc.allocateContainer(), LayoutDirection::Vertical);
+            item = lc.allocate(100, 30);
+            lc.endContainer();
+        }
+        lc.endContainer();
+    }
+    
+    EXPECT_FLOAT_EQ(items[1].x(), 110.0f);
+    EXPECT_FLOAT_EQ(items[1].y(), 0.0f);
+    EXPECT_FLOAT_EQ(items[2].x(), 0.0f);
+    EXPECT_FLOAT_EQ(items[2].y(), 40.0f);
+}
+
+TEST_F(LayoutTest, VirtualizedGridReturnsVisibleRange) {
+    LayoutContext lc;
+    lc.beginContainer(Rect(0, 0, 400, 100000), LayoutDirection::Vertical);
+    lc.setGrid(4, 0, 0);
+    lc.setScroll(0, 1000);
+    
+    // 100k items in 25k rows of 50px; viewport shows y = [0, 200)
+    ItemRange range = lc.virtualizeGrid(100000, 50, Rect(0, 0, 400, 200));
+    EXPECT_EQ(range.first, 20 * 4);
+    EXPECT_EQ(range.last, 24 * 4);
+    
+    Rect first = lc.allocate(100, 50);
+    EXPECT_FLOAT_EQ(first.x(), 0.0f);
+    EXPECT_FLOAT_EQ(first.y(), 0.0f);
+    
+    lc.endContainer();
+}
+
+TEST_F(LayoutTest, VirtualizedGridClampsExtremeScroll) {
+    LayoutContext lc;
+    lc.beginContainer(Rect(0, 0, 400, 400), LayoutDirection::Vertical);
+    lc.setGrid(1, 0, 0);
+    
+    // Far beyond INT_MAX rows: the range is empty at the end, not garbage
+    lc.setScroll(0, 1e30f);
+    ItemRange range = lc.virtualizeGrid(1000, 0.001f, Rect(0, 0, 400, 400));
+    EXPECT_EQ(range.first, 1000);
+    EXPECT_EQ(range.count(), 0);
+    lc.endContainer();
+    
+    lc.beginContainer(Rect(0, 0, 400, 400), LayoutDirection::Vertical);
+    lc.setGrid(1, 0, 0);
+    lc.setScroll(0, -1e30f);
+    range = lc.virtualizeGrid(1000, 0.001f, Rect(0, 0, 400, 400));
+    EXPECT_EQ(range.first, 0);
+    EXPECT_EQ(range.count(), 0);
+    lc.endContainer();
+}
+
+TEST_F(LayoutTest, VirtualizedGridReportsFullExtent) {
+    LayoutContext lc;
+    lc.beginContainer(Rect(0, 0, 400, 400), LayoutDirection::Vertical);
+    
+    lc.beginContainer(Rect(0, 0, 400, 400), LayoutDirection::Vertical);
+    lc.setGrid(2, 0, 0);
+    ItemRange range = lc.virtualizeGrid(1000, 40, Rect(0, 0, 400, 400));
+    EXPECT_EQ(range.count(), 20);
+    lc.endContainer();
+    
+    Rect after = lc.allocate(10, 10);
+    EXPECT_FLOAT_EQ(after.y(), 500.0f * 40.0f);
+    lc.endContainer();
+}
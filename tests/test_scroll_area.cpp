@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "TestContext.h"
+#include <fastener/widgets/scroll_area.h>
+#include <fastener/ui/layout.h>
+
+using namespace fst;
+using namespace fst::testing;
+
+namespace {
+
+// Render a scroll area whose content is `rows` rows of 20px allocated through the layout
+void renderRows(TestContext& tc, ScrollArea& area, int rows, const ScrollAreaOptions& opts = {}) {
+    tc.beginFrame();
+    area.render(tc.context(), "scroll", Rect(0, 0, 200, 100), [&](const Rect&) {
+        for (int i = 0; i < rows; ++i) {
+            tc.context().layout().allocate(150, 20);
+        }
+    }, opts);
+    tc.endFrame();
+}
+
+} // namespace
+
+TEST(ScrollAreaTest, MeasuresContentFromLayoutAllocations) {
+    TestContext tc;
+    ScrollArea area;
+    renderRows(tc, area, 50);
+    
+    EXPECT_FLOAT_EQ(area.contentSize().y, 1000.0f);
+    EXPECT_FLOAT_EQ(area.contentSize().x, 150.0f);
+}
+
+TEST(ScrollAreaTest, MeasuredContentCanShrinkToEmpty) {
+    TestContext tc;
+    ScrollArea area;
+    renderRows(tc, area, 50);
+    renderRows(tc, area, 0);
+    
+    EXPECT_FLOAT_EQ(area.contentSize().x, 0.0f);
+    EXPECT_FLOAT_EQ(area.contentSize().y, 0.0f);
+}
+
+TEST(ScrollAreaTest, ExplicitContentSizeIsNotMeasured) {
+    TestContext tc;
+    ScrollArea area;
+    area.setContentSize(Vec2(300, 2000));
+    renderRows(tc, area, 5);
+    
+    EXPECT_FLOAT_EQ(area.contentSize().x, 300.0f);
+    EXPECT_FLOAT_EQ(area.contentSize().y, 2000.0f);
+}
+
+TEST(ScrollAreaTest, VisibleRangeFollowsScrollOffset) {
+    TestContext tc;
+    ScrollArea area;
+    renderRows(tc, area, 50);
+    
+    area.setScrollOffset(Vec2(0, 210));
+    renderRows(tc, area, 50);
+    
+    ItemRange range = area.visibleRange(20.0f, 50);
+    EXPECT_EQ(range.first, 10);
+    EXPECT_EQ(range.last, 16);
+}
+
+TEST(ScrollAreaTest, ContentAllocationsAreScrolled) {
+    TestContext tc;
+    ScrollArea area;
+    area.setContentSize(Vec2(150, 1000));
+    area.setScrollOffset(Vec2(0, 40));
+    
+    Rect first;
+    tc.beginFrame();
+    area.render(tc.context(), "scroll", Rect(0, 0, 200, 100), [&](const Rect&) {
+        first = tc.context().layout().allocate(150, 20);
+    });
+    tc.endFrame();
+    
+    EXPECT_FLOAT_EQ(first.y(), -40.0f);
+    EXPECT_FALSE(area.isVisible(first));
+}
+
+TEST(ScrollAreaTest, ScrollToJumpsToMakeAreaVisible) {
+    TestContext tc;
+    ScrollArea area;
+    renderRows(tc, area, 50);
+    
+    area.scrollTo(Rect(0, 500, 10, 20), false);
+    EXPECT_FLOAT_EQ(area.scrollOffset().y, 420.0f);  // Bottom edge aligned with viewport
+    
+    area.scrollTo(Rect(0, 100, 10, 20), false);
+    EXPECT_FLOAT_EQ(area.scrollOffset().y, 100.0f);  // Top edge aligned with viewport
+}
+
+TEST(ScrollAreaTest, SmoothScrollToConverges) {
+    TestContext tc;
+    ScrollArea area;
+    renderRows(tc, area, 50);
+    
+    ScrollAreaOptions opts;
+    opts.smoothScrollSpeed = 1000.0f;
+    area.scrollTo(Rect(0, 500, 10, 20));
+    EXPECT_FLOAT_EQ(area.scrollOffset().y, 0.0f);
+    
+    for (int i = 0; i < 100000 && area.scrollOffset().y != 420.0f; ++i) {
+        renderRows(tc, area, 50, opts);
+    }
+    EXPECT_FLOAT_EQ(area.scrollOffset().y, 420.0f);
+}
@@ -0,0 +1,248 @@
+#include <gtest/gtest.h>
+#include <fastener/widgets/syntax_highlighter.h>
+#include <fastener/widgets/text_buffer.h>
+
+using namespace fst;
+
+namespace {
+
+// Colors that tell token kinds apart in assertions
+SyntaxColors testColors() {
+    SyntaxColors colors;
+    colors.keyword = Color(1, 0, 0);
+    colors.type = Color(2, 0, 0);
+    colors.string = Color(3, 0, 0);
+    colors.number = Color(4, 0, 0);
+    colors.comment = Color(5, 0, 0);
+    colors.preprocessor = Color(6, 0, 0);
+    colors.punctuation = Color(7, 0, 0);
+    return colors;
+}
+
+// Color of the segment covering a column, or black
+Color colorAt(const std::vector<TextSegment>& segments, int column) {
+    for (const TextSegment& segment : segments) {
+        if (column >= segment.startColumn && column < segment.endColumn) return segment.color;
+    }
+    return Color::black();
+}
+
+// Forwards to a real highlighter and counts lines tokenized
+class CountingHighlighter : public SyntaxHighlighter {
+public:
+    explicit CountingHighlighter(std::unique_ptr<SyntaxHighlighter> inner) : m_inner(std::move(inner)) {}
+
+    State highlightLine(std::string_view line, State state, std::vector<TextSegment>& segments) const override {
+        calls++;
+        return m_inner->highlightLine(line, state, segments);
+    }
+
+    mutable int calls = 0;
+
+private:
+    std::unique_ptr<SyntaxHighlighter> m_inner;
+};
+
+} // namespace
+
+//=============================================================================
+// SyntaxHighlighter Tests
+//=============================================================================
+
+TEST(SyntaxHighlighterTest, CppTokens) {
+    auto cpp = SyntaxHighlighter::cpp(testColors());
+    std::vector<TextSegment> segments;
+
+    std::string_view line = "#include <vector>";
+    EXPECT_EQ(cpp->highlightLine(line, 0, segments), 0u);
+    EXPECT_EQ(colorAt(segments, 0), Color(6, 0, 0));
+    EXPECT_EQ(colorAt(segments, 10), Color(3, 0, 0));
+
+    segments.clear();
+    line = "return x + 0x1Fu; // done";
+    cpp->highlightLine(line, 0, segments);
+    EXPECT_EQ(colorAt(segments, 0), Color(1, 0, 0));
+    EXPECT_EQ(colorAt(segments, 7), Color::black());
+    EXPECT_EQ(colorAt(segments, 11), Color(4, 0, 0));
+    EXPECT_EQ(colorAt(segments, 18), Color(5, 0, 0));
+}
+
+TEST(SyntaxHighlighterTest, CppStateSpansLines) {
+    auto cpp = SyntaxHighlighter::cpp(testColors());
+    std::vector<TextSegment> segments;
+
+    SyntaxHighlighter::State state = cpp->highlightLine("int a; /* open", 0, segments);
+    EXPECT_NE(state, 0u);
+    segments.clear();
+    state = cpp->highlightLine("still int */ int b;", state, segments);
+    EXPECT_EQ(state, 0u);
+    EXPECT_EQ(colorAt(segments, 6), Color(5, 0, 0));
+    EXPECT_EQ(colorAt(segments, 13), Color(2, 0, 0));
+
+    // Raw strings end only at their own delimiter
+    segments.clear();
+    state = cpp->highlightLine("auto s = R\"x(", 0, segments);
+    EXPECT_NE(state, 0u);
+    segments.clear();
+    state = cpp->highlightLine(")\" )y\" int", state, segments);
+    EXPECT_NE(state, 0u);
+    segments.clear();
+    state = cpp->highlightLine(")x\" int", state, segments);
+    EXPECT_EQ(state, 0u);
+    EXPECT_EQ(colorAt(segments, 0), Color(3, 0, 0));
+    EXPECT_EQ(colorAt(segments, 4), Color(2, 0, 0));
+}
+
+TEST(SyntaxHighlighterTest, PythonTripleQuotes) {
+    auto python = SyntaxHighlighter::python(testColors());
+    std::vector<TextSegment> segments;
+
+    SyntaxHighlighter::State state = python->highlightLine("doc = '''start", 0, segments);
+    EXPECT_NE(state, 0u);
+    segments.clear();
+    state = python->highlightLine("\"\"\" is not the end", state, segments);
+    EXPECT_NE(state, 0u);
+    segments.clear();
+    state = python->highlightLine("end''' if x: pass # note", state, segments);
+    EXPECT_EQ(state, 0u);
+    EXPECT_EQ(colorAt(segments, 3), Color(3, 0, 0));
+    EXPECT_EQ(colorAt(segments, 7), Color(1, 0, 0));
+    EXPECT_EQ(colorAt(segments, 20), Color(5, 0, 0));
+}
+
+TEST(SyntaxHighlighterTest, JsonKeysAndValues) {
+    auto json = SyntaxHighlighter::json(testColors());
+    std::vector<TextSegment> segments;
+
+    std::string_view line = "{\"size\": -1.5e3, \"name\": \"a\\\"b\", \"ok\": true}";
+    EXPECT_EQ(json->highlightLine(line, 0, segments), 0u);
+    EXPECT_EQ(colorAt(segments, 1), Color(2, 0, 0));
+    EXPECT_EQ(colorAt(segments, 9), Color(4, 0, 0));
+    EXPECT_EQ(colorAt(segments, 26), Color(3, 0, 0));
+    EXPECT_EQ(colorAt(segments, 41), Color(1, 0, 0));
+}
+
+//=============================================================================
+// HighlightCache Tests
+//=============================================================================
+
+TEST(HighlightCacheTest, EditRetokenizesUntilStatesConverge) {
+    std::string text;
+    for (int i = 0; i < 100; ++i) text += "int value" + std::to_string(i) + " = " + std::to_string(i) + ";\n";
+    TextBuffer buffer(text);
+
+    auto counting = std::make_shared<CountingHighlighter>(SyntaxHighlighter::cpp(testColors()));
+    HighlightCache cache;
+    cache.setHighlighter(counting);
+
+    // A budget smaller than the document leaves the rest unstyled for now
+    EXPECT_EQ(cache.update(buffer, buffer.lineCount() - 1, 40), 40);
+    EXPECT_NE(cache.segments(39), nullptr);
+    EXPECT_EQ(cache.segments(40), nullptr);
+    cache.update(buffer, buffer.lineCount() - 1, 1000);
+    EXPECT_EQ(counting->calls, buffer.lineCount());
+
+    // Editing inside a line that keeps its end state costs that line only
+    counting->calls = 0;
+    buffer.insert(buffer.offsetOf({50, 3}), "32");
+    cache.linesChanged(50, 1, 1);
+    cache.update(buffer, buffer.lineCount() - 1, 1000);
+    EXPECT_EQ(counting->calls, 1);
+
+    // A comment closed a few lines later stops once states agree again
+    counting->calls = 0;
+    buffer.insert(buffer.offsetOf({10, 0}), "/*\n");
+    cache.linesChanged(10, 1, 2);
+    buffer.insert(buffer.offsetOf({13, 0}), "*/\n");
+    cache.linesChanged(13, 1, 2);
+    cache.update(buffer, buffer.lineCount() - 1, 1000);
+    EXPECT_EQ(counting->calls, 5);
+    EXPECT_EQ(colorAt(*cache.segments(12), 0), Color(5, 0, 0));
+    EXPECT_EQ(colorAt(*cache.segments(15), 0), Color(2, 0, 0));
+
+    // An unclosed one changes the state of every line after it
+    counting->calls = 0;
+    buffer.insert(buffer.offsetOf({70, 0}), "/*");
+    cache.linesChanged(70, 1, 1);
+    cache.update(buffer, buffer.lineCount() - 1, 1000);
+    EXPECT_EQ(counting->calls, buffer.lineCount() - 70);
+    EXPECT_EQ(colorAt(*cache.segments(90), 0), Color(5, 0, 0));
+}
+
+TEST(HighlightCacheTest, LineCountChangesKeepCachedLinesAligned) {
+    TextBuffer buffer("a = 1\n'''\nb = 2\n'''\nc = 3");
+    auto counting = std::make_shared<CountingHighlighter>(SyntaxHighlighter::python(testColors()));
+    HighlightCache cache;
+    cache.setHighlighter(counting);
+    cache.update(buffer, buffer.lineCount() - 1, 100);
+    EXPECT_EQ(colorAt(*cache.segments(2), 0), Color(3, 0, 0));
+
+    // Dropping lines 1-3 joins the document into two lines
+    size_t begin = buffer.lineStart(1);
+    buffer.erase(begin, buffer.lineStart(4) - begin);
+    cache.linesChanged(1, 4, 1);
+    counting->calls = 0;
+    cache.update(buffer, buffer.lineCount() - 1, 100);
+    ASSERT_EQ(buffer.lineCount(), 2);
+    EXPECT_EQ(counting->calls, 1);
+    EXPECT_EQ(colorAt(*cache.segments(1), 4), Color(4, 0, 0));
+}
+
+TEST(HighlightCacheTest, FarViewIsStyledBeforeTheWalkArrives) {
+    std::string text = "/*\n";
+    for (int i = 1; i < 20000; ++i) text += "int x;\n";
+    TextBuffer buffer(text);
+
+    auto counting = std::make_shared<CountingHighlighter>(SyntaxHighlighter::cpp(testColors()));
+    HighlightCache cache;
+    cache.setHighlighter(counting);
+
+    // The view is tokenized on its own, from a guessed state
+    EXPECT_EQ(cache.update(buffer, 15000, 15039, 2000), 40);
+    EXPECT_EQ(cache.validLines(), 0);
+    ASSERT_NE(cache.segments(15010), nullptr);
+    EXPECT_EQ(colorAt(*cache.segments(15010), 0), Color(2, 0, 0));
+
+    // The walk corrects it on arrival; lines far from the view keep no segments
+    cache.update(buffer, buffer.lineCount() - 1, 100000);
+    EXPECT_EQ(cache.validLines(), buffer.lineCount());
+    EXPECT_EQ(colorAt(*cache.segments(15010), 0), Color(5, 0, 0));
+    EXPECT_EQ(cache.segments(100), nullptr);
+}
+
+TEST(HighlightCacheTest, EditPastTheWindowStopsAtACheckpoint) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) text += "int value = 1;\n";
+    TextBuffer buffer(text);
+
+    auto counting = std::make_shared<CountingHighlighter>(SyntaxHighlighter::cpp(testColors()));
+    HighlightCache cache;
+    cache.setHighlighter(counting);
+    cache.update(buffer, buffer.lineCount() - 1, 100000);
+    ASSERT_EQ(cache.segments(15000), nullptr);
+
+    // Only the lines back to the previous checkpoint and on to the next one
+    counting->calls = 0;
+    buffer.insert(buffer.offsetOf({15000, 12}), "2");
+    cache.linesChanged(15000, 1, 1);
+    cache.update(buffer, buffer.lineCount() - 1, 100000);
+    EXPECT_LE(counting->calls, 200);
+    EXPECT_EQ(cache.validLines(), buffer.lineCount());
+
+    // Checkpoints after an added line move with it
+    counting->calls = 0;
+    buffer.insert(buffer.offsetOf({16000, 0}), "\n");
+    cache.linesChanged(16000, 1, 2);
+    cache.update(buffer, buffer.lineCount() - 1, 100000);
+    EXPECT_LE(counting->calls, 200);
+    EXPECT_EQ(cache.validLines(), buffer.lineCount());
+
+    // An unclosed comment still reaches the end of the document
+    counting->calls = 0;
+    buffer.insert(buffer.offsetOf({17000, 0}), "/*");
+    cache.linesChanged(17000, 1, 1);
+    cache.update(buffer, buffer.lineCount() - 1, 100000);
+    EXPECT_GE(counting->calls, buffer.lineCount() - 17000);
+    cache.update(buffer, 19990, 19999, 2000);
+    EXPECT_EQ(colorAt(*cache.segments(19995), 0), Color(5, 0, 0));
+}
@@ -31,7 +31,7 @@ public:
     void setCursor(Cursor) override {}
     void hideCursor() override {}
     void showCursor() override {}
-    std::string getClipboardText() const override { return clipboard; }
+    std::string getClipboardText() override { return clipboard; }
     void setClipboardText(const std::string& text) override { clipboard = text; }
     void* nativeHandle() const override { return nullptr; }
     InputState& input() override { return inputState; }
@@ -98,3 +98,51 @@ TEST(TextAreaClipboardTest, CtrlAThenCtrlVPastesClipboard) {
 
     EXPECT_EQ(value, "Hi");
 }
+
+class AsyncClipboardWindowStub : public ClipboardWindowStub {
+public:
+    void requestClipboardText(ClipboardCallback callback) override {
+        pending.push_back(std::move(callback));
+    }
+    
+    void deliver() {
+        for (auto& callback : pending) callback(clipboard);
+        pending.clear();
+    }
+    
+    std::vector<ClipboardCallback> pending;
+};
+
+TEST(TextAreaClipboardTest, PasteAppliesWhenClipboardAnswersLater) {
+    AsyncClipboardWindowStub window;
+    Context ctx(false);
+
+    std::string value = "ab";
+    window.clipboard = "XY";
+
+    TextAreaOptions options;
+    options.style = Style().withSize(200, 100);
+
+    window.input().beginFrame();
+    ctx.beginFrame(window);
+    WidgetId id = ctx.makeId("async");
+    ctx.setFocusedWidget(id);
+    window.input().onModifiersChanged(false, true, false, false);
+    window.input().onKeyDown(Key::V);
+    TextArea(ctx, "async", value, options);
+    ctx.endFrame();
+
+    // Nothing is pasted while the owner has not answered
+    EXPECT_EQ(value, "ab");
+    ASSERT_EQ(window.pending.size(), 1u);
+    window.deliver();
+
+    window.input().beginFrame();
+    ctx.beginFrame(window);
+    ctx.setFocusedWidget(id);
+    TextArea(ctx, "async", value, options);
+    ctx.endFrame();
+
+    EXPECT_NE(value.find("XY"), std::string::npos);
+    EXPECT_EQ(value.size(), 4u);
+}
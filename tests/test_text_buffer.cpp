@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+#include <fastener/widgets/text_buffer.h>
+#include <fastener/platform/mapped_file.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+using namespace fst;
+
+namespace {
+
+// Lines of a plain string, for comparing against the buffer
+std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines(1);
+    for (char c : text) {
+        if (c == '\n') lines.emplace_back();
+        else lines.back() += c;
+    }
+    return lines;
+}
+
+} // namespace
+
+//=============================================================================
+// TextBuffer Tests
+//=============================================================================
+
+TEST(TextBufferTest, LinesAndPositions) {
+    TextBuffer buffer("first\r\nsecond\n\nlast");
+    EXPECT_EQ(buffer.text(), "first\nsecond\n\nlast");
+    ASSERT_EQ(buffer.lineCount(), 4);
+    EXPECT_EQ(buffer.line(1), "second");
+    EXPECT_EQ(buffer.line(2), "");
+    EXPECT_EQ(buffer.lineLength(3), 4);
+    EXPECT_EQ(buffer.lineStart(3), 14u);
+    
+    EXPECT_EQ(buffer.offsetOf({1, 3}), 9u);
+    EXPECT_EQ(buffer.positionOf(9), (TextPosition{1, 3}));
+    EXPECT_EQ(buffer.offsetOf({1, 99}), 12u);  // Clamped to the line
+    EXPECT_EQ(buffer.range({0, 3}, {1, 2}), "st\nse");
+    
+    TextBuffer empty;
+    EXPECT_EQ(empty.lineCount(), 1);
+    EXPECT_EQ(empty.line(0), "");
+}
+
+TEST(TextBufferTest, TypingExtendsOnePiece) {
+    TextBuffer buffer("hello world");
+    size_t offset = 5;
+    for (char c : std::string(", dear")) {
+        buffer.insert(offset++, std::string(1, c));
+    }
+    EXPECT_EQ(buffer.text(), "hello, dear world");
+    EXPECT_EQ(buffer.pieceCount(), 3u);  // Head, typed text, tail
+}
+
+TEST(TextBufferTest, RandomEditsMatchString) {
+    std::mt19937 rng(1234);
+    std::string model = "alpha\nbeta\ngamma\n";
+    TextBuffer buffer(model);
+    
+    for (int i = 0; i < 2000; ++i) {
+        size_t offset = rng() % (model.size() + 1);
+        if (rng() % 3 != 0 || model.empty()) {
+            std::string text = (rng() % 4 == 0) ? "\nx" : std::string(1 + rng() % 3, static_cast<char>('a' + rng() % 26));
+            model.insert(offset, text);
+            buffer.insert(offset, text);
+        } else {
+            size_t count = rng() % 6;
+            model.erase(offset, count);
+            buffer.erase(offset, count);
+        }
+    }
+    
+    ASSERT_EQ(buffer.text(), model);
+    std::vector<std::string> lines = splitLines(model);
+    ASSERT_EQ(buffer.lineCount(), static_cast<int>(lines.size()));
+    size_t offset = 0;
+    for (int i = 0; i < buffer.lineCount(); ++i) {
+        EXPECT_EQ(buffer.line(i), lines[i]);
+        EXPECT_EQ(buffer.lineStart(i), offset);
+        EXPECT_EQ(buffer.positionOf(offset), (TextPosition{i, 0}));
+        offset += lines[i].size() + 1;
+    }
+}
+
+TEST(TextBufferTest, LargeDocumentEditsInPlace) {
+    std::string text;
+    for (int i = 0; i < 500000; ++i) {
+        text += "log line " + std::to_string(i) + "\n";
+    }
+    TextBuffer buffer(text);
+    ASSERT_EQ(buffer.lineCount(), 500001);
+    
+    // Split 1000 lines in the middle of the document, then join two
+    for (int i = 0; i < 1000; ++i) {
+        size_t offset = buffer.offsetOf({250000 + 2 * i, 3});
+        buffer.insert(offset, "\n");
+    }
+    EXPECT_EQ(buffer.lineCount(), 501001);
+    EXPECT_EQ(buffer.line(250001), " line 250000");
+    
+    buffer.erase(buffer.lineStart(100) - 1, 1);
+    EXPECT_EQ(buffer.line(99), "log line 99log line 100");
+    EXPECT_EQ(buffer.line(500998), "log line 499999");
+}
+
+TEST(TextBufferTest, ParallelLineIndexMatchesScan) {
+    // Large enough to be split across threads, with breaks on slice edges
+    std::string text(40u << 20, 'x');
+    for (size_t i = 7; i < text.size(); i += 4093) {
+        text[i] = '\n';
+    }
+    text[(8u << 20) - 1] = '\n';
+    text[8u << 20] = '\n';
+    
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\n') expected.push_back(i);
+    }
+    EXPECT_EQ(TextBuffer::indexLines(text.data(), text.size()), expected);
+}
+
+TEST(TextBufferTest, MappedFileIsEditableWithoutCopying) {
+    std::string path = ::testing::TempDir() + "fst_text_buffer_mapped.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "one\r\ntwo\r\nthree";
+    }
+    
+    auto file = std::make_shared<MappedFile>();
+    ASSERT_TRUE(file->open(path));
+    TextBuffer buffer;
+    buffer.setMapped(file, TextBuffer::indexLines(file->data(), file->size()));
+    
+    ASSERT_EQ(buffer.lineCount(), 3);
+    EXPECT_EQ(buffer.line(0), "one");  // CR is not part of the line
+    EXPECT_EQ(buffer.lineLength(1), 3);
+    
+    buffer.insert(buffer.offsetOf({1, 3}), "!");
+    EXPECT_EQ(buffer.line(1), "two!");
+    EXPECT_EQ(buffer.text(), "one\r\ntwo!\r\nthree");
+    
+    file.reset();  // The buffer keeps the mapping alive
+    EXPECT_EQ(buffer.line(2), "three");
+    
+    buffer = TextBuffer();
+    std::remove(path.c_str());
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <fastener/widgets/text_editor.h>
+#include "TestContext.h"
+#include <filesystem>
+#include <functional>
+
+using namespace fst;
+using namespace fst::testing;
+
+namespace {
+
+std::string testFontPath() {
+    namespace fs = std::filesystem;
+    fs::path root = fs::path(__FILE__).parent_path().parent_path();
+    return (root / "assets" / "arial.ttf").string();
+}
+
+// Renders a focused editor for one frame, feeding input queued by `input`
+class EditorHarness {
+public:
+    EditorHarness() {
+        m_loaded = tc.context().loadFont(testFontPath(), 16.0f);
+    }
+
+    bool loaded() const { return m_loaded; }
+
+    void frame(const std::function<void(InputState&)>& input) {
+        InputState& state = tc.window().input();
+        state.beginFrame();
+        input(state);
+
+        tc.beginFrame();
+        Context& ctx = tc.context();
+        ctx.setFocusedWidget(ctx.makeId("text_editor_" + std::to_string(reinterpret_cast<std::uintptr_t>(&editor))));
+        editor.render(ctx, Rect(0, 0, 400, 300));
+        tc.endFrame();
+    }
+
+    void type(const std::string& text) {
+        frame([&](InputState& state) { state.onTextCommit(text); });
+    }
+
+    void press(Key key) {
+        frame([&](InputState& state) { state.onKeyDown(key); });
+        frame([&](InputState& state) { state.onKeyUp(key); });
+    }
+
+    TestContext tc;
+    TextEditor editor;
+
+private:
+    bool m_loaded = false;
+};
+
+} // namespace
+
+//=============================================================================
+// TextEditor Typed Undo Tests
+//=============================================================================
+
+TEST(TextEditorUndoTest, TypingWithinAWordIsOneStep) {
+    EditorHarness harness;
+    ASSERT_TRUE(harness.loaded());
+
+    harness.type("a");
+    harness.type("b");
+    harness.type("c");
+    EXPECT_EQ(harness.editor.getText(), "abc");
+
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "");
+    EXPECT_FALSE(harness.editor.canUndo());
+}
+
+TEST(TextEditorUndoTest, NewWordStartsNewStep) {
+    EditorHarness harness;
+    ASSERT_TRUE(harness.loaded());
+
+    // Trailing spaces stay with the word before them
+    harness.type("ab");
+    harness.type(" ");
+    harness.type("c");
+    harness.type("d");
+    EXPECT_EQ(harness.editor.getText(), "ab cd");
+
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "ab ");
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "");
+}
+
+TEST(TextEditorUndoTest, CaretMoveSplitsTyping) {
+    EditorHarness harness;
+    ASSERT_TRUE(harness.loaded());
+
+    harness.type("ab");
+    harness.press(Key::Left);
+    harness.type("x");
+    EXPECT_EQ(harness.editor.getText(), "axb");
+
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "ab");
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "");
+}
+
+TEST(TextEditorUndoTest, NewlineSplitsTyping) {
+    EditorHarness harness;
+    ASSERT_TRUE(harness.loaded());
+
+    harness.type("ab");
+    harness.press(Key::Enter);
+    harness.type("c");
+    EXPECT_EQ(harness.editor.getText(), "ab\nc");
+
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "ab\n");
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "ab");
+    harness.editor.undo();
+    EXPECT_EQ(harness.editor.getText(), "");
+}
@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+#include <fastener/widgets/text_search.h>
+#include <fastener/widgets/text_editor.h>
+#include <fastener/core/constants.h>
+
+using namespace fst;
+
+namespace {
+
+std::vector<TextMatch> searchAll(const TextBuffer& buffer, const SearchQuery& query) {
+    TextSearch search;
+    EXPECT_TRUE(search.start(buffer, query));
+    search.wait();
+    std::vector<TextMatch> matches;
+    search.collect(matches);
+    return matches;
+}
+
+std::vector<size_t> offsets(const std::vector<TextMatch>& matches) {
+    std::vector<size_t> result;
+    for (const TextMatch& match : matches) result.push_back(match.offset);
+    return result;
+}
+
+} // namespace
+
+//=============================================================================
+// TextSearch Tests
+//=============================================================================
+
+TEST(TextSearchTest, LiteralAndCaseInsensitive) {
+    TextBuffer buffer("Find the find\nFIND aaaa");
+
+    EXPECT_EQ(offsets(searchAll(buffer, {"find"})), (std::vector<size_t>{9}));
+    EXPECT_EQ(offsets(searchAll(buffer, {"find", false})), (std::vector<size_t>{0, 9, 14}));
+
+    // Matches do not overlap
+    EXPECT_EQ(offsets(searchAll(buffer, {"aa"})), (std::vector<size_t>{19, 21}));
+
+    // A literal pattern may span lines
+    std::vector<TextMatch> spanning = searchAll(buffer, {"find\nfind", false});
+    ASSERT_EQ(spanning.size(), 1u);
+    EXPECT_EQ(spanning[0].offset, 9u);
+    EXPECT_EQ(spanning[0].length, 9u);
+}
+
+TEST(TextSearchTest, MatchesAcrossWindowsAndPieces) {
+    const size_t window = constants::TEXT_SEARCH_WINDOW_BYTES;
+    TextBuffer buffer(std::string(window - 3, 'x') + "needle" + std::string(100, 'x') + "needle");
+
+    // Straddles the first window boundary, and an edited piece boundary
+    buffer.insert(window + 50, "nee");
+    buffer.insert(window + 53, "dle");
+    std::vector<TextMatch> matches = searchAll(buffer, {"needle"});
+    EXPECT_EQ(offsets(matches), (std::vector<size_t>{window - 3, window + 50, window + 109}));
+}
+
+TEST(TextSearchTest, RegexPerLine) {
+    TextBuffer buffer("int a = 10;\nfloat b = 2;\nINT c;");
+
+    std::vector<TextMatch> numbers = searchAll(buffer, {"[0-9]+", true, true});
+    ASSERT_EQ(numbers.size(), 2u);
+    EXPECT_EQ(numbers[0].offset, 8u);
+    EXPECT_EQ(numbers[0].length, 2u);
+    EXPECT_EQ(numbers[1].offset, 22u);
+
+    EXPECT_EQ(offsets(searchAll(buffer, {"^int\\b", false, true})), (std::vector<size_t>{0, 25}));
+
+    // Empty matches are skipped; invalid patterns are rejected up front
+    EXPECT_TRUE(searchAll(buffer, {"q*", true, true}).empty());
+    TextSearch search;
+    EXPECT_FALSE(search.start(buffer, {"(", true, true}));
+}
+
+TEST(TextSearchTest, RegexOnLongLineMatchesAcrossChunks) {
+    const size_t chunk = constants::TEXT_SEARCH_REGEX_CHUNK_BYTES;
+    std::string line = std::string(chunk - 2, 'x') + "a1234b";
+    line += std::string(2 * chunk - line.size() - 1, 'x') + "a99b";
+    line += std::string(3 * chunk, 'x');
+    TextBuffer buffer(line + "\nxx");
+
+    std::vector<TextMatch> matches = searchAll(buffer, {"a[0-9]+b", true, true});
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(matches[0].offset, chunk - 2);
+    EXPECT_EQ(matches[0].length, 6u);
+    EXPECT_EQ(matches[1].offset, 2 * chunk - 1);
+
+    // Anchors only match at the real line ends, not at chunk edges
+    EXPECT_EQ(offsets(searchAll(buffer, {"^x", true, true})), (std::vector<size_t>{0, line.size() + 1}));
+    EXPECT_EQ(offsets(searchAll(buffer, {"x$", true, true})), (std::vector<size_t>{line.size() - 1, line.size() + 2}));
+}
+
+TEST(TextSearchTest, SnapshotIsIndependentOfEdits) {
+    TextBuffer buffer("alpha beta alpha");
+    TextSearch search;
+    ASSERT_TRUE(search.start(buffer, {"alpha"}));
+    buffer.erase(0, 6);
+    buffer.insert(0, "alpha alpha ");
+    search.wait();
+
+    std::vector<TextMatch> matches;
+    EXPECT_EQ(search.collect(matches), 2u);
+    EXPECT_EQ(offsets(matches), (std::vector<size_t>{0, 11}));
+    EXPECT_EQ(search.collect(matches), 0u);
+}
+
+TEST(TextSearchTest, RestartDropsCancelledResults) {
+    // One long line, so the first regex search is still running when replaced
+    std::string text;
+    for (int i = 0; i < 50000; ++i) text += "ab ";
+    TextBuffer buffer(text);
+
+    TextSearch search;
+    ASSERT_TRUE(search.start(buffer, {"a", true, true}));
+    ASSERT_TRUE(search.start(buffer, {"b", true, true}));
+    search.wait();
+
+    std::vector<TextMatch> matches;
+    EXPECT_EQ(search.collect(matches), 50000u);
+    for (const TextMatch& match : matches) {
+        ASSERT_EQ(match.offset % 3, 1u);
+    }
+
+    search.cancel();
+    EXPECT_FALSE(search.isRunning());
+    EXPECT_EQ(search.collect(matches), 0u);
+}
+
+//=============================================================================
+// TextEditor Find / Replace Tests
+//=============================================================================
+
+TEST(TextEditorFindTest, FindNextWrapsAndReplaceSelectsNext) {
+    TextEditor editor;
+    editor.setText("one two one\none");
+    ASSERT_TRUE(editor.find({"one"}));
+    editor.waitForSearch();
+    ASSERT_EQ(editor.matches().size(), 3u);
+
+    editor.setCursor({0, 5});
+    ASSERT_TRUE(editor.findNext());
+    EXPECT_EQ(editor.cursor(), (TextPosition{0, 11}));
+    ASSERT_TRUE(editor.findNext());
+    EXPECT_EQ(editor.cursor(), (TextPosition{1, 3}));
+    ASSERT_TRUE(editor.findNext());
+    EXPECT_EQ(editor.cursor(), (TextPosition{0, 3}));
+    ASSERT_TRUE(editor.findPrevious());
+    EXPECT_EQ(editor.cursor(), (TextPosition{1, 3}));
+
+    // The selection is the first match; replacing moves on to the next
+    ASSERT_TRUE(editor.findNext());
+    EXPECT_TRUE(editor.replace("1"));
+    EXPECT_EQ(editor.cursor(), (TextPosition{0, 9}));
+    EXPECT_TRUE(editor.replace("1"));
+    EXPECT_TRUE(editor.replace("1"));
+    EXPECT_EQ(editor.getText(), "1 two 1\n1");
+    EXPECT_FALSE(editor.replace("1"));
+
+    editor.undo();
+    EXPECT_EQ(editor.getText(), "1 two 1\none");
+}
+
+TEST(TextEditorFindTest, ReplaceAllIsOneUndoStep) {
+    std::string text;
+    for (int i = 0; i < 100000; ++i) text += (i % 2 == 0) ? "foo bar\n" : "bar foo foo\n";
+    const std::string original = text;
+
+    TextEditor editor;
+    editor.setText(text);
+    ASSERT_TRUE(editor.find({"foo"}));
+    EXPECT_EQ(editor.replaceAll("quux"), 150000u);
+
+    std::string expected;
+    for (int i = 0; i < 100000; ++i) expected += (i % 2 == 0) ? "quux bar\n" : "bar quux quux\n";
+    EXPECT_EQ(editor.getText(), expected);
+
+    // Edits restart the search; the replaced text no longer matches
+    editor.waitForSearch();
+    EXPECT_TRUE(editor.matches().empty());
+
+    // Edits drop the matches at once; the restart waits for typing to pause
+    editor.undo();
+    EXPECT_EQ(editor.getText(), original);
+    EXPECT_FALSE(editor.canUndo());
+    EXPECT_TRUE(editor.matches().empty());
+    EXPECT_TRUE(editor.isSearching());
+    editor.waitForSearch();
+    EXPECT_EQ(editor.matches().size(), 150000u);
+
+    editor.redo();
+    EXPECT_EQ(editor.getText(), expected);
+}
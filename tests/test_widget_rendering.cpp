@@ -50,7 +50,7 @@ public:
     void setCursor(Cursor ) override {}
     void hideCursor() override {}
     void showCursor() override {}
-    std::string getClipboardText() const override { return ""; }
+    std::string getClipboardText() override { return ""; }
     void setClipboardText(const std::string&) override {}
     void* nativeHandle() const override { return nullptr; }
     InputState& input() override { return m_input; }
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <fastener/platform/window_manager.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace fst;
+using namespace std::chrono_literals;
+
+//=============================================================================
+// WindowManager Timer Tests (no display needed)
+//=============================================================================
+
+TEST(WindowManagerTimerTest, OneShotFiresOnceWhenDue) {
+    WindowManager wm;
+    const auto start = WindowManager::Clock::now();
+    int fired = 0;
+    wm.addTimer(0.5, [&]() { fired++; });
+
+    wm.fireDueTimers(start + 100ms);
+    EXPECT_EQ(fired, 0);
+    wm.fireDueTimers(start + 600ms);
+    EXPECT_EQ(fired, 1);
+    wm.fireDueTimers(start + 2s);
+    EXPECT_EQ(fired, 1);
+}
+
+TEST(WindowManagerTimerTest, RepeatingSkipsMissedPeriods) {
+    WindowManager wm;
+    const auto start = WindowManager::Clock::now();
+    int fired = 0;
+    WindowManager::TimerId id = wm.addTimer(0.1, [&]() { fired++; }, true);
+
+    wm.fireDueTimers(start + 150ms);
+    EXPECT_EQ(fired, 1);
+
+    // A stall covering several periods fires once, not in a burst
+    wm.fireDueTimers(start + 1050ms);
+    EXPECT_EQ(fired, 2);
+    wm.fireDueTimers(start + 1060ms);
+    EXPECT_EQ(fired, 2);
+    wm.fireDueTimers(start + 1250ms);
+    EXPECT_EQ(fired, 3);
+
+    wm.cancelTimer(id);
+    wm.fireDueTimers(start + 5s);
+    EXPECT_EQ(fired, 3);
+}
+
+TEST(WindowManagerTimerTest, CancelFromInsideCallback) {
+    WindowManager wm;
+    const auto start = WindowManager::Clock::now();
+    std::vector<int> order;
+    WindowManager::TimerId second = 0;
+    WindowManager::TimerId repeating = 0;
+
+    // The first callback cancels a timer that is due in the same batch
+    wm.addTimer(0.0, [&]() {
+        order.push_back(1);
+        wm.cancelTimer(second);
+    });
+    second = wm.addTimer(0.0, [&]() { order.push_back(2); });
+
+    // A repeating timer cancelling itself stops after this call
+    repeating = wm.addTimer(0.0, [&]() {
+        order.push_back(3);
+        wm.cancelTimer(repeating);
+    }, true);
+
+    wm.fireDueTimers(start + 10ms);
+    EXPECT_EQ(order, (std::vector<int>{1, 3}));
+
+    wm.fireDueTimers(start + 1s);
+    EXPECT_EQ(order, (std::vector<int>{1, 3}));
+}
+
+TEST(WindowManagerTimerTest, TimerAddedInCallbackWaitsForNextBatch) {
+    WindowManager wm;
+    const auto start = WindowManager::Clock::now();
+    int inner = 0;
+    wm.addTimer(0.0, [&]() {
+        wm.addTimer(0.0, [&]() { inner++; });
+    });
+
+    wm.fireDueTimers(start + 10ms);
+    EXPECT_EQ(inner, 0);
+    wm.fireDueTimers(start + 1s);
+    EXPECT_EQ(inner, 1);
+}
+
+TEST(WindowManagerLoopTest, RunReturnsWithoutWindows) {
+    WindowManager wm;
+    bool framed = false;
+    wm.run([&](Window&) { framed = true; });
+    EXPECT_FALSE(framed);
+    EXPECT_EQ(wm.windowCount(), 0u);
+}
+
+#ifdef __linux__
+TEST(WindowManagerLoopTest, WatchFdRejectsInvalidArguments) {
+    WindowManager wm;
+    EXPECT_FALSE(wm.watchFd(-1, []() {}));
+    EXPECT_FALSE(wm.watchFd(0, nullptr));
+    EXPECT_TRUE(wm.watchFd(0, []() {}));
+    wm.unwatchFd(0);
+}
+#endif
+
+//=============================================================================
+// WindowManager Window List Tests (need a display; skipped without one)
+//=============================================================================
+
+namespace {
+
+WindowConfig smallWindow(const char* title, int width = 200, int height = 150) {
+    WindowConfig config;
+    config.title = title;
+    config.width = width;
+    config.height = height;
+    config.decorated = false;
+    config.vsync = false;
+    config.msaaSamples = 0;
+    return config;
+}
+
+bool contains(const std::vector<Window*>& list, const Window* window) {
+    return std::find(list.begin(), list.end(), window) != list.end();
+}
+
+class WindowManagerListTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        main = wm.createWindow(smallWindow("Main"));
+        if (!main) {
+            GTEST_SKIP() << "No display available";
+        }
+    }
+
+    // Map and visibility changes arrive asynchronously from the server
+    template <typename Done>
+    bool pollUntil(Done done) {
+        const auto deadline = std::chrono::steady_clock::now() + 2s;
+        do {
+            wm.pollAllEvents();
+            if (done()) return true;
+            std::this_thread::sleep_for(10ms);
+        } while (std::chrono::steady_clock::now() < deadline);
+        return false;
+    }
+
+    WindowManager wm;
+    Window* main = nullptr;
+};
+
+} // namespace
+
+TEST_F(WindowManagerListTest, CreateAndDestroyKeepListsInSync) {
+    Window* tools = wm.createWindow(smallWindow("Tools"));
+    ASSERT_NE(tools, nullptr);
+    EXPECT_EQ(wm.windows(), (std::vector<Window*>{main, tools}));
+    EXPECT_EQ(wm.windowCount(), 2u);
+
+    ASSERT_TRUE(pollUntil([&]() { return wm.windowsNeedingRedraw().size() == 2; }));
+
+    // Both lists drop the window immediately, without another poll
+    wm.destroyWindow(tools);
+    EXPECT_EQ(wm.windows(), (std::vector<Window*>{main}));
+    EXPECT_EQ(wm.windowsNeedingRedraw(), (std::vector<Window*>{main}));
+
+    wm.destroyWindow(main);
+    EXPECT_TRUE(wm.windows().empty());
+    EXPECT_TRUE(wm.windowsNeedingRedraw().empty());
+    EXPECT_EQ(wm.mainWindow(), nullptr);
+}
+
+TEST_F(WindowManagerListTest, MinimizedAndClosedWindowsAreNotRedrawn) {
+    Window* tools = wm.createWindow(smallWindow("Tools"));
+    ASSERT_NE(tools, nullptr);
+    ASSERT_TRUE(pollUntil([&]() { return wm.windowsNeedingRedraw().size() == 2; }));
+
+    main->minimize();
+    ASSERT_TRUE(pollUntil([&]() { return !contains(wm.windowsNeedingRedraw(), main); }));
+    EXPECT_EQ(main->visibility(), WindowVisibility::Minimized);
+    EXPECT_TRUE(contains(wm.windowsNeedingRedraw(), tools));
+    EXPECT_TRUE(contains(wm.windows(), main));
+
+    main->restore();
+    EXPECT_TRUE(pollUntil([&]() { return contains(wm.windowsNeedingRedraw(), main); }));
+
+    // A closed window stays managed until destroyed, but is never drawn
+    tools->close();
+    wm.pollAllEvents();
+    EXPECT_EQ(tools->visibility(), WindowVisibility::Unmapped);
+    EXPECT_FALSE(contains(wm.windowsNeedingRedraw(), tools));
+    EXPECT_TRUE(contains(wm.windows(), tools));
+}
+
+TEST_F(WindowManagerListTest, ObscuredWindowIsNotRedrawn) {
+    main->setPosition(0, 0);
+    ASSERT_TRUE(pollUntil([&]() { return contains(wm.windowsNeedingRedraw(), main); }));
+
+    // A larger window on top covers the main window completely
+    Window* cover = wm.createWindow(smallWindow("Cover", 400, 300));
+    ASSERT_NE(cover, nullptr);
+    cover->setPosition(0, 0);
+    if (!pollUntil([&]() { return main->visibility() == WindowVisibility::Obscured; })) {
+        GTEST_SKIP() << "Window manager did not stack the cover window on top";
+    }
+    EXPECT_FALSE(contains(wm.windowsNeedingRedraw(), main));
+    EXPECT_TRUE(contains(wm.windowsNeedingRedraw(), cover));
+
+    // Uncovered again once the cover is gone
+    wm.destroyWindow(cover);
+    EXPECT_TRUE(pollUntil([&]() { return contains(wm.windowsNeedingRedraw(), main); }));
+}
+
+TEST_F(WindowManagerListTest, DestroyingDragSourceEndsDrag) {
+    Window* tools = wm.createWindow(smallWindow("Tools"));
+    Window* other = wm.createWindow(smallWindow("Other"));
+    ASSERT_NE(tools, nullptr);
+    ASSERT_NE(other, nullptr);
+
+    wm.beginCrossWindowDrag(tools);
+    EXPECT_TRUE(wm.isCrossWindowDragActive());
+
+    // Destroying an unrelated window leaves the drag alone
+    wm.destroyWindow(other);
+    EXPECT_TRUE(wm.isCrossWindowDragActive());
+    EXPECT_EQ(wm.dragSourceWindow(), tools);
+
+    wm.destroyWindow(tools);
+    EXPECT_FALSE(wm.isCrossWindowDragActive());
+    EXPECT_EQ(wm.dragSourceWindow(), nullptr);
+}